@@ -8,6 +8,7 @@
 #include <rz_util/rz_path.h>
 #include <rz_lib.h>
 #include <config.h>
+#include "analysis_private.h"
 
 RZ_LIB_VERSION(rz_analysis);
 
@@ -140,6 +141,7 @@ RZ_API RzAnalysis *rz_analysis_new(void) {
 	analysis->debug_info = rz_analysis_debug_info_new();
 	analysis->cmpval = UT64_MAX;
 	analysis->lea_jmptbl_ip = UT64_MAX;
+	analysis->op_cache = rz_analysis_op_cache_new();
 	return analysis;
 }
 
@@ -176,8 +178,7 @@ RZ_API RzAnalysis *rz_analysis_free(RzAnalysis *a) {
 	rz_platform_target_free(a->arch_target);
 	rz_platform_target_index_free(a->platform_target);
 	rz_reg_free(a->reg);
-	ht_up_free(a->ht_xrefs_from);
-	ht_up_free(a->ht_xrefs_to);
+	rz_analysis_xref_store_free(a->xref_store);
 	rz_list_free(a->leaddrs);
 	rz_type_db_free(a->typedb);
 	sdb_free(a->sdb);
@@ -192,6 +193,7 @@ RZ_API RzAnalysis *rz_analysis_free(RzAnalysis *a) {
 	ht_pp_free(a->ht_global_var);
 	rz_list_free(a->plugins);
 	rz_analysis_debug_info_free(a->debug_info);
+	rz_analysis_op_cache_free(a->op_cache);
 	free(a);
 	return NULL;
 }
@@ -249,6 +251,10 @@ RZ_API bool rz_analysis_set_reg_profile(RzAnalysis *analysis) {
 	bool ret = false;
 	char *p = rz_analysis_get_reg_profile(analysis);
 	if (p) {
+		if (analysis->op_cache && analysis->reg->reg_profile_str && strcmp(analysis->reg->reg_profile_str, p)) {
+			// the cached ops point to the RzRegItem of the old profile
+			rz_analysis_op_cache_clear(analysis);
+		}
 		rz_reg_set_profile_string(analysis->reg, p);
 		ret = true;
 	}
@@ -261,6 +267,9 @@ static bool analysis_set_os(RzAnalysis *analysis, const char *os) {
 	if (!os || !*os) {
 		os = RZ_SYS_OS;
 	}
+	if (analysis->op_cache && RZ_STR_NE(analysis->os, os)) {
+		rz_analysis_op_cache_clear(analysis);
+	}
 	free(analysis->os);
 	analysis->os = strdup(os);
 	char *types_dir = rz_path_system(RZ_SDB_TYPES);
@@ -479,6 +488,7 @@ RZ_API void rz_analysis_purge(RzAnalysis *analysis) {
 	rz_list_free(analysis->fcns);
 	analysis->fcns = rz_list_newf(rz_analysis_function_free);
 	rz_analysis_purge_imports(analysis);
+	rz_analysis_op_cache_clear(analysis);
 }
 
 /**
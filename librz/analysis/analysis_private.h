@@ -6,4 +6,7 @@
 
 #include <rz_analysis.h>
 
+RZ_IPI void rz_analysis_xref_store_free(RZ_NULLABLE RzAnalysisXRefStore *st);
+RZ_IPI void rz_analysis_op_cache_store(RzAnalysis *analysis, const RzAnalysisOp *op, int ret, const ut8 *data, int len, RzAnalysisOpMask mask);
+
 #endif // RZ_ANALYSIS_PRIVATE_H
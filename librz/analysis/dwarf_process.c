@@ -799,7 +799,7 @@ static char *die_name(const RzBinDwarfDie *die, Context *ctx) {
 		return attr_string(attr, ctx);
 	}
 	attr = rz_bin_dwarf_die_get_attr(die, DW_AT_specification);
-	RzBinDwarfDie *spec = attr ? ht_up_find(ctx->dw->info->die_by_offset, rz_bin_dwarf_attr_udata(attr), NULL) : NULL;
+	RzBinDwarfDie *spec = attr ? rz_bin_dwarf_info_die_at(ctx->dw->info, rz_bin_dwarf_attr_udata(attr)) : NULL;
 	if (!spec) {
 		return NULL;
 	}
@@ -907,7 +907,7 @@ static RzBaseType *RzBaseType_from_die(Context *ctx, const RzBinDwarfDie *die) {
 	rz_vector_foreach(&die->attrs, attr) {
 		switch (attr->at) {
 		case DW_AT_specification: {
-			RzBinDwarfDie *decl = ht_up_find(ctx->dw->info->die_by_offset, rz_bin_dwarf_attr_udata(attr), NULL);
+			RzBinDwarfDie *decl = rz_bin_dwarf_info_die_at(ctx->dw->info, rz_bin_dwarf_attr_udata(attr));
 			if (!decl) {
 				goto err;
 			}
@@ -1074,7 +1074,7 @@ static RZ_OWN RzType *type_parse_from_offset_internal(
 	}
 	set_u_add(visited, offset);
 
-	RzBinDwarfDie *die = ht_up_find(ctx->dw->info->die_by_offset, offset, NULL);
+	RzBinDwarfDie *die = rz_bin_dwarf_info_die_at(ctx->dw->info, offset);
 	if (!die) {
 		return NULL;
 	}
@@ -1239,7 +1239,7 @@ static inline const char *select_name(const char *demangle_name, const char *lin
 }
 
 static RzType *type_parse_from_abstract_origin(Context *ctx, ut64 offset, char **name_out) {
-	RzBinDwarfDie *die = ht_up_find(ctx->dw->info->die_by_offset, offset, NULL);
+	RzBinDwarfDie *die = rz_bin_dwarf_info_die_at(ctx->dw->info, offset);
 	if (!die) {
 		return NULL;
 	}
@@ -1764,7 +1764,7 @@ static bool function_from_die(
 			break;
 		case DW_AT_specification: /* u64 to declaration DIE with more info */
 		{
-			RzBinDwarfDie *spec = ht_up_find(ctx->dw->info->die_by_offset, rz_bin_dwarf_attr_udata(attr), NULL);
+			RzBinDwarfDie *spec = rz_bin_dwarf_info_die_at(ctx->dw->info, rz_bin_dwarf_attr_udata(attr));
 			if (!spec) {
 				RZ_LOG_ERROR("DWARF cannot find specification DIE at 0x%" PFMT64x " f.offset=0x%" PFMT64x "\n",
 					rz_bin_dwarf_attr_udata(attr), die->offset);
@@ -1906,7 +1906,7 @@ static void die_parse(Context *ctx, RzBinDwarfDie *die) {
 
 static RzBinDwarfDie *die_next(RzBinDwarfDie *die, RzBinDWARF *dw) {
 	return (die->sibling > die->offset)
-		? ht_up_find(dw->info->die_by_offset, die->sibling, NULL)
+		? rz_bin_dwarf_info_die_at(dw->info, die->sibling)
 		: die + 1;
 }
 
@@ -1931,7 +1931,7 @@ RZ_API void rz_analysis_dwarf_preprocess_info(
 	};
 	RzBinDwarfCompUnit *unit;
 	rz_vector_foreach(&dw->info->units, unit) {
-		if (rz_vector_empty(&unit->dies)) {
+		if (!rz_bin_dwarf_info_unit_load(dw->info, unit) || rz_vector_empty(&unit->dies)) {
 			continue;
 		}
 		ctx.unit = unit;
@@ -1940,6 +1940,8 @@ RZ_API void rz_analysis_dwarf_preprocess_info(
 			die = die_next(die, dw)) {
 			die_parse(&ctx, die);
 		}
+		// no DIE pointer is held anymore, the units decoded so far can be dropped
+		rz_bin_dwarf_info_trim(dw->info);
 	}
 }
 
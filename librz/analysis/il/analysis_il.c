@@ -106,6 +106,7 @@ RZ_API RZ_OWN RzAnalysisILVM *rz_analysis_il_vm_new(RzAnalysis *a, RZ_NULLABLE R
 		goto ruby_pool;
 	}
 	r->io_buf = rz_buf_new_with_io(&a->iob);
+	r->lift_cache_max_entries = RZ_ANALYSIS_IL_VM_CACHE_DEFAULT_SIZE;
 	setup_vm_from_config(a, r, config);
 	if (!r->vm) {
 		rz_buf_free(r->io_buf);
@@ -119,6 +120,149 @@ ruby_pool:
 	return r;
 }
 
+typedef struct {
+	RzILOpEffect *op; ///< Lifted effect, owned by the entry
+	ut8 bytes[RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE]; ///< Bytes the effect was lifted from
+	int size; ///< Size of the lifted op
+	int bits; ///< Value of analysis->bits when the op was lifted
+} LiftCacheEntry;
+
+/**
+ * \brief Effects lifted by a single plugin configuration, by address.
+ *
+ * The bytes of every entry are compared on each lookup, so any change
+ * of the code (IO writes, self-modifying code) simply lifts it again.
+ */
+typedef struct rz_analysis_il_lift_cache_t {
+	HtUP /*<ut64, LiftCacheEntry *>*/ *entries;
+	const RzAnalysisPlugin *plugin; ///< Plugin used to lift the stored effects
+	char *cpu; ///< Cpu used to lift the stored effects
+	int big_endian; ///< Endianness used to lift the stored effects
+	ut64 gp; ///< Global pointer used to lift the stored effects
+} RzAnalysisILLiftCache;
+
+static void lift_cache_entry_free(HtUPKv *kv) {
+	LiftCacheEntry *entry = kv->value;
+	rz_il_op_effect_free(entry->op);
+	free(entry);
+}
+
+static void lift_cache_free(RZ_NULLABLE RzAnalysisILLiftCache *cache) {
+	if (!cache) {
+		return;
+	}
+	ht_up_free(cache->entries);
+	free(cache->cpu);
+	free(cache);
+}
+
+static bool lift_cache_config_matches(RzAnalysisILLiftCache *cache, RzAnalysis *analysis) {
+	return cache->plugin == analysis->cur &&
+		cache->big_endian == analysis->big_endian &&
+		cache->gp == analysis->gp &&
+		RZ_STR_EQ(cache->cpu, analysis->cpu);
+}
+
+/**
+ * \brief Returns the effect lifted from \p code at \p addr, or NULL if it must be lifted again.
+ */
+static RzILOpEffect *lift_cache_get(RzAnalysis *analysis, RzAnalysisILVM *vm, ut64 addr, const ut8 *code, int *size) {
+	RzAnalysisILLiftCache *cache = vm->lift_cache;
+	if (!cache || !cache->entries || !cache->entries->count || !lift_cache_config_matches(cache, analysis)) {
+		return NULL;
+	}
+	LiftCacheEntry *entry = ht_up_find(cache->entries, addr, NULL);
+	if (!entry) {
+		return NULL;
+	}
+	// same checks rz_analysis_op() does before decoding
+	if (analysis->coreb.archbits) {
+		analysis->coreb.archbits(analysis->coreb.core, addr);
+	}
+	if (entry->bits != analysis->bits || (analysis->pcalign && addr % analysis->pcalign) ||
+		memcmp(entry->bytes, code, entry->size) || rz_analysis_addr_hints_at(analysis, addr)) {
+		return NULL;
+	}
+	*size = entry->size;
+	return entry->op;
+}
+
+/**
+ * \brief Moves the effect of \p op, just lifted from \p code, into the cache.
+ *
+ * \return true if the cache took the ownership of op->il_op, which is then reset
+ */
+static bool lift_cache_set(RzAnalysis *analysis, RzAnalysisILVM *vm, const ut8 *code, RzAnalysisOp *op) {
+	// the effect only depends on the bytes for reentrant plugins, and hints may alter the op
+	if (!vm->lift_cache_max_entries || !analysis->cur->op_reentrant || op->reads_memory || op->size <= 0 || op->size > RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE ||
+		rz_analysis_addr_hints_at(analysis, op->addr)) {
+		return false;
+	}
+	RzAnalysisILLiftCache *cache = vm->lift_cache;
+	if (!cache) {
+		cache = vm->lift_cache = RZ_NEW0(RzAnalysisILLiftCache);
+		if (!cache) {
+			return false;
+		}
+	}
+	if (!cache->entries || cache->entries->count >= vm->lift_cache_max_entries || !lift_cache_config_matches(cache, analysis)) {
+		ht_up_free(cache->entries);
+		cache->entries = ht_up_new(NULL, lift_cache_entry_free, NULL);
+		if (!cache->entries) {
+			return false;
+		}
+		cache->plugin = analysis->cur;
+		cache->big_endian = analysis->big_endian;
+		cache->gp = analysis->gp;
+		free(cache->cpu);
+		cache->cpu = analysis->cpu ? strdup(analysis->cpu) : NULL;
+	}
+	LiftCacheEntry *entry = RZ_NEW0(LiftCacheEntry);
+	if (!entry) {
+		return false;
+	}
+	entry->op = op->il_op;
+	memcpy(entry->bytes, code, op->size);
+	entry->size = op->size;
+	entry->bits = analysis->bits;
+	if (!ht_up_update(cache->entries, op->addr, entry)) {
+		free(entry);
+		return false;
+	}
+	op->il_op = NULL;
+	// the effect is only evaluated by this vm from now on
+	rz_il_vm_resolve_vars(vm->vm, entry->op);
+	return true;
+}
+
+/**
+ * \brief Drops all the effects lifted by \p vm so far.
+ */
+RZ_API void rz_analysis_il_vm_cache_clear(RZ_NONNULL RzAnalysisILVM *vm) {
+	rz_return_if_fail(vm);
+	lift_cache_free(vm->lift_cache);
+	vm->lift_cache = NULL;
+}
+
+/**
+ * \brief Returns the number of lifted effects \p vm keeps to execute them again.
+ */
+RZ_API ut32 rz_analysis_il_vm_cache_size(RZ_NONNULL RzAnalysisILVM *vm) {
+	rz_return_val_if_fail(vm, 0);
+	return vm->lift_cache && vm->lift_cache->entries ? vm->lift_cache->entries->count : 0;
+}
+
+/**
+ * \brief Sets the number of lifted effects \p vm keeps before dropping them all, 0 to lift every instruction again.
+ */
+RZ_API void rz_analysis_il_vm_cache_set_max_entries(RZ_NONNULL RzAnalysisILVM *vm, ut32 max_entries) {
+	rz_return_if_fail(vm);
+	if (max_entries < rz_analysis_il_vm_cache_size(vm)) {
+		rz_analysis_il_vm_cache_clear(vm);
+	}
+	vm->lift_cache_max_entries = max_entries;
+}
+
 /**
  * Frees an RzAnalysisILVM instance
  */
@@ -126,6 +270,7 @@ RZ_API void rz_analysis_il_vm_free(RZ_NULLABLE RzAnalysisILVM *vm) {
 	if (!vm) {
 		return;
 	}
+	lift_cache_free(vm->lift_cache);
 	rz_il_vm_free(vm->vm);
 	rz_il_reg_binding_free(vm->reg_binding);
 	rz_buf_free(vm->io_buf);
@@ -256,11 +401,21 @@ RZ_API RzAnalysisILStepResult rz_analysis_il_vm_step_while(RZ_NONNULL RzAnalysis
 		ut8 code[32] = { 0 };
 		analysis->read_at(analysis, addr, code, sizeof(code));
 		RzAnalysisOp op = { 0 };
-		int r = rz_analysis_op(analysis, &op, addr, code, sizeof(code), RZ_ANALYSIS_OP_MASK_IL | RZ_ANALYSIS_OP_MASK_HINT);
-		RzILOpEffect *ilop = r < 0 ? NULL : op.il_op;
+		bool lifted = false;
+		int size = 0;
+		RzILOpEffect *ilop = lift_cache_get(analysis, vm, addr, code, &size);
+		if (!ilop) {
+			int r = rz_analysis_op(analysis, &op, addr, code, sizeof(code), RZ_ANALYSIS_OP_MASK_IL | RZ_ANALYSIS_OP_MASK_HINT);
+			lifted = true;
+			ilop = r < 0 ? NULL : op.il_op;
+			size = op.size;
+			if (ilop) {
+				lift_cache_set(analysis, vm, code, &op);
+			}
+		}
 
 		if (ilop) {
-			bool succ = rz_il_vm_step(vm->vm, ilop, addr + (op.size > 0 ? op.size : 1));
+			bool succ = rz_il_vm_step(vm->vm, ilop, addr + (size > 0 ? size : 1));
 			if (!succ) {
 				res = RZ_ANALYSIS_IL_STEP_IL_RUNTIME_ERROR;
 			}
@@ -268,7 +423,9 @@ RZ_API RzAnalysisILStepResult rz_analysis_il_vm_step_while(RZ_NONNULL RzAnalysis
 			res = RZ_ANALYSIS_IL_STEP_INVALID_OP;
 		}
 
-		rz_analysis_op_fini(&op);
+		if (lifted) {
+			rz_analysis_op_fini(&op);
+		}
 		if (res != RZ_ANALYSIS_IL_STEP_RESULT_SUCCESS) {
 			break;
 		}
@@ -5,6 +5,7 @@
 #include <rz_analysis.h>
 #include <rz_util.h>
 #include <rz_list.h>
+#include "analysis_private.h"
 
 RZ_API RzAnalysisOp *rz_analysis_op_new(void) {
 	RzAnalysisOp *op = RZ_NEW(RzAnalysisOp);
@@ -125,6 +126,9 @@ RZ_API int rz_analysis_op(RZ_NONNULL RzAnalysis *analysis, RZ_OUT RzAnalysisOp *
 			op->size = 1;
 			return -1;
 		}
+		if (analysis->op_cache && rz_analysis_op_cache_get(analysis, op, addr, data, len, mask, &ret)) {
+			goto hint;
+		}
 		ret = analysis->cur->op(analysis, op, addr, data, len, mask);
 		if (ret < 1) {
 			op->type = RZ_ANALYSIS_OP_TYPE_ILL;
@@ -134,6 +138,9 @@ RZ_API int rz_analysis_op(RZ_NONNULL RzAnalysis *analysis, RZ_OUT RzAnalysisOp *
 		if (op->nopcode < 1) {
 			op->nopcode = 1;
 		}
+		if (analysis->op_cache && analysis->cur->op_reentrant) {
+			rz_analysis_op_cache_store(analysis, op, ret, data, len, mask);
+		}
 	} else if (!memcmp(data, "\xff\xff\xff\xff", RZ_MIN(4, len))) {
 		op->type = RZ_ANALYSIS_OP_TYPE_ILL;
 	} else {
@@ -145,6 +152,7 @@ RZ_API int rz_analysis_op(RZ_NONNULL RzAnalysis *analysis, RZ_OUT RzAnalysisOp *
 	if (!op->mnemonic && (mask & RZ_ANALYSIS_OP_MASK_DISASM)) {
 		RZ_LOG_DEBUG("Warning: unhandled RZ_ANALYSIS_OP_MASK_DISASM in rz_analysis_op\n");
 	}
+hint:
 	if (mask & RZ_ANALYSIS_OP_MASK_HINT) {
 		RzAnalysisHint *hint = rz_analysis_hint_get(analysis, addr);
 		if (hint) {
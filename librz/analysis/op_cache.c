@@ -0,0 +1,335 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file op_cache.c
+ * Bounded, address-keyed store of already decoded instructions.
+ *
+ * Every entry keeps the bytes it was decoded from and the analysis
+ * bits used at that time, so a lookup never returns an op that does
+ * not match the bytes the caller is asking to decode. Only the ops of
+ * plugins flagged with op_reentrant are stored, since the ops of the
+ * other plugins also depend on the previously decoded instructions. Entries are
+ * evicted in insertion order once the cache is full.
+ */
+
+#include "analysis_private.h"
+
+/**
+ * Writes bigger than this are handled by dropping the whole cache
+ * instead of removing the entries one address at a time.
+ */
+#define OP_CACHE_INVALIDATE_MAX_RANGE 0x1000
+
+typedef struct op_cache_entry_t {
+	RzAnalysisOp op; ///< Decoded op, without any hint applied
+	ut8 bytes[RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE]; ///< Bytes the op was decoded from
+	int ret; ///< Value returned by the plugin op callback
+	int bits; ///< Value of analysis->bits when the op was decoded
+	RzAnalysisOpMask mask; ///< Mask used to decode the op
+} OpCacheEntry;
+
+static void op_cache_entry_free(HtUPKv *kv) {
+	OpCacheEntry *entry = kv->value;
+	rz_analysis_op_fini(&entry->op);
+	free(entry);
+}
+
+static bool op_cache_config_matches(RzAnalysisOpCache *cache, RzAnalysis *analysis) {
+	return cache->plugin == analysis->cur &&
+		cache->big_endian == analysis->big_endian &&
+		cache->gp == analysis->gp &&
+		cache->seggrn == analysis->seggrn &&
+		cache->reg == analysis->reg &&
+		(!analysis->reg || cache->reg_gen == analysis->reg->items_gen) &&
+		RZ_STR_EQ(cache->cpu, analysis->cpu) &&
+		RZ_STR_EQ(cache->os, analysis->os);
+}
+
+static void op_cache_config_set(RzAnalysisOpCache *cache, RzAnalysis *analysis) {
+	cache->plugin = analysis->cur;
+	cache->big_endian = analysis->big_endian;
+	cache->gp = analysis->gp;
+	cache->seggrn = analysis->seggrn;
+	cache->reg = analysis->reg;
+	cache->reg_gen = analysis->reg ? analysis->reg->items_gen : 0;
+	free(cache->cpu);
+	cache->cpu = analysis->cpu ? strdup(analysis->cpu) : NULL;
+	free(cache->os);
+	cache->os = analysis->os ? strdup(analysis->os) : NULL;
+}
+
+/**
+ * \brief Copies only the details of \p src which were requested by \p mask
+ * into \p dst, so that the result matches a plugin that honours the mask.
+ */
+static void op_cache_copy(RzAnalysisOp *dst, const RzAnalysisOp *src, RzAnalysisOpMask mask) {
+	*dst = *src;
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(dst->src); i++) {
+		dst->src[i] = NULL;
+	}
+	dst->dst = NULL;
+	dst->access = NULL;
+	dst->mnemonic = src->mnemonic ? strdup(src->mnemonic) : NULL;
+	rz_strbuf_init(&dst->esil);
+	rz_strbuf_init(&dst->opex);
+	if (mask & RZ_ANALYSIS_OP_MASK_ESIL) {
+		rz_strbuf_copy(&dst->esil, (RzStrBuf *)&src->esil);
+	}
+	if (mask & RZ_ANALYSIS_OP_MASK_OPEX) {
+		rz_strbuf_copy(&dst->opex, (RzStrBuf *)&src->opex);
+	}
+	if (!(mask & RZ_ANALYSIS_OP_MASK_VAL)) {
+		return;
+	}
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(dst->src); i++) {
+		dst->src[i] = src->src[i] ? rz_analysis_value_copy(src->src[i]) : NULL;
+	}
+	dst->dst = src->dst ? rz_analysis_value_copy(src->dst) : NULL;
+	if (src->access) {
+		dst->access = rz_list_newf((RzListFree)rz_analysis_value_free);
+		RzListIter *it;
+		RzAnalysisValue *val;
+		rz_list_foreach (src->access, it, val) {
+			rz_list_append(dst->access, rz_analysis_value_copy(val));
+		}
+	}
+}
+
+/**
+ * \brief Returns true when \p op can be stored in the cache.
+ *
+ * Ops owning data that cannot be duplicated (IL, switch tables) or
+ * depending on bytes outside of the op are always decoded again.
+ */
+static bool op_is_cacheable(const RzAnalysisOp *op, int ret) {
+	return ret > 0 && op->size > 0 && op->size <= RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE &&
+		!op->il_op && !op->switch_op && !op->reads_memory;
+}
+
+/**
+ * \brief Makes room for a new entry at \p addr, evicting the oldest one when full.
+ */
+static void op_cache_reserve(RzAnalysisOpCache *cache, ut64 addr) {
+	if (rz_vector_len(&cache->order) < cache->max_entries) {
+		rz_vector_push(&cache->order, &addr);
+		return;
+	}
+	ut64 *slot = rz_vector_index_ptr(&cache->order, cache->order_pos);
+	// the slot may refer to an address already invalidated, deleting it again is harmless.
+	ht_up_delete(cache->entries, *slot);
+	*slot = addr;
+	cache->order_pos = (cache->order_pos + 1) % rz_vector_len(&cache->order);
+}
+
+static bool op_cache_insert(RzAnalysis *analysis, OpCacheEntry *entry) {
+	RzAnalysisOpCache *cache = analysis->op_cache;
+	if (!cache->plugin) {
+		op_cache_config_set(cache, analysis);
+	} else if (!op_cache_config_matches(cache, analysis)) {
+		rz_analysis_op_cache_clear(analysis);
+		op_cache_config_set(cache, analysis);
+	}
+	if (!ht_up_find(cache->entries, entry->op.addr, NULL)) {
+		op_cache_reserve(cache, entry->op.addr);
+	}
+	return ht_up_update(cache->entries, entry->op.addr, entry);
+}
+
+RZ_API RZ_OWN RzAnalysisOpCache *rz_analysis_op_cache_new(void) {
+	RzAnalysisOpCache *cache = RZ_NEW0(RzAnalysisOpCache);
+	if (!cache) {
+		return NULL;
+	}
+	cache->entries = ht_up_new(NULL, op_cache_entry_free, NULL);
+	if (!cache->entries) {
+		free(cache);
+		return NULL;
+	}
+	rz_vector_init(&cache->order, sizeof(ut64), NULL, NULL);
+	cache->max_entries = RZ_ANALYSIS_OP_CACHE_DEFAULT_SIZE;
+	return cache;
+}
+
+RZ_API void rz_analysis_op_cache_free(RZ_NULLABLE RzAnalysisOpCache *cache) {
+	if (!cache) {
+		return;
+	}
+	ht_up_free(cache->entries);
+	rz_vector_fini(&cache->order);
+	free(cache->cpu);
+	free(cache->os);
+	free(cache);
+}
+
+/**
+ * \brief Removes all the decoded ops stored in the cache.
+ *
+ * The hit/miss counters are preserved, see rz_analysis_op_cache_reset_stats().
+ */
+RZ_API void rz_analysis_op_cache_clear(RZ_NONNULL RzAnalysis *analysis) {
+	rz_return_if_fail(analysis && analysis->op_cache);
+	RzAnalysisOpCache *cache = analysis->op_cache;
+	ht_up_free(cache->entries);
+	cache->entries = ht_up_new(NULL, op_cache_entry_free, NULL);
+	rz_vector_clear(&cache->order);
+	cache->order_pos = 0;
+	cache->plugin = NULL;
+	RZ_FREE(cache->cpu);
+	RZ_FREE(cache->os);
+}
+
+/**
+ * \brief Returns the number of decoded ops stored in the cache.
+ */
+RZ_API ut32 rz_analysis_op_cache_size(RZ_NONNULL RzAnalysis *analysis) {
+	rz_return_val_if_fail(analysis && analysis->op_cache, 0);
+	return analysis->op_cache->entries->count;
+}
+
+/**
+ * \brief Sets the maximum number of ops kept by the cache.
+ *
+ * Growing the cache keeps the stored entries, shrinking it drops all of them.
+ *
+ * \param analysis    The RzAnalysis owning the cache
+ * \param max_entries The new bound, 0 disables the cache
+ */
+RZ_API void rz_analysis_op_cache_set_max_entries(RZ_NONNULL RzAnalysis *analysis, ut32 max_entries) {
+	rz_return_if_fail(analysis && analysis->op_cache);
+	RzAnalysisOpCache *cache = analysis->op_cache;
+	if (max_entries < rz_vector_len(&cache->order)) {
+		rz_analysis_op_cache_clear(analysis);
+	}
+	cache->max_entries = max_entries;
+}
+
+/**
+ * \brief Resets the hit and miss counters of the cache.
+ */
+RZ_API void rz_analysis_op_cache_reset_stats(RZ_NONNULL RzAnalysis *analysis) {
+	rz_return_if_fail(analysis && analysis->op_cache);
+	analysis->op_cache->hits = 0;
+	analysis->op_cache->misses = 0;
+}
+
+/**
+ * \brief Drops the cached ops overlapping the range [\p addr, \p addr + \p len).
+ *
+ * Must be called whenever the bytes in the range change, e.g. on IO writes.
+ */
+RZ_API void rz_analysis_op_cache_invalidate(RZ_NONNULL RzAnalysis *analysis, ut64 addr, ut64 len) {
+	rz_return_if_fail(analysis && analysis->op_cache);
+	RzAnalysisOpCache *cache = analysis->op_cache;
+	if (!cache->entries->count || !len) {
+		return;
+	}
+	if (len > OP_CACHE_INVALIDATE_MAX_RANGE) {
+		rz_analysis_op_cache_clear(analysis);
+		return;
+	}
+	// an op starting before addr can still span over the written bytes
+	ut64 from = addr > RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE - 1 ? addr - (RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE - 1) : 0;
+	ut64 to = addr + len < addr ? UT64_MAX : addr + len;
+	for (ut64 at = from; at < to; at++) {
+		OpCacheEntry *entry = ht_up_find(cache->entries, at, NULL);
+		if (entry && at + entry->op.size > addr) {
+			ht_up_delete(cache->entries, at);
+		}
+	}
+}
+
+/**
+ * \brief Stores a decoded op into the cache.
+ *
+ * The op must have been decoded, without hints, with the same plugin, cpu, os,
+ * endianness, bits and segment granularity currently configured in \p analysis
+ * (even when decoded by another RzAnalysis instance). Ops of plugins not
+ * flagged with op_reentrant are never stored. On success the ownership of the op details
+ * is moved into the cache and \p op is reset, otherwise \p op is left untouched.
+ *
+ * \param analysis The RzAnalysis owning the cache
+ * \param op       The decoded op
+ * \param ret      The value returned by the plugin when decoding the op
+ * \param bytes    The bytes the op was decoded from (at least op->size bytes)
+ * \param mask     The mask used to decode the op
+ *
+ * \return true if the op was stored, false otherwise.
+ */
+RZ_API bool rz_analysis_op_cache_set(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL RzAnalysisOp *op, int ret, RZ_NONNULL const ut8 *bytes, RzAnalysisOpMask mask) {
+	rz_return_val_if_fail(analysis && analysis->op_cache && op && bytes, false);
+	if (!analysis->cur || !analysis->cur->op_reentrant || !analysis->op_cache->max_entries || !op_is_cacheable(op, ret)) {
+		return false;
+	}
+	OpCacheEntry *entry = RZ_NEW0(OpCacheEntry);
+	if (!entry) {
+		return false;
+	}
+	entry->op = *op;
+	memcpy(entry->bytes, bytes, op->size);
+	entry->ret = ret;
+	entry->bits = analysis->bits;
+	entry->mask = mask & ~RZ_ANALYSIS_OP_MASK_HINT;
+	if (!op_cache_insert(analysis, entry)) {
+		free(entry);
+		return false;
+	}
+	rz_analysis_op_init(op);
+	return true;
+}
+
+/**
+ * \brief Stores a copy of \p op, just decoded from \p data by rz_analysis_op(), into the cache.
+ */
+RZ_IPI void rz_analysis_op_cache_store(RzAnalysis *analysis, const RzAnalysisOp *op, int ret, const ut8 *data, int len, RzAnalysisOpMask mask) {
+	if (!analysis->op_cache->max_entries || op->size > len || !op_is_cacheable(op, ret)) {
+		return;
+	}
+	OpCacheEntry *entry = RZ_NEW0(OpCacheEntry);
+	if (!entry) {
+		return;
+	}
+	entry->mask = mask & ~RZ_ANALYSIS_OP_MASK_HINT;
+	op_cache_copy(&entry->op, op, entry->mask);
+	memcpy(entry->bytes, data, op->size);
+	entry->ret = ret;
+	entry->bits = analysis->bits;
+	if (!op_cache_insert(analysis, entry)) {
+		rz_analysis_op_fini(&entry->op);
+		free(entry);
+	}
+}
+
+/**
+ * \brief Looks up a decoded op matching \p data at \p addr in the cache.
+ *
+ * \param analysis The RzAnalysis owning the cache
+ * \param op       An _uninitialized_ RzAnalysisOp to save the result into
+ * \param addr     The address of the op
+ * \param data     The bytes the caller wants to decode
+ * \param len      Length of \p data in bytes
+ * \param mask     The mask requested by the caller (hints are not applied)
+ * \param ret      Where the plugin return value is stored on hit
+ *
+ * \return true on hit and \p op is filled, false otherwise and \p op is untouched.
+ */
+RZ_API bool rz_analysis_op_cache_get(RZ_NONNULL RzAnalysis *analysis, RZ_OUT RzAnalysisOp *op, ut64 addr, RZ_NONNULL const ut8 *data, int len, RzAnalysisOpMask mask, RZ_OUT int *ret) {
+	rz_return_val_if_fail(analysis && analysis->op_cache && op && data && ret, false);
+	RzAnalysisOpCache *cache = analysis->op_cache;
+	if (!cache->max_entries || !analysis->cur || !analysis->cur->op_reentrant) {
+		return false;
+	}
+	OpCacheEntry *entry = NULL;
+	if (cache->entries->count && op_cache_config_matches(cache, analysis)) {
+		entry = ht_up_find(cache->entries, addr, NULL);
+	}
+	RzAnalysisOpMask wanted = mask & ~RZ_ANALYSIS_OP_MASK_HINT;
+	if (!entry || entry->bits != analysis->bits || len < entry->op.size ||
+		(wanted & entry->mask) != wanted || memcmp(entry->bytes, data, entry->op.size)) {
+		cache->misses++;
+		return false;
+	}
+	op_cache_copy(op, &entry->op, wanted);
+	*ret = entry->ret;
+	cache->hits++;
+	return true;
+}
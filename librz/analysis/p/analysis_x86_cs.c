@@ -1229,6 +1229,8 @@ static void anop_esil(RzAnalysis *a, RzAnalysisOp *op, ut64 addr, const ut8 *buf
 	case X86_INS_CALL: {
 		if (a->read_at && a->bits != 16) {
 			ut8 thunk[4] = { 0 };
+			// the esil depends on the bytes at the call target
+			op->reads_memory = true;
 			if (a->read_at(a, (ut64)INSOP(0).imm, thunk, sizeof(thunk))) {
 				/* 8b xx x4    mov <reg>, dword [esp]
 					   c3          ret
@@ -3753,6 +3755,7 @@ RzAnalysisPlugin rz_analysis_plugin_x86_cs = {
 	.name = "x86",
 	.desc = "Capstone X86 analysis",
 	.esil = true,
+	.op_reentrant = true,
 	.license = "BSD",
 	.arch = "x86",
 	.bits = 16 | 32 | 64,
@@ -1072,11 +1072,17 @@ beach:
 	return ret;
 }
 
-static bool store_label_cb(void *j, const ut64 k, const void *v) {
-	pj_kn(j, v, k);
+static bool collect_label_cb(void *user, const ut64 k, const void *v) {
+	rz_vector_push(user, (void *)&k);
 	return true;
 }
 
+static int label_addr_cmp(const void *a, const void *b, void *user) {
+	ut64 aa = *(const ut64 *)a;
+	ut64 ab = *(const ut64 *)b;
+	return aa < ab ? -1 : (aa > ab ? 1 : 0);
+}
+
 static void function_store(RZ_NONNULL Sdb *db, const char *key, RzAnalysisFunction *function) {
 	PJ *j = pj_new();
 	if (!j) {
@@ -1136,9 +1142,18 @@ static void function_store(RZ_NONNULL Sdb *db, const char *key, RzAnalysisFuncti
 	}
 
 	if (function->labels->count) {
+		// sorted by address, the order of the hash table depends on its implementation
+		RzVector addrs;
+		rz_vector_init(&addrs, sizeof(ut64), NULL, NULL);
+		ht_up_foreach(function->labels, collect_label_cb, &addrs);
+		rz_vector_sort(&addrs, label_addr_cmp, false, NULL);
 		pj_ko(j, "labels");
-		ht_up_foreach(function->labels, store_label_cb, j);
+		ut64 *addr;
+		rz_vector_foreach(&addrs, addr) {
+			pj_kn(j, ht_up_find(function->labels, *addr, NULL), *addr);
+		}
 		pj_end(j);
+		rz_vector_fini(&addrs);
 	}
 
 	pj_end(j);
@@ -1403,38 +1418,52 @@ RZ_API bool rz_serialize_analysis_function_noreturn_load(RZ_NONNULL Sdb *db, RZ_
 	return true;
 }
 
-static bool store_xref_cb(void *j, const ut64 k, const void *v) {
-	const RzAnalysisXRef *xref = v;
-	pj_o(j);
-	pj_kn(j, "to", k);
-	if (xref->type != RZ_ANALYSIS_XREF_TYPE_NULL) {
-		char type[2] = { xref->type, '\0' };
-		pj_ks(j, "type", type);
-	}
-	pj_end(j);
-	return true;
-}
+typedef struct {
+	Sdb *db;
+	PJ *j; ///< Array of the xrefs from the current address
+	ut64 from;
+} XRefsSaveCtx;
 
-static bool store_xrefs_list_cb(void *db, const ut64 k, const void *v) {
+static bool store_xrefs_list(XRefsSaveCtx *ctx) {
 	char key[0x20];
-	if (snprintf(key, sizeof(key), "0x%" PFMT64x, k) < 0) {
+	pj_end(ctx->j);
+	bool ret = snprintf(key, sizeof(key), "0x%" PFMT64x, ctx->from) >= 0 &&
+		sdb_set(ctx->db, key, pj_string(ctx->j), 0);
+	pj_free(ctx->j);
+	ctx->j = NULL;
+	return ret;
+}
+
+static bool store_xref_cb(const RzAnalysisXRef *xref, void *user) {
+	XRefsSaveCtx *ctx = user;
+	// the xrefs come sorted by from, each address gets the array of its xrefs
+	if (ctx->j && ctx->from != xref->from && !store_xrefs_list(ctx)) {
 		return false;
 	}
-	PJ *j = pj_new();
-	if (!j) {
-		return false;
+	if (!ctx->j) {
+		ctx->j = pj_new();
+		if (!ctx->j) {
+			return false;
+		}
+		ctx->from = xref->from;
+		pj_a(ctx->j);
 	}
-	pj_a(j);
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach(ht, store_xref_cb, j);
-	pj_end(j);
-	sdb_set(db, key, pj_string(j), 0);
-	pj_free(j);
+	pj_o(ctx->j);
+	pj_kn(ctx->j, "to", xref->to);
+	if (xref->type != RZ_ANALYSIS_XREF_TYPE_NULL) {
+		char type[2] = { xref->type, '\0' };
+		pj_ks(ctx->j, "type", type);
+	}
+	pj_end(ctx->j);
 	return true;
 }
 
 RZ_API void rz_serialize_analysis_xrefs_save(RZ_NONNULL Sdb *db, RZ_NONNULL RzAnalysis *analysis) {
-	ht_up_foreach(analysis->ht_xrefs_from, store_xrefs_list_cb, db);
+	XRefsSaveCtx ctx = { db, NULL, 0 };
+	rz_analysis_xrefs_foreach(analysis, store_xref_cb, &ctx);
+	if (ctx.j) {
+		store_xrefs_list(&ctx);
+	}
 }
 
 static bool xrefs_load_cb(void *user, const char *k, const char *v) {
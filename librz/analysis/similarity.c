@@ -17,20 +17,45 @@
  * If two signatures are of the same size, memcmp is used to perform
  * a fast compare which speeds up the computation and skips the levenshtein
  * distance calculation which is more expensive to perform.
+ *
+ * When matching lists, a MinHash sketch of the byte 4-grams is computed
+ * for each element and, if RzAnalysisMatchOpt.candidate_threshold is set,
+ * the levenshtein distance is only calculated for the pairs whose sketches
+ * share a LSH band and agree on enough values. Both are sized from
+ * RzAnalysisMatchOpt.candidate_recall, so that a pair with a 4-gram similarity
+ * of at least the threshold is compared with at least that probability.
  */
 
 #define iob_read_at(addr, buf, size) (analysis->iob.read_at(analysis->iob.io, addr, buf, size))
 
+#define MINHASH_SIZE    64
+#define MINHASH_SHINGLE 4
+
 typedef ut8 *(*AllocateBuffer)(RzAnalysis *analysis, void *data, ut8 **buffer, ut32 *buf_sz);
+typedef const char *(*ElementName)(void *data);
+
+typedef struct match_element_t {
+	void *data; ///< RzAnalysisBlock or RzAnalysisFunction
+	const char *name; ///< Name used to force a match, can be NULL
+	ut8 *buf;
+	ut32 size;
+	ut32 minhash[MINHASH_SIZE];
+} MatchElement;
 
 typedef struct shared_context_t {
-	const RzList /*<void *>*/ *list_b;
+	MatchElement *elems_b; ///< Elements of list B, in the same order
+	size_t n_elems_b;
+	double threshold; ///< Minimum similarity of the candidate pairs, 0 to compare all the pairs
+	ut32 band_rows; ///< Number of MinHash values in each LSH band
+	ut32 min_equal; ///< Minimum number of equal MinHash values of the candidate pairs
+	HtUP *bands; ///< LSH band hash -> RzVector<ut32> indices in elems_b
+	HtPP *names; ///< Element name -> index + 1 in elems_b
+	ElementName name_cb;
 	RzThreadQueue *queue;
 	RzThreadQueue *matches;
 	RzThreadQueue *unmatch;
 	AllocateBuffer alloc;
-	RzThreadLock *lock_a;
-	RzThreadLock *lock_b;
+	RzThreadLock *lock; ///< Serializes the reads of the elements of list A
 	RzAnalysis *analysis_a;
 	RzAnalysis *analysis_b;
 	RzAtomicBool *loop;
@@ -42,17 +67,177 @@ typedef struct match_ui_info_t {
 	RzAnalysisMatchThreadInfoCb callback;
 } MatchUIInfo;
 
-static bool shared_context_init(SharedContext *context, RzAnalysis *analysis_a, RzAnalysis *analysis_b, RzList /*<void *>*/ *list_a, RzList /*<void *>*/ *list_b, AllocateBuffer alloc_cb) {
-	RzThreadLock *lock_a = rz_th_lock_new(true);
-	RzThreadLock *lock_b = analysis_a == analysis_b ? lock_a : rz_th_lock_new(true);
+static inline ut64 minhash_mix(ut64 x) {
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+	return x;
+}
+
+/**
+ * Computes the MinHash sketch of the set of 4-grams of the buffer; each of
+ * the hash functions is derived from two base hashes of the 4-gram.
+ */
+static void minhash_compute(ut32 minhash[MINHASH_SIZE], const ut8 *buf, ut32 size) {
+	memset(minhash, 0xff, sizeof(ut32) * MINHASH_SIZE);
+	ut32 n_shingles = size > MINHASH_SHINGLE ? size - MINHASH_SHINGLE + 1 : 1;
+	for (ut32 i = 0; i < n_shingles; i++) {
+		ut64 shingle = 0;
+		for (ut32 j = i; j < i + MINHASH_SHINGLE && j < size; j++) {
+			shingle = (shingle << 8) | buf[j];
+		}
+		ut64 h1 = minhash_mix(shingle);
+		ut64 h2 = minhash_mix(shingle ^ 0x9e3779b97f4a7c15ULL) | 1;
+		for (ut32 k = 0; k < MINHASH_SIZE; k++) {
+			ut32 h = (ut32)((h1 + k * h2) >> 32);
+			if (h < minhash[k]) {
+				minhash[k] = h;
+			}
+		}
+	}
+}
+
+static ut32 minhash_equal(const ut32 *minhash_a, const ut32 *minhash_b) {
+	ut32 equal = 0;
+	for (ut32 k = 0; k < MINHASH_SIZE; k++) {
+		equal += minhash_a[k] == minhash_b[k];
+	}
+	return equal;
+}
+
+static ut64 minhash_band(const ut32 *minhash, ut32 band, ut32 rows) {
+	ut64 hash = minhash_mix(band + 1);
+	for (ut32 k = band * rows; k < (band + 1) * rows; k++) {
+		hash = minhash_mix(hash ^ minhash[k]);
+	}
+	return hash;
+}
+
+/**
+ * Picks the largest number of rows of each LSH band such that a pair with a
+ * similarity of \p threshold shares one of the MINHASH_SIZE / rows bands with
+ * a probability of at least \p probability, i.e. 1 - (1 - t^rows)^bands.
+ * Falls back to bands of a single value when no size reaches it.
+ */
+static ut32 minhash_band_rows(double threshold, double probability) {
+	ut32 rows = 1;
+	for (ut32 r = 2; r <= MINHASH_SIZE; r++) {
+		if (1.0 - pow(1.0 - pow(threshold, r), MINHASH_SIZE / r) < probability) {
+			break;
+		}
+		rows = r;
+	}
+	return rows;
+}
+
+/**
+ * Picks the largest number of equal MinHash values that a pair with a
+ * similarity of \p threshold reaches with a probability of at least
+ * \p probability; each value is equal with probability t, so the count
+ * follows a binomial distribution.
+ */
+static ut32 minhash_min_equal(double threshold, double probability) {
+	if (threshold >= 1.0) {
+		return MINHASH_SIZE;
+	}
+	double tail = 0.0;
+	for (ut32 k = MINHASH_SIZE; k > 0; k--) {
+		tail += exp(lgamma(MINHASH_SIZE + 1) - lgamma(k + 1) - lgamma(MINHASH_SIZE - k + 1) +
+			k * log(threshold) + (MINHASH_SIZE - k) * log1p(-threshold));
+		if (tail >= probability) {
+			return k;
+		}
+	}
+	return 0;
+}
+
+static void band_kv_free(HtUPKv *kv) {
+	rz_vector_free(kv->value);
+}
+
+static void match_element_fini(MatchElement *elem) {
+	free(elem->buf);
+	elem->buf = NULL;
+}
+
+static bool match_element_read(MatchElement *elem, RzAnalysis *analysis, void *data, AllocateBuffer alloc_cb, ElementName name_cb) {
+	memset(elem, 0, sizeof(MatchElement));
+	elem->data = data;
+	elem->name = name_cb ? name_cb(data) : NULL;
+	return alloc_cb(analysis, data, &elem->buf, &elem->size);
+}
+
+static bool shared_context_add_candidate(SharedContext *context, MatchElement *elem, ut32 index) {
+	if (elem->name && !ht_pp_find(context->names, elem->name, NULL) &&
+		!ht_pp_insert(context->names, elem->name, (void *)(size_t)(index + 1))) {
+		return false;
+	}
+	if (context->threshold <= 0.0) {
+		return true;
+	}
+	for (ut32 band = 0; band < MINHASH_SIZE / context->band_rows; band++) {
+		ut64 key = minhash_band(elem->minhash, band, context->band_rows);
+		RzVector *bucket = ht_up_find(context->bands, key, NULL);
+		if (!bucket) {
+			if (!(bucket = rz_vector_new(sizeof(ut32), NULL, NULL)) || !ht_up_insert(context->bands, key, bucket)) {
+				rz_vector_free(bucket);
+				return false;
+			}
+		}
+		if (!rz_vector_push(bucket, &index)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Reads the elements of list B once and indexes their sketches, so that
+ * the threads do not need to read them again for each element of list A.
+ */
+static bool shared_context_init_candidates(SharedContext *context, RzAnalysis *analysis_b, RzList /*<void *>*/ *list_b, AllocateBuffer alloc_cb, double threshold, double recall) {
+	context->threshold = RZ_MIN(threshold, 1.0);
+	if (!(recall > 0.0 && recall < 1.0)) {
+		recall = RZ_ANALYSIS_MATCH_CANDIDATE_RECALL;
+	}
+	// a pair missed by either the bands or the count is missed, split the misses among the two
+	double probability = 1.0 - (1.0 - recall) / 2;
+	context->band_rows = minhash_band_rows(context->threshold, probability);
+	context->min_equal = minhash_min_equal(context->threshold, probability);
+	context->names = ht_pp_new(NULL, NULL, NULL);
+	context->bands = ht_up_new(NULL, band_kv_free, NULL);
+	context->elems_b = RZ_NEWS0(MatchElement, rz_list_length(list_b) + 1);
+	if (!context->names || !context->bands || !context->elems_b) {
+		return false;
+	}
+	RzListIter *iter;
+	void *data;
+	rz_list_foreach (list_b, iter, data) {
+		MatchElement *elem = &context->elems_b[context->n_elems_b];
+		if (!match_element_read(elem, analysis_b, data, alloc_cb, context->name_cb)) {
+			RZ_LOG_ERROR("analysis_match: cannot allocate buffer for element %" PFMTSZu " (B)\n", context->n_elems_b);
+			continue;
+		}
+		minhash_compute(elem->minhash, elem->buf, elem->size);
+		if (!shared_context_add_candidate(context, elem, context->n_elems_b)) {
+			match_element_fini(elem);
+			return false;
+		}
+		context->n_elems_b++;
+	}
+	return true;
+}
+
+static bool shared_context_init(SharedContext *context, RzAnalysis *analysis_a, RzAnalysis *analysis_b, RzList /*<void *>*/ *list_a, RzList /*<void *>*/ *list_b, AllocateBuffer alloc_cb, ElementName name_cb, double threshold, double recall) {
+	RzThreadLock *lock = rz_th_lock_new(true);
 	RzThreadQueue *queue = rz_th_queue_from_list(list_a, NULL);
 	RzThreadQueue *matches = rz_th_queue_new(RZ_THREAD_QUEUE_UNLIMITED, NULL);
 	RzThreadQueue *unmatch = rz_th_queue_new(RZ_THREAD_QUEUE_UNLIMITED, NULL);
 	RzAtomicBool *loop = rz_atomic_bool_new(true);
-	if (!lock_a || !lock_b || !queue || !matches || !unmatch || !loop) {
-		rz_th_lock_free(lock_a);
-		lock_a = NULL;
-		rz_th_lock_free(lock_b);
+	if (!lock || !queue || !matches || !unmatch || !loop) {
+		rz_th_lock_free(lock);
 		rz_th_queue_free(queue);
 		rz_th_queue_free(matches);
 		rz_th_queue_free(unmatch);
@@ -60,39 +245,38 @@ static bool shared_context_init(SharedContext *context, RzAnalysis *analysis_a,
 		return false;
 	}
 	context->queue = queue;
-	context->list_b = list_b;
+	context->name_cb = name_cb;
 	context->matches = matches;
 	context->unmatch = unmatch;
 	context->alloc = alloc_cb;
-	context->lock_a = lock_a;
-	context->lock_b = lock_b;
+	context->lock = lock;
 	context->analysis_a = analysis_a;
 	context->analysis_b = analysis_b;
 	context->loop = loop;
-	return true;
+	return shared_context_init_candidates(context, analysis_b, list_b, alloc_cb, threshold, recall);
 }
 
 static void shared_context_fini(SharedContext *context) {
+	for (size_t i = 0; i < context->n_elems_b; i++) {
+		match_element_fini(&context->elems_b[i]);
+	}
+	free(context->elems_b);
+	ht_up_free(context->bands);
+	ht_pp_free(context->names);
 	rz_th_queue_free(context->queue);
 	rz_th_queue_free(context->matches);
 	rz_th_queue_free(context->unmatch);
-	rz_th_lock_free(context->lock_a);
-	if (context->lock_a != context->lock_b) {
-		rz_th_lock_free(context->lock_b);
-	}
-}
-
-static bool shared_context_alloc_a(SharedContext *context, void *ptr, ut8 **buffer, ut32 *buf_sz) {
-	rz_th_lock_enter(context->lock_a);
-	bool res = context->alloc(context->analysis_a, ptr, buffer, buf_sz);
-	rz_th_lock_leave(context->lock_a);
-	return res;
+	rz_th_lock_free(context->lock);
+	rz_atomic_bool_free(context->loop);
 }
 
-static bool shared_context_alloc_b(SharedContext *context, void *ptr, ut8 **buffer, ut32 *buf_sz) {
-	rz_th_lock_enter(context->lock_b);
-	bool res = context->alloc(context->analysis_b, ptr, buffer, buf_sz);
-	rz_th_lock_leave(context->lock_b);
+static bool shared_context_alloc_a(SharedContext *context, void *ptr, MatchElement *elem) {
+	rz_th_lock_enter(context->lock);
+	bool res = match_element_read(elem, context->analysis_a, ptr, context->alloc, context->name_cb);
+	rz_th_lock_leave(context->lock);
+	if (res) {
+		minhash_compute(elem->minhash, elem->buf, elem->size);
+	}
 	return res;
 }
 
@@ -147,15 +331,126 @@ fail:
 	return false;
 }
 
-static double calculate_similarity(const ut8 *buf_a, ut32 size_a, const ut8 *buf_b, ut32 size_b) {
+/**
+ * Calculates the similarity of the two buffers; any similarity below
+ * \p min_similarity is of no interest and is returned as 0.0, which
+ * allows to stop the distance calculation early.
+ */
+static double calculate_similarity(const ut8 *buf_a, ut32 size_a, const ut8 *buf_b, ut32 size_b, double min_similarity) {
 	if (size_a == size_b && !memcmp(buf_a, buf_b, size_b)) {
 		return 1.0;
 	}
-	double similarity = 0.0;
-	if (!rz_diff_levenshtein_distance(buf_a, size_a, buf_b, size_b, NULL, &similarity)) {
+	ut32 length = RZ_MAX(size_a, size_b);
+	// one more edit than the bound, to be safe from rounding errors
+	double max_distance = floor((1.0 - min_similarity) * length) + 1.0;
+	ut32 distance = 0;
+	if (!rz_diff_levenshtein_distance_within(buf_a, size_a, buf_b, size_b, max_distance < UT32_MAX ? (ut32)max_distance : UT32_MAX, &distance)) {
 		return 0.0;
 	}
-	return similarity;
+	return 1.0 - (double)distance / length;
+}
+
+typedef struct match_candidates_t {
+	ut8 *seen; ///< Marks the elements of B already added to indices
+	RzVector /*<ut32>*/ indices; ///< Indices of the candidates in elems_b, sorted
+} MatchCandidates;
+
+static bool match_candidates_init(MatchCandidates *cand, SharedContext *shared) {
+	rz_vector_init(&cand->indices, sizeof(ut32), NULL, NULL);
+	cand->seen = shared->threshold > 0.0 ? calloc(shared->n_elems_b + 1, 1) : NULL;
+	return shared->threshold <= 0.0 || cand->seen;
+}
+
+static void match_candidates_fini(MatchCandidates *cand) {
+	rz_vector_fini(&cand->indices);
+	free(cand->seen);
+}
+
+static int index_cmp(const void *a, const void *b, void *user) {
+	ut32 x = *(const ut32 *)a;
+	ut32 y = *(const ut32 *)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static void match_candidates_add(MatchCandidates *cand, ut32 index) {
+	if (!cand->seen[index]) {
+		cand->seen[index] = 1;
+		rz_vector_push(&cand->indices, &index);
+	}
+}
+
+/**
+ * Collects the elements of B sharing a LSH band or the name with \p elem,
+ * in the same order as list B.
+ */
+static void match_candidates_collect(MatchCandidates *cand, SharedContext *shared, const MatchElement *elem) {
+	rz_vector_clear(&cand->indices);
+	if (shared->threshold <= 0.0) {
+		return;
+	}
+	for (ut32 band = 0; band < MINHASH_SIZE / shared->band_rows; band++) {
+		RzVector *bucket = ht_up_find(shared->bands, minhash_band(elem->minhash, band, shared->band_rows), NULL);
+		if (!bucket) {
+			continue;
+		}
+		ut32 *index;
+		rz_vector_foreach(bucket, index) {
+			match_candidates_add(cand, *index);
+		}
+	}
+	size_t named = elem->name ? (size_t)ht_pp_find(shared->names, elem->name, NULL) : 0;
+	if (named) {
+		match_candidates_add(cand, (ut32)(named - 1));
+	}
+	ut32 *index;
+	rz_vector_foreach(&cand->indices, index) {
+		cand->seen[*index] = 0;
+	}
+	if (rz_vector_len(&cand->indices) > 1) {
+		rz_vector_sort(&cand->indices, index_cmp, false, NULL);
+	}
+}
+
+/**
+ * Finds the element of B most similar to \p elem among the candidates; an
+ * element with the same name is always preferred.
+ */
+static void *match_candidates_best(MatchCandidates *cand, SharedContext *shared, const MatchElement *elem, double *similarity) {
+	bool all = shared->threshold <= 0.0;
+	double max_similarity = 0.0, calc_similarity = 0.0;
+	void *match = NULL;
+
+	match_candidates_collect(cand, shared, elem);
+	size_t n = all ? shared->n_elems_b : rz_vector_len(&cand->indices);
+	for (size_t i = 0; i < n; i++) {
+		if (!rz_atomic_bool_get(shared->loop)) {
+			break;
+		}
+		ut32 index = all ? (ut32)i : *(ut32 *)rz_vector_index_ptr(&cand->indices, i);
+		const MatchElement *other = &shared->elems_b[index];
+		bool same_name = elem->name && other->name && !strcmp(elem->name, other->name);
+		if (!all && !same_name && minhash_equal(elem->minhash, other->minhash) < shared->min_equal) {
+			continue;
+		}
+
+		// a match below both the best similarity and the threshold is never taken
+		double min_similarity = same_name ? 0.0 : RZ_MIN(max_similarity, RZ_ANALYSIS_SIMILARITY_THRESHOLD);
+		calc_similarity = calculate_similarity(elem->buf, elem->size, other->buf, other->size, min_similarity);
+		if (same_name) {
+			max_similarity = calc_similarity;
+			match = other->data;
+			break;
+		} else if (calc_similarity < RZ_ANALYSIS_SIMILARITY_THRESHOLD && calc_similarity <= max_similarity) {
+			continue;
+		}
+		max_similarity = calc_similarity;
+		match = other->data;
+		if (max_similarity >= 1.0) {
+			break;
+		}
+	}
+	*similarity = max_similarity;
+	return match;
 }
 
 static double analysis_similarity_generic(RzAnalysis *analysis_a, void *ptr_a, RzAnalysis *analysis_b, void *ptr_b, AllocateBuffer callback_new) {
@@ -170,7 +465,7 @@ static double analysis_similarity_generic(RzAnalysis *analysis_a, void *ptr_a, R
 		goto fail;
 	}
 
-	similarity = calculate_similarity(buf_a, size_a, buf_b, size_b);
+	similarity = calculate_similarity(buf_a, size_a, buf_b, size_b, 0.0);
 
 fail:
 	free(buf_a);
@@ -267,7 +562,7 @@ static void *match_thread_ui(MatchUIInfo *ui_info) {
 	return NULL;
 }
 
-static RZ_OWN RzAnalysisMatchResult *analysis_match_result_new(RZ_NONNULL RzAnalysisMatchOpt *opt, RZ_NONNULL RzList /*<void *>*/ *list_a, RZ_NONNULL RzList /*<void *>*/ *list_b, RzThreadFunction thread_cb, AllocateBuffer alloc_cb) {
+static RZ_OWN RzAnalysisMatchResult *analysis_match_result_new(RZ_NONNULL RzAnalysisMatchOpt *opt, RZ_NONNULL RzList /*<void *>*/ *list_a, RZ_NONNULL RzList /*<void *>*/ *list_b, RzThreadFunction thread_cb, AllocateBuffer alloc_cb, ElementName name_cb) {
 	size_t pool_size = 1;
 	RzListIter *iter;
 	RzAnalysisMatchPair *pair = NULL;
@@ -279,7 +574,7 @@ static RZ_OWN RzAnalysisMatchResult *analysis_match_result_new(RZ_NONNULL RzAnal
 	SharedContext shared = { 0 };
 	MatchUIInfo ui_info = { 0 };
 
-	if (!unmatch_a || !unmatch_b || !pool || !shared_context_init(&shared, opt->analysis_a, opt->analysis_b, list_a, list_b, alloc_cb)) {
+	if (!unmatch_a || !unmatch_b || !pool || !shared_context_init(&shared, opt->analysis_a, opt->analysis_b, list_a, list_b, alloc_cb, name_cb, opt->candidate_threshold, opt->candidate_recall)) {
 		RZ_LOG_ERROR("analysis_match: cannot initialize search context\n");
 		goto fail;
 	}
@@ -361,43 +656,27 @@ RZ_API void rz_analysis_match_result_free(RZ_NULLABLE RzAnalysisMatchResult *res
 }
 
 static void *analysis_match_basic_blocks(SharedContext *shared) {
-	double max_similarity = 0.0, calc_similarity = 0.0;
-	const RzListIter *iter = NULL;
-	RzAnalysisBlock *bb_a = NULL, *bb_b = NULL, *match = NULL;
+	double max_similarity = 0.0;
+	RzAnalysisBlock *bb_a = NULL, *match = NULL;
 	RzAnalysisMatchPair *pair = NULL;
-	ut32 size_a = 0, size_b = 0;
-	ut8 *buf_a = NULL, *buf_b = NULL;
+	MatchElement elem_a = { 0 };
+	MatchCandidates cand = { 0 };
+
+	if (!match_candidates_init(&cand, shared)) {
+		RZ_LOG_ERROR("analysis_match: cannot allocate candidates\n");
+		rz_atomic_bool_set(shared->loop, false);
+		return NULL;
+	}
 
 	while (rz_atomic_bool_get(shared->loop) && (bb_a = rz_th_queue_pop(shared->queue, false))) {
-		if (!shared_context_alloc_a(shared, bb_a, &buf_a, &size_a)) {
+		if (!shared_context_alloc_a(shared, bb_a, &elem_a)) {
 			RZ_LOG_ERROR("analysis_match: cannot allocate buffer for block 0x%08" PFMT64x " (A)\n", bb_a->addr);
 			rz_th_queue_push(shared->unmatch, bb_a, true);
 			continue;
 		}
 
-		match = NULL;
-		max_similarity = 0.0;
-		rz_list_foreach (shared->list_b, iter, bb_b) {
-			if (!rz_atomic_bool_get(shared->loop)) {
-				break;
-			} else if (!shared_context_alloc_b(shared, bb_b, &buf_b, &size_b)) {
-				RZ_LOG_ERROR("analysis_match: cannot allocate buffer for block 0x%08" PFMT64x " (B)\n", bb_b->addr);
-				continue;
-			}
-
-			calc_similarity = calculate_similarity(buf_a, size_a, buf_b, size_b);
-			free(buf_b);
-
-			if (calc_similarity < RZ_ANALYSIS_SIMILARITY_THRESHOLD && calc_similarity <= max_similarity) {
-				continue;
-			}
-			max_similarity = calc_similarity;
-			match = bb_b;
-			if (max_similarity >= 1.0) {
-				break;
-			}
-		}
-		free(buf_a);
+		match = match_candidates_best(&cand, shared, &elem_a, &max_similarity);
+		match_element_fini(&elem_a);
 
 		if (match && (pair = match_pair_new(bb_a, match, max_similarity))) {
 			rz_th_queue_push(shared->matches, pair, true);
@@ -406,6 +685,7 @@ static void *analysis_match_basic_blocks(SharedContext *shared) {
 		rz_th_queue_push(shared->unmatch, bb_a, true);
 	}
 
+	match_candidates_fini(&cand);
 	return NULL;
 }
 
@@ -420,62 +700,39 @@ static void *analysis_match_basic_blocks(SharedContext *shared) {
  */
 RZ_API RZ_OWN RzAnalysisMatchResult *rz_analysis_match_basic_blocks(RZ_NONNULL RzAnalysisFunction *fcn_a, RZ_NONNULL RzAnalysisFunction *fcn_b, RZ_NONNULL RzAnalysisMatchOpt *opt) {
 	rz_return_val_if_fail(opt && opt->analysis_a && opt->analysis_b && fcn_a && fcn_b, NULL);
-	return analysis_match_result_new(opt, fcn_a->bbs, fcn_b->bbs, (RzThreadFunction)analysis_match_basic_blocks, (AllocateBuffer)basic_block_data_new);
+	return analysis_match_result_new(opt, fcn_a->bbs, fcn_b->bbs, (RzThreadFunction)analysis_match_basic_blocks, (AllocateBuffer)basic_block_data_new, NULL);
 }
 
-static bool function_name_cmp(RzAnalysisFunction *fcn_a, RzAnalysisFunction *fcn_b) {
-	if (RZ_STR_ISEMPTY(fcn_b->name) ||
-		!strncmp(fcn_b->name, "fcn.", strlen("fcn.")) ||
-		RZ_STR_ISEMPTY(fcn_a->name) ||
-		!strncmp(fcn_a->name, "fcn.", strlen("fcn."))) {
-		return false;
+/* Only real names are used to force a match, not the autogenerated ones */
+static const char *function_match_name(RzAnalysisFunction *fcn) {
+	if (RZ_STR_ISEMPTY(fcn->name) || !strncmp(fcn->name, "fcn.", strlen("fcn."))) {
+		return NULL;
 	}
-
-	return !strcmp(fcn_a->name, fcn_b->name);
+	return fcn->name;
 }
 
 static void *analysis_match_functions(SharedContext *shared) {
-	double max_similarity = 0.0, calc_similarity = 0.0;
-	const RzListIter *iter = NULL;
-	RzAnalysisFunction *fcn_a = NULL, *fcn_b = NULL, *match = NULL;
+	double max_similarity = 0.0;
+	RzAnalysisFunction *fcn_a = NULL, *match = NULL;
 	RzAnalysisMatchPair *pair = NULL;
-	ut32 size_a = 0, size_b = 0;
-	ut8 *buf_a = NULL, *buf_b = NULL;
+	MatchElement elem_a = { 0 };
+	MatchCandidates cand = { 0 };
+
+	if (!match_candidates_init(&cand, shared)) {
+		RZ_LOG_ERROR("analysis_match: cannot allocate candidates\n");
+		rz_atomic_bool_set(shared->loop, false);
+		return NULL;
+	}
 
 	while (rz_atomic_bool_get(shared->loop) && (fcn_a = rz_th_queue_pop(shared->queue, false))) {
-		if (!shared_context_alloc_a(shared, fcn_a, &buf_a, &size_a)) {
+		if (!shared_context_alloc_a(shared, fcn_a, &elem_a)) {
 			RZ_LOG_ERROR("analysis_match: cannot allocate buffer for function %s (A)\n", fcn_a->name);
 			rz_th_queue_push(shared->unmatch, fcn_a, true);
 			continue;
 		}
 
-		match = NULL;
-		max_similarity = 0.0;
-		rz_list_foreach (shared->list_b, iter, fcn_b) {
-			if (!rz_atomic_bool_get(shared->loop)) {
-				break;
-			} else if (!shared_context_alloc_b(shared, fcn_b, &buf_b, &size_b)) {
-				RZ_LOG_ERROR("analysis_match: cannot allocate buffer for function %s (B)\n", fcn_b->name);
-				continue;
-			}
-
-			calc_similarity = calculate_similarity(buf_a, size_a, buf_b, size_b);
-			free(buf_b);
-
-			if (function_name_cmp(fcn_a, fcn_b)) {
-				max_similarity = calc_similarity;
-				match = fcn_b;
-				break;
-			} else if (calc_similarity < RZ_ANALYSIS_SIMILARITY_THRESHOLD && calc_similarity <= max_similarity) {
-				continue;
-			}
-			max_similarity = calc_similarity;
-			match = fcn_b;
-			if (max_similarity >= 1.0) {
-				break;
-			}
-		}
-		free(buf_a);
+		match = match_candidates_best(&cand, shared, &elem_a, &max_similarity);
+		match_element_fini(&elem_a);
 
 		if (match && (pair = match_pair_new(fcn_a, match, max_similarity))) {
 			rz_th_queue_push(shared->matches, pair, true);
@@ -484,6 +741,7 @@ static void *analysis_match_functions(SharedContext *shared) {
 		rz_th_queue_push(shared->unmatch, fcn_a, true);
 	}
 
+	match_candidates_fini(&cand);
 	return NULL;
 }
 
@@ -498,5 +756,5 @@ static void *analysis_match_functions(SharedContext *shared) {
  */
 RZ_API RZ_OWN RzAnalysisMatchResult *rz_analysis_match_functions(RzList /*<RzAnalysisFunction *>*/ *list_a, RzList /*<RzAnalysisFunction *>*/ *list_b, RZ_NONNULL RzAnalysisMatchOpt *opt) {
 	rz_return_val_if_fail(opt && opt->analysis_a && opt->analysis_b && list_a && list_b, NULL);
-	return analysis_match_result_new(opt, list_a, list_b, (RzThreadFunction)analysis_match_functions, (AllocateBuffer)function_data_new);
+	return analysis_match_result_new(opt, list_a, list_b, (RzThreadFunction)analysis_match_functions, (AllocateBuffer)function_data_new, (ElementName)function_match_name);
 }
@@ -6,17 +6,8 @@
 
 #include <rz_analysis.h>
 #include <rz_cons.h>
+#include "analysis_private.h"
 
-/*
-DICT
-====
-
-refs 10->20 C 16->10 J 20->10 C
-
-xrefs 20->[10 C] 10 -> [16 J, 20 C]
-
-10 : call 20 16 : jmp 10 20 : call 10
-*/
 // TODO: is it possible to have multiple type for the same (from, to) pair?
 //       if it is, things need to be adjusted
 
@@ -30,86 +21,337 @@ static RzAnalysisXRef *rz_analysis_xref_new(ut64 from, ut64 to, ut64 type) {
 	return xref;
 }
 
-static void rz_analysis_xref_free(RzAnalysisXRef *xref) {
-	free(xref);
-}
-
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xref_list_new() {
 	return rz_list_newf((RzListFree)free);
 }
 
-static void xrefs_ht_free(HtUPKv *kv) {
-	ht_up_free(kv->value);
+/*
+ * The xrefs are stored in columns sorted by (from, to), with an index of
+ * their positions sorted by (to, from), which costs 21 bytes per xref.
+ * New xrefs are kept in a pair of red-black trees until they are enough
+ * to be merged into the columns, while deleted ones are only marked until
+ * the next merge.
+ */
+
+#define XREF_DELETED     0xff
+#define XREF_PENDING_MIN 0x400
+
+typedef struct {
+	ut64 from;
+	ut64 to;
+	RBNode from_rb; ///< In RzAnalysisXRefStore.pending_from
+	RBNode to_rb; ///< In RzAnalysisXRefStore.pending_to
+	ut32 index; ///< Position in the columns, set while merging
+	ut8 type;
+} XRefPending;
+
+struct rz_analysis_xref_store_t {
+	ut64 *from;
+	ut64 *to;
+	ut8 *type; ///< XREF_DELETED for the xrefs deleted since the last merge
+	ut32 *by_to; ///< Positions of the xrefs sorted by (to, from)
+	ut32 len;
+	ut32 deleted;
+	RBTree pending_from; ///< XRefPending sorted by (from, to)
+	RBTree pending_to; ///< XRefPending sorted by (to, from)
+	ut32 pending_len;
+};
+
+static inline int xref_key_cmp(ut64 a1, ut64 a2, ut64 b1, ut64 b2) {
+	if (a1 != b1) {
+		return a1 < b1 ? -1 : 1;
+	}
+	if (a2 != b2) {
+		return a2 < b2 ? -1 : 1;
+	}
+	return 0;
+}
+
+static int pending_from_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	const RzAnalysisXRef *xref = incoming;
+	const XRefPending *p = container_of(in_tree, const XRefPending, from_rb);
+	return xref_key_cmp(xref->from, xref->to, p->from, p->to);
 }
 
-static void xrefs_ref_free(HtUPKv *kv) {
-	rz_analysis_xref_free(kv->value);
+static int pending_to_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	const RzAnalysisXRef *xref = incoming;
+	const XRefPending *p = container_of(in_tree, const XRefPending, to_rb);
+	return xref_key_cmp(xref->to, xref->from, p->to, p->from);
 }
 
-static bool appendRef(void *u, const ut64 k, const void *v) {
-	RzList *list = (RzList *)u;
-	RzAnalysisXRef *xref = (RzAnalysisXRef *)v;
-	RzAnalysisXRef *cloned = rz_analysis_xref_new(xref->from, xref->to, xref->type);
-	if (cloned) {
-		rz_list_append(list, cloned);
-		return true;
+static void pending_free(RBNode *node, void *user) {
+	free(container_of(node, XRefPending, from_rb));
+}
+
+static RzAnalysisXRefStore *xref_store_new(void) {
+	return RZ_NEW0(RzAnalysisXRefStore);
+}
+
+static void xref_store_clear(RzAnalysisXRefStore *st) {
+	free(st->from);
+	free(st->to);
+	free(st->type);
+	free(st->by_to);
+	rz_rbtree_free(st->pending_from, pending_free, NULL);
+	memset(st, 0, sizeof(*st));
+}
+
+RZ_IPI void rz_analysis_xref_store_free(RZ_NULLABLE RzAnalysisXRefStore *st) {
+	if (!st) {
+		return;
 	}
-	return false;
+	xref_store_clear(st);
+	free(st);
 }
 
-static bool mylistrefs_cb(void *list, const ut64 k, const void *v) {
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach(ht, appendRef, list);
-	return true;
+static inline ut32 xref_store_count(RzAnalysisXRefStore *st) {
+	return st->len - st->deleted + st->pending_len;
 }
 
-static int ref_cmp(const RzAnalysisXRef *a, const RzAnalysisXRef *b) {
-	if (a->from < b->from) {
-		return -1;
+/**
+ * Returns the position of the first merged xref not lower than (from, to).
+ */
+static ut32 merged_lower_bound(RzAnalysisXRefStore *st, ut64 from, ut64 to) {
+	ut32 lo = 0, hi = st->len;
+	while (lo < hi) {
+		ut32 mid = lo + (hi - lo) / 2;
+		if (xref_key_cmp(st->from[mid], st->to[mid], from, to) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
 	}
-	if (a->from > b->from) {
-		return 1;
+	return lo;
+}
+
+/**
+ * Returns the position in by_to of the first merged xref to an address not lower than \p to.
+ */
+static ut32 merged_lower_bound_to(RzAnalysisXRefStore *st, ut64 to) {
+	ut32 lo = 0, hi = st->len;
+	while (lo < hi) {
+		ut32 mid = lo + (hi - lo) / 2;
+		if (st->to[st->by_to[mid]] < to) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
 	}
-	if (a->to < b->to) {
-		return -1;
+	return lo;
+}
+
+static bool merged_find(RzAnalysisXRefStore *st, ut64 from, ut64 to, ut32 *pos) {
+	ut32 i = merged_lower_bound(st, from, to);
+	if (i >= st->len || st->from[i] != from || st->to[i] != to) {
+		return false;
 	}
-	if (a->to > b->to) {
-		return 1;
+	*pos = i;
+	return true;
+}
+
+/**
+ * Merges the pending xrefs into the columns and drops the deleted ones.
+ */
+static bool xref_store_merge(RzAnalysisXRefStore *st) {
+	const ut32 len = xref_store_count(st);
+	ut64 *from = RZ_NEWS(ut64, len + 1);
+	ut64 *to = RZ_NEWS(ut64, len + 1);
+	ut8 *type = RZ_NEWS(ut8, len + 1);
+	ut32 *by_to = RZ_NEWS(ut32, len + 1);
+	// new position of each merged xref
+	ut32 *remap = RZ_NEWS(ut32, st->len + 1);
+	if (!from || !to || !type || !by_to || !remap) {
+		free(from);
+		free(to);
+		free(type);
+		free(by_to);
+		free(remap);
+		return false;
 	}
-	return 0;
+
+	ut32 n = 0, i = 0;
+	RBIter it = rz_rbtree_first(st->pending_from);
+	while (true) {
+		while (i < st->len && st->type[i] == XREF_DELETED) {
+			i++;
+		}
+		XRefPending *p = rz_rbtree_iter_has(&it) ? rz_rbtree_iter_get(&it, XRefPending, from_rb) : NULL;
+		if (i < st->len && (!p || xref_key_cmp(st->from[i], st->to[i], p->from, p->to) < 0)) {
+			from[n] = st->from[i];
+			to[n] = st->to[i];
+			type[n] = st->type[i];
+			remap[i++] = n++;
+		} else if (p) {
+			from[n] = p->from;
+			to[n] = p->to;
+			type[n] = p->type;
+			p->index = n++;
+			rz_rbtree_iter_next(&it);
+		} else {
+			break;
+		}
+	}
+
+	n = 0;
+	i = 0;
+	it = rz_rbtree_first(st->pending_to);
+	while (true) {
+		while (i < st->len && st->type[st->by_to[i]] == XREF_DELETED) {
+			i++;
+		}
+		XRefPending *p = rz_rbtree_iter_has(&it) ? rz_rbtree_iter_get(&it, XRefPending, to_rb) : NULL;
+		if (i < st->len) {
+			ut32 pos = st->by_to[i];
+			if (!p || xref_key_cmp(st->to[pos], st->from[pos], p->to, p->from) < 0) {
+				by_to[n++] = remap[pos];
+				i++;
+				continue;
+			}
+		}
+		if (!p) {
+			break;
+		}
+		by_to[n++] = p->index;
+		rz_rbtree_iter_next(&it);
+	}
+	free(remap);
+
+	xref_store_clear(st);
+	st->from = from;
+	st->to = to;
+	st->type = type;
+	st->by_to = by_to;
+	st->len = len;
+	return true;
 }
 
-static void sortxrefs(RzList /*<RzAnalysisXRef *>*/ *list) {
-	rz_list_sort(list, (RzListComparator)ref_cmp);
+static void xref_store_maintain(RzAnalysisXRefStore *st) {
+	if (st->pending_len + st->deleted > RZ_MAX(XREF_PENDING_MIN, st->len / 8)) {
+		// on failure the xrefs just stay pending
+		xref_store_merge(st);
+	}
 }
 
-static void listxrefs(HtUP *m, ut64 addr, RzList /*<RzAnalysisXRef *>*/ *list) {
-	if (addr == UT64_MAX) {
-		ht_up_foreach(m, mylistrefs_cb, list);
-	} else {
-		HtUP *d = ht_up_find(m, addr, NULL);
-		if (d) {
-			ht_up_foreach(d, appendRef, list);
+static bool xref_store_set(RzAnalysisXRefStore *st, ut64 from, ut64 to, RzAnalysisXRefType type) {
+	ut32 i;
+	if (merged_find(st, from, to, &i)) {
+		if (st->type[i] == XREF_DELETED) {
+			st->deleted--;
 		}
+		st->type[i] = type;
+		return true;
+	}
+	RzAnalysisXRef key = { .from = from, .to = to };
+	RBNode *node = rz_rbtree_find(st->pending_from, &key, pending_from_cmp, NULL);
+	if (node) {
+		container_of(node, XRefPending, from_rb)->type = type;
+		return true;
 	}
+	XRefPending *p = RZ_NEW0(XRefPending);
+	if (!p) {
+		return false;
+	}
+	p->from = from;
+	p->to = to;
+	p->type = type;
+	rz_rbtree_insert(&st->pending_from, &key, &p->from_rb, pending_from_cmp, NULL);
+	rz_rbtree_insert(&st->pending_to, &key, &p->to_rb, pending_to_cmp, NULL);
+	st->pending_len++;
+	xref_store_maintain(st);
+	return true;
 }
 
-static bool set_xref(HtUP *m, RzAnalysisXRef *xref, bool from2to) {
-	ut64 key1 = from2to ? xref->from : xref->to;
-	HtUP *ht = ht_up_find(m, key1, NULL);
-	if (!ht) {
-		// RzAnalysis::ht_xrefs_to is responsible for releasing of pointers.
-		HtUPKvFreeFunc cb = from2to ? NULL : xrefs_ref_free;
-		ht = ht_up_new(NULL, cb, NULL);
-		if (!ht) {
+static bool xref_store_del(RzAnalysisXRefStore *st, ut64 from, ut64 to) {
+	ut32 i;
+	if (merged_find(st, from, to, &i)) {
+		if (st->type[i] == XREF_DELETED) {
 			return false;
 		}
-		if (!ht_up_insert(m, key1, ht)) {
+		st->type[i] = XREF_DELETED;
+		st->deleted++;
+		xref_store_maintain(st);
+		return true;
+	}
+	RzAnalysisXRef key = { .from = from, .to = to };
+	if (!rz_rbtree_find(st->pending_from, &key, pending_from_cmp, NULL)) {
+		return false;
+	}
+	rz_rbtree_delete(&st->pending_to, &key, pending_to_cmp, NULL, NULL, NULL);
+	rz_rbtree_delete(&st->pending_from, &key, pending_from_cmp, NULL, pending_free, NULL);
+	st->pending_len--;
+	return true;
+}
+
+/**
+ * Calls \p cb on the xrefs from (or to, if \p by_to is set) the addresses
+ * in [first, last], sorted by (from, to) or (to, from).
+ */
+static bool xref_store_walk(RzAnalysisXRefStore *st, bool by_to, ut64 first, ut64 last, RzAnalysisXRefCb cb, void *user) {
+	ut32 i = by_to ? merged_lower_bound_to(st, first) : merged_lower_bound(st, first, 0);
+	RzAnalysisXRef key = { .from = by_to ? 0 : first, .to = by_to ? first : 0 };
+	RBIter it = by_to
+		? rz_rbtree_lower_bound_forward(st->pending_to, &key, pending_to_cmp, NULL)
+		: rz_rbtree_lower_bound_forward(st->pending_from, &key, pending_from_cmp, NULL);
+	RzAnalysisXRef xref;
+	while (true) {
+		ut32 pos = 0;
+		bool merged = false;
+		for (; i < st->len; i++) {
+			pos = by_to ? st->by_to[i] : i;
+			if (st->type[pos] != XREF_DELETED) {
+				merged = (by_to ? st->to[pos] : st->from[pos]) <= last;
+				break;
+			}
+		}
+		XRefPending *p = NULL;
+		if (rz_rbtree_iter_has(&it)) {
+			p = by_to ? rz_rbtree_iter_get(&it, XRefPending, to_rb) : rz_rbtree_iter_get(&it, XRefPending, from_rb);
+			if ((by_to ? p->to : p->from) > last) {
+				p = NULL;
+			}
+		}
+		if (merged && (!p || (by_to ? xref_key_cmp(st->to[pos], st->from[pos], p->to, p->from) : xref_key_cmp(st->from[pos], st->to[pos], p->from, p->to)) < 0)) {
+			xref.from = st->from[pos];
+			xref.to = st->to[pos];
+			xref.type = st->type[pos];
+			i++;
+		} else if (p) {
+			xref.from = p->from;
+			xref.to = p->to;
+			xref.type = p->type;
+			rz_rbtree_iter_next(&it);
+		} else {
+			return true;
+		}
+		if (!cb(&xref, user)) {
 			return false;
 		}
 	}
-	ut64 key2 = from2to ? xref->to : xref->from;
-	return ht_up_update(ht, key2, xref);
+}
+
+static bool append_xref_cb(const RzAnalysisXRef *xref, void *user) {
+	RzAnalysisXRef *cloned = rz_analysis_xref_new(xref->from, xref->to, xref->type);
+	if (!cloned || !rz_list_append(user, cloned)) {
+		free(cloned);
+		return false;
+	}
+	return true;
+}
+
+static int ref_cmp(const RzAnalysisXRef *a, const RzAnalysisXRef *b) {
+	return xref_key_cmp(a->from, a->to, b->from, b->to);
+}
+
+static void sortxrefs(RzList /*<RzAnalysisXRef *>*/ *list) {
+	rz_list_sort(list, (RzListComparator)ref_cmp);
+}
+
+static void listxrefs(RzAnalysisXRefStore *st, bool by_to, ut64 addr, RzList /*<RzAnalysisXRef *>*/ *list) {
+	if (addr == UT64_MAX) {
+		xref_store_walk(st, false, 0, UT64_MAX, append_xref_cb, list);
+	} else {
+		xref_store_walk(st, by_to, addr, addr, append_xref_cb, list);
+	}
 }
 
 // Set a cross reference from FROM to TO.
@@ -125,48 +367,23 @@ RZ_API bool rz_analysis_xrefs_set(RzAnalysis *analysis, ut64 from, ut64 to, RzAn
 			return false;
 		}
 	}
-	RzAnalysisXRef *xref = rz_analysis_xref_new(from, to, type);
-	if (!xref) {
-		return false;
+	if (type == -1) {
+		type = RZ_ANALYSIS_XREF_TYPE_CODE;
 	}
-	if (!set_xref(analysis->ht_xrefs_from, xref, true)) {
-		// Pointer isn't added to <ht_xrefs_from> so we have to release it
-		rz_analysis_xref_free(xref);
-		return false;
-	}
-	if (!set_xref(analysis->ht_xrefs_to, xref, false)) {
-		// Delete the entry in <ht_xrefs_from>
-		rz_analysis_xrefs_deln(analysis, from, to, type);
-		// Pointer isn't added to <ht_xrefs_to> so we have to release it
-		rz_analysis_xref_free(xref);
-		return false;
-	}
-	return true;
+	return xref_store_set(analysis->xref_store, from, to, type);
 }
 
 RZ_API bool rz_analysis_xrefs_deln(RzAnalysis *analysis, ut64 from, ut64 to, RzAnalysisXRefType type) {
 	if (!analysis) {
 		return false;
 	}
-	HtUP *ht1 = ht_up_find(analysis->ht_xrefs_from, from, NULL);
-	if (ht1) {
-		ht_up_delete(ht1, to);
-	}
-	HtUP *ht2 = ht_up_find(analysis->ht_xrefs_to, to, NULL);
-	if (ht2) {
-		ht_up_delete(ht2, from);
-	}
+	xref_store_del(analysis->xref_store, from, to);
 	return true;
 }
 
 RZ_API bool rz_analysis_xref_del(RzAnalysis *analysis, ut64 from, ut64 to) {
-	bool res = false;
-	res |= rz_analysis_xrefs_deln(analysis, from, to, RZ_ANALYSIS_XREF_TYPE_NULL);
-	res |= rz_analysis_xrefs_deln(analysis, from, to, RZ_ANALYSIS_XREF_TYPE_CODE);
-	res |= rz_analysis_xrefs_deln(analysis, from, to, RZ_ANALYSIS_XREF_TYPE_CALL);
-	res |= rz_analysis_xrefs_deln(analysis, from, to, RZ_ANALYSIS_XREF_TYPE_DATA);
-	res |= rz_analysis_xrefs_deln(analysis, from, to, RZ_ANALYSIS_XREF_TYPE_STRING);
-	return res;
+	rz_return_val_if_fail(analysis, false);
+	return xref_store_del(analysis->xref_store, from, to);
 }
 
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_to(RzAnalysis *analysis, ut64 addr) {
@@ -174,8 +391,7 @@ RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_to(RzAnalysis
 	if (!list) {
 		return NULL;
 	}
-	listxrefs(analysis->ht_xrefs_to, addr, list);
-	sortxrefs(list);
+	listxrefs(analysis->xref_store, true, addr, list);
 	if (rz_list_empty(list)) {
 		rz_list_free(list);
 		list = NULL;
@@ -188,8 +404,7 @@ RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_from(RzAnalys
 	if (!list) {
 		return NULL;
 	}
-	listxrefs(analysis->ht_xrefs_from, addr, list);
-	sortxrefs(list);
+	listxrefs(analysis->xref_store, false, addr, list);
 	if (rz_list_empty(list)) {
 		rz_list_free(list);
 		list = NULL;
@@ -197,6 +412,42 @@ RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_from(RzAnalys
 	return list;
 }
 
+static RzList /*<RzAnalysisXRef *>*/ *xrefs_get_range(RzAnalysis *analysis, bool by_to, ut64 start, ut64 end) {
+	RzList *list = rz_analysis_xref_list_new();
+	if (!list || start >= end) {
+		return list;
+	}
+	if (!xref_store_walk(analysis->xref_store, by_to, start, end - 1, append_xref_cb, list)) {
+		rz_list_free(list);
+		return NULL;
+	}
+	return list;
+}
+
+/**
+ * \brief Get the xrefs from the addresses in [start, end)
+ * \param analysis RzAnalysis instance
+ * \param start First address of the range
+ * \param end Address following the range
+ * \return The xrefs sorted by (from, to), NULL on error
+ */
+RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_from_range(RZ_NONNULL RzAnalysis *analysis, ut64 start, ut64 end) {
+	rz_return_val_if_fail(analysis, NULL);
+	return xrefs_get_range(analysis, false, start, end);
+}
+
+/**
+ * \brief Get the xrefs to the addresses in [start, end)
+ * \param analysis RzAnalysis instance
+ * \param start First address of the range
+ * \param end Address following the range
+ * \return The xrefs sorted by (to, from), NULL on error
+ */
+RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_to_range(RZ_NONNULL RzAnalysis *analysis, ut64 start, ut64 end) {
+	rz_return_val_if_fail(analysis, NULL);
+	return xrefs_get_range(analysis, true, start, end);
+}
+
 /**
  * \brief Get list of all xrefs.
  * \param analysis RzAnalysis instance
@@ -206,12 +457,23 @@ RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_list(RzAnalysis *
 	rz_return_val_if_fail(analysis, NULL);
 	RzList *list = rz_analysis_xref_list_new();
 	if (list) {
-		listxrefs(analysis->ht_xrefs_from, UT64_MAX, list);
-		sortxrefs(list);
+		listxrefs(analysis->xref_store, false, UT64_MAX, list);
 	}
 	return list;
 }
 
+/**
+ * \brief Calls \p cb on all the xrefs, sorted by (from, to), without building a list.
+ *
+ * The callback must not add nor delete xrefs.
+ *
+ * \return false if \p cb stopped the iteration
+ */
+RZ_API bool rz_analysis_xrefs_foreach(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL RzAnalysisXRefCb cb, void *user) {
+	rz_return_val_if_fail(analysis && cb, false);
+	return xref_store_walk(analysis->xref_store, false, 0, UT64_MAX, cb, user);
+}
+
 RZ_API const char *rz_analysis_xrefs_type_tostring(RzAnalysisXRefType type) {
 	switch (type) {
 	case RZ_ANALYSIS_XREF_TYPE_CODE:
@@ -242,39 +504,16 @@ RZ_API RzAnalysisXRefType rz_analysis_xrefs_type(char ch) {
 }
 
 RZ_API bool rz_analysis_xrefs_init(RzAnalysis *analysis) {
-	ht_up_free(analysis->ht_xrefs_from);
-	analysis->ht_xrefs_from = NULL;
-	ht_up_free(analysis->ht_xrefs_to);
-	analysis->ht_xrefs_to = NULL;
-
-	HtUP *tmp = ht_up_new(NULL, xrefs_ht_free, NULL);
-	if (!tmp) {
-		return false;
-	}
-	analysis->ht_xrefs_from = tmp;
-
-	tmp = ht_up_new(NULL, xrefs_ht_free, NULL);
-	if (!tmp) {
-		ht_up_free(analysis->ht_xrefs_from);
-		analysis->ht_xrefs_from = NULL;
-		return false;
-	}
-	analysis->ht_xrefs_to = tmp;
-	return true;
-}
-
-static bool count_cb(void *user, const ut64 k, const void *v) {
-	(*(ut64 *)user) += ((HtUP *)v)->count;
-	return true;
+	rz_analysis_xref_store_free(analysis->xref_store);
+	analysis->xref_store = xref_store_new();
+	return analysis->xref_store != NULL;
 }
 
 RZ_API ut64 rz_analysis_xrefs_count(RzAnalysis *analysis) {
-	ut64 ret = 0;
-	ht_up_foreach(analysis->ht_xrefs_to, count_cb, &ret);
-	return ret;
+	return xref_store_count(analysis->xref_store);
 }
 
-static RZ_OWN RzList /*<RzAnalysisXRef *>*/ *fcn_get_refs(const RzAnalysisFunction *fcn, HtUP *ht) {
+static RZ_OWN RzList /*<RzAnalysisXRef *>*/ *fcn_get_refs(const RzAnalysisFunction *fcn, bool by_to) {
 	RzListIter *iter;
 	RzAnalysisBlock *bb;
 	RzList *list = rz_analysis_xref_list_new();
@@ -286,7 +525,7 @@ static RZ_OWN RzList /*<RzAnalysisXRef *>*/ *fcn_get_refs(const RzAnalysisFuncti
 
 		for (i = 0; i < bb->ninstr; i++) {
 			ut64 at = bb->addr + rz_analysis_block_get_op_offset(bb, i);
-			listxrefs(ht, at, list);
+			listxrefs(fcn->analysis->xref_store, by_to, at, list);
 		}
 	}
 	sortxrefs(list);
@@ -295,12 +534,12 @@ static RZ_OWN RzList /*<RzAnalysisXRef *>*/ *fcn_get_refs(const RzAnalysisFuncti
 
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_function_get_xrefs_from(const RzAnalysisFunction *fcn) {
 	rz_return_val_if_fail(fcn, NULL);
-	return fcn_get_refs(fcn, fcn->analysis->ht_xrefs_from);
+	return fcn_get_refs(fcn, false);
 }
 
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_function_get_xrefs_to(const RzAnalysisFunction *fcn) {
 	rz_return_val_if_fail(fcn, NULL);
-	return fcn_get_refs(fcn, fcn->analysis->ht_xrefs_to);
+	return fcn_get_refs(fcn, true);
 }
 
 RZ_API const char *rz_analysis_ref_type_tostring(RzAnalysisXRefType t) {
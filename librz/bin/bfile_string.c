@@ -16,7 +16,9 @@ typedef struct search_interval_t {
 typedef struct shared_data_t {
 	RzThreadLock *lock;
 	RzBinFile *bf;
-	HtUP *strings_db;
+	RzThreadHtUP *strings_db;
+	const ut8 *data; ///< Buffer bytes when directly addressable, scanned without copying
+	ut64 data_size; ///< Size of data
 } SharedData;
 
 typedef struct search_thread_data_t {
@@ -37,13 +39,6 @@ static st64 shared_data_read_at(SharedData *sd, ut64 addr, ut8 *buf, ut64 size)
 	return ret;
 }
 
-static bool shared_ht_up_insert(SharedData *sd, const ut64 key, void *value) {
-	rz_th_lock_enter(sd->lock);
-	bool ret = ht_up_insert(sd->strings_db, key, value);
-	rz_th_lock_leave(sd->lock);
-	return ret;
-}
-
 static bool is_data_section(RzBinFile *a, RzBinSection *s) {
 	if (s->has_strings || s->is_data) {
 		return true;
@@ -88,6 +83,15 @@ static RzList /*<RzDetectedString *>*/ *string_scan_range(SearchThreadData *std,
 		.check_ascii_freq = std->check_ascii_freq,
 	};
 
+	ut64 end = paddr + size;
+	const SharedData *sd = std->shared;
+	if (sd->data && end >= paddr && end <= sd->data_size) {
+		if (rz_scan_strings_raw(sd->data + paddr, found, &scan_opt, paddr, end, std->encoding) <= 0) {
+			RZ_FREE_CUSTOM(found, rz_list_free);
+		}
+		return found;
+	}
+
 	ut8 *buf = calloc(size, 1);
 	if (!buf) {
 		RZ_LOG_ERROR("bin_file_strings: cannot allocate string seac buffer.\n");
@@ -97,7 +101,6 @@ static RzList /*<RzDetectedString *>*/ *string_scan_range(SearchThreadData *std,
 
 	shared_data_read_at(std->shared, paddr, buf, size);
 
-	ut64 end = paddr + size;
 	int count = rz_scan_strings_raw(buf, found, &scan_opt, paddr, end, std->encoding);
 	free(buf);
 
@@ -144,7 +147,7 @@ static void *search_string_thread_runner(SearchThreadData *std) {
 			bstr->paddr += bf->o->boffset;
 			bstr->vaddr = rz_bin_object_p2v(bf->o, bstr->paddr);
 
-			shared_ht_up_insert(std->shared, bstr->vaddr, bstr);
+			rz_th_ht_up_insert(std->shared->strings_db, bstr->vaddr, bstr);
 		}
 
 		rz_list_free(list);
@@ -335,7 +338,7 @@ static void scan_cfstring_table(RzBinFile *bf, HtUP *strings_db, RzPVector /*<Rz
 RZ_API RZ_OWN RzPVector /*<RzBinString *>*/ *rz_bin_file_strings(RZ_NONNULL RzBinFile *bf, size_t min_length, bool raw_strings) {
 	rz_return_val_if_fail(bf, NULL);
 
-	HtUP *strings_db = NULL;
+	RzThreadHtUP *strings_db = NULL;
 	RzPVector *results = NULL;
 	RzThreadQueue *intervals = NULL;
 	RzThreadPool *pool = NULL;
@@ -370,7 +373,7 @@ RZ_API RZ_OWN RzPVector /*<RzBinString *>*/ *rz_bin_file_strings(RZ_NONNULL RzBi
 		goto fail;
 	}
 
-	strings_db = ht_up_new0();
+	strings_db = rz_th_ht_up_new0();
 	if (!strings_db) {
 		RZ_LOG_ERROR("bin_file_strings: cannot allocate string map.\n");
 		goto fail;
@@ -458,6 +461,8 @@ RZ_API RZ_OWN RzPVector /*<RzBinString *>*/ *rz_bin_file_strings(RZ_NONNULL RzBi
 		.bf = bf,
 		.strings_db = strings_db,
 	};
+	// mapped bytes are scanned in place, the other buffers are read under the lock
+	shared.data = rz_buf_direct_data(bf->buf, &shared.data_size);
 
 	RZ_LOG_VERBOSE("bin_file_strings: using %u threads\n", (ut32)pool_size);
 	for (size_t i = 0; i < pool_size; ++i) {
@@ -493,7 +498,11 @@ RZ_API RZ_OWN RzPVector /*<RzBinString *>*/ *rz_bin_file_strings(RZ_NONNULL RzBi
 	}
 
 	if (!raw_strings) {
-		scan_cfstring_table(bf, strings_db, results, max_interval);
+		HtUP *strings = rz_th_ht_up_move(strings_db);
+		if (strings) {
+			scan_cfstring_table(bf, strings, results, max_interval);
+			ht_up_free(strings);
+		}
 	}
 	rz_pvector_sort(results, (RzPVectorComparator)string_compare_sort, NULL);
 
@@ -520,7 +529,7 @@ fail:
 		}
 		rz_th_pool_free(pool);
 	}
-	ht_up_free(strings_db);
+	rz_th_ht_up_free(strings_db);
 	rz_th_lock_free(lock);
 	rz_th_queue_free(intervals);
 	return results;
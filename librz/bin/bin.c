@@ -620,24 +620,8 @@ RZ_DEPRECATE RZ_API RZ_BORROW RzBinInfo *rz_bin_get_info(RzBin *bin) {
  * \return Pointer to a \p RzBinSection containing the address
  */
 RZ_API RZ_BORROW RzBinSection *rz_bin_get_section_at(RzBinObject *o, ut64 off, int va) {
-	RzBinSection *section;
-	void **iter;
-	ut64 from, to;
-
 	rz_return_val_if_fail(o, NULL);
-	// TODO: must be O(1) .. use sdb here
-	rz_pvector_foreach (o->sections, iter) {
-		section = *iter;
-		if (section->is_segment) {
-			continue;
-		}
-		from = va ? rz_bin_object_addr_with_base(o, section->vaddr) : section->paddr;
-		to = from + (va ? section->vsize : section->size);
-		if (off >= from && off < to) {
-			return section;
-		}
-	}
-	return NULL;
+	return rz_bin_object_index_section_at(o, off, va);
 }
 
 /**
@@ -654,20 +638,7 @@ RZ_API RZ_BORROW RzBinSection *rz_bin_get_section_at(RzBinObject *o, ut64 off, i
  */
 RZ_API RZ_BORROW RzBinMap *rz_bin_object_get_map_at(RZ_NONNULL RzBinObject *o, ut64 off, bool va) {
 	rz_return_val_if_fail(o, NULL);
-
-	RzBinMap *map;
-	void **iter;
-	ut64 from, to;
-
-	rz_pvector_foreach_prev(o->maps, iter) {
-		map = *iter;
-		from = va ? rz_bin_object_addr_with_base(o, map->vaddr) : map->paddr;
-		to = from + (va ? map->vsize : map->psize);
-		if (off >= from && off < to) {
-			return map;
-		}
-	}
-	return NULL;
+	return rz_bin_object_index_map_at(o, off, va);
 }
 
 /**
@@ -680,26 +651,7 @@ RZ_API RZ_BORROW RzBinMap *rz_bin_object_get_map_at(RZ_NONNULL RzBinObject *o, u
  */
 RZ_API RZ_BORROW RzBinSymbol *rz_bin_object_get_symbol_at(RZ_NONNULL RzBinObject *o, ut64 off, bool va) {
 	rz_return_val_if_fail(o, NULL);
-
-	RzBinSymbol *sym;
-	void **iter;
-
-	if (va) {
-		rz_pvector_foreach (o->symbols, iter) {
-			sym = *iter;
-			if (off == sym->vaddr) {
-				return sym;
-			}
-		}
-	} else {
-		rz_pvector_foreach (o->symbols, iter) {
-			sym = *iter;
-			if (off == sym->paddr) {
-				return sym;
-			}
-		}
-	}
-	return NULL;
+	return rz_bin_object_index_symbol_at(o, off, va);
 }
 
 /**
@@ -713,23 +665,11 @@ RZ_API RZ_BORROW RzBinSymbol *rz_bin_object_get_symbol_at(RZ_NONNULL RzBinObject
 RZ_API RZ_OWN RzPVector /*<RzBinMap *>*/ *rz_bin_object_get_maps_at(RzBinObject *o, ut64 off, bool va) {
 	rz_return_val_if_fail(o, NULL);
 
-	RzBinMap *map;
-	void **iter;
-	ut64 from, to;
-
 	RzPVector *res = rz_pvector_new(NULL);
 	if (!res) {
 		return NULL;
 	}
-
-	rz_pvector_foreach (o->maps, iter) {
-		map = *iter;
-		from = va ? rz_bin_object_addr_with_base(o, map->vaddr) : map->paddr;
-		to = from + (va ? map->vsize : map->psize);
-		if (off >= from && off < to) {
-			rz_pvector_push(res, map);
-		}
-	}
+	rz_bin_object_index_maps_at(o, off, va, res);
 	return res;
 }
 
@@ -184,6 +184,7 @@ RZ_IPI void rz_bin_object_free(RzBinObject *o) {
 		return;
 	}
 	free(o->regstate);
+	rz_bin_object_index_free(o->addr_index);
 	ht_pp_free(o->glue_to_class_field);
 	ht_pp_free(o->glue_to_class_method);
 	ht_pp_free(o->name_to_class_object);
@@ -369,9 +370,11 @@ RZ_API RZ_BORROW RzBinSymbol *rz_bin_object_add_method(RZ_NONNULL RzBinObject *o
 	if ((symbol = rz_bin_object_find_method(o, klass, method))) {
 		if (symbol->paddr == UT64_MAX && paddr != UT64_MAX) {
 			symbol->paddr = paddr;
+			rz_bin_object_addrs_changed(o);
 		}
 		if (symbol->vaddr == UT64_MAX && vaddr != UT64_MAX) {
 			symbol->vaddr = vaddr;
+			rz_bin_object_addrs_changed(o);
 		}
 		return symbol;
 	}
@@ -494,6 +497,10 @@ RZ_IPI RzBinObject *rz_bin_object_new(RzBinFile *bf, RzBinPlugin *plugin, RzBinO
 	o->regstate = NULL;
 	o->baddr_shift = 0;
 	o->plugin = plugin;
+	if (!rz_bin_object_index_init(o)) {
+		free(o);
+		return NULL;
+	}
 
 	if (plugin && plugin->load_buffer) {
 		if (!plugin->load_buffer(bf, o, bf->buf, bf->sdb)) {
@@ -606,6 +613,17 @@ RZ_API ut64 rz_bin_object_addr_with_base(RzBinObject *o, ut64 addr) {
 	return o ? addr + o->baddr_shift : addr;
 }
 
+/**
+ * \brief Notifies \p o that the addresses or sizes of its sections, maps or symbols were edited in place.
+ *
+ * Replacing, growing or shrinking the vectors is detected automatically,
+ * only in place edits of their elements need to be notified.
+ */
+RZ_API void rz_bin_object_addrs_changed(RZ_NONNULL RzBinObject *o) {
+	rz_return_if_fail(o);
+	o->addr_gen++;
+}
+
 /* \brief Resolve the given address pair to a vaddr if possible
  * returns vaddr, rebased with the baseaddr of bin, if va is enabled for bin,
  * paddr otherwise
@@ -0,0 +1,275 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file bobj_index.c
+ * Address indexes of the sections, maps and symbols of a RzBinObject.
+ *
+ * Each index is built on first use and transparently rebuilt when the
+ * indexed vector is replaced, grows or shrinks, when the base address
+ * of the object changes or when in place edits of the elements are
+ * notified with rz_bin_object_addrs_changed(), so the lookups return
+ * exactly what a linear scan of the vector would return. Builds and lookups hold the index lock,
+ * since the string search translates addresses from many threads.
+ */
+
+#include <rz_bin.h>
+#include "i/private.h"
+
+/**
+ * The interval trees store the position of the element in the vector as
+ * data, so that overlapping elements can be resolved by vector order.
+ */
+#define IDX_TO_DATA(x) ((void *)(size_t)(x))
+#define DATA_TO_IDX(x) ((size_t)(x))
+
+static bool index_is_stale(RzBinObjectIndexState *state, const RzPVector *vec, st64 baddr_shift, ut32 gen) {
+	return !state->built ||
+		state->vec != vec ||
+		state->data != vec->v.a ||
+		state->len != rz_pvector_len(vec) ||
+		state->baddr_shift != baddr_shift ||
+		state->gen != gen;
+}
+
+static void index_state_set(RzBinObjectIndexState *state, const RzPVector *vec, st64 baddr_shift, ut32 gen) {
+	state->built = true;
+	state->vec = vec;
+	state->data = vec->v.a;
+	state->len = rz_pvector_len(vec);
+	state->baddr_shift = baddr_shift;
+	state->gen = gen;
+}
+
+static void interval_index_fini(RzBinObjectIntervalIndex *index) {
+	rz_interval_tree_fini(&index->paddr);
+	rz_interval_tree_fini(&index->vaddr);
+	index->state.built = false;
+}
+
+static void symbol_index_fini(RzBinObjectSymbolIndex *index) {
+	ht_up_free(index->paddr);
+	ht_up_free(index->vaddr);
+	index->paddr = NULL;
+	index->vaddr = NULL;
+	index->state.built = false;
+}
+
+/**
+ * Inserts [from, from + size) in \p tree, skipping the intervals which
+ * cannot contain any address (empty or wrapping around).
+ */
+static void interval_index_insert(RzIntervalTree *tree, ut64 from, ut64 size, size_t idx) {
+	ut64 to = from + size;
+	if (to <= from) {
+		return;
+	}
+	rz_interval_tree_insert(tree, from, to - 1, IDX_TO_DATA(idx));
+}
+
+static RzBinObjectIntervalIndex *sections_index(RzBinObject *o) {
+	RzBinObjectIntervalIndex *index = &o->addr_index->sections;
+	if (!index_is_stale(&index->state, o->sections, o->baddr_shift, o->addr_gen)) {
+		return index;
+	}
+	interval_index_fini(index);
+	rz_interval_tree_init(&index->paddr, NULL);
+	rz_interval_tree_init(&index->vaddr, NULL);
+	for (size_t i = 0; i < rz_pvector_len(o->sections); i++) {
+		RzBinSection *section = rz_pvector_at(o->sections, i);
+		if (section->is_segment) {
+			continue;
+		}
+		interval_index_insert(&index->paddr, section->paddr, section->size, i);
+		interval_index_insert(&index->vaddr, rz_bin_object_addr_with_base(o, section->vaddr), section->vsize, i);
+	}
+	index_state_set(&index->state, o->sections, o->baddr_shift, o->addr_gen);
+	return index;
+}
+
+static RzBinObjectIntervalIndex *maps_index(RzBinObject *o) {
+	RzBinObjectIntervalIndex *index = &o->addr_index->maps;
+	if (!index_is_stale(&index->state, o->maps, o->baddr_shift, o->addr_gen)) {
+		return index;
+	}
+	interval_index_fini(index);
+	rz_interval_tree_init(&index->paddr, NULL);
+	rz_interval_tree_init(&index->vaddr, NULL);
+	for (size_t i = 0; i < rz_pvector_len(o->maps); i++) {
+		RzBinMap *map = rz_pvector_at(o->maps, i);
+		interval_index_insert(&index->paddr, map->paddr, map->psize, i);
+		interval_index_insert(&index->vaddr, rz_bin_object_addr_with_base(o, map->vaddr), map->vsize, i);
+	}
+	index_state_set(&index->state, o->maps, o->baddr_shift, o->addr_gen);
+	return index;
+}
+
+static RzBinObjectSymbolIndex *symbols_index(RzBinObject *o) {
+	RzBinObjectSymbolIndex *index = &o->addr_index->symbols;
+	// symbols are looked up without the base address, thus the shift does not matter.
+	if (!index_is_stale(&index->state, o->symbols, 0, o->addr_gen)) {
+		return index;
+	}
+	symbol_index_fini(index);
+	index->paddr = ht_up_new(NULL, NULL, NULL);
+	index->vaddr = ht_up_new(NULL, NULL, NULL);
+	if (!index->paddr || !index->vaddr) {
+		index->state.built = false;
+		return NULL;
+	}
+	void **it;
+	rz_pvector_foreach (o->symbols, it) {
+		RzBinSymbol *sym = *it;
+		// ht_up_insert keeps the first symbol found at each address
+		ht_up_insert(index->paddr, sym->paddr, sym);
+		ht_up_insert(index->vaddr, sym->vaddr, sym);
+	}
+	index_state_set(&index->state, o->symbols, 0, o->addr_gen);
+	return index;
+}
+
+/**
+ * \brief Allocates the (still empty) indexes of \p o.
+ *
+ * Must be called before \p o is shared with other threads, since only
+ * the builds and lookups are serialized, not the allocation itself.
+ */
+RZ_IPI bool rz_bin_object_index_init(RZ_NONNULL RzBinObject *o) {
+	if (o->addr_index) {
+		return true;
+	}
+	RzBinObjectIndex *index = RZ_NEW0(RzBinObjectIndex);
+	if (!index) {
+		return false;
+	}
+	index->lock = rz_th_lock_new(false);
+	if (!index->lock) {
+		free(index);
+		return false;
+	}
+	o->addr_index = index;
+	return true;
+}
+
+/**
+ * \brief Drops the indexes of \p o, which are built again on the next lookup.
+ */
+RZ_IPI void rz_bin_object_index_reset(RZ_NONNULL RzBinObject *o) {
+	RzBinObjectIndex *index = o->addr_index;
+	if (!index) {
+		return;
+	}
+	rz_th_lock_enter(index->lock);
+	interval_index_fini(&index->sections);
+	interval_index_fini(&index->maps);
+	symbol_index_fini(&index->symbols);
+	rz_th_lock_leave(index->lock);
+}
+
+RZ_IPI void rz_bin_object_index_free(RZ_NULLABLE RzBinObjectIndex *index) {
+	if (!index) {
+		return;
+	}
+	interval_index_fini(&index->sections);
+	interval_index_fini(&index->maps);
+	symbol_index_fini(&index->symbols);
+	rz_th_lock_free(index->lock);
+	free(index);
+}
+
+static bool index_min_cb(RzIntervalNode *node, void *user) {
+	size_t *min = user;
+	size_t idx = DATA_TO_IDX(node->data);
+	if (idx < *min) {
+		*min = idx;
+	}
+	return true;
+}
+
+static bool index_max_cb(RzIntervalNode *node, void *user) {
+	size_t *max = user;
+	size_t idx = DATA_TO_IDX(node->data);
+	if (*max == SIZE_MAX || idx > *max) {
+		*max = idx;
+	}
+	return true;
+}
+
+static bool index_collect_cb(RzIntervalNode *node, void *user) {
+	RzVector *indexes = user;
+	size_t idx = DATA_TO_IDX(node->data);
+	rz_vector_push(indexes, &idx);
+	return true;
+}
+
+static int index_cmp(const void *a, const void *b, void *user) {
+	size_t ia = *(const size_t *)a;
+	size_t ib = *(const size_t *)b;
+	return ia < ib ? -1 : (ia > ib ? 1 : 0);
+}
+
+/**
+ * \brief Returns the first non-segment section of \p o containing \p off, or NULL.
+ */
+RZ_IPI RzBinSection *rz_bin_object_index_section_at(RzBinObject *o, ut64 off, bool va) {
+	if (!o->sections || !rz_bin_object_index_init(o)) {
+		return NULL;
+	}
+	rz_th_lock_enter(o->addr_index->lock);
+	RzBinObjectIntervalIndex *index = sections_index(o);
+	size_t min = SIZE_MAX;
+	rz_interval_tree_all_in(va ? &index->vaddr : &index->paddr, off, true, index_min_cb, &min);
+	rz_th_lock_leave(o->addr_index->lock);
+	return min != SIZE_MAX ? rz_pvector_at(o->sections, min) : NULL;
+}
+
+/**
+ * \brief Returns the last map of \p o containing \p off, or NULL.
+ */
+RZ_IPI RzBinMap *rz_bin_object_index_map_at(RzBinObject *o, ut64 off, bool va) {
+	if (!o->maps || !rz_bin_object_index_init(o)) {
+		return NULL;
+	}
+	rz_th_lock_enter(o->addr_index->lock);
+	RzBinObjectIntervalIndex *index = maps_index(o);
+	size_t max = SIZE_MAX;
+	rz_interval_tree_all_in(va ? &index->vaddr : &index->paddr, off, true, index_max_cb, &max);
+	rz_th_lock_leave(o->addr_index->lock);
+	return max != SIZE_MAX ? rz_pvector_at(o->maps, max) : NULL;
+}
+
+/**
+ * \brief Appends to \p res all the maps of \p o containing \p off, in the same order of o->maps.
+ */
+RZ_IPI void rz_bin_object_index_maps_at(RzBinObject *o, ut64 off, bool va, RzPVector /*<RzBinMap *>*/ *res) {
+	if (!o->maps || !rz_bin_object_index_init(o)) {
+		return;
+	}
+	RzVector indexes;
+	rz_vector_init(&indexes, sizeof(size_t), NULL, NULL);
+	rz_th_lock_enter(o->addr_index->lock);
+	RzBinObjectIntervalIndex *index = maps_index(o);
+	rz_interval_tree_all_in(va ? &index->vaddr : &index->paddr, off, true, index_collect_cb, &indexes);
+	rz_th_lock_leave(o->addr_index->lock);
+	if (rz_vector_len(&indexes) > 1) {
+		rz_vector_sort(&indexes, index_cmp, false, NULL);
+	}
+	size_t *idx;
+	rz_vector_foreach(&indexes, idx) {
+		rz_pvector_push(res, rz_pvector_at(o->maps, *idx));
+	}
+	rz_vector_fini(&indexes);
+}
+
+/**
+ * \brief Returns the first symbol of \p o placed exactly at \p off, or NULL.
+ */
+RZ_IPI RzBinSymbol *rz_bin_object_index_symbol_at(RzBinObject *o, ut64 off, bool va) {
+	if (!o->symbols || !rz_bin_object_index_init(o)) {
+		return NULL;
+	}
+	rz_th_lock_enter(o->addr_index->lock);
+	RzBinObjectSymbolIndex *index = symbols_index(o);
+	RzBinSymbol *sym = index ? ht_up_find(va ? index->vaddr : index->paddr, off, NULL) : NULL;
+	rz_th_lock_leave(o->addr_index->lock);
+	return sym;
+}
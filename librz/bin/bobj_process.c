@@ -182,6 +182,8 @@ RZ_API bool rz_bin_object_process_plugin_data(RZ_NONNULL RzBinFile *bf, RZ_NONNU
 	rz_bin_process_imports(bf, o, demangler, flags);
 	rz_bin_set_and_process_relocs(bf, o, demangler, flags);
 
+	// the vectors were replaced and their elements rebased, the address indexes are built again on demand
+	rz_bin_object_index_reset(o);
 	return true;
 }
 
@@ -17,7 +17,7 @@ RZ_IPI bool RzBinDwarfEncoding_from_file(RzBinDwarfEncoding *encoding, RzBinFile
 }
 
 static inline RZ_OWN RzBinDWARF *dwarf_from_file(
-	RZ_BORROW RZ_NONNULL RzBinFile *bf, bool is_dwo) {
+	RZ_BORROW RZ_NONNULL RzBinFile *bf, bool is_dwo, const RzBinDwarfInfoOptions *opt) {
 	rz_return_val_if_fail(bf, NULL);
 	RzBinDWARF *dw = RZ_NEW0(RzBinDWARF);
 	RET_NULL_IF_FAIL(dw);
@@ -33,7 +33,8 @@ static inline RZ_OWN RzBinDWARF *dwarf_from_file(
 	dw->abbrev = rz_bin_dwarf_abbrev_from_file(bf, is_dwo);
 
 	if (dw->abbrev) {
-		dw->info = rz_bin_dwarf_info_from_file(bf, dw, is_dwo);
+		RzBinEndianReader *reader = RzBinEndianReader_from_file(bf, ".debug_info", is_dwo);
+		dw->info = reader ? (opt ? rz_bin_dwarf_info_from_buf_opt(reader, dw, opt) : rz_bin_dwarf_info_from_buf(reader, dw)) : NULL;
 	}
 	if (dw->info) {
 		dw->line = rz_bin_dwarf_line_from_file(bf, dw, is_dwo);
@@ -236,7 +237,7 @@ RZ_API RZ_OWN RzBinDWARF *rz_bin_dwarf_from_path(
 	if (!bf) {
 		goto beach;
 	}
-	dwo = dwarf_from_file(bf, is_dwo);
+	dwo = dwarf_from_file(bf, is_dwo, NULL);
 
 beach:
 	rz_bin_free(bin_tmp);
@@ -246,7 +247,17 @@ beach:
 
 RZ_API RZ_OWN RzBinDWARF *rz_bin_dwarf_from_file(
 	RZ_BORROW RZ_NONNULL RzBinFile *bf) {
-	return dwarf_from_file(bf, false);
+	return dwarf_from_file(bf, false, NULL);
+}
+
+/**
+ * \brief Loads the DWARF debug information of \p bf
+ * \param opt how to parse .debug_info, e.g. decoding the DIEs only when needed
+ */
+RZ_API RZ_OWN RzBinDWARF *rz_bin_dwarf_from_file_opt(
+	RZ_BORROW RZ_NONNULL RzBinFile *bf, RZ_NONNULL const RzBinDwarfInfoOptions *opt) {
+	rz_return_val_if_fail(opt, NULL);
+	return dwarf_from_file(bf, false, opt);
 }
 
 RZ_API void rz_bin_dwarf_free(RZ_OWN RZ_NULLABLE RzBinDWARF *dw) {
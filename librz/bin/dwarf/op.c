@@ -610,7 +610,7 @@ static RzBinDwarfValueType ValueType_from_name(const char *name, ut8 byte_size)
 
 static RzBinDwarfValueType ValueType_from_die(
 	const RzBinDwarfEvaluation *eval, const RzBinDWARF *dw, UnitOffset offset) {
-	const RzBinDwarfDie *die = ht_up_find(dw->info->die_by_offset, eval->unit->offset + offset, NULL);
+	const RzBinDwarfDie *die = rz_bin_dwarf_info_die_at(dw->info, eval->unit->offset + offset);
 	if (!die) {
 		return RzBinDwarfValueType_GENERIC;
 	}
@@ -4,11 +4,15 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 
 #include <rz_bin_dwarf.h>
+#include <rz_th.h>
 #include "dwarf_private.h"
 
 typedef struct {
 	RzBinDwarfInfo *info;
 	RzBinDWARF *dw;
+	const ut8 *data; ///< .debug_info bytes, shared read-only by the parsing threads
+	ut64 data_size; ///< Size of data
+	size_t max_threads; ///< See RzBinDwarfInfoOptions.max_threads
 } DebugInfoContext;
 
 static void Die_fini(RzBinDwarfDie *die) {
@@ -79,6 +83,7 @@ static void apply_attr_opt(DebugInfoContext *ctx, RzBinDwarfCompUnit *cu, RzBinD
 
 static bool CU_attrs_parse(
 	DebugInfoContext *ctx,
+	RzBinEndianReader *reader,
 	RzBinDwarfDie *die,
 	RzBinDwarfCompUnit *cu,
 	RzBinDwarfAbbrevDecl *abbrev_decl) {
@@ -97,33 +102,43 @@ static bool CU_attrs_parse(
 			.unit_offset = cu->offset,
 			.encoding = &cu->hdr.encoding,
 		};
-		if (!RzBinDwarfAttr_parse(ctx->info->reader, &attr, &opt)) {
+		if (!RzBinDwarfAttr_parse(reader, &attr, &opt)) {
 			RZ_LOG_ERROR("DWARF: failed attr: 0x%" PFMT64x " %s [%s]\n ",
 				die->offset, rz_bin_dwarf_attr(spec->at), rz_bin_dwarf_form(spec->form));
 			continue;
 		}
 
-		switch (attr.at) {
-		case DW_AT_sibling:
+		if (attr.at == DW_AT_sibling) {
 			die->sibling = rz_bin_dwarf_attr_udata(&attr);
-			break;
-		case DW_AT_location: {
-			if (attr.value.kind == RzBinDwarfAttr_LoclistPtr ||
-				attr.value.kind == RzBinDwarfAttr_Reference ||
-				attr.value.kind == RzBinDwarfAttr_UConstant ||
-				attr.value.kind == RzBinDwarfAttr_SecOffset) {
-				ut64 offset = rz_bin_dwarf_attr_udata(&attr);
-				ht_up_insert(ctx->info->location_encoding,
-					offset, &cu->hdr.encoding);
-			}
-		}
-		default:
-			break;
 		}
-
 		rz_vector_push(&die->attrs, &attr);
 	}
+	return true;
+}
+
+static void Die_location_apply(RzBinDwarfInfo *info, RzBinDwarfCompUnit *cu, RzBinDwarfDie *die) {
+	RzBinDwarfAttr *attr;
+	rz_vector_foreach(&die->attrs, attr) {
+		if (attr->at == DW_AT_location &&
+			(attr->value.kind == RzBinDwarfAttr_LoclistPtr ||
+				attr->value.kind == RzBinDwarfAttr_Reference ||
+				attr->value.kind == RzBinDwarfAttr_UConstant ||
+				attr->value.kind == RzBinDwarfAttr_SecOffset)) {
+			ut64 offset = rz_bin_dwarf_attr_udata(attr);
+			ht_up_insert(info->location_encoding,
+				offset, &cu->hdr.encoding);
+		}
+	}
+}
 
+/**
+ * \brief Applies what \p die tells about its unit to \p cu and to the info tables
+ *
+ * This is done once all the units are parsed, in order, since it reads strings
+ * and addresses from the other sections through their shared readers.
+ */
+static void Die_apply(DebugInfoContext *ctx, RzBinDwarfCompUnit *cu, RzBinDwarfDie *die) {
+	Die_location_apply(ctx->info, cu, die);
 	if (die->tag == DW_TAG_compile_unit ||
 		die->tag == DW_TAG_skeleton_unit) {
 		apply_attr_opt(ctx, cu, die, DW_AT_str_offsets_base);
@@ -137,7 +152,6 @@ static bool CU_attrs_parse(
 			CU_attr_apply(ctx, cu, attr);
 		}
 	}
-	return true;
 }
 
 /**
@@ -170,13 +184,16 @@ static inline ut64 CU_next(RzBinDwarfCompUnit *unit) {
 
 /**
  * \brief Reads throught comp_unit buffer and parses all its DIEntries*
+ * \param root_only stop after the first DIE, which describes the unit itself
  */
 static bool CU_dies_parse(
 	DebugInfoContext *ctx,
+	RzBinEndianReader *reader,
 	RzBinDwarfCompUnit *unit,
-	const RzBinDwarfAbbrevTable *tbl) {
+	const RzBinDwarfAbbrevTable *tbl,
+	bool root_only) {
 	st64 depth = 0;
-	RzBuffer *buffer = ctx->info->reader->buffer;
+	RzBuffer *buffer = reader->buffer;
 	while (true) {
 		ut64 offset = rz_buf_tell(buffer);
 		if (offset >= CU_next(unit)) {
@@ -225,9 +242,12 @@ static bool CU_dies_parse(
 			if (die.has_children) {
 				depth++;
 			}
-			GOTO_IF_FAIL(CU_attrs_parse(ctx, &die, unit, abbrev_decl), err);
+			GOTO_IF_FAIL(CU_attrs_parse(ctx, reader, &die, unit, abbrev_decl), err);
 		}
 		rz_vector_push(&unit->dies, &die);
+		if (root_only) {
+			break;
+		}
 	}
 	return true;
 err:
@@ -263,8 +283,76 @@ static bool CU_Hdr_parse(DebugInfoContext *ctx, RzBinDwarfCompUnitHdr *hdr) {
 	return true;
 }
 
+static bool CU_dies_parse_at(DebugInfoContext *ctx, RzBinEndianReader *reader, RzBinDwarfCompUnit *unit, bool root_only) {
+	RzBinDwarfAbbrevTable *tbl = ht_up_find(
+		ctx->dw->abbrev->tbl_by_offset, unit->hdr.abbrev_offset, NULL);
+	ut64 dies_offset = unit->offset + (unit->hdr.encoding.is_64bit ? 12 : 4) + unit->hdr.header_size;
+	if (!tbl || rz_buf_seek(reader->buffer, (st64)dies_offset, RZ_BUF_SET) < 0) {
+		return false;
+	}
+	return CU_dies_parse(ctx, reader, unit, tbl, root_only);
+}
+
+static void CU_dies_parse_thread(void *element, void *user) {
+	DebugInfoContext *ctx = user;
+	RzBinDwarfCompUnit *unit = element;
+	// every unit gets its own cursor over the shared bytes
+	RzBinEndianReader reader = *ctx->info->reader;
+	reader.buffer = rz_buf_new_with_pointers(ctx->data, ctx->data_size, false);
+	if (!reader.buffer) {
+		RZ_LOG_ERROR("DWARF: cannot allocate reader for unit 0x%" PFMT64x "\n", unit->offset);
+		return;
+	}
+	CU_dies_parse_at(ctx, &reader, unit, false);
+	rz_buf_free(reader.buffer);
+}
+
+static int CU_length_cmp(const void *a, const void *b, void *user) {
+	const RzBinDwarfCompUnit *ua = a;
+	const RzBinDwarfCompUnit *ub = b;
+	return ua->hdr.length > ub->hdr.length ? -1 : (ua->hdr.length < ub->hdr.length ? 1 : 0);
+}
+
+/**
+ * \brief Parses the DIEs of all the units, concurrently when possible
+ *
+ * Each unit only fills its own vector of DIEs, so the result does not depend on
+ * the order in which the units are parsed. The largest units are handed out
+ * first to keep the threads busy until the end.
+ */
+static void CU_dies_parse_all(DebugInfoContext *ctx) {
+	RzVector *units = &ctx->info->units;
+	RzBinDwarfCompUnit *unit = NULL;
+	if (rz_vector_len(units) > 1 && ctx->max_threads != 1) {
+		ctx->data = rz_buf_direct_data(ctx->info->reader->buffer, &ctx->data_size);
+	}
+	if (ctx->data) {
+		RzPVector work;
+		rz_pvector_init(&work, NULL);
+		bool done = false;
+		if (rz_pvector_reserve(&work, rz_vector_len(units))) {
+			rz_vector_foreach(units, unit) {
+				rz_pvector_push(&work, unit);
+			}
+			rz_pvector_sort(&work, CU_length_cmp, NULL);
+			done = rz_th_iterate_pvector(&work, CU_dies_parse_thread, ctx->max_threads, ctx);
+		}
+		rz_pvector_fini(&work);
+		if (done) {
+			return;
+		}
+	}
+	rz_vector_foreach(units, unit) {
+		CU_dies_parse_at(ctx, ctx->info->reader, unit, false);
+	}
+}
+
 /**
  * \brief Parses whole .debug_info section
+ *
+ * The unit headers are read first, since they give the offset of the next
+ * unit, then the DIEs of all the units are parsed. In lazy mode only the root
+ * DIE of each unit is read.
  */
 static bool CU_parse_all(DebugInfoContext *ctx) {
 	RzBuffer *buffer = ctx->info->reader->buffer;
@@ -286,18 +374,28 @@ static bool CU_parse_all(DebugInfoContext *ctx) {
 		if (unit.hdr.length > rz_buf_size(buffer)) {
 			goto cleanup;
 		}
-
-		RzBinDwarfAbbrevTable *tbl = ht_up_find(
-			ctx->dw->abbrev->tbl_by_offset, unit.hdr.abbrev_offset, NULL);
-		if (!tbl) {
+		if (!ht_up_find(ctx->dw->abbrev->tbl_by_offset, unit.hdr.abbrev_offset, NULL)) {
 			goto cleanup;
 		}
 
 		RZ_LOG_DEBUG("0x%" PFMT64x ":\tcompile unit length = 0x%" PFMT64x ", abbr_offset: 0x%" PFMT64x "\n",
 			unit.offset, unit.hdr.length, unit.hdr.abbrev_offset);
-		CU_dies_parse(ctx, &unit, tbl);
-		ctx->info->die_count += rz_vector_len(&unit.dies);
 		rz_vector_push(&ctx->info->units, &unit);
+		if (rz_buf_seek(buffer, (st64)CU_next(&unit), RZ_BUF_SET) < 0) {
+			break;
+		}
+	}
+
+	RzBinDwarfCompUnit *unit = NULL;
+	if (ctx->info->max_decoded_units) {
+		rz_vector_foreach(&ctx->info->units, unit) {
+			CU_dies_parse_at(ctx, ctx->info->reader, unit, true);
+		}
+		return true;
+	}
+	CU_dies_parse_all(ctx);
+	rz_vector_foreach(&ctx->info->units, unit) {
+		ctx->info->die_count += rz_vector_len(&unit->dies);
 	}
 	return true;
 cleanup:
@@ -318,6 +416,7 @@ RZ_API RZ_BORROW RzBinDwarfAttr *rz_bin_dwarf_die_get_attr(
 
 static bool info_init(RzBinDwarfInfo *info) {
 	rz_vector_init(&info->units, sizeof(RzBinDwarfCompUnit), (RzVectorFree)CU_fini, NULL);
+	rz_pvector_init(&info->decoded_units, NULL);
 	info->offset_comp_dir = ht_up_new(NULL, NULL, NULL);
 	info->location_encoding = ht_up_new0();
 	if (!info->offset_comp_dir) {
@@ -335,6 +434,7 @@ static inline void info_free(RzBinDwarfInfo *info) {
 	}
 	RzBinEndianReader_free(info->reader);
 	rz_vector_fini(&info->units);
+	rz_pvector_fini(&info->decoded_units);
 	ht_up_free(info->offset_comp_dir);
 	ht_up_free(info->die_by_offset);
 	ht_up_free(info->unit_by_offset);
@@ -346,10 +446,19 @@ RZ_API void rz_bin_dwarf_info_free(RZ_OWN RZ_NULLABLE RzBinDwarfInfo *info) {
 	info_free(info);
 }
 
-RZ_API RZ_OWN RzBinDwarfInfo *rz_bin_dwarf_info_from_buf(
+/**
+ * \brief Parses .debug_info section
+ * \param reader .debug_info reader
+ * \param dw RzBinDWARF instance owning the returned info
+ * \param opt how to parse, e.g. decoding the DIEs only when needed
+ * \return RzBinDwarfDebugInfo* Parsed information, NULL if error
+ */
+RZ_API RZ_OWN RzBinDwarfInfo *rz_bin_dwarf_info_from_buf_opt(
 	RZ_OWN RZ_NONNULL RzBinEndianReader *reader,
-	RZ_BORROW RZ_NONNULL RzBinDWARF *dw) {
-	rz_return_val_if_fail(reader && reader->buffer && dw && dw->abbrev, NULL);
+	RZ_BORROW RZ_NONNULL RzBinDWARF *dw,
+	RZ_NONNULL const RzBinDwarfInfoOptions *opt) {
+	rz_return_val_if_fail(reader && reader->buffer && dw && dw->abbrev && opt, NULL);
+	const size_t max_decoded_units = opt->max_decoded_units;
 	if (rz_buf_size(reader->buffer) <= 0) {
 		rz_buf_free(reader->buffer);
 		return NULL;
@@ -358,10 +467,13 @@ RZ_API RZ_OWN RzBinDwarfInfo *rz_bin_dwarf_info_from_buf(
 	RET_NULL_IF_FAIL(info);
 	ERR_IF_FAIL(info_init(info));
 	info->reader = reader;
+	info->dw = dw;
+	info->max_decoded_units = max_decoded_units;
 
 	DebugInfoContext ctx = {
 		.info = info,
 		.dw = dw,
+		.max_threads = opt->max_threads,
 	};
 	ERR_IF_FAIL(CU_parse_all(&ctx));
 
@@ -395,7 +507,16 @@ RZ_API RZ_OWN RzBinDwarfInfo *rz_bin_dwarf_info_from_buf(
 
 		RzBinDwarfDie *die = NULL;
 		rz_vector_foreach(&unit->dies, die) {
-			ht_up_insert(info->die_by_offset, die->offset, die); // optimization for further processing
+			if (!max_decoded_units) {
+				ht_up_insert(info->die_by_offset, die->offset, die); // optimization for further processing
+			}
+			Die_apply(&ctx, unit, die);
+		}
+		if (max_decoded_units) {
+			// the root DIE was only needed for the unit attributes
+			rz_vector_clear(&unit->dies);
+		} else {
+			unit->dies_decoded = true;
 		}
 	}
 	return info;
@@ -404,6 +525,130 @@ err:
 	return NULL;
 }
 
+RZ_API RZ_OWN RzBinDwarfInfo *rz_bin_dwarf_info_from_buf(
+	RZ_OWN RZ_NONNULL RzBinEndianReader *reader,
+	RZ_BORROW RZ_NONNULL RzBinDWARF *dw) {
+	RzBinDwarfInfoOptions opt = {
+		.max_decoded_units = 0,
+		.max_threads = RZ_THREAD_POOL_ALL_CORES,
+	};
+	return rz_bin_dwarf_info_from_buf_opt(reader, dw, &opt);
+}
+
+/**
+ * \brief Makes sure the DIEs of \p unit are decoded
+ *
+ * In lazy mode the DIE pointers of the unit stay valid until the next call
+ * to rz_bin_dwarf_info_trim().
+ */
+RZ_API bool rz_bin_dwarf_info_unit_load(
+	RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info,
+	RZ_BORROW RZ_NONNULL RzBinDwarfCompUnit *unit) {
+	rz_return_val_if_fail(info && unit, false);
+	unit->last_use = ++info->use_count;
+	if (unit->dies_decoded) {
+		return true;
+	}
+	DebugInfoContext ctx = {
+		.info = info,
+		.dw = info->dw,
+	};
+	rz_vector_clear(&unit->dies);
+	bool ret = CU_dies_parse_at(&ctx, info->reader, unit, false);
+	unit->dies_decoded = true;
+	rz_pvector_push(&info->decoded_units, unit);
+	info->die_count += rz_vector_len(&unit->dies);
+	RzBinDwarfDie *die = NULL;
+	rz_vector_foreach(&unit->dies, die) {
+		ht_up_insert(info->die_by_offset, die->offset, die);
+		Die_location_apply(info, unit, die);
+	}
+	RZ_LOG_DEBUG("DWARF: decoded %" PFMTSZu " DIEs of unit 0x%" PFMT64x "\n", rz_vector_len(&unit->dies), unit->offset);
+	return ret;
+}
+
+#define UNIT_CMP(x, y) ((x) < ((const RzBinDwarfCompUnit *)(y))->offset ? -1 : ((x) > ((const RzBinDwarfCompUnit *)(y))->offset ? 1 : 0))
+
+/**
+ * \brief Returns the unit containing \p offset in .debug_info, with its DIEs decoded
+ */
+RZ_API RZ_BORROW RzBinDwarfCompUnit *rz_bin_dwarf_info_unit_at(
+	RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info, ut64 offset) {
+	rz_return_val_if_fail(info, NULL);
+	size_t i;
+	rz_vector_upper_bound(&info->units, offset, i, UNIT_CMP);
+	if (!i) {
+		return NULL;
+	}
+	RzBinDwarfCompUnit *unit = rz_vector_index_ptr(&info->units, i - 1);
+	if (offset >= CU_next(unit)) {
+		return NULL;
+	}
+	rz_bin_dwarf_info_unit_load(info, unit);
+	return unit;
+}
+
+/**
+ * \brief Returns the DIE at \p offset in .debug_info, decoding its unit if needed
+ */
+RZ_API RZ_BORROW RzBinDwarfDie *rz_bin_dwarf_info_die_at(
+	RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info, ut64 offset) {
+	rz_return_val_if_fail(info, NULL);
+	if (!info->max_decoded_units) {
+		return ht_up_find(info->die_by_offset, offset, NULL);
+	}
+	return rz_bin_dwarf_info_unit_at(info, offset) ? ht_up_find(info->die_by_offset, offset, NULL) : NULL;
+}
+
+static int unit_last_use_cmp(const void *a, const void *b, void *user) {
+	const RzBinDwarfCompUnit *ua = a;
+	const RzBinDwarfCompUnit *ub = b;
+	return ua->last_use > ub->last_use ? -1 : (ua->last_use < ub->last_use ? 1 : 0);
+}
+
+/**
+ * \brief Drops the DIEs of the least recently used units in lazy mode
+ *
+ * Only the RzBinDwarfInfo.max_decoded_units most recently used units are kept
+ * decoded, the pointers to the DIEs of the other units become invalid.
+ */
+RZ_API void rz_bin_dwarf_info_trim(RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info) {
+	rz_return_if_fail(info);
+	if (!info->max_decoded_units || rz_pvector_len(&info->decoded_units) <= info->max_decoded_units) {
+		return;
+	}
+	rz_pvector_sort(&info->decoded_units, unit_last_use_cmp, NULL);
+	while (rz_pvector_len(&info->decoded_units) > info->max_decoded_units) {
+		RzBinDwarfCompUnit *unit = rz_pvector_pop(&info->decoded_units);
+		RzBinDwarfDie *die = NULL;
+		rz_vector_foreach(&unit->dies, die) {
+			ht_up_delete(info->die_by_offset, die->offset);
+		}
+		info->die_count -= rz_vector_len(&unit->dies);
+		rz_vector_clear(&unit->dies);
+		unit->dies_decoded = false;
+	}
+}
+
+/**
+ * \brief Makes sure RzBinDwarfInfo.location_encoding has the entries of all the units
+ *
+ * The entries of a unit are added when its DIEs are decoded and kept when they
+ * are dropped, so in lazy mode every unit is decoded once, trimming in between.
+ */
+RZ_API void rz_bin_dwarf_info_locations_load(RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info) {
+	rz_return_if_fail(info);
+	if (!info->max_decoded_units || info->locations_loaded) {
+		return;
+	}
+	RzBinDwarfCompUnit *unit = NULL;
+	rz_vector_foreach(&info->units, unit) {
+		rz_bin_dwarf_info_unit_load(info, unit);
+		rz_bin_dwarf_info_trim(info);
+	}
+	info->locations_loaded = true;
+}
+
 /**
  * \brief Parses .debug_info section
  * \param bin RzBinFile instance
@@ -76,4 +76,40 @@ struct rz_bin_string_database_t {
 	HtUP /*<ut64, RzBinString*>*/ *virt; ///< Contains all the strings but mapped by virtual address
 };
 
+typedef struct {
+	bool built; ///< True when the index reflects vec
+	const RzPVector *vec; ///< Vector the index was built from
+	const void *data; ///< Storage of vec when the index was built
+	size_t len; ///< Length of vec when the index was built
+	st64 baddr_shift; ///< Base address shift used for the virtual addresses
+	ut32 gen; ///< Value of RzBinObject.addr_gen when the index was built
+} RzBinObjectIndexState;
+
+typedef struct {
+	RzBinObjectIndexState state;
+	RzIntervalTree paddr; ///< Physical intervals, data is the position in the vector
+	RzIntervalTree vaddr; ///< Virtual intervals (with base address), data is the position in the vector
+} RzBinObjectIntervalIndex;
+
+typedef struct {
+	RzBinObjectIndexState state;
+	HtUP /*<ut64, RzBinSymbol *>*/ *paddr; ///< First symbol at each physical address
+	HtUP /*<ut64, RzBinSymbol *>*/ *vaddr; ///< First symbol at each virtual address
+} RzBinObjectSymbolIndex;
+
+struct rz_bin_object_index_t {
+	RzThreadLock *lock; ///< Guards the lazy (re)builds, the lookups may come from the string search threads
+	RzBinObjectIntervalIndex sections; ///< Non-segment sections
+	RzBinObjectIntervalIndex maps;
+	RzBinObjectSymbolIndex symbols;
+};
+
+RZ_IPI bool rz_bin_object_index_init(RZ_NONNULL RzBinObject *o);
+RZ_IPI void rz_bin_object_index_reset(RZ_NONNULL RzBinObject *o);
+RZ_IPI void rz_bin_object_index_free(RZ_NULLABLE RzBinObjectIndex *index);
+RZ_IPI RzBinSection *rz_bin_object_index_section_at(RzBinObject *o, ut64 off, bool va);
+RZ_IPI RzBinMap *rz_bin_object_index_map_at(RzBinObject *o, ut64 off, bool va);
+RZ_IPI void rz_bin_object_index_maps_at(RzBinObject *o, ut64 off, bool va, RzPVector /*<RzBinMap *>*/ *res);
+RZ_IPI RzBinSymbol *rz_bin_object_index_symbol_at(RzBinObject *o, ut64 off, bool va);
+
 #endif
@@ -36,6 +36,7 @@ RZ_API RzBreakpoint *rz_bp_new(RZ_BORROW RZ_NONNULL RzBreakpointContext *ctx) {
 	bp->traces = rz_bp_traptrace_new();
 	bp->cb_printf = (PrintfCallback)printf;
 	bp->bps = rz_list_newf((RzListFree)rz_bp_item_free);
+	rz_interval_tree_init(&bp->bps_tree, NULL);
 	bp->plugins = rz_list_new();
 	bp->nhwbps = 0;
 	for (i = 0; i < RZ_ARRAY_SIZE(bp_static_plugins); i++) {
@@ -46,6 +47,12 @@ RZ_API RzBreakpoint *rz_bp_new(RZ_BORROW RZ_NONNULL RzBreakpointContext *ctx) {
 }
 
 RZ_API RzBreakpoint *rz_bp_free(RzBreakpoint *bp) {
+	if (bp->coverage) {
+		rz_vector_fini(&bp->coverage->addrs);
+		rz_bv_fini(&bp->coverage->hits);
+		free(bp->coverage);
+	}
+	rz_interval_tree_fini(&bp->bps_tree);
 	rz_list_free(bp->bps);
 	rz_list_free(bp->plugins);
 	rz_list_free(bp->traces);
@@ -96,19 +103,57 @@ repeat:
 	return b->length;
 }
 
+typedef struct {
+	ut64 addr;
+	int perm;
+	bool (*match)(RzBreakpointItem *b, ut64 addr, int perm);
+	RzBreakpointItem *found;
+	ut32 count;
+} BpFindCtx;
+
+static bool find_cb(RzIntervalNode *node, void *user) {
+	BpFindCtx *ctx = user;
+	if (!ctx->match(node->data, ctx->addr, ctx->perm)) {
+		return true;
+	}
+	ctx->found = node->data;
+	return ++ctx->count < 2;
+}
+
 /**
- * \brief Get the breakpoint at exactly \p addr
+ * The index does not keep the order of breakpoints sharing addresses, so if
+ * more than one matches, the first one of the list is returned like before.
  */
-RZ_API RZ_BORROW RzBreakpointItem *rz_bp_get_at(RZ_NONNULL RzBreakpoint *bp, ut64 addr) {
-	rz_return_val_if_fail(bp, NULL);
+static RzBreakpointItem *find_first(RzBreakpoint *bp, BpFindCtx *ctx) {
+	if (ctx->count < 2) {
+		return ctx->found;
+	}
 	RzListIter *iter;
 	RzBreakpointItem *b;
 	rz_list_foreach (bp->bps, iter, b) {
-		if (b->addr == addr) {
+		if (ctx->match(b, ctx->addr, ctx->perm) && rz_interval_tree_node_at_data(&bp->bps_tree, b->addr, b)) {
 			return b;
 		}
 	}
-	return NULL;
+	return ctx->found;
+}
+
+static bool match_at(RzBreakpointItem *b, ut64 addr, int perm) {
+	return b->addr == addr;
+}
+
+/**
+ * \brief Get the breakpoint at exactly \p addr
+ */
+RZ_API RZ_BORROW RzBreakpointItem *rz_bp_get_at(RZ_NONNULL RzBreakpoint *bp, ut64 addr) {
+	rz_return_val_if_fail(bp, NULL);
+	BpFindCtx ctx = { addr, 0, match_at, NULL, 0 };
+	rz_interval_tree_all_at(&bp->bps_tree, addr, find_cb, &ctx);
+	return find_first(bp, &ctx);
+}
+
+static bool match_ending_at(RzBreakpointItem *b, ut64 addr, int perm) {
+	return !b->hw && b->addr + b->size == addr;
 }
 
 /**
@@ -118,35 +163,25 @@ RZ_API RZ_BORROW RzBreakpointItem *rz_bp_get_at(RZ_NONNULL RzBreakpoint *bp, ut6
  */
 RZ_API RZ_BORROW RzBreakpointItem *rz_bp_get_ending_at(RZ_NONNULL RzBreakpoint *bp, ut64 addr) {
 	rz_return_val_if_fail(bp, NULL);
-	RzListIter *iter;
-	RzBreakpointItem *b;
-	rz_list_foreach (bp->bps, iter, b) {
-		if (!b->hw && b->addr + b->size == addr) {
-			return b;
-		}
-	}
-	return NULL;
-}
-
-static inline bool inRange(RzBreakpointItem *b, ut64 addr) {
-	return (addr >= b->addr && addr < (b->addr + b->size));
+	// the last byte of the breakpoint is right before addr
+	BpFindCtx ctx = { addr, 0, match_ending_at, NULL, 0 };
+	rz_interval_tree_all_in(&bp->bps_tree, addr - 1, false, find_cb, &ctx);
+	return find_first(bp, &ctx);
 }
 
 static inline bool matchProt(RzBreakpointItem *b, int perm) {
 	return (!perm || (perm && b->perm));
 }
 
+static bool match_in(RzBreakpointItem *b, ut64 addr, int perm) {
+	return addr >= b->addr && addr < b->addr + b->size && matchProt(b, perm);
+}
+
 RZ_API RzBreakpointItem *rz_bp_get_in(RzBreakpoint *bp, ut64 addr, int perm) {
-	RzBreakpointItem *b;
-	RzListIter *iter;
-	rz_list_foreach (bp->bps, iter, b) {
-		// eprintf ("---ataddr--- 0x%08"PFMT64x" %d %d %x\n", b->addr, b->size, b->recoil, b->perm);
-		// Check addr within range and provided perm matches (or null)
-		if (inRange(b, addr) && matchProt(b, perm)) {
-			return b;
-		}
-	}
-	return NULL;
+	// Check addr within range and provided perm matches (or null)
+	BpFindCtx ctx = { addr, perm, match_in, NULL, 0 };
+	rz_interval_tree_all_in(&bp->bps_tree, addr, false, find_cb, &ctx);
+	return find_first(bp, &ctx);
 }
 
 RZ_API RzBreakpointItem *rz_bp_enable(RzBreakpoint *bp, ut64 addr, int set, int count) {
@@ -173,45 +208,80 @@ RZ_API int rz_bp_stepy_continuation(RzBreakpoint *bp) {
 	return bp->stepcont;
 }
 
+/**
+ * Remove \p b from the address index, so it is not found by rz_bp_get_*() anymore
+ */
+RZ_IPI void rz_bp_item_unindex(RzBreakpoint *bp, RzBreakpointItem *b) {
+	RzIntervalNode *node = rz_interval_tree_node_at_data(&bp->bps_tree, b->addr, b);
+	if (node) {
+		rz_interval_tree_delete(&bp->bps_tree, node, false);
+	}
+}
+
 static void unlinkBreakpoint(RzBreakpoint *bp, RzBreakpointItem *b) {
 	int i;
 	for (i = 0; i < bp->bps_idx_count; i++) {
 		if (bp->bps_idx[i] == b) {
 			bp->bps_idx[i] = NULL;
+			bp->bps_idx_free = RZ_MIN(bp->bps_idx_free, i);
 		}
 	}
+	rz_bp_item_unindex(bp, b);
 	rz_list_delete_data(bp->bps, b);
 }
 
+/**
+ * Delete all the breakpoints for which \p cb returns true in a single pass
+ */
+RZ_IPI void rz_bp_item_delete_all(RzBreakpoint *bp, bool (*cb)(RzBreakpointItem *b, void *user), void *user) {
+	int i;
+	for (i = 0; i < bp->bps_idx_count; i++) {
+		if (bp->bps_idx[i] && cb(bp->bps_idx[i], user)) {
+			bp->bps_idx[i] = NULL;
+			bp->bps_idx_free = RZ_MIN(bp->bps_idx_free, i);
+		}
+	}
+	RzListIter *iter, *iter_tmp;
+	RzBreakpointItem *b;
+	rz_list_foreach_safe (bp->bps, iter, iter_tmp, b) {
+		if (cb(b, user)) {
+			rz_bp_item_unindex(bp, b);
+			rz_list_delete(bp->bps, iter);
+		}
+	}
+}
+
 /**
  * Put an allocated RzBreakpointItem into the RzBreakpoint's list and give it an index
  */
 RZ_IPI void rz_bp_item_insert(RzBreakpoint *bp, RzBreakpointItem *b) {
 	int i;
 	/* find empty slot */
-	for (i = 0; i < bp->bps_idx_count; i++) {
+	for (i = bp->bps_idx_free; i < bp->bps_idx_count; i++) {
 		if (!bp->bps_idx[i]) {
 			break;
 		}
 	}
 	if (i == bp->bps_idx_count) {
 		/* allocate new slot */
-		bp->bps_idx_count += 16; // allocate space for 16 more bps
-		RzBreakpointItem **newbps = realloc(bp->bps_idx, bp->bps_idx_count * sizeof(RzBreakpointItem *));
+		int grow = RZ_MAX(16, bp->bps_idx_count / 2);
+		RzBreakpointItem **newbps = realloc(bp->bps_idx, (bp->bps_idx_count + grow) * sizeof(RzBreakpointItem *));
 		if (newbps) {
 			bp->bps_idx = newbps;
+			bp->bps_idx_count += grow;
 			for (int j = i; j < bp->bps_idx_count; j++) {
 				bp->bps_idx[j] = NULL;
 			}
 		} else {
-			bp->bps_idx_count -= 16; // allocate space for 16 more bps
 			i = 0; // avoid oob below
 		}
 	}
 	/* empty slot */
 	bp->bps_idx[i] = b;
+	bp->bps_idx_free = i + 1;
 	bp->nbps++;
 	rz_list_append(bp->bps, b);
+	rz_interval_tree_insert(&bp->bps_tree, b->addr, b->addr + b->size, b);
 }
 
 /* TODO: detect overlapping of breakpoints */
@@ -303,27 +373,26 @@ RZ_API RzBreakpointItem *rz_bp_add_hw(RzBreakpoint *bp, ut64 addr, int size, int
 RZ_API bool rz_bp_del_all(RzBreakpoint *bp) {
 	int i;
 	if (!rz_list_empty(bp->bps)) {
+		rz_vector_free(rz_bp_coverage_stop(bp));
+		rz_interval_tree_fini(&bp->bps_tree);
+		rz_interval_tree_init(&bp->bps_tree, NULL);
 		rz_list_purge(bp->bps);
 		for (i = 0; i < bp->bps_idx_count; i++) {
 			bp->bps_idx[i] = NULL;
 		}
+		bp->bps_idx_free = 0;
 		return true;
 	}
 	return false;
 }
 
 RZ_API bool rz_bp_del(RzBreakpoint *bp, ut64 addr) {
-	RzListIter *iter;
-	RzBreakpointItem *b;
-	/* No _safe loop necessary because we return immediately after the delete. */
-	rz_list_foreach (bp->bps, iter, b) {
-		if (b->addr == addr) {
-			unlinkBreakpoint(bp, b);
-			// rz_list_delete (bp->bps, iter);
-			return true;
-		}
+	RzBreakpointItem *b = rz_bp_get_at(bp, addr);
+	if (!b) {
+		return false;
 	}
-	return false;
+	unlinkBreakpoint(bp, b);
+	return true;
 }
 
 RZ_API int rz_bp_set_trace(RzBreakpoint *bp, ut64 addr, int set) {
@@ -363,8 +432,9 @@ RZ_API int rz_bp_get_index_at(RzBreakpoint *bp, ut64 addr) {
 
 RZ_API int rz_bp_del_index(RzBreakpoint *bp, int idx) {
 	if (idx >= 0 && idx < bp->bps_idx_count) {
-		rz_list_delete_data(bp->bps, bp->bps_idx[idx]);
-		bp->bps_idx[idx] = 0;
+		if (bp->bps_idx[idx]) {
+			unlinkBreakpoint(bp, bp->bps_idx[idx]);
+		}
 		return true;
 	}
 	return false;
@@ -413,6 +483,24 @@ RZ_API bool rz_bp_is_valid(RzBreakpoint *bp, RzBreakpointItem *b) {
 	return bp->ctx.is_mapped(b->addr, b->perm, bp->ctx.user);
 }
 
+/**
+ * \brief Move \p item to \p addr
+ *
+ * The address of a breakpoint must only be changed through this function,
+ * to keep it in sync with the index used to look up breakpoints.
+ */
+RZ_API void rz_bp_item_set_addr(RZ_NONNULL RzBreakpoint *bp, RZ_NONNULL RzBreakpointItem *item, ut64 addr) {
+	rz_return_if_fail(bp && item);
+	if (item->addr == addr) {
+		return;
+	}
+	RzIntervalNode *node = rz_interval_tree_node_at_data(&bp->bps_tree, item->addr, item);
+	if (node) {
+		rz_interval_tree_resize(&bp->bps_tree, node, addr, addr + item->size);
+	}
+	item->addr = addr;
+}
+
 /**
  * \brief set the condition for a RzBreakpointItem
  *
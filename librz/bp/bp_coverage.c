@@ -0,0 +1,222 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file bp_coverage.c
+ * Coverage tracing with one-shot software breakpoints.
+ *
+ * Unlike regular breakpoints, which are written before continuing and removed
+ * again on every stop, coverage breakpoints are written once and stay in
+ * memory until they are hit, so a stop only costs the write of the hit one.
+ * rz_bp_coverage_hide() keeps them out of the memory reads in the meantime.
+ * Hit breakpoints are only removed from the index right away, the list and the
+ * index table are cleaned up in batches.
+ */
+
+#include <rz_bp.h>
+
+RZ_IPI void rz_bp_item_unindex(RzBreakpoint *bp, RzBreakpointItem *b);
+RZ_IPI void rz_bp_item_delete_all(RzBreakpoint *bp, bool (*cb)(RzBreakpointItem *b, void *user), void *user);
+
+static int addr_cmp(const void *a, const void *b, void *user) {
+	ut64 x = *(const ut64 *)a;
+	ut64 y = *(const ut64 *)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+#define ADDR_CMP(x, y) ((x) < *(const ut64 *)(y) ? -1 : ((x) > *(const ut64 *)(y) ? 1 : 0))
+
+static void coverage_write(RzBreakpoint *bp, RzBreakpointItem *b, bool set) {
+	if (bp->breakpoint && bp->breakpoint(bp, b, set)) {
+		return;
+	}
+	rz_bp_restore_one(bp, b, set);
+}
+
+static bool is_hit_coverage(RzBreakpointItem *b, void *user) {
+	return b->coverage && b->hits;
+}
+
+static bool is_coverage(RzBreakpointItem *b, void *user) {
+	return b->coverage;
+}
+
+/**
+ * Write (\p set) or remove the coverage breakpoints not hit yet
+ */
+static void coverage_write_all(RzBreakpoint *bp, bool set) {
+	RzListIter *iter;
+	RzBreakpointItem *b;
+	rz_list_foreach (bp->bps, iter, b) {
+		if (b->coverage && b->enabled) {
+			coverage_write(bp, b, set);
+		}
+	}
+}
+
+/**
+ * \brief Start tracing which of \p addrs get executed
+ *
+ * A one-shot software breakpoint is placed at every address that does not
+ * have a breakpoint yet and written right away. Coverage breakpoints are left
+ * alone by rz_bp_restore(), handled by the debugger without stopping and
+ * removed once hit.
+ *
+ * \param addrs addresses to trace, in any order
+ * \return false if a coverage is already running or no breakpoint could be placed
+ */
+RZ_API bool rz_bp_coverage_start(RZ_NONNULL RzBreakpoint *bp, RZ_NONNULL RzVector /*<ut64>*/ *addrs) {
+	rz_return_val_if_fail(bp && addrs, false);
+	if (bp->coverage) {
+		RZ_LOG_ERROR("bp: A coverage is already running.\n");
+		return false;
+	}
+	if (rz_vector_empty(addrs)) {
+		return false;
+	}
+	RzBreakpointCoverage *cov = RZ_NEW0(RzBreakpointCoverage);
+	if (!cov) {
+		return false;
+	}
+	rz_vector_init(&cov->addrs, sizeof(ut64), NULL, NULL);
+	RzVector sorted;
+	if (!rz_vector_clone_into(&sorted, addrs) || !rz_vector_reserve(&cov->addrs, sorted.len)) {
+		rz_vector_fini(&sorted);
+		rz_vector_fini(&cov->addrs);
+		free(cov);
+		return false;
+	}
+	rz_vector_sort(&sorted, addr_cmp, false, NULL);
+	ut64 *addr;
+	ut64 last = UT64_MAX;
+	rz_vector_foreach(&sorted, addr) {
+		if (*addr == last || rz_bp_get_in(bp, *addr, 0)) {
+			continue;
+		}
+		last = *addr;
+		RzBreakpointItem *b = rz_bp_add_sw(bp, *addr, 0, RZ_PERM_X);
+		if (!b) {
+			continue;
+		}
+		b->coverage = true;
+		b->internal = true;
+		rz_vector_push(&cov->addrs, addr);
+	}
+	rz_vector_fini(&sorted);
+	if (rz_vector_empty(&cov->addrs) || !rz_bv_init(&cov->hits, cov->addrs.len)) {
+		rz_vector_fini(&cov->addrs);
+		free(cov);
+		return false;
+	}
+	bp->coverage = cov;
+	coverage_write_all(bp, true);
+	return true;
+}
+
+/**
+ * \brief Stop tracing the coverage
+ *
+ * The original bytes are restored at all the addresses that have not been hit
+ * and all coverage breakpoints are removed.
+ *
+ * \return the addresses that have been hit, sorted, or NULL if no coverage was running
+ */
+RZ_API RZ_OWN RzVector /*<ut64>*/ *rz_bp_coverage_stop(RZ_NONNULL RzBreakpoint *bp) {
+	rz_return_val_if_fail(bp, NULL);
+	RzBreakpointCoverage *cov = bp->coverage;
+	if (!cov) {
+		return NULL;
+	}
+	RzVector *hits = rz_vector_new(sizeof(ut64), NULL, NULL);
+	if (hits) {
+		for (ut32 i = 0; i < cov->addrs.len; i++) {
+			if (rz_bv_get(&cov->hits, i)) {
+				rz_vector_push(hits, rz_vector_index_ptr(&cov->addrs, i));
+			}
+		}
+	}
+	coverage_write_all(bp, false);
+	rz_bp_item_delete_all(bp, is_coverage, NULL);
+	bp->coverage = NULL;
+	rz_vector_fini(&cov->addrs);
+	rz_bv_fini(&cov->hits);
+	free(cov);
+	return hits;
+}
+
+typedef struct {
+	ut64 addr;
+	ut8 *buf;
+	size_t len;
+} HideCtx;
+
+static bool hide_cb(RzIntervalNode *node, void *user) {
+	RzBreakpointItem *b = node->data;
+	HideCtx *read = user;
+	if (!b->coverage || !b->enabled || !b->obytes) {
+		return true;
+	}
+	// copy the part of [b->addr, b->addr + b->size) inside the read
+	ut64 from = RZ_MAX(b->addr, read->addr);
+	ut64 to = RZ_MIN(b->addr + b->size, read->addr + read->len);
+	if (from < to) {
+		memcpy(read->buf + (from - read->addr), b->obytes + (from - b->addr), to - from);
+	}
+	return true;
+}
+
+/**
+ * \brief Put back the original bytes of the coverage breakpoints into \p buf
+ *
+ * Coverage breakpoints not hit yet stay in memory while the execution is
+ * stopped, this hides them from the \p len bytes read at \p addr.
+ */
+RZ_API void rz_bp_coverage_hide(RZ_NONNULL RzBreakpoint *bp, ut64 addr, RZ_NONNULL ut8 *buf, size_t len) {
+	rz_return_if_fail(bp && buf);
+	if (!bp->coverage || !len) {
+		return;
+	}
+	HideCtx read = { addr, buf, len };
+	ut64 end = addr + len < addr ? UT64_MAX : addr + len;
+	rz_interval_tree_all_intersect(&bp->bps_tree, addr, end, false, hide_cb, &read);
+}
+
+/**
+ * \brief Record a hit of the coverage breakpoint \p b
+ *
+ * The original bytes are restored and the breakpoint is disabled and dropped
+ * from the address index immediately, so the execution can simply continue.
+ * It is deleted later together with other hit breakpoints.
+ */
+RZ_API bool rz_bp_coverage_hit(RZ_NONNULL RzBreakpoint *bp, RZ_NONNULL RzBreakpointItem *b) {
+	rz_return_val_if_fail(bp && b, false);
+	RzBreakpointCoverage *cov = bp->coverage;
+	if (!cov || !b->coverage || b->hits) {
+		return false;
+	}
+	if (cov->pending >= RZ_MAX(0x100, rz_list_length(bp->bps) / 8)) {
+		rz_bp_coverage_flush(bp);
+	}
+	coverage_write(bp, b, false);
+	b->enabled = false;
+	b->hits++;
+	rz_bp_item_unindex(bp, b);
+	size_t i;
+	rz_vector_lower_bound(&cov->addrs, b->addr, i, ADDR_CMP);
+	if (i < cov->addrs.len && *(ut64 *)rz_vector_index_ptr(&cov->addrs, i) == b->addr) {
+		rz_bv_set(&cov->hits, i, true);
+	}
+	cov->pending++;
+	return true;
+}
+
+/**
+ * \brief Delete all the coverage breakpoints that have been hit so far
+ */
+RZ_API void rz_bp_coverage_flush(RZ_NONNULL RzBreakpoint *bp) {
+	rz_return_if_fail(bp);
+	if (!bp->coverage || !bp->coverage->pending) {
+		return;
+	}
+	rz_bp_item_delete_all(bp, is_hit_coverage, NULL);
+	bp->coverage->pending = 0;
+}
@@ -47,6 +47,10 @@ RZ_API bool rz_bp_restore_except(RzBreakpoint *bp, bool set, ut64 addr) {
 		if (addr && b->addr == addr) {
 			continue;
 		}
+		// Coverage breakpoints stay in memory until they are hit
+		if (b->coverage) {
+			continue;
+		}
 		// Avoid restoring disabled breakpoints
 		if (set && !b->enabled) {
 			continue;
@@ -16,6 +16,9 @@ RZ_API void rz_serialize_bp_save(RZ_NONNULL Sdb *db, RZ_NONNULL RzBreakpoint *bp
 	RzListIter *iter;
 	RzBreakpointItem *bp_item;
 	rz_list_foreach (bp->bps, iter, bp_item) {
+		if (bp_item->coverage) {
+			continue;
+		}
 		PJ *j = pj_new();
 		if (!j) {
 			return;
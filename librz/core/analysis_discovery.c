@@ -0,0 +1,394 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file analysis_discovery.c
+ * Parallel recursive descent used by `aa` when analysis.threads != 1.
+ *
+ * The function candidates are decoded concurrently: every worker owns a
+ * private RzAnalysis configured like core->analysis, follows the control
+ * flow of its candidate and queues the called functions as new candidates.
+ * Once all the workers are done, the decoded ops are committed serially
+ * into core->analysis->op_cache, so that the usual (serial) function
+ * analysis finds every instruction already decoded and builds exactly the
+ * same functions, basic blocks and xrefs as without threads.
+ *
+ * Only the decoding is parallel: splitting the basic blocks and creating
+ * the functions is still done by the serial analysis. Ops whose decoding
+ * read memory out of the instruction (RzAnalysisOp.reads_memory) are not
+ * committed and are decoded again by the serial analysis.
+ */
+
+#include <rz_core.h>
+#include <rz_th.h>
+
+#include "core_private.h"
+
+#define DISCOVERY_OP_MASK     (RZ_ANALYSIS_OP_MASK_ESIL | RZ_ANALYSIS_OP_MASK_VAL)
+#define DISCOVERY_WINDOW_SIZE 4096
+
+typedef struct discovery_candidate_t {
+	ut64 addr;
+	int depth;
+} DiscoveryCandidate;
+
+typedef struct discovery_op_t {
+	RzAnalysisOp op;
+	int ret;
+	ut8 bytes[RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE];
+} DiscoveryOp;
+
+typedef struct discovery_shared_t {
+	RzIO *io;
+	RzThreadLock *lock; ///< Guards all the fields below and serializes the IO reads
+	RzThreadCond *cond; ///< Signaled when a candidate is queued or a worker becomes idle
+	RzVector /*<DiscoveryCandidate>*/ candidates;
+	SetU *queued; ///< Addresses ever queued as candidates
+	size_t busy; ///< Number of workers currently decoding a candidate
+	bool stop;
+} DiscoveryShared;
+
+typedef struct discovery_worker_t {
+	DiscoveryShared *shared;
+	RzAnalysis *analysis; ///< Private instance, never shared between threads
+	SetU *decoded; ///< Addresses already decoded by this worker
+	RzVector /*<DiscoveryOp>*/ ops;
+	ut8 window[DISCOVERY_WINDOW_SIZE];
+	ut64 window_addr;
+	bool window_valid;
+} DiscoveryWorker;
+
+static void discovery_op_fini(void *e, void *user) {
+	DiscoveryOp *dop = e;
+	rz_analysis_op_fini(&dop->op);
+}
+
+/* must be called with shared->lock held */
+static void discovery_push_candidate(DiscoveryShared *shared, ut64 addr, int depth) {
+	if (addr == UT64_MAX || set_u_contains(shared->queued, addr)) {
+		return;
+	}
+	DiscoveryCandidate cand = { .addr = addr, .depth = depth };
+	if (!rz_vector_push(&shared->candidates, &cand)) {
+		return;
+	}
+	set_u_add(shared->queued, addr);
+	rz_th_cond_signal(shared->cond);
+}
+
+static bool discovery_read_window(DiscoveryWorker *worker, ut64 addr) {
+	DiscoveryShared *shared = worker->shared;
+	bool ok = false;
+	rz_th_lock_enter(shared->lock);
+	if (rz_cons_is_breaked()) {
+		shared->stop = true;
+		rz_th_cond_signal_all(shared->cond);
+	} else {
+		ok = rz_io_read_at(shared->io, addr, worker->window, sizeof(worker->window));
+	}
+	rz_th_lock_leave(shared->lock);
+	worker->window_addr = addr;
+	worker->window_valid = ok;
+	return ok;
+}
+
+/**
+ * read_at of the worker analysis, plugins may read memory out of the op being decoded.
+ */
+static bool discovery_analysis_read_at(RzAnalysis *analysis, ut64 addr, ut8 *buf, int len) {
+	DiscoveryShared *shared = analysis->read_at_user;
+	rz_th_lock_enter(shared->lock);
+	bool ok = rz_io_read_at(shared->io, addr, buf, len);
+	rz_th_lock_leave(shared->lock);
+	return ok;
+}
+
+static const ut8 *discovery_bytes_at(DiscoveryWorker *worker, ut64 addr, int *len) {
+	if (!worker->window_valid || addr < worker->window_addr ||
+		addr + RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE > worker->window_addr + sizeof(worker->window)) {
+		if (!discovery_read_window(worker, addr)) {
+			return NULL;
+		}
+	}
+	ut64 delta = addr - worker->window_addr;
+	*len = (int)(sizeof(worker->window) - delta);
+	return worker->window + delta;
+}
+
+/**
+ * Decodes all the instructions reachable from \p cand without following
+ * the calls, which are instead queued as new candidates.
+ */
+static void discovery_walk(DiscoveryWorker *worker, const DiscoveryCandidate *cand) {
+	RzAnalysis *analysis = worker->analysis;
+	ut64 bb_max_size = analysis->opt.bb_max_size > 0 ? analysis->opt.bb_max_size : UT64_MAX;
+	RzVector blocks;
+	rz_vector_init(&blocks, sizeof(ut64), NULL, NULL);
+	rz_vector_push(&blocks, (void *)&cand->addr);
+
+	while (!rz_vector_empty(&blocks) && !worker->shared->stop) {
+		ut64 at, bb_start;
+		rz_vector_pop(&blocks, &at);
+		bb_start = at;
+		while (!set_u_contains(worker->decoded, at) && at - bb_start < bb_max_size) {
+			int len = 0;
+			const ut8 *bytes = discovery_bytes_at(worker, at, &len);
+			if (!bytes) {
+				break;
+			}
+			DiscoveryOp *dop = rz_vector_push(&worker->ops, NULL);
+			if (!dop) {
+				break;
+			}
+			dop->ret = rz_analysis_op(analysis, &dop->op, at, bytes, len, DISCOVERY_OP_MASK);
+			if (dop->ret < 1 || dop->op.size < 1 || dop->op.size > RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE) {
+				rz_analysis_op_fini(&dop->op);
+				rz_vector_pop(&worker->ops, NULL);
+				break;
+			}
+			memcpy(dop->bytes, bytes, dop->op.size);
+			set_u_add(worker->decoded, at);
+
+			RzAnalysisOp *op = &dop->op;
+			bool end = false;
+			switch (op->type & RZ_ANALYSIS_OP_TYPE_MASK) {
+			case RZ_ANALYSIS_OP_TYPE_JMP:
+				rz_vector_push(&blocks, &op->jump);
+				end = true;
+				break;
+			case RZ_ANALYSIS_OP_TYPE_CJMP:
+				rz_vector_push(&blocks, &op->jump);
+				break;
+			case RZ_ANALYSIS_OP_TYPE_CALL:
+			case RZ_ANALYSIS_OP_TYPE_CCALL:
+				if (cand->depth > 0) {
+					rz_th_lock_enter(worker->shared->lock);
+					discovery_push_candidate(worker->shared, op->jump, cand->depth - 1);
+					rz_th_lock_leave(worker->shared->lock);
+				}
+				break;
+			case RZ_ANALYSIS_OP_TYPE_RET:
+			case RZ_ANALYSIS_OP_TYPE_CRET:
+			case RZ_ANALYSIS_OP_TYPE_ILL:
+			case RZ_ANALYSIS_OP_TYPE_TRAP:
+			case RZ_ANALYSIS_OP_TYPE_UJMP:
+			case RZ_ANALYSIS_OP_TYPE_RJMP:
+			case RZ_ANALYSIS_OP_TYPE_IJMP:
+			case RZ_ANALYSIS_OP_TYPE_IRJMP:
+			case RZ_ANALYSIS_OP_TYPE_MJMP:
+				end = true;
+				break;
+			default:
+				break;
+			}
+			if (end) {
+				break;
+			}
+			at += op->size;
+		}
+	}
+	rz_vector_fini(&blocks);
+}
+
+static void *discovery_worker_run(DiscoveryWorker *worker) {
+	DiscoveryShared *shared = worker->shared;
+	DiscoveryCandidate cand;
+
+	rz_th_lock_enter(shared->lock);
+	while (!shared->stop) {
+		if (rz_vector_empty(&shared->candidates)) {
+			if (!shared->busy) {
+				// nothing left to decode and nobody can queue new candidates.
+				rz_th_cond_signal_all(shared->cond);
+				break;
+			}
+			rz_th_cond_wait(shared->cond, shared->lock);
+			continue;
+		}
+		rz_vector_pop(&shared->candidates, &cand);
+		shared->busy++;
+		rz_th_lock_leave(shared->lock);
+
+		discovery_walk(worker, &cand);
+
+		rz_th_lock_enter(shared->lock);
+		shared->busy--;
+		if (!shared->busy && rz_vector_empty(&shared->candidates)) {
+			rz_th_cond_signal_all(shared->cond);
+		}
+	}
+	rz_th_lock_leave(shared->lock);
+	return NULL;
+}
+
+static RzAnalysis *discovery_analysis_new(RzAnalysis *analysis, DiscoveryShared *shared) {
+	RzAnalysis *clone = rz_analysis_new();
+	if (!clone) {
+		return NULL;
+	}
+	if (!rz_analysis_use(clone, analysis->cur->name)) {
+		rz_analysis_free(clone);
+		return NULL;
+	}
+	rz_analysis_set_big_endian(clone, analysis->big_endian);
+	rz_analysis_set_cpu(clone, analysis->cpu);
+	rz_analysis_set_bits(clone, analysis->bits);
+	clone->opt = analysis->opt;
+	clone->gp = analysis->gp;
+	clone->seggrn = analysis->seggrn;
+	free(clone->os);
+	clone->os = analysis->os ? strdup(analysis->os) : NULL;
+	clone->pcalign = analysis->pcalign;
+	if (analysis->read_at) {
+		clone->read_at = discovery_analysis_read_at;
+		clone->read_at_user = shared;
+	}
+	// the decoded ops are kept by the worker until they are committed
+	rz_analysis_op_cache_set_max_entries(clone, 0);
+	return clone;
+}
+
+static void discovery_value_remap(RzAnalysisValue *val, RzReg *from, RzReg *to) {
+	RzRegItem **items[] = { &val->seg, &val->reg, &val->regdelta };
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(items); i++) {
+		RzRegItem *item = *items[i];
+		// items not owned by the worker register profile (e.g. plugin static ones) are kept as they are
+		if (item && rz_reg_get(from, item->name, RZ_REG_TYPE_ANY) == item) {
+			*items[i] = rz_reg_get(to, item->name, RZ_REG_TYPE_ANY);
+		}
+	}
+}
+
+/**
+ * The decoded values point to the registers of the worker analysis,
+ * which must be replaced with the ones of the analysis owning the cache.
+ */
+static void discovery_op_remap_regs(RzAnalysisOp *op, RzReg *from, RzReg *to) {
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(op->src); i++) {
+		if (op->src[i]) {
+			discovery_value_remap(op->src[i], from, to);
+		}
+	}
+	if (op->dst) {
+		discovery_value_remap(op->dst, from, to);
+	}
+	RzListIter *it;
+	RzAnalysisValue *val;
+	rz_list_foreach (op->access, it, val) {
+		discovery_value_remap(val, from, to);
+	}
+}
+
+static void discovery_commit(RzAnalysis *analysis, DiscoveryWorker *worker) {
+	DiscoveryOp *dop;
+	rz_vector_foreach(&worker->ops, dop) {
+		discovery_op_remap_regs(&dop->op, worker->analysis->reg, analysis->reg);
+		// on success the ownership of the op is moved to the cache.
+		rz_analysis_op_cache_set(analysis, &dop->op, dop->ret, dop->bytes, DISCOVERY_OP_MASK);
+	}
+}
+
+static void discovery_worker_fini(DiscoveryWorker *worker) {
+	rz_vector_fini(&worker->ops);
+	set_u_free(worker->decoded);
+	rz_analysis_free(worker->analysis);
+}
+
+/**
+ * \brief Decodes in parallel the functions reachable from \p entries and
+ * stores the decoded instructions into core->analysis->op_cache.
+ *
+ * \param core     The RzCore to use
+ * \param entries  Addresses of the function candidates
+ * \param depth    Maximum call depth to follow from each candidate
+ * \param threads  Maximum number of threads (RZ_THREAD_POOL_ALL_CORES for all the cores)
+ *
+ * \return false when the parallel decoding cannot be performed, true otherwise.
+ */
+RZ_IPI bool rz_core_analysis_discover(RzCore *core, RzVector /*<ut64>*/ *entries, int depth, size_t threads) {
+	rz_return_val_if_fail(core && entries, false);
+	RzAnalysis *analysis = core->analysis;
+	if (!analysis->cur || !analysis->op_cache) {
+		return false;
+	} else if (!analysis->cur->op_reentrant) {
+		RZ_LOG_VERBOSE("aa: the '%s' analysis plugin cannot decode in parallel\n", analysis->cur->name);
+		return false;
+	}
+
+	bool result = false;
+	DiscoveryWorker *workers = NULL;
+	size_t n_workers = 0;
+	DiscoveryShared shared = { 0 };
+	shared.io = core->io;
+	shared.lock = rz_th_lock_new(false);
+	shared.cond = rz_th_cond_new();
+	shared.queued = set_u_new();
+	rz_vector_init(&shared.candidates, sizeof(DiscoveryCandidate), NULL, NULL);
+	RzThreadPool *pool = rz_th_pool_new(threads);
+	if (!shared.lock || !shared.cond || !shared.queued || !pool) {
+		RZ_LOG_ERROR("aa: cannot allocate the shared discovery context\n");
+		goto end;
+	}
+
+	ut64 *addr;
+	rz_vector_foreach(entries, addr) {
+		discovery_push_candidate(&shared, *addr, depth);
+	}
+
+	size_t pool_size = rz_th_pool_size(pool);
+	workers = RZ_NEWS0(DiscoveryWorker, pool_size);
+	if (!workers) {
+		RZ_LOG_ERROR("aa: cannot allocate discovery workers\n");
+		goto end;
+	}
+	// RzAnalysis instances are created sequentially since they load the types from disk
+	for (; n_workers < pool_size; n_workers++) {
+		DiscoveryWorker *worker = &workers[n_workers];
+		worker->shared = &shared;
+		worker->analysis = discovery_analysis_new(analysis, &shared);
+		worker->decoded = set_u_new();
+		rz_vector_init(&worker->ops, sizeof(DiscoveryOp), discovery_op_fini, NULL);
+		if (!worker->analysis || !worker->decoded) {
+			RZ_LOG_ERROR("aa: cannot allocate discovery worker\n");
+			n_workers++;
+			goto end;
+		}
+	}
+
+	RZ_LOG_VERBOSE("aa: using %u threads to decode %u candidates\n", (ut32)pool_size, (ut32)rz_vector_len(entries));
+	for (size_t i = 0; i < n_workers; i++) {
+		RzThread *th = rz_th_new((RzThreadFunction)discovery_worker_run, &workers[i]);
+		if (!th || !rz_th_pool_add_thread(pool, th)) {
+			RZ_LOG_ERROR("aa: cannot add discovery thread to the pool\n");
+			rz_th_free(th);
+			// the threads already started will still empty the candidates queue.
+			break;
+		}
+	}
+	rz_th_pool_wait(pool);
+
+	// all the decoded ops must fit in the cache, rz_core_analysis_all() restores the bound afterwards
+	ut64 n_ops = rz_analysis_op_cache_size(analysis);
+	for (size_t i = 0; i < n_workers; i++) {
+		n_ops += rz_vector_len(&workers[i].ops);
+	}
+	if (n_ops > analysis->op_cache->max_entries) {
+		rz_analysis_op_cache_set_max_entries(analysis, (ut32)RZ_MIN(n_ops, UT32_MAX));
+	}
+	for (size_t i = 0; i < n_workers; i++) {
+		discovery_commit(analysis, &workers[i]);
+	}
+	RZ_LOG_VERBOSE("aa: decoded %u instructions\n", rz_analysis_op_cache_size(analysis));
+	result = !shared.stop;
+
+end:
+	rz_th_pool_free(pool);
+	for (size_t i = 0; i < n_workers; i++) {
+		discovery_worker_fini(&workers[i]);
+	}
+	free(workers);
+	rz_vector_fini(&shared.candidates);
+	set_u_free(shared.queued);
+	rz_th_cond_free(shared.cond);
+	rz_th_lock_free(shared.lock);
+	return result;
+}
@@ -2362,6 +2362,59 @@ static bool isSkippable(RzBinSymbol *s) {
 	return false;
 }
 
+/**
+ * Collects the same function candidates visited by rz_core_analysis_all()
+ */
+static void analysis_all_candidates(RzCore *core, RzVector /*<ut64>*/ *addrs) {
+	RzFlagItem *item = rz_flag_get(core->flags, "entry0");
+	ut64 addr = item ? item->offset : core->offset;
+	rz_vector_push(addrs, &addr);
+
+	RzBinFile *bf = core->bin->cur;
+	RzBinObject *o = bf ? bf->o : NULL;
+	void **it;
+	if (o && o->symbols) {
+		rz_pvector_foreach (o->symbols, it) {
+			RzBinSymbol *symbol = *it;
+			if (!isSkippable(symbol) && isValidSymbol(symbol)) {
+				addr = rz_bin_object_get_vaddr(o, symbol->paddr, symbol->vaddr);
+				rz_vector_push(addrs, &addr);
+			}
+		}
+	}
+	const RzBinAddr *binmain;
+	if (o && (binmain = rz_bin_object_get_special_symbol(o, RZ_BIN_SPECIAL_SYMBOL_MAIN)) && binmain->paddr != UT64_MAX) {
+		addr = rz_bin_object_get_vaddr(o, binmain->paddr, binmain->vaddr);
+		rz_vector_push(addrs, &addr);
+	}
+	RzList *list = rz_bin_get_entries(core->bin);
+	RzListIter *iter;
+	RzBinAddr *entry;
+	rz_list_foreach (list, iter, entry) {
+		if (entry->paddr != UT64_MAX) {
+			addr = rz_bin_object_get_vaddr(o, entry->paddr, entry->vaddr);
+			rz_vector_push(addrs, &addr);
+		}
+	}
+}
+
+/**
+ * When analysis.threads != 1, decodes in parallel all the functions
+ * candidates, so that the serial analysis which follows does not need
+ * to decode again the same instructions.
+ */
+static void analysis_all_discover(RzCore *core, int depth) {
+	int threads = rz_config_get_i(core->config, "analysis.threads");
+	if (threads == 1) {
+		return;
+	}
+	RzVector addrs;
+	rz_vector_init(&addrs, sizeof(ut64), NULL, NULL);
+	analysis_all_candidates(core, &addrs);
+	rz_core_analysis_discover(core, &addrs, depth - 1, threads < 0 ? RZ_THREAD_POOL_ALL_CORES : threads);
+	rz_vector_fini(&addrs);
+}
+
 RZ_API int rz_core_analysis_all(RzCore *core) {
 	RzList *list;
 	RzListIter *iter;
@@ -2372,6 +2425,7 @@ RZ_API int rz_core_analysis_all(RzCore *core) {
 	RzBinSymbol *symbol;
 	int depth = core->analysis->opt.depth;
 	bool analysis_vars = rz_config_get_i(core->config, "analysis.vars");
+	analysis_all_discover(core, depth);
 
 	/* Analyze Functions */
 	/* Entries */
@@ -2444,6 +2498,8 @@ RZ_API int rz_core_analysis_all(RzCore *core) {
 	rz_platform_profile_add_flag_every_io(core->analysis->arch_target->profile, core->flags);
 	rz_platform_index_add_flags_comments(core);
 
+	// the parallel discovery may have grown the decoded ops cache beyond its configured bound
+	rz_analysis_op_cache_set_max_entries(core->analysis, rz_config_get_i(core->config, "analysis.opcache"));
 	rz_cons_break_pop();
 	return true;
 }
@@ -3612,15 +3668,14 @@ struct core_noretl {
 	SetU *todo;
 };
 
-static bool process_reference_noreturn_cb(void *u, const ut64 k, const void *v) {
-	RzCore *core = ((struct core_noretl *)u)->core;
-	RzList *noretl = ((struct core_noretl *)u)->noretl;
-	SetU *todo = ((struct core_noretl *)u)->todo;
-	RzAnalysisXRef *xref = (RzAnalysisXRef *)v;
+static void process_reference_noreturn(struct core_noretl *u, RzAnalysisXRef *xref) {
+	RzCore *core = u->core;
+	RzList *noretl = u->noretl;
+	SetU *todo = u->todo;
 	if (xref->type == RZ_ANALYSIS_XREF_TYPE_CALL || xref->type == RZ_ANALYSIS_XREF_TYPE_CODE) {
 		// At first we check if there are any relocations that override the call address
 		// Note, that the relocation overrides only the part of the instruction
-		ut64 addr = k;
+		ut64 addr = xref->from;
 		ut8 buf[CALL_BUF_SIZE] = { 0 };
 		RzAnalysisOp op = { 0 };
 		if (core->analysis->iob.read_at(core->analysis->iob.io, addr, buf, CALL_BUF_SIZE)) {
@@ -3631,7 +3686,7 @@ static bool process_reference_noreturn_cb(void *u, const ut64 k, const void *v)
 					RzAnalysisBlock *block = find_block_at_xref_addr(core, addr);
 					if (!block) {
 						rz_analysis_op_fini(&op);
-						return true;
+						return;
 					}
 					relocation_noreturn_process(core, noretl, todo, block, rel, op.size, addr);
 				}
@@ -3641,13 +3696,6 @@ static bool process_reference_noreturn_cb(void *u, const ut64 k, const void *v)
 			RZ_LOG_INFO("analysis: Fail to load %d bytes of data at 0x%08" PFMT64x "\n", CALL_BUF_SIZE, addr);
 		}
 	}
-	return true;
-}
-
-static bool process_refs_cb(void *u, const ut64 k, const void *v) {
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach(ht, process_reference_noreturn_cb, u);
-	return true;
 }
 
 static bool reanalyze_fcns_cb(void *u, const ut64 k, const void *v) {
@@ -3671,7 +3719,14 @@ RZ_API void rz_core_analysis_propagate_noreturn_relocs(RzCore *core, ut64 addr)
 	// List of the potentially noreturn functions
 	SetU *todo = set_u_new();
 	struct core_noretl u = { core, noretl, todo };
-	ht_up_foreach(core->analysis->ht_xrefs_to, process_refs_cb, &u);
+	// the processing can change the xrefs, so they are iterated from a copy
+	RzList *xrefs = rz_analysis_xrefs_list(core->analysis);
+	RzListIter *iter;
+	RzAnalysisXRef *xref;
+	rz_list_foreach (xrefs, iter, xref) {
+		process_reference_noreturn(&u, xref);
+	}
+	rz_list_free(xrefs);
 	rz_list_free(noretl);
 	core->analysis->bits = bits1;
 	core->rasm->bits = bits2;
@@ -4310,7 +4365,14 @@ RZ_API bool rz_core_analysis_sigdb_apply(RZ_NONNULL RzCore *core, RZ_NULLABLE in
 		return false;
 	}
 
-	n_flags_old = rz_flag_count(core->flags, "flirt");
+	RzStrBuf key;
+	rz_strbuf_initf(&key, "%u\n", arch_id);
+	RzList *files = rz_list_new();
+	if (!files) {
+		rz_strbuf_fini(&key);
+		rz_list_free(sigdb);
+		return false;
+	}
 	rz_list_foreach (sigdb, iter, sig) {
 		if (rz_cons_is_breaked()) {
 			break;
@@ -4335,7 +4397,32 @@ RZ_API bool rz_core_analysis_sigdb_apply(RZ_NONNULL RzCore *core, RZ_NULLABLE in
 			rz_cons_printf("Applying %s/%s/%u/%s signature file\n",
 				sig->bin_name, sig->arch_name, sig->arch_bits, sig->base_name);
 		}
-		rz_sign_flirt_apply(core->analysis, sig->file_path, arch_id);
+		rz_list_append(files, sig->file_path);
+		rz_strbuf_appendf(&key, "%s:%" PFMT64u ":%" PFMT64u "\n", sig->file_path,
+			rz_file_size(sig->file_path), rz_file_mtime(sig->file_path));
+	}
+
+	// all the selected files are matched at once and kept for the next run
+	if (!core->sigdb_node || !core->sigdb_node_key || strcmp(core->sigdb_node_key, rz_strbuf_get(&key))) {
+		RZ_FREE_CUSTOM(core->sigdb_node, rz_sign_flirt_node_free);
+		RZ_FREE(core->sigdb_node_key);
+		core->sigdb_node = RZ_NEW0(RzFlirtNode);
+		char *file_path;
+		rz_list_foreach (files, iter, file_path) {
+			RzFlirtNode *node = core->sigdb_node ? rz_sign_flirt_parse_file(file_path, arch_id) : NULL;
+			if (node && !rz_sign_flirt_node_merge(core->sigdb_node, node)) {
+				rz_sign_flirt_node_free(node);
+			}
+		}
+		core->sigdb_node_key = rz_strbuf_drain_nofree(&key);
+	}
+	rz_strbuf_fini(&key);
+	rz_list_free(files);
+
+	n_flags_old = rz_flag_count(core->flags, "flirt");
+	if (core->sigdb_node && core->sigdb_node->child_list) {
+		size_t threads = rz_config_get_i(core->config, "flirt.threads");
+		rz_sign_flirt_apply_node(core->analysis, core->sigdb_node, threads);
 	}
 	rz_list_free(sigdb);
 	n_flags_new = rz_flag_count(core->flags, "flirt");
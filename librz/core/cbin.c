@@ -628,7 +628,11 @@ RZ_API bool rz_core_bin_apply_main(RzCore *r, RzBinFile *binfile, bool va) {
 }
 
 static inline RzBinDWARF *load_dwarf(RzCore *core, RzBinFile *binfile) {
-	RzBinDWARF *dw = rz_bin_dwarf_from_file(binfile);
+	RzBinDwarfInfoOptions opt = {
+		.max_decoded_units = rz_config_get_i(core->config, "bin.dbginfo.lazy"),
+		.max_threads = rz_config_get_i(core->config, "bin.dbginfo.threads"),
+	};
+	RzBinDWARF *dw = rz_bin_dwarf_from_file_opt(binfile, &opt);
 
 	const char *dwo_path = rz_config_get(core->config, "bin.dbginfo.dwo_path");
 	if (RZ_STR_ISNOTEMPTY(dwo_path)) {
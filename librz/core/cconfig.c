@@ -146,6 +146,16 @@ static bool cb_analysis_jmptailcall(void *user, void *data) {
 	return true;
 }
 
+static bool cb_analysis_opcache(void *user, void *data) {
+	RzCore *core = (RzCore *)user;
+	RzConfigNode *node = (RzConfigNode *)data;
+	if (node->i_value > UT32_MAX) {
+		return false;
+	}
+	rz_analysis_op_cache_set_max_entries(core->analysis, (ut32)node->i_value);
+	return true;
+}
+
 static bool cb_analysis_armthumb(void *user, void *data) {
 	RzCore *core = (RzCore *)user;
 	RzConfigNode *node = (RzConfigNode *)data;
@@ -2339,6 +2349,9 @@ static bool cb_seggrn(void *user, void *data) {
 	RzCore *core = (RzCore *)user;
 	RzConfigNode *node = (RzConfigNode *)data;
 	core->rasm->seggrn = node->i_value;
+	if (core->analysis->seggrn != node->i_value) {
+		rz_analysis_op_cache_clear(core->analysis);
+	}
 	core->analysis->seggrn = node->i_value;
 	core->print->seggrn = node->i_value;
 	return true;
@@ -2955,6 +2968,8 @@ RZ_API int rz_core_config_init(RzCore *core) {
 		"analysis.fcn", "analysis.bb",
 		NULL);
 	SETI("analysis.timeout", 0, "Stop analyzing after a couple of seconds");
+	SETICB("analysis.opcache", RZ_ANALYSIS_OP_CACHE_DEFAULT_SIZE, &cb_analysis_opcache, "Maximum number of decoded instructions kept in cache (0: disabled)");
+	SETI("analysis.threads", 1, "Number of threads used by aa to decode the functions (1: no threads, 0: all the available cores)");
 	SETCB("analysis.jmp.retpoline", "true", &cb_analysis_jmpretpoline, "Analyze retpolines, may be slower if not needed");
 	SETICB("analysis.jmp.tailcall", 0, &cb_analysis_jmptailcall, "Consume a branch as a call if delta is big");
 
@@ -3248,6 +3263,8 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	SETI("bin.laddr", 0, "Base address for loading library ('*.so')");
 	SETCB("bin.dbginfo", "true", &cb_bindbginfo, "Load debug information at startup if available");
 	SETCB("bin.dbginfo.dwo_path", "", NULL, "Load separate debug information (DWARF) file if available");
+	SETI("bin.dbginfo.lazy", 0, "Number of DWARF units kept decoded when decoding them on demand (0: decode all upfront)");
+	SETI("bin.dbginfo.threads", RZ_THREAD_POOL_ALL_CORES, "Number of threads used to parse the DWARF units (1: no threads, 0: all the available cores)");
 	SETCB("bin.dbginfo.debug_file_directory", "/usr/lib/debug", NULL,
 		"Set the directories which searches for separate debugging information files to directory");
 	SETCB("bin.dbginfo.debuginfod", "false", NULL,
@@ -3271,6 +3288,7 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	/* prj */
 	SETPREF("prj.file", "", "Path of the currently opened project");
 	SETBPREF("prj.compress", "false", "Compress the project file while saving");
+	SETBPREF("prj.binary", "false", "Save the project in the binary format, which is faster to save and load");
 
 	/* cfg */
 	SETBPREF("cfg.plugins", "true", "Load plugins at startup");
@@ -3669,6 +3687,7 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	SETICB("search.kwidx", 0, &cb_search_kwidx, "Store last search index count");
 	SETPREF("search.prefix", "hit", "Prefix name in search hits label");
 	SETBPREF("search.show", "true", "Show search results");
+	SETI("search.threads", 1, "Number of threads used to search keywords, regexps, AES and private keys (1: no threads, 0: all the available cores)");
 	SETI("search.to", -1, "Search end address");
 	n = NODECB("search.case_sensitive", "smart", &cb_search_case_sensitive);
 	SETDESC(n, "Set grep(~) as case smart/sensitive/insensitive");
@@ -3775,6 +3794,7 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	SETB("flirt.sigdb.load.system", true, "Load signatures from the system path");
 	SETB("flirt.sigdb.load.extra", true, "Load signatures from the extra path");
 	SETB("flirt.sigdb.load.home", true, "Load signatures from the home path");
+	SETI("flirt.threads", RZ_THREAD_POOL_ALL_CORES, "Number of threads used to match the functions against the FLIRT signatures (1: no threads, 0: all the available cores)");
 
 	rz_config_lock(cfg, true);
 	return true;
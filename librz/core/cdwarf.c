@@ -169,7 +169,7 @@ RZ_API RZ_OWN char *rz_core_bin_dwarf_attr_to_string(
 }
 
 RZ_API RZ_OWN char *rz_core_bin_dwarf_debug_info_to_string(
-	RZ_NONNULL RZ_BORROW const RzBinDwarfInfo *info,
+	RZ_NONNULL RZ_BORROW RzBinDwarfInfo *info,
 	const RzBinDWARF *dw) {
 	rz_return_val_if_fail(info, NULL);
 	RzStrBuf *sb = rz_strbuf_new(NULL);
@@ -190,6 +190,7 @@ RZ_API RZ_OWN char *rz_core_bin_dwarf_debug_info_to_string(
 		}
 		rz_strbuf_append(sb, "\n");
 
+		rz_bin_dwarf_info_unit_load(info, unit);
 		RzBinDwarfDie *die = NULL;
 		rz_vector_foreach(&unit->dies, die) {
 			rz_strbuf_appendf(sb, "<0x%" PFMT64x ">: Abbrev Number: %-4" PFMT64u " ",
@@ -222,6 +223,7 @@ RZ_API RZ_OWN char *rz_core_bin_dwarf_debug_info_to_string(
 				rz_strbuf_append(sb, "\n");
 			}
 		}
+		rz_bin_dwarf_info_trim(info);
 	}
 	return rz_strbuf_drain(sb);
 }
@@ -243,7 +245,7 @@ static bool htup_loclists_cb(void *u, ut64 k, const void *v) {
 	rz_pvector_foreach (&loclist->entries, it) {
 		RzBinDwarfLocListEntry *entry = *it;
 		rz_strbuf_appendf(sb, "\t(0x%" PFMT64x ", 0x%" PFMT64x ")\t", entry->range->begin, entry->range->end);
-		if (entry->expression) {
+		if (entry->expression && ctx->dw->info) {
 			const RzBinDwarfEncoding *enc = ht_up_find(
 				ctx->dw->info->location_encoding, k, NULL);
 			if (!enc) {
@@ -271,6 +273,10 @@ RZ_API RZ_OWN char *rz_core_bin_dwarf_loc_to_string(
 		return NULL;
 	}
 	rz_strbuf_appendf(sb, "\nContents of the .debug_loc|.debug_loclists section:\n");
+	if (dw->info) {
+		// the encodings of the units not decoded yet are missing in lazy mode
+		rz_bin_dwarf_info_locations_load(dw->info);
+	}
 	DumpContext ctx = {
 		.dw = dw,
 		.sb = sb,
@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 
 #include <rz_core.h>
+#include <rz_th.h>
+#include "core_private.h"
 
 RZ_API RzCmdStatus rz_core_hash_plugin_print(RzCmdStateOutput *state, const RzHashPlugin *plugin) {
 	PJ *pj = state->d.pj;
@@ -53,3 +55,415 @@ RZ_API RzCmdStatus rz_core_hash_plugins_print(RzHash *hash, RzCmdStateOutput *st
 	rz_cmd_state_output_array_end(state);
 	return RZ_CMD_STATUS_OK;
 }
+
+/* Digests of fixed size blocks, cached across commands */
+
+#define BLOCK_HASH_READ_SIZE   0x1000000 ///< Bytes read and hashed at once
+#define BLOCK_HASH_MAX_ENTRIES 0x100000 ///< Digests kept per map before they are dropped
+#define BLOCK_HASH_MAX_TABLES  16 ///< Algorithm, block size and phase combinations kept before dropping the oldest
+#define BLOCK_HASH_PHYS        UT64_MAX ///< Key of the blocks read in physical mode, in place of a map id
+
+typedef struct {
+	ut64 state; ///< Fingerprint of the map the digests were computed on
+	HtUP /*<ut64, ut8 *>*/ *digests; ///< Offset of the block in the map to digest
+} BlockHashMap;
+
+typedef struct {
+	char *algo;
+	ut64 blocksize;
+	ut64 phase; ///< Address of the blocks modulo blocksize
+	RzHashSize digest_size;
+	HtUP /*<ut64, BlockHashMap *>*/ *maps; ///< Map id (or BLOCK_HASH_PHYS) to the digests of its blocks
+} BlockHashTable;
+
+struct rz_core_block_hash_cache_t {
+	RzPVector /*<BlockHashTable *>*/ tables;
+	ut64 io_state; ///< Fingerprint of the io settings the digests were computed with
+};
+
+typedef struct {
+	const ut8 *data;
+	ut64 size;
+	ut8 *digest;
+	bool success;
+} BlockHashJob;
+
+typedef struct {
+	RzHash *hash;
+	const char *algo;
+	RzHashSize digest_size;
+} BlockHashShared;
+
+static void block_hash_kv_free(HtUPKv *kv) {
+	free(kv->value);
+}
+
+static void block_hash_map_kv_free(HtUPKv *kv) {
+	BlockHashMap *map = kv->value;
+	ht_up_free(map->digests);
+	free(map);
+}
+
+static void block_hash_table_free(BlockHashTable *table) {
+	if (!table) {
+		return;
+	}
+	ht_up_free(table->maps);
+	free(table->algo);
+	free(table);
+}
+
+RZ_IPI RZ_OWN RzCoreBlockHashCache *rz_core_block_hash_cache_new(void) {
+	RzCoreBlockHashCache *cache = RZ_NEW0(RzCoreBlockHashCache);
+	if (!cache) {
+		return NULL;
+	}
+	rz_pvector_init(&cache->tables, (RzPVectorFree)block_hash_table_free);
+	return cache;
+}
+
+RZ_IPI void rz_core_block_hash_cache_free(RZ_NULLABLE RzCoreBlockHashCache *cache) {
+	if (!cache) {
+		return;
+	}
+	rz_pvector_fini(&cache->tables);
+	free(cache);
+}
+
+/**
+ * \brief Drops the cached digests of the blocks read through \p map
+ */
+RZ_IPI void rz_core_block_hash_map_deleted(RzCore *core, RzIOMap *map) {
+	RzCoreBlockHashCache *cache = core->block_hashes;
+	if (!cache) {
+		return;
+	}
+	void **it;
+	rz_pvector_foreach (&cache->tables, it) {
+		BlockHashTable *table = *it;
+		ht_up_delete(table->maps, map->id);
+	}
+}
+
+#define MIX(h, x) h = (h ^ (ut64)(x)) * 0x100000001b3ULL
+
+/**
+ * The settings changing what every read returns. The writes, including the
+ * ones to the write cache, are reported by the io events and the maps are
+ * checked one by one, so neither is part of this fingerprint.
+ */
+static ut64 io_state_fingerprint(RzIO *io) {
+	ut64 h = 0xcbf29ce484222325ULL;
+	MIX(h, io->va);
+	MIX(h, io->cached);
+	MIX(h, io->Oxff);
+	return h;
+}
+
+static ut64 map_state_fingerprint(RzIOMap *map) {
+	ut64 h = 0xcbf29ce484222325ULL;
+	MIX(h, map->fd);
+	MIX(h, map->perm);
+	MIX(h, map->delta);
+	MIX(h, map->itv.addr);
+	return h;
+}
+
+#undef MIX
+
+/**
+ * Returns the digests of the map the block at \p addr is read from, and the
+ * offset of the block in it. The blocks spanning several maps are not cached.
+ */
+static BlockHashMap *block_hash_map_get(RzIO *io, BlockHashTable *table, ut64 addr, ut64 *offset) {
+	ut64 id, state;
+	if (io->va) {
+		const RzSkylineItem *part = rz_skyline_get_item(&io->map_skyline, addr);
+		if (!part || part->itv.size < table->blocksize || addr - part->itv.addr > part->itv.size - table->blocksize) {
+			return NULL;
+		}
+		RzIOMap *map = part->user;
+		id = map->id;
+		state = map_state_fingerprint(map);
+		*offset = addr - map->itv.addr;
+	} else {
+		if (!io->desc) {
+			return NULL;
+		}
+		id = BLOCK_HASH_PHYS;
+		state = io->desc->fd;
+		*offset = addr;
+	}
+	BlockHashMap *map = ht_up_find(table->maps, id, NULL);
+	if (map && (map->state != state || map->digests->count >= BLOCK_HASH_MAX_ENTRIES)) {
+		ht_up_delete(table->maps, id);
+		map = NULL;
+	}
+	if (map) {
+		return map;
+	}
+	map = RZ_NEW0(BlockHashMap);
+	if (!map) {
+		return NULL;
+	}
+	map->state = state;
+	map->digests = ht_up_new(NULL, block_hash_kv_free, NULL);
+	if (!map->digests || !ht_up_insert(table->maps, id, map)) {
+		ht_up_free(map->digests);
+		free(map);
+		return NULL;
+	}
+	return map;
+}
+
+static ut8 *block_hash_find(RzIO *io, BlockHashTable *table, ut64 addr) {
+	ut64 offset;
+	BlockHashMap *map = table ? block_hash_map_get(io, table, addr, &offset) : NULL;
+	return map ? ht_up_find(map->digests, offset, NULL) : NULL;
+}
+
+static BlockHashTable *block_hash_table_get(RzCoreBlockHashCache *cache, const char *algo, ut64 blocksize, ut64 phase, RzHashSize digest_size) {
+	void **it;
+	rz_pvector_foreach (&cache->tables, it) {
+		BlockHashTable *table = *it;
+		if (table->blocksize == blocksize && table->phase == phase && !strcmp(table->algo, algo)) {
+			return table;
+		}
+	}
+	if (rz_pvector_len(&cache->tables) >= BLOCK_HASH_MAX_TABLES) {
+		block_hash_table_free(rz_pvector_remove_at(&cache->tables, 0));
+	}
+	BlockHashTable *table = RZ_NEW0(BlockHashTable);
+	if (!table) {
+		return NULL;
+	}
+	table->algo = strdup(algo);
+	table->blocksize = blocksize;
+	table->phase = phase;
+	table->digest_size = digest_size;
+	table->maps = ht_up_new(NULL, block_hash_map_kv_free, NULL);
+	if (!table->algo || !table->maps || !rz_pvector_push(&cache->tables, table)) {
+		block_hash_table_free(table);
+		return NULL;
+	}
+	return table;
+}
+
+static void block_hash_job_run(BlockHashJob *job, BlockHashShared *shared) {
+	RzHashSize size = 0;
+	ut8 *digest = rz_hash_cfg_calculate_small_block(shared->hash, shared->algo, job->data, job->size, &size);
+	if (!digest) {
+		return;
+	}
+	memcpy(job->digest, digest, RZ_MIN(size, shared->digest_size));
+	job->success = true;
+	free(digest);
+}
+
+/**
+ * Reads the \p count consecutive blocks starting at \p addr at once and
+ * hashes them on all the cores.
+ */
+static bool block_hash_compute(RzCore *core, BlockHashShared *shared, BlockHashTable *table, ut64 addr, ut64 blocksize, size_t count, ut8 *out) {
+	ut8 *buf = malloc(blocksize * count);
+	BlockHashJob *jobs = RZ_NEWS0(BlockHashJob, count);
+	RzPVector *vec = rz_pvector_new(NULL);
+	if (!buf || !jobs || !vec || !rz_pvector_reserve(vec, count)) {
+		free(buf);
+		free(jobs);
+		rz_pvector_free(vec);
+		return false;
+	}
+	rz_io_read_at(core->io, addr, buf, blocksize * count);
+	for (size_t i = 0; i < count; i++) {
+		jobs[i].data = buf + i * blocksize;
+		jobs[i].size = blocksize;
+		jobs[i].digest = out + i * shared->digest_size;
+		rz_pvector_push(vec, &jobs[i]);
+	}
+	if (count > 1) {
+		rz_th_iterate_pvector(vec, (RzThreadIterator)block_hash_job_run, RZ_THREAD_POOL_ALL_CORES, shared);
+	} else {
+		block_hash_job_run(&jobs[0], shared);
+	}
+
+	bool result = true;
+	for (size_t i = 0; i < count; i++) {
+		if (!jobs[i].success) {
+			result = false;
+			continue;
+		}
+		ut64 offset;
+		BlockHashMap *map = table ? block_hash_map_get(core->io, table, addr + i * blocksize, &offset) : NULL;
+		if (!map) {
+			continue;
+		}
+		ut8 *copy = rz_mem_dup(jobs[i].digest, shared->digest_size);
+		if (copy && !ht_up_update(map->digests, offset, copy)) {
+			free(copy);
+		}
+	}
+	free(buf);
+	free(jobs);
+	rz_pvector_free(vec);
+	return result;
+}
+
+/**
+ * \brief Calculates the digests of \p nblocks consecutive blocks starting at \p from
+ *
+ * The digests are cached per algorithm, block size and map, so that asking
+ * again for the same blocks (e.g. redrawing an entropy bar) only hashes the
+ * blocks which have been written in the meantime, and changing a map only
+ * drops the digests of that map. The blocks missing from the cache are read
+ * in big chunks and hashed in parallel. Nothing is cached while debugging,
+ * since the memory can change at any time.
+ *
+ * \param core RzCore to read the blocks from
+ * \param algo name of the hash algorithm
+ * \param from address of the first block
+ * \param blocksize size of each block
+ * \param nblocks number of blocks
+ * \param digest_size set to the size of each digest
+ * \return the digests of the blocks one after the other, or NULL on failure
+ */
+RZ_API RZ_OWN ut8 *rz_core_block_hash(RZ_NONNULL RzCore *core, RZ_NONNULL const char *algo, ut64 from, ut64 blocksize, size_t nblocks, RZ_NULLABLE RzHashSize *digest_size) {
+	rz_return_val_if_fail(core && algo, NULL);
+	if (!blocksize || !nblocks || UT64_MUL_OVFCHK(blocksize, nblocks) ||
+		UT64_ADD_OVFCHK(from, blocksize * nblocks - 1)) {
+		return NULL;
+	}
+	RzHashCfg *md = rz_hash_cfg_new_with_algo2(core->hash, algo);
+	if (!md) {
+		return NULL;
+	}
+	BlockHashShared shared = {
+		.hash = core->hash,
+		.algo = algo,
+		.digest_size = rz_hash_cfg_size(md, algo),
+	};
+	rz_hash_cfg_free(md);
+	if (!shared.digest_size || SZT_MUL_OVFCHK(nblocks, shared.digest_size)) {
+		return NULL;
+	}
+	ut8 *out = RZ_NEWS0(ut8, nblocks * shared.digest_size);
+	if (!out) {
+		return NULL;
+	}
+
+	BlockHashTable *table = NULL;
+	RzCoreBlockHashCache *cache = core->block_hashes;
+	if (cache && !rz_config_get_b(core->config, "cfg.debug")) {
+		ut64 io_state = io_state_fingerprint(core->io);
+		if (io_state != cache->io_state) {
+			rz_pvector_clear(&cache->tables);
+			cache->io_state = io_state;
+		}
+		table = block_hash_table_get(cache, algo, blocksize, from % blocksize, shared.digest_size);
+	}
+
+	size_t max_count = RZ_MAX(BLOCK_HASH_READ_SIZE / blocksize, 1);
+	for (size_t i = 0; i < nblocks;) {
+		ut64 addr = from + i * blocksize;
+		ut8 *digest = block_hash_find(core->io, table, addr);
+		if (digest) {
+			memcpy(out + i * shared.digest_size, digest, shared.digest_size);
+			i++;
+			continue;
+		}
+		size_t count = 1;
+		while (i + count < nblocks && count < max_count &&
+			!block_hash_find(core->io, table, addr + count * blocksize)) {
+			count++;
+		}
+		if (!block_hash_compute(core, &shared, table, addr, blocksize, count, out + i * shared.digest_size)) {
+			free(out);
+			return NULL;
+		}
+		i += count;
+	}
+	if (digest_size) {
+		*digest_size = shared.digest_size;
+	}
+	return out;
+}
+
+/**
+ * \brief Calculates the entropy fraction (0 to 1) of \p nblocks consecutive blocks starting at \p from
+ *
+ * \see rz_core_block_hash
+ */
+RZ_API RZ_OWN double *rz_core_block_entropy(RZ_NONNULL RzCore *core, ut64 from, ut64 blocksize, size_t nblocks) {
+	rz_return_val_if_fail(core, NULL);
+	RzHashSize digest_size = 0;
+	ut8 *digests = rz_core_block_hash(core, "entropy_fract", from, blocksize, nblocks, &digest_size);
+	if (!digests || digest_size != sizeof(double)) {
+		free(digests);
+		return NULL;
+	}
+	double *entropy = RZ_NEWS(double, nblocks);
+	if (entropy) {
+		for (size_t i = 0; i < nblocks; i++) {
+			entropy[i] = rz_read_be_double(digests + i * digest_size);
+		}
+	}
+	free(digests);
+	return entropy;
+}
+
+/**
+ * Drops the digests of \p map for the blocks overlapping [from, last], the
+ * map starting at \p base.
+ */
+static void block_hash_map_invalidate(BlockHashTable *table, BlockHashMap *map, ut64 base, ut64 from, ut64 last) {
+	if (!map || !map->digests->count) {
+		return;
+	}
+	ut64 bs = table->blocksize;
+	ut64 lo = RZ_MAX(from > bs - 1 ? from - (bs - 1) : 0, base);
+	ut64 first = lo + (table->phase + bs - lo % bs) % bs;
+	if (first < lo || first > last) {
+		return;
+	}
+	ut64 n = (last - first) / bs;
+	if (n >= map->digests->count) {
+		ht_up_free(map->digests);
+		map->digests = ht_up_new(NULL, block_hash_kv_free, NULL);
+		return;
+	}
+	for (ut64 i = 0; i <= n; i++) {
+		ht_up_delete(map->digests, first + i * bs - base);
+	}
+}
+
+/**
+ * \brief Drops the cached digests of all the blocks overlapping [addr, addr + len)
+ */
+RZ_API void rz_core_block_hash_invalidate(RZ_NONNULL RzCore *core, ut64 addr, ut64 len) {
+	rz_return_if_fail(core);
+	RzCoreBlockHashCache *cache = core->block_hashes;
+	if (!cache || !len) {
+		return;
+	}
+	RzIO *io = core->io;
+	ut64 last = addr + len - 1 < addr ? UT64_MAX : addr + len - 1;
+	void **it;
+	rz_pvector_foreach (&cache->tables, it) {
+		BlockHashTable *table = *it;
+		if (!io->va) {
+			block_hash_map_invalidate(table, ht_up_find(table->maps, BLOCK_HASH_PHYS, NULL), 0, addr, last);
+			continue;
+		}
+		// also the maps hidden by others, their digests are kept
+		void **mit;
+		rz_pvector_foreach (&io->maps, mit) {
+			RzIOMap *map = *mit;
+			ut64 map_last = rz_itv_end(map->itv) - 1;
+			if (!map->itv.size || last < map->itv.addr || addr > map_last) {
+				continue;
+			}
+			block_hash_map_invalidate(table, ht_up_find(table->maps, map->id, NULL),
+				map->itv.addr, RZ_MAX(addr, map->itv.addr), RZ_MIN(last, map_last));
+		}
+	}
+}
@@ -796,11 +796,14 @@ RZ_API RzCmdStatus rz_core_io_cache_print(RzCore *core, RzCmdStateOutput *state)
 	rz_return_val_if_fail(core && core->io, RZ_CMD_STATUS_ERROR);
 
 	size_t i, j = 0;
-	void **iter;
+	RzList *caches = rz_io_cache_list(core->io);
+	if (!caches) {
+		return RZ_CMD_STATUS_ERROR;
+	}
+	RzListIter *iter;
 	RzIOCache *c;
 
-	rz_pvector_foreach (&core->io->cache, iter) {
-		c = *iter;
+	rz_list_foreach (caches, iter, c) {
 		const ut64 dataSize = rz_itv_size(c->itv);
 		switch (state->mode) {
 		case RZ_OUTPUT_MODE_STANDARD:
@@ -846,6 +849,7 @@ RZ_API RzCmdStatus rz_core_io_cache_print(RzCore *core, RzCmdStateOutput *state)
 		}
 		j++;
 	}
+	rz_list_free(caches);
 	return RZ_CMD_STATUS_OK;
 }
 
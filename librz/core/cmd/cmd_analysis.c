@@ -5903,6 +5903,45 @@ RZ_IPI RzCmdStatus rz_list_mne_handler(RzCore *core, int argc, const char **argv
 	return RZ_CMD_STATUS_OK;
 }
 
+RZ_IPI RzCmdStatus rz_analyze_op_cache_stats_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state) {
+	RzAnalysisOpCache *cache = core->analysis->op_cache;
+	if (!cache) {
+		return RZ_CMD_STATUS_ERROR;
+	}
+	ut32 size = rz_analysis_op_cache_size(core->analysis);
+	switch (state->mode) {
+	case RZ_OUTPUT_MODE_JSON:
+		pj_o(state->d.pj);
+		pj_kn(state->d.pj, "size", size);
+		pj_kn(state->d.pj, "max_size", cache->max_entries);
+		pj_kn(state->d.pj, "hits", cache->hits);
+		pj_kn(state->d.pj, "misses", cache->misses);
+		pj_end(state->d.pj);
+		break;
+	case RZ_OUTPUT_MODE_STANDARD: {
+		ut64 lookups = cache->hits + cache->misses;
+		rz_cons_printf("size: %u/%u\n", size, cache->max_entries);
+		rz_cons_printf("hits: %" PFMT64u "\n", cache->hits);
+		rz_cons_printf("misses: %" PFMT64u "\n", cache->misses);
+		rz_cons_printf("hit ratio: %.2f%%\n", lookups ? cache->hits * 100.0 / lookups : 0.0);
+		break;
+	}
+	default:
+		rz_warn_if_reached();
+		break;
+	}
+	return RZ_CMD_STATUS_OK;
+}
+
+RZ_IPI RzCmdStatus rz_analyze_op_cache_clear_handler(RzCore *core, int argc, const char **argv) {
+	if (!core->analysis->op_cache) {
+		return RZ_CMD_STATUS_ERROR;
+	}
+	rz_analysis_op_cache_clear(core->analysis);
+	rz_analysis_op_cache_reset_stats(core->analysis);
+	return RZ_CMD_STATUS_OK;
+}
+
 RZ_IPI RzCmdStatus rz_list_plugins_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state) {
 	return rz_core_asm_plugins_print(core, NULL, state);
 }
@@ -1827,6 +1827,10 @@ RZ_IPI RzCmdStatus rz_cmd_debug_list_bp_handler(RzCore *core, int argc, const ch
 		"perm", "hwsw", "type", "state", "valid", "cmd", "cond", "name", "module");
 
 	rz_list_foreach (core->dbg->bp->bps, iter, b) {
+		if (b->coverage) {
+			// listed by dbv
+			continue;
+		}
 		switch (state->mode) {
 		case RZ_OUTPUT_MODE_STANDARD:
 			rz_cons_printf("0x%08" PFMT64x " - 0x%08" PFMT64x
@@ -2326,6 +2330,104 @@ RZ_IPI RzCmdStatus rz_cmd_debug_bp_set_expr_cur_offset_handler(RzCore *core, int
 	return RZ_CMD_STATUS_OK;
 }
 
+// dbv
+RZ_IPI RzCmdStatus rz_cmd_debug_bp_coverage_list_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state) {
+	RzBreakpointCoverage *cov = core->dbg->bp->coverage;
+	if (!cov) {
+		RZ_LOG_ERROR("No coverage is running, start one with dbv+\n");
+		return RZ_CMD_STATUS_ERROR;
+	}
+	rz_cmd_state_output_array_start(state);
+	ut32 hits = 0;
+	for (ut32 i = 0; i < cov->addrs.len; i++) {
+		ut64 addr = *(ut64 *)rz_vector_index_ptr(&cov->addrs, i);
+		bool hit = rz_bv_get(&cov->hits, i);
+		hits += hit;
+		switch (state->mode) {
+		case RZ_OUTPUT_MODE_STANDARD:
+			rz_cons_printf("0x%08" PFMT64x " %s\n", addr, hit ? "hit" : "-");
+			break;
+		case RZ_OUTPUT_MODE_QUIET:
+			if (hit) {
+				rz_cons_printf("0x%08" PFMT64x "\n", addr);
+			}
+			break;
+		case RZ_OUTPUT_MODE_JSON:
+			pj_o(state->d.pj);
+			pj_kn(state->d.pj, "addr", addr);
+			pj_kb(state->d.pj, "hit", hit);
+			pj_end(state->d.pj);
+			break;
+		default:
+			rz_warn_if_reached();
+			break;
+		}
+	}
+	rz_cmd_state_output_array_end(state);
+	if (state->mode == RZ_OUTPUT_MODE_STANDARD) {
+		rz_cons_printf("%u/%u blocks hit\n", hits, (ut32)cov->addrs.len);
+	}
+	return RZ_CMD_STATUS_OK;
+}
+
+// dbv+
+RZ_IPI RzCmdStatus rz_cmd_debug_bp_coverage_start_handler(RzCore *core, int argc, const char **argv) {
+	RzVector addrs;
+	rz_vector_init(&addrs, sizeof(ut64), NULL, NULL);
+	RzListIter *it, *bit;
+	RzAnalysisFunction *fcn;
+	RzAnalysisBlock *bb;
+	rz_list_foreach (core->analysis->fcns, it, fcn) {
+		rz_list_foreach (fcn->bbs, bit, bb) {
+			rz_vector_push(&addrs, &bb->addr);
+		}
+	}
+	if (rz_vector_empty(&addrs)) {
+		RZ_LOG_ERROR("No basic blocks to trace, analyze some functions first\n");
+		rz_vector_fini(&addrs);
+		return RZ_CMD_STATUS_ERROR;
+	}
+	bool ok = rz_bp_coverage_start(core->dbg->bp, &addrs);
+	rz_vector_fini(&addrs);
+	return ok ? RZ_CMD_STATUS_OK : RZ_CMD_STATUS_ERROR;
+}
+
+// dbv-
+RZ_IPI RzCmdStatus rz_cmd_debug_bp_coverage_stop_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state) {
+	RzBreakpointCoverage *cov = core->dbg->bp->coverage;
+	if (!cov) {
+		RZ_LOG_ERROR("No coverage is running, start one with dbv+\n");
+		return RZ_CMD_STATUS_ERROR;
+	}
+	ut32 traced = cov->addrs.len;
+	RzVector *hits = rz_bp_coverage_stop(core->dbg->bp);
+	if (!hits) {
+		return RZ_CMD_STATUS_ERROR;
+	}
+	rz_cmd_state_output_array_start(state);
+	ut64 *addr;
+	rz_vector_foreach(hits, addr) {
+		switch (state->mode) {
+		case RZ_OUTPUT_MODE_STANDARD:
+		case RZ_OUTPUT_MODE_QUIET:
+			rz_cons_printf("0x%08" PFMT64x "\n", *addr);
+			break;
+		case RZ_OUTPUT_MODE_JSON:
+			pj_n(state->d.pj, *addr);
+			break;
+		default:
+			rz_warn_if_reached();
+			break;
+		}
+	}
+	rz_cmd_state_output_array_end(state);
+	if (state->mode == RZ_OUTPUT_MODE_STANDARD) {
+		rz_cons_printf("%u/%u blocks hit\n", (ut32)hits->len, traced);
+	}
+	rz_vector_free(hits);
+	return RZ_CMD_STATUS_OK;
+}
+
 // dbw
 RZ_IPI RzCmdStatus rz_cmd_debug_add_watchpoint_handler(RzCore *core, int argc, const char **argv) {
 	bool hwbp = rz_config_get_b(core->config, "dbg.hwbp");
@@ -31,11 +31,20 @@ RZ_IPI RzCmdStatus rz_flirt_scan_handler(RzCore *core, int argc, const char **ar
 	RzList *files = rz_file_globsearch(argv[1], depth);
 	ut8 arch_id = rz_core_flirt_arch_from_name(arch);
 
-	old = rz_flag_count(core->flags, "flirt");
+	RzFlirtNode *root = RZ_NEW0(RzFlirtNode);
 	rz_list_foreach (files, iter, file) {
-		rz_sign_flirt_apply(core->analysis, file, arch_id);
+		RzFlirtNode *node = root ? rz_sign_flirt_parse_file(file, arch_id) : NULL;
+		if (node && !rz_sign_flirt_node_merge(root, node)) {
+			rz_sign_flirt_node_free(node);
+		}
 	}
 	rz_list_free(files);
+
+	old = rz_flag_count(core->flags, "flirt");
+	if (root && root->child_list) {
+		rz_sign_flirt_apply_node(core->analysis, root, rz_config_get_i(core->config, "flirt.threads"));
+	}
+	rz_sign_flirt_node_free(root);
 	new = rz_flag_count(core->flags, "flirt");
 
 	rz_cons_printf("Found %d FLIRT signatures via %s\n", new - old, argv[1]);
@@ -2390,12 +2390,10 @@ static char *__op_refs(RzCore *core, RzAnalysisOp *op, int n) {
 	return res;
 }
 
-static inline char *__refs(RzCore *core, ut64 x) {
-	if (!core->print->hasrefs) {
-		return NULL;
-	}
-
-	char *refs = core->print->hasrefs(core->print->user, x, true);
+static inline char *__refs(RzCore *core, ut64 x, RZ_NULLABLE const RzIOReadReq *mem) {
+	char *refs = mem
+		? rz_core_analysis_hasrefs_to_depth_mem(core, x, mem->buf, mem->ok, NULL, 1)
+		: rz_core_analysis_hasrefs_to_depth(core, x, NULL, 1);
 	if (RZ_STR_ISNOTEMPTY(refs)) {
 		rz_str_trim(refs);
 	} else {
@@ -2404,6 +2402,38 @@ static inline char *__refs(RzCore *core, ut64 x) {
 	return refs;
 }
 
+/**
+ * Reads the memory pointed by each word of \p buf, where pxr starts to telescope
+ * from, in a single batch instead of one read per word.
+ */
+static RzIOReadReq *pxr_read_refs(RzCore *core, const ut8 *buf, int end, int wordsize, bool be) {
+	if (end <= wordsize) {
+		return NULL;
+	}
+	const size_t count = end / wordsize;
+	RzIOReadReq *reqs = RZ_NEWS(RzIOReadReq, count);
+	ut8 *mem = malloc(count * RZ_CORE_HASREFS_MEM_SIZE);
+	if (!reqs || !mem) {
+		free(reqs);
+		free(mem);
+		return NULL;
+	}
+	size_t n = 0;
+	for (ut64 i = 0; i + wordsize < end; i += wordsize, n++) {
+		ut64 val = rz_read_ble(buf + i, be, wordsize * 8);
+		reqs[n] = (RzIOReadReq){ val, mem + n * RZ_CORE_HASREFS_MEM_SIZE, RZ_CORE_HASREFS_MEM_SIZE, false };
+	}
+	rz_io_read_at_batch(core->io, reqs, n);
+	return reqs;
+}
+
+static void pxr_refs_free(RZ_NULLABLE RzIOReadReq *reqs) {
+	if (reqs) {
+		free(reqs[0].buf);
+		free(reqs);
+	}
+}
+
 static bool cmd_pxr(RzCore *core, ut64 at, int len, RzCmdStateOutput *state, int wordsize, const char *query) {
 	if (!len) {
 		return true;
@@ -2426,42 +2456,52 @@ static bool cmd_pxr(RzCore *core, ut64 at, int len, RzCmdStateOutput *state, int
 		rz_table_add_column(t, n, "addr", 0);
 		rz_table_add_column(t, n, "value", 0);
 		rz_table_add_column(t, s, "refs", 0);
+		RzIOReadReq *mem = pxr_read_refs(core, buf, end, wordsize, be);
 		for (ut64 i = 0; i + wordsize < end; i += wordsize) {
 			ut64 addr = at + i;
 			ut64 val = rz_read_ble(buf + i, be, bitsize);
-			char *refs = __refs(core, val);
+			char *refs = __refs(core, val, mem ? &mem[i / wordsize] : NULL);
 			rz_table_add_rowf(t, "xxs", addr, val, refs);
 			RZ_FREE(refs);
 		}
+		pxr_refs_free(mem);
 		rz_table_query(t, query);
 	} else if (mode == RZ_OUTPUT_MODE_JSON) {
 		PJ *pj = state->d.pj;
 		const int hex_depth = (int)rz_config_get_i(core->config, "hex.depth");
+		RzIOReadReq *mem = pxr_read_refs(core, buf, end, wordsize, be);
 		pj_a(pj);
 		for (ut64 i = 0; i + wordsize < end; i += wordsize) {
 			ut64 addr = at + i;
 			ut64 val = rz_read_ble(buf + i, be, bitsize);
+			RzIOReadReq *val_mem = mem ? &mem[i / wordsize] : NULL;
 			pj_o(pj);
 			pj_kn(pj, "addr", addr);
 			pj_kn(pj, "value", val);
-			char *refs = __refs(core, val);
+			char *refs = __refs(core, val, val_mem);
 			if (refs) {
 				char *refstr = rz_str_escape(refs);
 				pj_ks(pj, "refstr", rz_str_trim_head_ro(refstr));
 				free(refstr);
 
 				pj_k(pj, "ref");
-				free(rz_core_analysis_hasrefs_to_depth(core, val, pj, hex_depth));
+				char *ref = val_mem
+					? rz_core_analysis_hasrefs_to_depth_mem(core, val, val_mem->buf, val_mem->ok, pj, hex_depth)
+					: rz_core_analysis_hasrefs_to_depth(core, val, pj, hex_depth);
+				free(ref);
 			}
 			pj_end(pj);
 		}
 		pj_end(pj);
+		pxr_refs_free(mem);
 	} else if (mode == RZ_OUTPUT_MODE_QUIET) {
+		RzIOReadReq *mem = pxr_read_refs(core, buf, end, wordsize, be);
 		for (ut64 i = 0; i + wordsize < end; i += wordsize) {
 			ut64 val = rz_read_ble(buf + i, be, bitsize);
-			char *refs = __refs(core, val);
+			char *refs = __refs(core, val, mem ? &mem[i / wordsize] : NULL);
 			rz_strbuf_appendf(sb, "%s\n", refs);
 		}
+		pxr_refs_free(mem);
 	} else if (mode == RZ_OUTPUT_MODE_RIZIN) {
 		for (ut64 i = 0; i + wordsize < end; i += wordsize) {
 			ut64 addr = at + i;
@@ -6212,19 +6252,19 @@ static RzCmdStatus print_histogram_entropy(RzCore *core, int argc, const char **
 		return RZ_CMD_STATUS_ERROR;
 	}
 	ut8 *data = calloc(1, brange->nblocks);
-	ut8 *tmp = malloc(brange->blocksize);
-	if (!tmp) {
+	if (!data) {
 		RZ_LOG_ERROR("core: failed to malloc memory");
-		free(data);
 		free(brange);
 		return RZ_CMD_STATUS_ERROR;
 	}
-	for (size_t i = 0; i < brange->nblocks; i++) {
-		ut64 off = brange->from + (brange->blocksize * (i + brange->skipblocks));
-		rz_io_read_at(core->io, off, tmp, brange->blocksize);
-		data[i] = (ut8)(255 * rz_hash_entropy_fraction(tmp, brange->blocksize));
+	ut64 from = brange->from + brange->blocksize * brange->skipblocks;
+	double *entropy = rz_core_block_entropy(core, from, brange->blocksize, brange->nblocks);
+	if (entropy) {
+		for (size_t i = 0; i < brange->nblocks; i++) {
+			data[i] = (ut8)(255 * entropy[i]);
+		}
+		free(entropy);
 	}
-	free(tmp);
 	if (isinteractive) {
 		if (!print_visual_bytes(core, data, brange)) {
 			RZ_LOG_ERROR("Cannot generate interactive histogram\n");
@@ -6245,7 +6285,7 @@ static RzCmdStatus print_histogram_entropy(RzCore *core, int argc, const char **
 	return RZ_CMD_STATUS_OK;
 }
 
-static bool print_rising_and_falling_entropy_table(RzCore *core, RzCmdStateOutput *state, CoreBlockRange *brange, ut8 *tmp, double fallingthreshold, double risingthreshold) {
+static bool print_rising_and_falling_entropy_table(RzCore *core, RzCmdStateOutput *state, CoreBlockRange *brange, const double *entropy, double fallingthreshold, double risingthreshold) {
 	bool resetFlag = 1;
 	st8 lastEdge = 0;
 	RzTable *t = state->d.t;
@@ -6257,9 +6297,7 @@ static bool print_rising_and_falling_entropy_table(RzCore *core, RzCmdStateOutpu
 	rz_table_add_column(t, n, "entropy_value", 0);
 	for (int i = 0; i < brange->nblocks; i++) {
 		ut64 off = brange->from + (brange->blocksize * (i));
-		if (!rz_io_read_at(core->io, off, tmp, brange->blocksize))
-			return false;
-		double data = rz_hash_entropy_fraction(tmp, brange->blocksize);
+		double data = entropy[i];
 		// reseting flag if goes above falling threshold and below rising threshold
 		if (resetFlag == 0 && lastEdge == 0 && data > fallingthreshold) {
 			resetFlag = 1;
@@ -6284,16 +6322,14 @@ static bool print_rising_and_falling_entropy_table(RzCore *core, RzCmdStateOutpu
 	return true;
 }
 
-static bool print_rising_and_falling_entropy_JSON(RzCore *core, RzCmdStateOutput *state, CoreBlockRange *brange, ut8 *tmp, double fallingthreshold, double risingthreshold) {
+static bool print_rising_and_falling_entropy_JSON(RzCore *core, RzCmdStateOutput *state, CoreBlockRange *brange, const double *entropy, double fallingthreshold, double risingthreshold) {
 	bool resetFlag = 1;
 	st8 lastEdge = 0;
 	PJ *pj = state->d.pj;
 	pj_a(pj);
 	for (int i = 0; i < brange->nblocks; i++) {
 		ut64 off = brange->from + (brange->blocksize * (i));
-		if (!rz_io_read_at(core->io, off, tmp, brange->blocksize))
-			return false;
-		double data = rz_hash_entropy_fraction(tmp, brange->blocksize);
+		double data = entropy[i];
 		// reseting flag if goes above falling threshold and below rising threshold
 		if (resetFlag == 0 && lastEdge == 0 && data > fallingthreshold) {
 			resetFlag = 1;
@@ -6329,7 +6365,7 @@ static bool print_rising_and_falling_entropy_JSON(RzCore *core, RzCmdStateOutput
 	return true;
 }
 
-static bool print_rising_and_falling_entropy_quiet(RzCore *core, CoreBlockRange *brange, ut8 *tmp, double fallingthreshold, double risingthreshold) {
+static bool print_rising_and_falling_entropy_quiet(RzCore *core, CoreBlockRange *brange, const double *entropy, double fallingthreshold, double risingthreshold) {
 	RzStrBuf *buf = rz_strbuf_new("");
 	if (!buf) {
 		RZ_LOG_ERROR("core: failed to malloc memory");
@@ -6339,11 +6375,7 @@ static bool print_rising_and_falling_entropy_quiet(RzCore *core, CoreBlockRange
 	st8 lastEdge = 0;
 	for (int i = 0; i < brange->nblocks; i++) {
 		ut64 off = brange->from + (brange->blocksize * (i));
-		if (!rz_io_read_at(core->io, off, tmp, brange->blocksize)) {
-			rz_strbuf_free(buf);
-			return false;
-		}
-		double data = rz_hash_entropy_fraction(tmp, brange->blocksize);
+		double data = entropy[i];
 		// reseting flag if goes above falling threshold and below rising threshold
 		if (resetFlag == 0 && lastEdge == 0 && data > fallingthreshold) {
 			resetFlag = 1;
@@ -6371,7 +6403,7 @@ static bool print_rising_and_falling_entropy_quiet(RzCore *core, CoreBlockRange
 	return true;
 }
 
-static bool print_rising_and_falling_entropy_standard(RzCore *core, CoreBlockRange *brange, ut8 *tmp, double fallingthreshold, double risingthreshold) {
+static bool print_rising_and_falling_entropy_standard(RzCore *core, CoreBlockRange *brange, const double *entropy, double fallingthreshold, double risingthreshold) {
 	RzStrBuf *buf = rz_strbuf_new("");
 	if (!buf) {
 		RZ_LOG_ERROR("core: failed to malloc memory");
@@ -6381,11 +6413,7 @@ static bool print_rising_and_falling_entropy_standard(RzCore *core, CoreBlockRan
 	st8 lastEdge = 0;
 	for (int i = 0; i < brange->nblocks; i++) {
 		ut64 off = brange->from + (brange->blocksize * (i));
-		if (!rz_io_read_at(core->io, off, tmp, brange->blocksize)) {
-			rz_strbuf_free(buf);
-			return false;
-		}
-		double data = rz_hash_entropy_fraction(tmp, brange->blocksize);
+		double data = entropy[i];
 		// reseting flag if goes above falling threshold and below rising threshold
 		if (resetFlag == 0 && lastEdge == 0 && data > fallingthreshold) {
 			resetFlag = 1;
@@ -6413,7 +6441,7 @@ static bool print_rising_and_falling_entropy_standard(RzCore *core, CoreBlockRan
 	return true;
 }
 
-static bool print_rising_and_falling_entropy_long(RzCore *core, CoreBlockRange *brange, ut8 *tmp, double fallingthreshold, double risingthreshold) {
+static bool print_rising_and_falling_entropy_long(RzCore *core, CoreBlockRange *brange, const double *entropy, double fallingthreshold, double risingthreshold) {
 	RzStrBuf *buf = rz_strbuf_new("");
 	if (!buf) {
 		RZ_LOG_ERROR("core: failed to malloc memory");
@@ -6423,11 +6451,7 @@ static bool print_rising_and_falling_entropy_long(RzCore *core, CoreBlockRange *
 	st8 lastEdge = 0;
 	for (int i = 0; i < brange->nblocks; i++) {
 		ut64 off = brange->from + (brange->blocksize * (i));
-		if (!rz_io_read_at(core->io, off, tmp, brange->blocksize)) {
-			rz_strbuf_free(buf);
-			return false;
-		}
-		double data = rz_hash_entropy_fraction(tmp, brange->blocksize);
+		double data = entropy[i];
 		// reseting flag if goes above falling threshold and below rising threshold
 		if (resetFlag == 0 && lastEdge == 0 && data > fallingthreshold) {
 			resetFlag = 1;
@@ -6480,55 +6504,55 @@ static RzCmdStatus print_rising_and_falling_entropy(RzCore *core, int argc, cons
 		RZ_LOG_ERROR("Cannot calculate blocks range\n");
 		return RZ_CMD_STATUS_ERROR;
 	}
-	ut8 *tmp = malloc(brange->blocksize);
-	if (!tmp) {
-		RZ_LOG_ERROR("core: failed to malloc memory");
+	double *entropy = rz_core_block_entropy(core, brange->from, brange->blocksize, brange->nblocks);
+	if (!entropy && brange->nblocks) {
+		RZ_LOG_ERROR("core: failed to calculate the entropy of the blocks\n");
 		free(brange);
 		return RZ_CMD_STATUS_ERROR;
 	}
 	switch (state->mode) {
 	case RZ_OUTPUT_MODE_TABLE:
-		if (!print_rising_and_falling_entropy_table(core, state, brange, tmp, fallingthreshold, risingthreshold)) {
-			free(tmp);
+		if (!print_rising_and_falling_entropy_table(core, state, brange, entropy, fallingthreshold, risingthreshold)) {
+			free(entropy);
 			free(brange);
 			return RZ_CMD_STATUS_ERROR;
 		}
 		break;
 	case RZ_OUTPUT_MODE_JSON:
-		if (!print_rising_and_falling_entropy_JSON(core, state, brange, tmp, fallingthreshold, risingthreshold)) {
-			free(tmp);
+		if (!print_rising_and_falling_entropy_JSON(core, state, brange, entropy, fallingthreshold, risingthreshold)) {
+			free(entropy);
 			free(brange);
 			return RZ_CMD_STATUS_ERROR;
 		}
 		break;
 	case RZ_OUTPUT_MODE_QUIET:
-		if (!print_rising_and_falling_entropy_quiet(core, brange, tmp, fallingthreshold, risingthreshold)) {
-			free(tmp);
+		if (!print_rising_and_falling_entropy_quiet(core, brange, entropy, fallingthreshold, risingthreshold)) {
+			free(entropy);
 			free(brange);
 			return RZ_CMD_STATUS_ERROR;
 		}
 		break;
 	case RZ_OUTPUT_MODE_STANDARD:
-		if (!print_rising_and_falling_entropy_standard(core, brange, tmp, fallingthreshold, risingthreshold)) {
-			free(tmp);
+		if (!print_rising_and_falling_entropy_standard(core, brange, entropy, fallingthreshold, risingthreshold)) {
+			free(entropy);
 			free(brange);
 			return RZ_CMD_STATUS_ERROR;
 		}
 		break;
 	case RZ_OUTPUT_MODE_LONG:
-		if (!print_rising_and_falling_entropy_long(core, brange, tmp, fallingthreshold, risingthreshold)) {
-			free(tmp);
+		if (!print_rising_and_falling_entropy_long(core, brange, entropy, fallingthreshold, risingthreshold)) {
+			free(entropy);
 			free(brange);
 			return RZ_CMD_STATUS_ERROR;
 		}
 		break;
 	default:
 		rz_warn_if_reached();
-		free(tmp);
+		free(entropy);
 		free(brange);
 		return RZ_CMD_STATUS_ERROR;
 	}
-	free(tmp);
+	free(entropy);
 	free(brange);
 	return RZ_CMD_STATUS_OK;
 }
@@ -16,7 +16,8 @@ RZ_IPI RzCmdStatus rz_project_save_handler(RzCore *core, int argc, const char **
 		file = argv[1];
 	}
 	bool compress = rz_config_get_b(core->config, "prj.compress");
-	RzProjectErr err = rz_project_save_file(core, file, compress);
+	bool binary = rz_config_get_b(core->config, "prj.binary");
+	RzProjectErr err = binary ? rz_project_save_file_binary(core, file, compress) : rz_project_save_file(core, file, compress);
 	if (err != RZ_PROJECT_ERR_SUCCESS) {
 		RZ_LOG_ERROR("core: Failed to save project to file %s: %s\n", file, rz_project_err_message(err));
 	}
@@ -16,6 +16,8 @@
 
 #define AES_SEARCH_LENGTH         40
 #define PRIVATE_KEY_SEARCH_LENGTH 11
+// Size of the blocks read when they are searched on many threads
+#define PARALLEL_SEARCH_BLOCK_SIZE 0x1000000
 
 static const char *help_msg_search_esil[] = {
 	"/E", " [esil-expr]", "search offsets matching a specific esil expression",
@@ -2324,6 +2326,9 @@ static void do_string_search(RzCore *core, RzInterval search_itv, struct search_
 	ut64 at;
 	ut8 *buf;
 	RzSearch *search = core->search;
+	const int threads = rz_config_get_i(core->config, "search.threads");
+	const bool parallel = threads != 1 && !search->bckwrds;
+	const ut64 bsize = parallel ? RZ_MAX(core->blocksize, PARALLEL_SEARCH_BLOCK_SIZE) : core->blocksize;
 
 	if (param->outmode == RZ_MODE_JSON) {
 		pj_a(param->pj);
@@ -2345,7 +2350,7 @@ static void do_string_search(RzCore *core, RzInterval search_itv, struct search_
 		/* TODO: launch search in background support */
 		// REMOVE OLD FLAGS rz_core_cmdf (core, "f-%s*", rz_config_get (core->config, "search.prefix"));
 		rz_search_set_callback(core->search, &_cb_hit, param);
-		if (!(buf = malloc(core->blocksize))) {
+		if (!(buf = malloc(bsize))) {
 			return;
 		}
 		if (search->bckwrds) {
@@ -2388,28 +2393,32 @@ static void do_string_search(RzCore *core, RzInterval search_itv, struct search_
 					break;
 				}
 				if (search->bckwrds) {
-					len = RZ_MIN(core->blocksize, at - from);
+					len = RZ_MIN(bsize, at - from);
 					// TODO prefix_read_at
 					if (!rz_io_is_valid_offset(core->io, at - len, 0)) {
 						break;
 					}
 					(void)rz_io_read_at(core->io, at - len, buf, len);
 				} else {
-					len = RZ_MIN(core->blocksize, to - at);
+					len = RZ_MIN(bsize, to - at);
 					if (!rz_io_is_valid_offset(core->io, at, 0)) {
 						break;
 					}
 					(void)rz_io_read_at(core->io, at, buf, len);
 				}
-				rz_search_update(core->search, at, buf, len);
+				if (parallel) {
+					rz_search_update_parallel(core->search, at, buf, len, threads < 0 ? RZ_THREAD_POOL_ALL_CORES : threads);
+				} else {
+					rz_search_update(core->search, at, buf, len);
+				}
 				if (param->aes_search) {
 					// Adjust length to search between blocks.
-					if (len == core->blocksize) {
+					if (len == bsize) {
 						len -= AES_SEARCH_LENGTH - 1;
 					}
 				} else if (param->privkey_search) {
 					// Adjust length to search between blocks.
-					if (len == core->blocksize) {
+					if (len == bsize) {
 						len -= PRIVATE_KEY_SEARCH_LENGTH - 1;
 					}
 				}
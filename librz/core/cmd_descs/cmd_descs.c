@@ -49,6 +49,7 @@ static const RzCmdDescDetail cmd_cmp_unified_details[2];
 static const RzCmdDescDetail cw_details[2];
 static const RzCmdDescDetail cmd_debug_list_bp_details[2];
 static const RzCmdDescDetail cmd_debug_add_cond_bp_details[2];
+static const RzCmdDescDetail cmd_debug_bp_coverage_start_details[2];
 static const RzCmdDescDetail cmd_debug_add_watchpoint_details[3];
 static const RzCmdDescDetail cmd_debug_esil_add_details[2];
 static const RzCmdDescDetail cmd_debug_signal_option_details[2];
@@ -6159,6 +6160,22 @@ static const RzCmdDescHelp list_mne_help = {
 	.args = list_mne_args,
 };
 
+static const RzCmdDescArg analyze_op_cache_stats_args[] = {
+	{ 0 },
+};
+static const RzCmdDescHelp analyze_op_cache_stats_help = {
+	.summary = "Show the hit/miss statistics of the decoded instructions cache",
+	.args = analyze_op_cache_stats_args,
+};
+
+static const RzCmdDescArg analyze_op_cache_clear_args[] = {
+	{ 0 },
+};
+static const RzCmdDescHelp analyze_op_cache_clear_help = {
+	.summary = "Empty the decoded instructions cache and reset its statistics",
+	.args = analyze_op_cache_clear_args,
+};
+
 static const RzCmdDescArg analyse_name_args[] = {
 	{
 		.name = "name",
@@ -7803,6 +7820,44 @@ static const RzCmdDescHelp cmd_debug_bp_set_expr_cur_offset_help = {
 	.args = cmd_debug_bp_set_expr_cur_offset_args,
 };
 
+static const RzCmdDescHelp dbv_help = {
+	.summary = "Basic block coverage with one-shot breakpoints",
+};
+static const RzCmdDescArg cmd_debug_bp_coverage_list_args[] = {
+	{ 0 },
+};
+static const RzCmdDescHelp cmd_debug_bp_coverage_list_help = {
+	.summary = "List the traced basic blocks and whether they were hit",
+	.args = cmd_debug_bp_coverage_list_args,
+};
+
+static const RzCmdDescDetailEntry cmd_debug_bp_coverage_start_Notes_detail_entries[] = {
+	{ .text = "Coverage breakpoints", .arg_str = NULL, .comment = "are written once and stay in memory until hit, also while stopped" },
+	{ .text = "Memory reads", .arg_str = NULL, .comment = "show the original bytes in place of the coverage breakpoints not hit yet" },
+	{ .text = "A hit", .arg_str = NULL, .comment = "removes its breakpoint for good and continues without stopping" },
+	{ 0 },
+};
+static const RzCmdDescDetail cmd_debug_bp_coverage_start_details[] = {
+	{ .name = "Notes", .entries = cmd_debug_bp_coverage_start_Notes_detail_entries },
+	{ 0 },
+};
+static const RzCmdDescArg cmd_debug_bp_coverage_start_args[] = {
+	{ 0 },
+};
+static const RzCmdDescHelp cmd_debug_bp_coverage_start_help = {
+	.summary = "Start tracing the basic blocks of all the analyzed functions",
+	.details = cmd_debug_bp_coverage_start_details,
+	.args = cmd_debug_bp_coverage_start_args,
+};
+
+static const RzCmdDescArg cmd_debug_bp_coverage_stop_args[] = {
+	{ 0 },
+};
+static const RzCmdDescHelp cmd_debug_bp_coverage_stop_help = {
+	.summary = "Stop tracing, restore the original bytes of the blocks not hit and list the hit ones",
+	.args = cmd_debug_bp_coverage_stop_args,
+};
+
 static const RzCmdDescDetailEntry cmd_debug_add_watchpoint_Valid_space_permission_space_arguments_detail_entries[] = {
 	{ .text = "r", .arg_str = NULL, .comment = "read only" },
 	{ .text = "w", .arg_str = NULL, .comment = "write only" },
@@ -19802,6 +19857,12 @@ RZ_IPI void rzshell_cmddescs_init(RzCore *core) {
 	RzCmdDesc *list_mne_cd = rz_cmd_desc_argv_new(core->rcmd, ao_cd, "aoma", rz_list_mne_handler, &list_mne_help);
 	rz_warn_if_fail(list_mne_cd);
 
+	RzCmdDesc *analyze_op_cache_stats_cd = rz_cmd_desc_argv_state_new(core->rcmd, ao_cd, "aoC", RZ_OUTPUT_MODE_STANDARD | RZ_OUTPUT_MODE_JSON, rz_analyze_op_cache_stats_handler, &analyze_op_cache_stats_help);
+	rz_warn_if_fail(analyze_op_cache_stats_cd);
+
+	RzCmdDesc *analyze_op_cache_clear_cd = rz_cmd_desc_argv_new(core->rcmd, ao_cd, "aoC-", rz_analyze_op_cache_clear_handler, &analyze_op_cache_clear_help);
+	rz_warn_if_fail(analyze_op_cache_clear_cd);
+
 	RzCmdDesc *analyse_name_cd = rz_cmd_desc_argv_state_new(core->rcmd, cmd_analysis_cd, "an", RZ_OUTPUT_MODE_STANDARD | RZ_OUTPUT_MODE_JSON, rz_analyse_name_handler, &analyse_name_help);
 	rz_warn_if_fail(analyse_name_cd);
 
@@ -20186,6 +20247,14 @@ RZ_IPI void rzshell_cmddescs_init(RzCore *core) {
 	RzCmdDesc *cmd_debug_bp_set_expr_cur_offset_cd = rz_cmd_desc_argv_new(core->rcmd, db_cd, "dbx", rz_cmd_debug_bp_set_expr_cur_offset_handler, &cmd_debug_bp_set_expr_cur_offset_help);
 	rz_warn_if_fail(cmd_debug_bp_set_expr_cur_offset_cd);
 
+	RzCmdDesc *dbv_cd = rz_cmd_desc_group_state_new(core->rcmd, db_cd, "dbv", RZ_OUTPUT_MODE_STANDARD | RZ_OUTPUT_MODE_JSON | RZ_OUTPUT_MODE_QUIET, rz_cmd_debug_bp_coverage_list_handler, &cmd_debug_bp_coverage_list_help, &dbv_help);
+	rz_warn_if_fail(dbv_cd);
+	RzCmdDesc *cmd_debug_bp_coverage_start_cd = rz_cmd_desc_argv_new(core->rcmd, dbv_cd, "dbv+", rz_cmd_debug_bp_coverage_start_handler, &cmd_debug_bp_coverage_start_help);
+	rz_warn_if_fail(cmd_debug_bp_coverage_start_cd);
+
+	RzCmdDesc *cmd_debug_bp_coverage_stop_cd = rz_cmd_desc_argv_state_new(core->rcmd, dbv_cd, "dbv-", RZ_OUTPUT_MODE_STANDARD | RZ_OUTPUT_MODE_JSON | RZ_OUTPUT_MODE_QUIET, rz_cmd_debug_bp_coverage_stop_handler, &cmd_debug_bp_coverage_stop_help);
+	rz_warn_if_fail(cmd_debug_bp_coverage_stop_cd);
+
 	RzCmdDesc *cmd_debug_add_watchpoint_cd = rz_cmd_desc_argv_new(core->rcmd, db_cd, "dbw", rz_cmd_debug_add_watchpoint_handler, &cmd_debug_add_watchpoint_help);
 	rz_warn_if_fail(cmd_debug_add_watchpoint_cd);
 
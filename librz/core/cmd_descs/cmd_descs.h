@@ -741,6 +741,10 @@ RZ_IPI RzCmdStatus rz_analyze_cycles_handler(RzCore *core, int argc, const char
 RZ_IPI RzCmdStatus rz_convert_mne_handler(RzCore *core, int argc, const char **argv);
 // "aoma"
 RZ_IPI RzCmdStatus rz_list_mne_handler(RzCore *core, int argc, const char **argv);
+// "aoC"
+RZ_IPI RzCmdStatus rz_analyze_op_cache_stats_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state);
+// "aoC-"
+RZ_IPI RzCmdStatus rz_analyze_op_cache_clear_handler(RzCore *core, int argc, const char **argv);
 // "an"
 RZ_IPI RzCmdStatus rz_analyse_name_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state);
 // "abi"
@@ -1007,6 +1011,12 @@ RZ_IPI RzCmdStatus rz_cmd_debug_bt_disable_bp_trace_handler(RzCore *core, int ar
 RZ_IPI RzCmdStatus rz_cmd_debug_bt_toggle_bp_trace_handler(RzCore *core, int argc, const char **argv);
 // "dbx"
 RZ_IPI RzCmdStatus rz_cmd_debug_bp_set_expr_cur_offset_handler(RzCore *core, int argc, const char **argv);
+// "dbv"
+RZ_IPI RzCmdStatus rz_cmd_debug_bp_coverage_list_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state);
+// "dbv+"
+RZ_IPI RzCmdStatus rz_cmd_debug_bp_coverage_start_handler(RzCore *core, int argc, const char **argv);
+// "dbv-"
+RZ_IPI RzCmdStatus rz_cmd_debug_bp_coverage_stop_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state);
 // "dbw"
 RZ_IPI RzCmdStatus rz_cmd_debug_add_watchpoint_handler(RzCore *core, int argc, const char **argv);
 // "dbW"
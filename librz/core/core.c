@@ -1811,6 +1811,22 @@ static char *getvalue(ut64 value, int bits) {
  * no json support
 */
 RZ_API char *rz_core_analysis_hasrefs_to_depth(RzCore *core, ut64 value, PJ *pj, int depth) {
+	rz_return_val_if_fail(core, NULL);
+	ut8 mem[RZ_CORE_HASREFS_MEM_SIZE];
+	bool mem_ok = false;
+	if (depth >= 1 && value != UT64_MAX) {
+		mem_ok = rz_io_read_at(core->io, value, mem, sizeof(mem));
+	}
+	return rz_core_analysis_hasrefs_to_depth_mem(core, value, mem, mem_ok, pj, depth);
+}
+
+/**
+ * \brief Same as rz_core_analysis_hasrefs_to_depth(), with the memory at \p value already read
+ *
+ * \param mem The RZ_CORE_HASREFS_MEM_SIZE bytes at \p value
+ * \param mem_ok Whether reading \p mem succeeded
+ */
+RZ_IPI char *rz_core_analysis_hasrefs_to_depth_mem(RzCore *core, ut64 value, const ut8 *mem, bool mem_ok, PJ *pj, int depth) {
 	const int bits = core->rasm->bits;
 	const bool big_endian = rz_config_get_b(core->config, "cfg.bigendian");
 	rz_return_val_if_fail(core, NULL);
@@ -1956,12 +1972,10 @@ RZ_API char *rz_core_analysis_hasrefs_to_depth(RzCore *core, ut64 value, PJ *pj,
 			}
 			if (type & RZ_ANALYSIS_ADDR_TYPE_EXEC) {
 				RzAsmOp op;
-				ut8 buf[32];
 				rz_strbuf_appendf(s, "%sX%s ", c, cend);
 				/* instruction disassembly */
-				rz_io_read_at(core->io, value, buf, sizeof(buf));
 				rz_asm_set_pc(core->rasm, value);
-				rz_asm_disassemble(core->rasm, &op, buf, sizeof(buf));
+				rz_asm_disassemble(core->rasm, &op, mem, 32);
 				rz_strbuf_appendf(s, "'%s' ", rz_asm_op_get_asm(&op));
 				/* get library name */
 				{ // NOTE: dup for mapname?
@@ -1977,9 +1991,8 @@ RZ_API char *rz_core_analysis_hasrefs_to_depth(RzCore *core, ut64 value, PJ *pj,
 					}
 				}
 			} else if (type & RZ_ANALYSIS_ADDR_TYPE_READ) {
-				ut8 buf[8];
-				if (rz_io_read_at(core->io, value, buf, sizeof(buf))) {
-					ut64 n = rz_read_ble(buf, big_endian, bits);
+				if (mem_ok) {
+					ut64 n = rz_read_ble(mem, big_endian, bits);
 					rz_strbuf_appendf(s, "0x%" PFMT64x " ", n);
 				}
 			}
@@ -1989,13 +2002,11 @@ RZ_API char *rz_core_analysis_hasrefs_to_depth(RzCore *core, ut64 value, PJ *pj,
 		}
 	}
 	{
-		ut8 buf[128];
 		RzStrEnc encoding = rz_str_enc_string_as_type(core->bin->strenc);
 		const char *c = rz_config_get_i(core->config, "scr.color") ? core->cons->context->pal.ai_ascii : "";
 		const char *cend = (c && *c) ? Color_RESET : "";
 		RzDetectedString *dstr = NULL;
-		if (rz_io_read_at(core->io, value, buf, sizeof(buf)) &&
-			get_string(buf, sizeof(buf), &dstr, encoding, big_endian)) {
+		if (mem_ok && get_string(mem, RZ_CORE_HASREFS_MEM_SIZE, &dstr, encoding, big_endian)) {
 			if (pj) {
 				pj_ks(pj, "string", dstr->string);
 			} else {
@@ -2006,9 +2017,8 @@ RZ_API char *rz_core_analysis_hasrefs_to_depth(RzCore *core, ut64 value, PJ *pj,
 	}
 	if ((type & RZ_ANALYSIS_ADDR_TYPE_READ) && !(type & RZ_ANALYSIS_ADDR_TYPE_EXEC) && depth) {
 		// Try to telescope further, but only several levels deep.
-		ut8 buf[8];
-		if (rz_io_read_at(core->io, value, buf, sizeof(buf))) {
-			ut64 n = rz_read_ble(buf, big_endian, bits);
+		if (mem_ok) {
+			ut64 n = rz_read_ble(mem, big_endian, bits);
 			if (n != value) {
 				if (pj) {
 					pj_k(pj, "ref");
@@ -2181,6 +2191,13 @@ static const char *colorfor_cb(void *user, ut64 addr, bool verbose) {
 	return rz_core_analysis_optype_colorfor((RzCore *)user, addr, verbose);
 }
 
+static void io_read_filter_cb(void *user, ut64 addr, ut8 *buf, size_t len) {
+	RzCore *core = user;
+	if (core->dbg && core->dbg->bp) {
+		rz_bp_coverage_hide(core->dbg->bp, addr, buf, len);
+	}
+}
+
 static char *hasrefs_cb(void *user, ut64 addr, int mode) {
 	return rz_core_analysis_hasrefs((RzCore *)user, addr, mode);
 }
@@ -2282,9 +2299,33 @@ static int bp_bits_at(ut64 addr, void *user) {
 	return r ? r : core->analysis->bits;
 }
 
+static void iowrite_invalidate_caches(RzCore *core, ut64 addr, ut64 len) {
+	rz_analysis_op_cache_invalidate(core->analysis, addr, len);
+	rz_core_block_hash_invalidate(core, addr, len);
+}
+
 static void ev_iowrite_cb(RzEvent *ev, int type, void *user, void *data) {
 	RzCore *core = user;
 	RzEventIOWrite *iow = data;
+	if (iow->fd < 0 || !core->io->va) {
+		iowrite_invalidate_caches(core, iow->addr, iow->len);
+	} else {
+		// the caches are keyed by virtual address, invalidate every map of the written range
+		ut64 end = iow->addr + iow->len < iow->addr ? UT64_MAX : iow->addr + iow->len;
+		void **it;
+		rz_pvector_foreach (&core->io->maps, it) {
+			RzIOMap *map = *it;
+			if (map->fd != iow->fd || !map->itv.size) {
+				continue;
+			}
+			ut64 map_end = map->delta + map->itv.size < map->delta ? UT64_MAX : map->delta + map->itv.size;
+			ut64 from = RZ_MAX(iow->addr, map->delta);
+			ut64 to = RZ_MIN(end, map_end);
+			if (from < to) {
+				iowrite_invalidate_caches(core, map->itv.addr + (from - map->delta), to - from);
+			}
+		}
+	}
 	if (rz_config_get_i(core->config, "analysis.detectwrites")) {
 		rz_analysis_update_analysis_range(core->analysis, iow->addr, iow->len);
 		if (core->cons->event_resize && core->cons->event_data) {
@@ -2306,6 +2347,7 @@ static void ev_iodescclose_cb(RzEvent *ev, int type, void *user, void *data) {
 
 static void ev_iomapdel_cb(RzEvent *ev, int type, void *user, void *data) {
 	RzEventIOMapDel *iod = data;
+	rz_core_block_hash_map_deleted(user, iod->map);
 	rz_core_file_io_map_deleted(user, iod->map);
 }
 
@@ -2459,6 +2501,7 @@ RZ_API bool rz_core_init(RzCore *core) {
 		core->asmqjmps = RZ_NEWS(ut64, core->asmqjmps_size);
 	}
 	core->hash = rz_hash_new();
+	core->block_hashes = rz_core_block_hash_cache_new();
 
 	rz_bin_bind(core->bin, &(core->rasm->binb));
 	rz_bin_bind(core->bin, &(core->analysis->binb));
@@ -2498,6 +2541,8 @@ RZ_API bool rz_core_init(RzCore *core) {
 	rz_io_bind(core->io, &(core->dbg->bp->iob));
 	rz_core_bind(core, &core->dbg->corebind);
 	rz_core_bind(core, &core->io->corebind);
+	core->io->read_filter = io_read_filter_cb;
+	core->io->read_filter_user = core;
 	core->dbg->analysis = core->analysis; // XXX: dupped instance.. can cause lost pointerz
 	// rz_debug_use (core->dbg, "native");
 	//  XXX pushing uninitialized regstate results in trashed reg values
@@ -2574,6 +2619,9 @@ RZ_API void rz_core_fini(RzCore *c) {
 	rz_core_wait(c);
 	//  avoid double free
 	RZ_FREE_CUSTOM(c->hash, rz_hash_free);
+	RZ_FREE_CUSTOM(c->block_hashes, rz_core_block_hash_cache_free);
+	RZ_FREE_CUSTOM(c->sigdb_node, rz_sign_flirt_node_free);
+	RZ_FREE(c->sigdb_node_key);
 	RZ_FREE_CUSTOM(c->ropchain, rz_list_free);
 	RZ_FREE_CUSTOM(c->ev, rz_event_free);
 	RZ_FREE(c->cmdlog);
@@ -16,8 +16,13 @@ RZ_IPI int fcn_cmpaddr(const void *_a, const void *_b);
 
 RZ_IPI void rz_core_add_string_ref(RzCore *core, ut64 xref_from, ut64 xref_to);
 RZ_IPI bool rz_core_get_string_at(RzCore *core, ut64 address, char **string, size_t *length, RzStrEnc *encoding, bool can_search);
+
+#define RZ_CORE_HASREFS_MEM_SIZE 128 ///< Bytes read at the telescoped value by rz_core_analysis_hasrefs_to_depth()
+RZ_IPI char *rz_core_analysis_hasrefs_to_depth_mem(RzCore *core, ut64 value, const ut8 *mem, bool mem_ok, PJ *pj, int depth);
+
 RZ_IPI int rz_core_analysis_set_reg(RzCore *core, const char *regname, ut64 val);
 RZ_IPI void rz_core_analysis_esil_init(RzCore *core);
+RZ_IPI bool rz_core_analysis_discover(RzCore *core, RzVector /*<ut64>*/ *entries, int depth, size_t threads);
 RZ_IPI void rz_core_analysis_esil_init_mem_p(RzCore *core);
 RZ_IPI void rz_core_analysis_esil_step_over_until(RzCore *core, ut64 addr);
 RZ_IPI void rz_core_analysis_esil_step_over_untilexpr(RzCore *core, const char *expr);
@@ -463,4 +468,13 @@ static inline char *rz_address_str(ut64 addr) {
 
 RZ_IPI void rz_core_prompt_highlight(RzCore *core);
 
+/* chash.c */
+RZ_IPI RZ_OWN RzCoreBlockHashCache *rz_core_block_hash_cache_new(void);
+RZ_IPI void rz_core_block_hash_cache_free(RZ_NULLABLE RzCoreBlockHashCache *cache);
+RZ_IPI void rz_core_block_hash_map_deleted(RzCore *core, RzIOMap *map);
+
+/* serialize_core.c */
+RZ_IPI bool rz_serialize_core_load_bin(RZ_NONNULL Sdb *db, RZ_NONNULL SdbBin *bin, RZ_NONNULL RzCore *core, bool load_bin_io,
+	RZ_NULLABLE const char *prj_file, RZ_NULLABLE RzSerializeResultInfo *res);
+
 #endif
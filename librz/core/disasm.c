@@ -6413,16 +6413,11 @@ RZ_API int rz_core_disasm_pde(RzCore *core, int nb_opcodes, RzCmdStateOutput *st
 		}
 	}
 	RzAnalysisEsil *esil = core->analysis->esil;
-	RzPVector ocache = core->io->cache;
 	const int ocached = core->io->cached;
-	if (ocache.v.a) {
-		RzPVector *vec = rz_pvector_clone(&ocache);
-		vec->v.free = NULL;
-		vec->v.free_user = ocache.v.free_user;
-		core->io->cache = *vec;
-		free(vec);
-	} else {
-		rz_io_cache_init(core->io);
+	if (!rz_io_cache_push(core->io)) {
+		RZ_LOG_ERROR("core: cannot save the io cache before emulating\n");
+		rz_cmd_state_output_array_end(state);
+		return -1;
 	}
 	rz_reg_arena_push(reg);
 	RzConfigHold *chold = rz_config_hold_new(core->config);
@@ -6519,23 +6514,7 @@ RZ_API int rz_core_disasm_pde(RzCore *core, int nb_opcodes, RzCmdStateOutput *st
 	rz_cmd_state_output_array_end(state);
 	free(buf);
 	rz_reg_arena_pop(reg);
-	int len = rz_pvector_len(&ocache);
-	if (rz_pvector_len(&core->io->cache) > len) {
-		// TODO: Implement push/pop for IO.cache
-		while (len > 0) {
-			(void)rz_pvector_pop_front(&core->io->cache);
-			len--;
-		}
-		core->io->cache.v.free = ocache.v.free;
-	}
-	rz_io_cache_fini(core->io);
-	core->io->cache = ocache;
-	rz_skyline_clear(&core->io->cache_skyline);
-	void **it;
-	rz_pvector_foreach (&ocache, it) {
-		RzIOCache *c = (RzIOCache *)*it;
-		rz_skyline_add(&core->io->cache_skyline, c->itv, c);
-	}
+	rz_io_cache_pop(core->io);
 	core->io->cached = ocached;
 	rz_config_hold_restore(chold);
 	rz_config_hold_free(chold);
@@ -1152,6 +1152,9 @@ RZ_API RzList /*<RzHeapBin *>*/ *GH(rz_heap_tcache_content)(RzCore *core, GHT ar
 	RzList *tcache_bins_list = rz_list_newf((RzListFree)GH(rz_heap_bin_free));
 
 	// Use rz_tcache struct to get bins
+	RzHeapBin *bins[TCACHE_MAX_BINS];
+	GHT tcache_fd[TCACHE_MAX_BINS];
+	int left[TCACHE_MAX_BINS];
 	for (int i = 0; i < TCACHE_MAX_BINS; i++) {
 		int count = GH(tcache_get_count)(tcache, i);
 		GHT entry = GH(tcache_get_entry)(tcache, i);
@@ -1164,6 +1167,9 @@ RZ_API RzList /*<RzHeapBin *>*/ *GH(rz_heap_tcache_content)(RzCore *core, GHT ar
 		bin->bin_num = i;
 		bin->chunks = rz_list_newf((RzListFree)GH(rz_heap_chunk_free));
 		rz_list_append(tcache_bins_list, bin);
+		bins[i] = bin;
+		left[i] = count - 1;
+		tcache_fd[i] = entry;
 		if (count <= 0) {
 			continue;
 		}
@@ -1175,28 +1181,38 @@ RZ_API RzList /*<RzHeapBin *>*/ *GH(rz_heap_tcache_content)(RzCore *core, GHT ar
 		}
 		chunk->addr = (ut64)(entry - GH(HDR_SZ));
 		rz_list_append(bin->chunks, chunk);
+	}
 
-		if (count <= 1) {
-			continue;
-		}
-
-		// get rest of the chunks
-		GHT tcache_fd = entry;
-		GHT tcache_tmp = GHT_MAX;
-		for (size_t n = 1; n < count; n++) {
-			int r = rz_io_nread_at(core->io, tcache_fd, (ut8 *)&tcache_tmp, sizeof(GHT));
-			if (r <= 0) {
-				goto error;
+	// get rest of the chunks, reading the next pointer of every bin at once
+	GHT next[TCACHE_MAX_BINS];
+	RzIOReadReq reqs[TCACHE_MAX_BINS];
+	int reqs_bin[TCACHE_MAX_BINS];
+	for (;;) {
+		size_t n = 0;
+		for (int i = 0; i < TCACHE_MAX_BINS; i++) {
+			if (left[i] > 0) {
+				reqs[n] = (RzIOReadReq){ tcache_fd[i], (ut8 *)&next[i], sizeof(GHT), false };
+				reqs_bin[n++] = i;
 			}
-			tcache_tmp = GH(get_next_pointer)(core, tcache_fd, tcache_tmp);
-			chunk = RZ_NEW0(RzHeapChunkListItem);
+		}
+		if (!n) {
+			break;
+		}
+		if (!rz_io_read_at_batch(core->io, reqs, n)) {
+			goto error;
+		}
+		for (size_t j = 0; j < n; j++) {
+			int i = reqs_bin[j];
+			GHT tcache_tmp = GH(get_next_pointer)(core, tcache_fd[i], next[i]);
+			RzHeapChunkListItem *chunk = RZ_NEW0(RzHeapChunkListItem);
 			if (!chunk) {
 				goto error;
 			}
 			// the base address of the chunk = address - 2 * PTR_SIZE
 			chunk->addr = (ut64)(tcache_tmp - GH(HDR_SZ));
-			rz_list_append(bin->chunks, chunk);
-			tcache_fd = tcache_tmp;
+			rz_list_append(bins[i]->chunks, chunk);
+			tcache_fd[i] = tcache_tmp;
+			left[i]--;
 		}
 	}
 	free(tcache);
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 
 #include <rz_project.h>
+#include "core_private.h"
 
 #define RZ_PROJECT_KEY_TYPE    "type"
 #define RZ_PROJECT_KEY_VERSION "version"
@@ -40,7 +41,7 @@ RZ_API RzProjectErr rz_project_save(RzCore *core, RzProject *prj, const char *fi
 	return RZ_PROJECT_ERR_SUCCESS;
 }
 
-RZ_API RzProjectErr rz_project_save_file(RzCore *core, const char *file, bool compress) {
+static RzProjectErr project_save_file(RzCore *core, const char *file, bool compress, bool binary) {
 	char *tmp_file = NULL;
 
 	if (compress) {
@@ -63,7 +64,7 @@ RZ_API RzProjectErr rz_project_save_file(RzCore *core, const char *file, bool co
 		sdb_free(prj);
 		return err;
 	}
-	if (!sdb_text_save(prj, save_file, true)) {
+	if (!(binary ? sdb_bin_save(prj, save_file) : sdb_text_save(prj, save_file, true))) {
 		err = RZ_PROJECT_ERR_FILE;
 	}
 	sdb_free(prj);
@@ -85,45 +86,70 @@ tmp_file_err:
 	return err;
 }
 
-/// Load a file into an RzProject but don't actually migrate anything or load it into an RzCore
-RZ_API RzProject *rz_project_load_file_raw(const char *file) {
-	RzProject *prj = sdb_new0();
-	if (!prj) {
+RZ_API RzProjectErr rz_project_save_file(RzCore *core, const char *file, bool compress) {
+	return project_save_file(core, file, compress, false);
+}
+
+/**
+ * \brief Save the state of \p core into the project file \p file, in the binary format
+ *
+ * The binary format is faster to save and load than the text one used by
+ * rz_project_save_file(). Both are loaded by rz_project_load_file_raw().
+ *
+ * \param compress Deflate the saved file
+ */
+RZ_API RzProjectErr rz_project_save_file_binary(RzCore *core, const char *file, bool compress) {
+	return project_save_file(core, file, compress, true);
+}
+
+/**
+ * Returns the uncompressed project file to read, which is \p file itself or,
+ * if it is compressed, a temporary file to remove afterwards in \p tmp_file.
+ */
+static const char *project_file_uncompressed(const char *file, char **tmp_file) {
+	*tmp_file = NULL;
+	if (!rz_file_exists(file)) {
+		return NULL;
+	}
+	if (!rz_file_is_deflated(file)) {
+		return file;
+	}
+	int mkstemp_fd = rz_file_mkstemp("ldprj", tmp_file);
+	if (mkstemp_fd == -1 || !*tmp_file) {
+		free(*tmp_file);
+		*tmp_file = NULL;
 		return NULL;
 	}
-
-	char *tmp_file;
-	int mkstemp_fd = rz_file_mkstemp("ldprj", &tmp_file);
 	close(mkstemp_fd);
-
-	if (mkstemp_fd == -1 || !tmp_file) {
-		free(tmp_file);
+	if (!rz_file_inflate(file, *tmp_file)) {
+		rz_file_rm(*tmp_file);
+		free(*tmp_file);
+		*tmp_file = NULL;
 		return NULL;
 	}
+	return *tmp_file;
+}
 
-	const char *load_file = tmp_file;
-
-	if (!rz_file_exists(file)) {
-		prj = NULL;
-		goto return_goto;
-	}
-	if (rz_file_is_deflated(file)) {
-		if (!rz_file_inflate(file, tmp_file)) {
-			prj = NULL;
-			goto return_goto;
-		}
-	} else {
-		load_file = file;
+static void project_file_cleanup(char *tmp_file) {
+	if (tmp_file) {
+		rz_file_rm(tmp_file);
+		free(tmp_file);
 	}
+}
 
-	if (!sdb_text_load(prj, load_file)) {
+/// Load a file into an RzProject but don't actually migrate anything or load it into an RzCore
+RZ_API RzProject *rz_project_load_file_raw(const char *file) {
+	char *tmp_file;
+	const char *load_file = project_file_uncompressed(file, &tmp_file);
+	if (!load_file) {
+		return NULL;
+	}
+	RzProject *prj = sdb_new0();
+	if (prj && !(sdb_bin_check(load_file) ? sdb_bin_load(prj, load_file) : sdb_text_load(prj, load_file))) {
 		sdb_free(prj);
 		prj = NULL;
 	}
-
-return_goto:
-	rz_file_rm(tmp_file);
-	free(tmp_file);
+	project_file_cleanup(tmp_file);
 	return prj;
 }
 
@@ -131,8 +157,7 @@ RZ_API void rz_project_free(RzProject *prj) {
 	sdb_free(prj);
 }
 
-RZ_API RzProjectErr rz_project_load(RzCore *core, RzProject *prj, bool load_bin_io, RZ_NULLABLE const char *file, RzSerializeResultInfo *res) {
-	rz_return_val_if_fail(core && prj, RZ_PROJECT_ERR_UNKNOWN);
+static RzProjectErr project_check_version(RzProject *prj, unsigned long *version) {
 	const char *type = sdb_const_get(prj, RZ_PROJECT_KEY_TYPE, 0);
 	if (!type || strcmp(type, RZ_PROJECT_TYPE) != 0) {
 		return RZ_PROJECT_ERR_INVALID_TYPE;
@@ -141,13 +166,23 @@ RZ_API RzProjectErr rz_project_load(RzCore *core, RzProject *prj, bool load_bin_
 	if (!version_str) {
 		return RZ_PROJECT_ERR_INVALID_VERSION;
 	}
-	unsigned long version = strtoul(version_str, NULL, 0);
-	if (!version || version == ULONG_MAX) {
+	*version = strtoul(version_str, NULL, 0);
+	if (!*version || *version == ULONG_MAX) {
 		return RZ_PROJECT_ERR_INVALID_VERSION;
 	}
-	if (version > RZ_PROJECT_VERSION) {
+	if (*version > RZ_PROJECT_VERSION) {
 		return RZ_PROJECT_ERR_NEWER_VERSION;
 	}
+	return RZ_PROJECT_ERR_SUCCESS;
+}
+
+RZ_API RzProjectErr rz_project_load(RzCore *core, RzProject *prj, bool load_bin_io, RZ_NULLABLE const char *file, RzSerializeResultInfo *res) {
+	rz_return_val_if_fail(core && prj, RZ_PROJECT_ERR_UNKNOWN);
+	unsigned long version;
+	RzProjectErr err = project_check_version(prj, &version);
+	if (err != RZ_PROJECT_ERR_SUCCESS) {
+		return err;
+	}
 	if (!rz_project_migrate(prj, version, res)) {
 		return RZ_PROJECT_ERR_MIGRATION_FAILED;
 	}
@@ -166,13 +201,83 @@ RZ_API RzProjectErr rz_project_load(RzCore *core, RzProject *prj, bool load_bin_
 	return RZ_PROJECT_ERR_SUCCESS;
 }
 
-RZ_API RzProjectErr rz_project_load_file(RzCore *core, const char *file, bool load_bin_io, RzSerializeResultInfo *res) {
-	RzProject *prj = rz_project_load_file_raw(file);
+/**
+ * Loads a binary project file into \p core, mapping the file and only loading
+ * each namespace of the core right before it is deserialized.
+ */
+static RzProjectErr project_load_bin(RzCore *core, SdbBin *bin, bool load_bin_io, const char *file, RzSerializeResultInfo *res) {
+	RzProject *prj = sdb_new0();
 	if (!prj) {
+		return RZ_PROJECT_ERR_UNKNOWN;
+	}
+	RzProjectErr ret;
+	unsigned long version;
+	if (!sdb_bin_load_kvs(bin, prj, NULL)) {
+		RZ_SERIALIZE_ERR(res, "failed to read database file");
+		ret = RZ_PROJECT_ERR_FILE;
+		goto beach;
+	}
+	ret = project_check_version(prj, &version);
+	if (ret != RZ_PROJECT_ERR_SUCCESS) {
+		goto beach;
+	}
+	if (version < RZ_PROJECT_VERSION) {
+		// the migrations may touch any namespace
+		if (!sdb_bin_load_ns(bin, prj, NULL)) {
+			RZ_SERIALIZE_ERR(res, "failed to read database file");
+			ret = RZ_PROJECT_ERR_FILE;
+			goto beach;
+		}
+		ret = rz_project_load(core, prj, load_bin_io, file, res);
+		goto beach;
+	}
+
+	Sdb *core_db = sdb_ns(prj, "core", true);
+	if (!core_db || !sdb_bin_load_kvs(bin, core_db, "core")) {
+		RZ_SERIALIZE_ERR(res, "missing core namespace");
+		ret = RZ_PROJECT_ERR_INVALID_CONTENTS;
+		goto beach;
+	}
+	if (!rz_serialize_core_load_bin(core_db, bin, core, load_bin_io, file, res)) {
+		ret = RZ_PROJECT_ERR_INVALID_CONTENTS;
+		goto beach;
+	}
+	rz_config_set(core->config, "prj.file", file);
+	ret = RZ_PROJECT_ERR_SUCCESS;
+beach:
+	sdb_free(prj);
+	return ret;
+}
+
+RZ_API RzProjectErr rz_project_load_file(RzCore *core, const char *file, bool load_bin_io, RzSerializeResultInfo *res) {
+	char *tmp_file;
+	const char *load_file = project_file_uncompressed(file, &tmp_file);
+	if (!load_file) {
+		RZ_SERIALIZE_ERR(res, "failed to read database file");
+		return RZ_PROJECT_ERR_FILE;
+	}
+	RzProjectErr ret;
+	if (sdb_bin_check(load_file)) {
+		SdbBin *bin = sdb_bin_open(load_file);
+		if (bin) {
+			ret = project_load_bin(core, bin, load_bin_io, file, res);
+			sdb_bin_close(bin);
+		} else {
+			RZ_SERIALIZE_ERR(res, "failed to read database file");
+			ret = RZ_PROJECT_ERR_FILE;
+		}
+		project_file_cleanup(tmp_file);
+		return ret;
+	}
+	RzProject *prj = sdb_new0();
+	if (!prj || !sdb_text_load(prj, load_file)) {
+		sdb_free(prj);
+		project_file_cleanup(tmp_file);
 		RZ_SERIALIZE_ERR(res, "failed to read database file");
 		return RZ_PROJECT_ERR_FILE;
 	}
-	RzProjectErr ret = rz_project_load(core, prj, load_bin_io, file, res);
+	project_file_cleanup(tmp_file);
+	ret = rz_project_load(core, prj, load_bin_io, file, res);
 	sdb_free(prj);
 	return ret;
 }
@@ -3,6 +3,7 @@
 
 #include <rz_util/rz_serialize.h>
 #include <rz_core.h>
+#include "core_private.h"
 
 /*
  * SDB Format:
@@ -68,11 +69,40 @@ static const char *const config_exclude[] = {
 	NULL
 };
 
-RZ_API bool rz_serialize_core_load(RZ_NONNULL Sdb *db, RZ_NONNULL RzCore *core, bool load_bin_io,
+// returns the sub-namespace ns of db, first loading it from bin if given
+static Sdb *core_sub_load(Sdb *db, RZ_NULLABLE SdbBin *bin, const char *ns) {
+	if (!bin) {
+		return sdb_ns(db, ns, false);
+	}
+	char path[0x20];
+	Sdb *subdb = sdb_ns(db, ns, true);
+	if (subdb && !sdb_bin_load_ns(bin, subdb, rz_strf(path, "core/%s", ns))) {
+		sdb_ns_unset(db, ns, NULL);
+		subdb = NULL;
+	}
+	return subdb;
+}
+
+static bool core_load(RZ_NONNULL Sdb *db, RZ_NULLABLE SdbBin *bin, RZ_NONNULL RzCore *core, bool load_bin_io,
 	RZ_NULLABLE const char *prj_file, RZ_NULLABLE RzSerializeResultInfo *res) {
 	Sdb *subdb;
 
-#define SUB(ns, call) RZ_SERIALIZE_SUB_DO(db, subdb, res, ns, call, return false;)
+	// a namespace loaded from the binary file is dropped again once deserialized
+#define SUB(ns, call) \
+	do { \
+		subdb = core_sub_load(db, bin, ns); \
+		if (!subdb) { \
+			RZ_SERIALIZE_ERR(res, "missing " ns " namespace"); \
+			return false; \
+		} \
+		bool succ = call; \
+		if (bin) { \
+			sdb_ns_unset(db, ns, NULL); \
+		} \
+		if (!succ) { \
+			return false; \
+		} \
+	} while (0)
 
 	if (load_bin_io) {
 		SUB("file", file_load(subdb, core, prj_file, res));
@@ -82,6 +112,7 @@ RZ_API bool rz_serialize_core_load(RZ_NONNULL Sdb *db, RZ_NONNULL RzCore *core,
 	SUB("analysis", rz_serialize_analysis_load(subdb, core->analysis, res));
 	SUB("debug", rz_serialize_debug_load(subdb, core->dbg, res));
 	SUB("seek", rz_serialize_core_seek_load(subdb, core, res));
+#undef SUB
 
 	const char *str = sdb_const_get(db, "offset", 0);
 	if (!str || !*str) {
@@ -104,6 +135,20 @@ RZ_API bool rz_serialize_core_load(RZ_NONNULL Sdb *db, RZ_NONNULL RzCore *core,
 	return true;
 }
 
+RZ_API bool rz_serialize_core_load(RZ_NONNULL Sdb *db, RZ_NONNULL RzCore *core, bool load_bin_io,
+	RZ_NULLABLE const char *prj_file, RZ_NULLABLE RzSerializeResultInfo *res) {
+	return core_load(db, NULL, core, load_bin_io, prj_file, res);
+}
+
+/**
+ * \brief Like rz_serialize_core_load(), but loads each sub-namespace of the core from \p bin only when it is deserialized
+ * \param db holds the keys of the core namespace, its sub-namespaces are taken from "core/..." in \p bin
+ */
+RZ_IPI bool rz_serialize_core_load_bin(RZ_NONNULL Sdb *db, RZ_NONNULL SdbBin *bin, RZ_NONNULL RzCore *core, bool load_bin_io,
+	RZ_NULLABLE const char *prj_file, RZ_NULLABLE RzSerializeResultInfo *res) {
+	return core_load(db, bin, core, load_bin_io, prj_file, res);
+}
+
 /* these file functions are a high-level serialization of RBin and RIO, i.e. for loading the project's underlying binary.
  * It only supports a subset of possible RBin and RIO configurations:
  *  - Only a single binary, loaded as a regular file
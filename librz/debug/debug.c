@@ -42,7 +42,7 @@ RZ_API void rz_debug_bp_update(RzDebug *dbg) {
 	RzListIter *iter;
 	rz_list_foreach (dbg->bp->bps, iter, bp) {
 		if (bp->expr) {
-			bp->addr = dbg->corebind.numGet(dbg->corebind.core, bp->expr);
+			rz_bp_item_set_addr(dbg->bp, bp, dbg->corebind.numGet(dbg->corebind.core, bp->expr));
 		}
 	}
 }
@@ -54,6 +54,20 @@ static int rz_debug_drx_at(RzDebug *dbg, ut64 addr) {
 	return -1;
 }
 
+static bool is_coverage_hit(RzDebug *dbg, ut64 pc) {
+	if (!dbg->bp->coverage) {
+		return false;
+	}
+	RzBreakpointItem *b = NULL;
+	if (!dbg->pc_at_bp_set || !dbg->pc_at_bp) {
+		b = rz_bp_get_ending_at(dbg->bp, pc);
+	}
+	if (!b) {
+		b = rz_bp_get_at(dbg->bp, pc);
+	}
+	return b && b->coverage;
+}
+
 /*
  * Recoiling after a breakpoint has two stages:
  * 1. remove the breakpoint and fix the program counter.
@@ -84,7 +98,8 @@ static int rz_debug_bp_hit(RzDebug *dbg, RzRegItem *pc_ri, ut64 pc, RzBreakpoint
 	 * the code messing up our analysis.
 	 */
 	rz_debug_bp_update(dbg);
-	if (!rz_bp_restore(dbg->bp, false)) { // unset sw breakpoints
+	/* coverage hits are handled without stopping, so everything stays in place */
+	if (!is_coverage_hit(dbg, pc) && !rz_bp_restore(dbg->bp, false)) { // unset sw breakpoints
 		return false;
 	}
 
@@ -172,6 +187,13 @@ static int rz_debug_bp_hit(RzDebug *dbg, RzRegItem *pc_ri, ut64 pc, RzBreakpoint
 
 	*pb = b;
 
+	/* coverage breakpoints are one-shot and never stop the execution */
+	if (b->coverage) {
+		rz_bp_coverage_hit(dbg->bp, b);
+		dbg->reason.bp_addr = 0;
+		return true;
+	}
+
 	/* if we are on a software stepping breakpoint, we hide what is going on... */
 	if (b->swstep) {
 		dbg->reason.bp_addr = 0;
@@ -1120,8 +1142,8 @@ RZ_API bool rz_debug_goto_cnum(RzDebug *dbg, ut32 cnum) {
 		eprintf("Error: out of cnum range\n");
 		return false;
 	}
-	dbg->session->cnum = cnum;
 	rz_debug_session_restore_reg_mem(dbg, cnum);
+	dbg->session->cnum = cnum;
 
 	return true;
 }
@@ -1752,7 +1774,7 @@ RZ_API void rz_debug_bp_rebase(RzDebug *dbg, ut64 old_base, ut64 new_base) {
 
 	// update bp's address
 	rz_list_foreach (dbg->bp->bps, iter, bp) {
-		bp->addr += diff;
+		rz_bp_item_set_addr(dbg->bp, bp, bp->addr + diff);
 		bp->delta = bp->addr - dbg->bp->baddr;
 	}
 }
@@ -8,11 +8,18 @@
 #define CMP_CNUM_MEM(x, y)   ((x) >= ((RzDebugChangeMem *)y)->cnum ? 1 : -1)
 #define CMP_CNUM_CHKPT(x, y) ((x) >= ((RzDebugCheckpoint *)y)->cnum ? 1 : -1)
 
+// last address of the size bytes at addr, as inclusive end of a range in the memory index
+static inline ut64 mem_last(ut64 addr, ut64 size) {
+	return addr + size - 1 < addr ? UT64_MAX : addr + size - 1;
+}
+
 RZ_API void rz_debug_session_free(RzDebugSession *session) {
 	if (session) {
 		rz_vector_free(session->checkpoints);
 		ht_up_free(session->registers);
-		ht_up_free(session->memory);
+		rz_vector_free(session->memory);
+		rz_vector_free(session->memory_data);
+		rz_interval_tree_fini(&session->memory_index);
 		RZ_FREE(session);
 	}
 }
@@ -35,6 +42,7 @@ RZ_API RzDebugSession *rz_debug_session_new(void) {
 	if (!session) {
 		return NULL;
 	}
+	rz_interval_tree_init(&session->memory_index, NULL);
 
 	session->checkpoints = rz_vector_new(sizeof(RzDebugCheckpoint), rz_debug_checkpoint_fini, NULL);
 	if (!session->checkpoints) {
@@ -46,8 +54,9 @@ RZ_API RzDebugSession *rz_debug_session_new(void) {
 		rz_debug_session_free(session);
 		return NULL;
 	}
-	session->memory = ht_up_new(NULL, htup_vector_free, NULL);
-	if (!session->memory) {
+	session->memory = rz_vector_new(sizeof(RzDebugChangeMem), NULL, NULL);
+	session->memory_data = rz_vector_new(sizeof(ut8), NULL, NULL);
+	if (!session->memory || !session->memory_data) {
 		rz_debug_session_free(session);
 		return NULL;
 	}
@@ -55,6 +64,17 @@ RZ_API RzDebugSession *rz_debug_session_new(void) {
 	return session;
 }
 
+static RzDebugSnap *_get_snap(RzDebugCheckpoint *checkpoint, ut64 addr) {
+	RzListIter *iter;
+	RzDebugSnap *snap;
+	rz_list_foreach (checkpoint->snaps, iter, snap) {
+		if (snap->addr == addr) {
+			return snap;
+		}
+	}
+	return NULL;
+}
+
 RZ_API bool rz_debug_add_checkpoint(RzDebug *dbg) {
 	rz_return_val_if_fail(dbg->session, false);
 	size_t i;
@@ -69,17 +89,19 @@ RZ_API bool rz_debug_add_checkpoint(RzDebug *dbg) {
 		checkpoint.arena[i] = b;
 	}
 
-	// Save current memory maps
+	// Save current memory maps, sharing the pages unchanged since the last checkpoint
 	checkpoint.snaps = rz_list_newf((RzListFree)rz_debug_snap_free);
 	if (!checkpoint.snaps) {
 		return false;
 	}
+	RzVector *checkpoints = dbg->session->checkpoints;
+	RzDebugCheckpoint *last = rz_vector_empty(checkpoints) ? NULL : rz_vector_tail(checkpoints);
 	RzListIter *iter;
 	RzDebugMap *map;
 	rz_debug_map_sync(dbg);
 	rz_list_foreach (dbg->maps, iter, map) {
 		if ((map->perm & RZ_PERM_RW) == RZ_PERM_RW) {
-			RzDebugSnap *snap = rz_debug_snap_map(dbg, map);
+			RzDebugSnap *snap = rz_debug_snap_map_from(dbg, map, last ? _get_snap(last, map->addr) : NULL);
 			if (snap) {
 				rz_list_append(checkpoint.snaps, snap);
 			}
@@ -132,45 +154,219 @@ RZ_API void _restore_registers(RzDebug *dbg, ut32 cnum) {
 	}
 }
 
+static RzDebugCheckpoint *_get_checkpoint_before(RzDebugSession *session, ut32 cnum) {
+	RzDebugCheckpoint *checkpoint = NULL;
+	size_t index;
+	rz_vector_upper_bound(session->checkpoints, cnum, index, CMP_CNUM_CHKPT);
+	if (index > 0 && index <= session->checkpoints->len) {
+		checkpoint = rz_vector_index_ptr(session->checkpoints, index - 1);
+	}
+	return checkpoint;
+}
+
 static void _set_initial_memory(RzDebug *dbg) {
 	RzListIter *iter;
 	RzDebugSnap *snap;
 	rz_list_foreach (dbg->session->cur_chkpt->snaps, iter, snap) {
-		dbg->iob.write_at(dbg->iob.io, snap->addr, snap->data, snap->size);
+		rz_debug_snap_restore(dbg, snap);
 	}
 }
 
-static bool _restore_memory_cb(void *user, const ut64 key, const void *value) {
+static void _restore_memory_full(RzDebug *dbg, ut32 cnum) {
+	_set_initial_memory(dbg);
+	// Replay in order the writes done after the checkpoint, up to cnum
+	RzDebugSession *session = dbg->session;
 	size_t index;
-	RzDebug *dbg = user;
-	RzVector *vmem = (RzVector *)value;
+	rz_vector_upper_bound(session->memory, session->cur_chkpt->cnum, index, CMP_CNUM_MEM);
+	for (; index < session->memory->len; index++) {
+		RzDebugChangeMem *mem = rz_vector_index_ptr(session->memory, index);
+		if (mem->cnum > cnum) {
+			break;
+		}
+		dbg->iob.write_at(dbg->iob.io, mem->addr, rz_vector_index_ptr(session->memory_data, mem->data), mem->size);
+	}
+}
 
-	rz_vector_upper_bound(vmem, dbg->session->cnum, index, CMP_CNUM_MEM);
-	if (index > 0 && index <= vmem->len) {
-		RzDebugChangeMem *mem = rz_vector_index_ptr(vmem, index - 1);
-		if (mem->cnum > dbg->session->cur_chkpt->cnum) {
-			dbg->iob.write_at(dbg->iob.io, key, &mem->data, 1);
+static void add_range(RzVector /*<RzInterval>*/ *ranges, ut64 addr, ut64 size) {
+	RzInterval itv = { addr, RZ_MIN(size, UT64_MAX - addr) };
+	rz_vector_push(ranges, &itv);
+}
+
+/**
+ * Adds to \p ranges the pages of the snaps that are not shared between \p a
+ * and \p b, which are consecutive checkpoints.
+ * Returns false if their snaps are not of the same maps.
+ */
+static bool add_changed_pages(RzVector /*<RzInterval>*/ *ranges, RzDebugCheckpoint *a, RzDebugCheckpoint *b) {
+	if (rz_list_length(a->snaps) != rz_list_length(b->snaps)) {
+		return false;
+	}
+	RzListIter *iter;
+	RzDebugSnap *snap;
+	rz_list_foreach (b->snaps, iter, snap) {
+		RzDebugSnap *prev = _get_snap(a, snap->addr);
+		if (!prev || prev->size != snap->size) {
+			return false;
+		}
+		for (ut64 off = 0, idx = 0; off < snap->size; off += RZ_DEBUG_SNAP_PAGE_SIZE, idx++) {
+			if (prev->pages[idx] != snap->pages[idx]) {
+				add_range(ranges, snap->addr + off, RZ_MIN(RZ_DEBUG_SNAP_PAGE_SIZE, snap->size - off));
+			}
 		}
 	}
 	return true;
 }
 
-static void _restore_memory(RzDebug *dbg, ut32 cnum) {
-	_set_initial_memory(dbg);
-	ht_up_foreach(dbg->session->memory, _restore_memory_cb, dbg);
+static int cmp_range_addr(const void *a, const void *b, void *user) {
+	const RzInterval *ra = a;
+	const RzInterval *rb = b;
+	return (ra->addr > rb->addr) - (ra->addr < rb->addr);
 }
 
-static RzDebugCheckpoint *_get_checkpoint_before(RzDebugSession *session, ut32 cnum) {
-	RzDebugCheckpoint *checkpoint = NULL;
+// copies the bytes of the snaps of checkpoint in [addr, addr + size) to buf
+static void fill_from_snaps(RzDebugCheckpoint *checkpoint, ut64 addr, ut8 *buf, ut64 size) {
+	RzListIter *iter;
+	RzDebugSnap *snap;
+	rz_list_foreach (checkpoint->snaps, iter, snap) {
+		ut64 from = RZ_MAX(addr, snap->addr);
+		ut64 to = RZ_MIN(addr + size, snap->addr + snap->size);
+		while (from < to) {
+			ut64 off = from - snap->addr;
+			ut64 idx = off / RZ_DEBUG_SNAP_PAGE_SIZE;
+			ut64 page_off = off % RZ_DEBUG_SNAP_PAGE_SIZE;
+			ut64 len = RZ_MIN(to - from, RZ_DEBUG_SNAP_PAGE_SIZE - page_off);
+			memcpy(buf + (from - addr), snap->pages[idx]->data + page_off, len);
+			from += len;
+		}
+	}
+}
+
+static bool snaps_cover(RzDebugCheckpoint *checkpoint, ut64 addr, ut64 size) {
+	RzListIter *iter;
+	RzDebugSnap *snap;
+	rz_list_foreach (checkpoint->snaps, iter, snap) {
+		if (snap->addr <= addr && addr + size <= snap->addr + snap->size) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool collect_write_cb(RzIntervalNode *node, void *user) {
+	size_t index = (size_t)node->data;
+	rz_vector_push(user, &index);
+	return true;
+}
+
+static int cmp_size_t(const void *a, const void *b, void *user) {
+	size_t ia = *(const size_t *)a;
+	size_t ib = *(const size_t *)b;
+	return (ia > ib) - (ia < ib);
+}
+
+/**
+ * Sets the memory in [addr, addr + size) to its contents at cnum: the contents of
+ * the snaps of the current checkpoint, with the writes after it up to cnum on top.
+ */
+static void restore_range(RzDebug *dbg, ut32 cnum, ut64 addr, ut64 size, RzVector /*<size_t>*/ *writes) {
+	RzDebugSession *session = dbg->session;
+	ut8 *buf = malloc(size);
+	if (!buf) {
+		return;
+	}
+	if (!snaps_cover(session->cur_chkpt, addr, size)) {
+		// memory outside of the snaps is only changed by the writes
+		dbg->iob.read_at(dbg->iob.io, addr, buf, size);
+	}
+	fill_from_snaps(session->cur_chkpt, addr, buf, size);
+
+	rz_vector_clear(writes);
+	rz_interval_tree_all_intersect(&session->memory_index, addr, mem_last(addr, size), true, collect_write_cb, writes);
+	if (!rz_vector_empty(writes)) {
+		// in the order they were done
+		rz_vector_sort(writes, cmp_size_t, false, NULL);
+	}
+	size_t *index;
+	rz_vector_foreach(writes, index) {
+		RzDebugChangeMem *mem = rz_vector_index_ptr(session->memory, *index);
+		if (mem->cnum <= session->cur_chkpt->cnum || mem->cnum > cnum) {
+			continue;
+		}
+		ut64 from = RZ_MAX(addr, mem->addr);
+		ut64 to = RZ_MIN(addr + size, mem->addr + mem->size);
+		memcpy(buf + (from - addr), (ut8 *)rz_vector_index_ptr(session->memory_data, mem->data) + (from - mem->addr), to - from);
+	}
+	dbg->iob.write_at(dbg->iob.io, addr, buf, size);
+	free(buf);
+}
+
+/**
+ * Brings the memory from its contents at step \p from to the ones at \p cnum.
+ *
+ * Only the memory that may differ between the two steps is written: the ranges
+ * touched by the writes done between them and, if checkpoints are crossed, the
+ * pages of the snaps that changed from one checkpoint to the next.
+ */
+static void _restore_memory(RzDebug *dbg, ut32 from, ut32 cnum) {
+	RzDebugSession *session = dbg->session;
+	RzDebugCheckpoint *from_chkpt = _get_checkpoint_before(session, from);
+	if (!from_chkpt) {
+		_restore_memory_full(dbg, cnum);
+		return;
+	}
+	RzVector ranges;
+	rz_vector_init(&ranges, sizeof(RzInterval), NULL, NULL);
+
+	// the pages changed between the checkpoints
+	RzDebugCheckpoint *lo = RZ_MIN(from_chkpt, session->cur_chkpt);
+	RzDebugCheckpoint *hi = RZ_MAX(from_chkpt, session->cur_chkpt);
+	for (RzDebugCheckpoint *c = lo; c < hi; c++) {
+		if (!add_changed_pages(&ranges, c, c + 1)) {
+			rz_vector_fini(&ranges);
+			_restore_memory_full(dbg, cnum);
+			return;
+		}
+	}
+
+	// the writes between the steps
 	size_t index;
-	rz_vector_upper_bound(session->checkpoints, cnum, index, CMP_CNUM_CHKPT);
-	if (index > 0 && index <= session->checkpoints->len) {
-		checkpoint = rz_vector_index_ptr(session->checkpoints, index - 1);
+	rz_vector_upper_bound(session->memory, RZ_MIN(from, cnum), index, CMP_CNUM_MEM);
+	for (; index < session->memory->len; index++) {
+		RzDebugChangeMem *mem = rz_vector_index_ptr(session->memory, index);
+		if (mem->cnum > RZ_MAX(from, cnum)) {
+			break;
+		}
+		add_range(&ranges, mem->addr, mem->size);
 	}
-	return checkpoint;
+
+	if (rz_vector_empty(&ranges)) {
+		rz_vector_fini(&ranges);
+		return;
+	}
+	// each byte is written once
+	rz_vector_sort(&ranges, cmp_range_addr, false, NULL);
+	RzVector writes;
+	rz_vector_init(&writes, sizeof(size_t), NULL, NULL);
+	RzInterval *cur = NULL;
+	RzInterval *itv;
+	rz_vector_foreach(&ranges, itv) {
+		if (cur && itv->addr <= rz_itv_end(*cur)) {
+			cur->size = RZ_MAX(rz_itv_end(*cur), rz_itv_end(*itv)) - cur->addr;
+			continue;
+		}
+		if (cur) {
+			restore_range(dbg, cnum, cur->addr, cur->size, &writes);
+		}
+		cur = itv;
+	}
+	if (cur) {
+		restore_range(dbg, cnum, cur->addr, cur->size, &writes);
+	}
+	rz_vector_fini(&writes);
+	rz_vector_fini(&ranges);
 }
 
-RZ_API void rz_debug_session_restore_reg_mem(RzDebug *dbg, ut32 cnum) {
+static void _restore_reg_mem(RzDebug *dbg, ut32 cnum, bool full) {
 	// Set checkpoint for initial registers and memory
 	dbg->session->cur_chkpt = _get_checkpoint_before(dbg->session, cnum);
 
@@ -179,7 +375,21 @@ RZ_API void rz_debug_session_restore_reg_mem(RzDebug *dbg, ut32 cnum) {
 	rz_debug_reg_sync(dbg, RZ_REG_TYPE_ANY, true);
 
 	// Restore memory
-	_restore_memory(dbg, cnum);
+	if (full) {
+		_restore_memory_full(dbg, cnum);
+	} else {
+		_restore_memory(dbg, dbg->session->cnum, cnum);
+	}
+}
+
+/**
+ * \brief Restore the registers and memory of the debuggee to their state at step \p cnum
+ *
+ * The memory is expected to be at its state at step dbg->session->cnum, only
+ * what differs from it is written.
+ */
+RZ_API void rz_debug_session_restore_reg_mem(RzDebug *dbg, ut32 cnum) {
+	_restore_reg_mem(dbg, cnum, false);
 }
 
 RZ_API void rz_debug_session_list_memory(RzDebug *dbg) {
@@ -230,19 +440,44 @@ RZ_API bool rz_debug_session_add_reg_change(RzDebugSession *session, int arena,
 	return true;
 }
 
-RZ_API bool rz_debug_session_add_mem_change(RzDebugSession *session, ut64 addr, ut8 data) {
-	RzVector *vmem = ht_up_find(session->memory, addr, NULL);
-	if (!vmem) {
-		vmem = rz_vector_new(sizeof(RzDebugChangeMem), NULL, NULL);
-		if (!vmem) {
-			eprintf("Error: creating a memory vector.\n");
-			return false;
+/**
+ * \brief Record that the \p size bytes in \p data were written at \p addr in the current step
+ *
+ * Writes contiguous to the previous one in the same step are merged with it.
+ */
+RZ_API bool rz_debug_session_add_mem_change(RzDebugSession *session, ut64 addr, RZ_NONNULL const ut8 *data, ut32 size) {
+	rz_return_val_if_fail(session && data, false);
+	if (!size) {
+		return true;
+	}
+	size_t offset = session->memory_data->len;
+	if (!rz_vector_insert_range(session->memory_data, offset, (void *)data, size)) {
+		return false;
+	}
+	RzDebugChangeMem *last = rz_vector_empty(session->memory) ? NULL : rz_vector_tail(session->memory);
+	void *last_index = (void *)(size_t)(session->memory->len - 1);
+	if (last && last->cnum == session->cnum && last->addr + last->size == addr && last->data + last->size == offset) {
+		RzIntervalNode *node = rz_interval_tree_node_at_data(&session->memory_index, last->addr, last_index);
+		if (node && rz_interval_tree_resize(&session->memory_index, node, last->addr, mem_last(addr, size))) {
+			last->size += size;
+			return true;
 		}
-		ht_up_insert(session->memory, addr, vmem);
 	}
-	RzDebugChangeMem mem = { session->cnum, data };
-	rz_vector_push(vmem, &mem);
-	return true;
+	RzDebugChangeMem mem = { session->cnum, size, addr, offset };
+	if (!rz_vector_push(session->memory, &mem)) {
+		return false;
+	}
+	return rz_interval_tree_insert(&session->memory_index, addr, mem_last(addr, size), (void *)(size_t)(session->memory->len - 1));
+}
+
+static void memory_index_rebuild(RzDebugSession *session) {
+	rz_interval_tree_fini(&session->memory_index);
+	rz_interval_tree_init(&session->memory_index, NULL);
+	RzDebugChangeMem *mem;
+	size_t i;
+	rz_vector_enumerate(session->memory, mem, i) {
+		rz_interval_tree_insert(&session->memory_index, mem->addr, mem_last(mem->addr, mem->size), (void *)i);
+	}
 }
 
 /* Save and Load Session */
@@ -275,41 +510,96 @@ static void serialize_registers(Sdb *db, HtUP *registers) {
 	ht_up_foreach(registers, serialize_register_cb, db);
 }
 
-// 0x<addr>={"size":<size_t>, "a":[<RzDebugChangeMem>]}},
-static bool serialize_memory_cb(void *db, const ut64 k, const void *v) {
-	RzDebugChangeMem *mem;
-	RzVector *vmem = (RzVector *)v;
+// 0x<cnum>=[<RzDebugChangeMem>]
+static void serialize_memory(Sdb *db, RzDebugSession *session) {
 	char tmpbuf[32];
-	PJ *j = pj_new();
-	if (!j) {
-		return false;
+	size_t i = 0;
+	while (i < session->memory->len) {
+		PJ *j = pj_new();
+		if (!j) {
+			return;
+		}
+		pj_a(j);
+		int cnum = ((RzDebugChangeMem *)rz_vector_index_ptr(session->memory, i))->cnum;
+		for (; i < session->memory->len; i++) {
+			RzDebugChangeMem *mem = rz_vector_index_ptr(session->memory, i);
+			if (mem->cnum != cnum) {
+				break;
+			}
+			char *edata = sdb_encode(rz_vector_index_ptr(session->memory_data, mem->data), mem->size);
+			if (!edata) {
+				pj_free(j);
+				return;
+			}
+			pj_o(j);
+			pj_kn(j, "addr", mem->addr);
+			pj_ks(j, "data", edata);
+			pj_end(j);
+			free(edata);
+		}
+		pj_end(j);
+		sdb_set(db, rz_strf(tmpbuf, "0x%x", cnum), pj_string(j), 0);
+		pj_free(j);
 	}
-	pj_a(j);
+}
 
-	rz_vector_foreach(vmem, mem) {
-		pj_o(j);
-		pj_kN(j, "cnum", mem->cnum);
-		pj_kn(j, "data", mem->data);
-		pj_end(j);
+typedef struct {
+	Sdb *db; ///< Contents of the pages by their hash
+	RzHash *hash;
+	HtUP /*<RzDebugSnapPage *, char *>*/ *keys; ///< Hash of the pages already stored
+} SerializePages;
+
+static void page_key_free(HtUPKv *kv) {
+	free(kv->value);
+}
+
+// <sha256>=<base64>, stored once for all the snaps sharing the page or having the same contents
+static const char *serialize_page(SerializePages *pages, RzDebugSnapPage *page, ut32 size) {
+	char *key = ht_up_find(pages->keys, (ut64)(size_t)page, NULL);
+	if (key) {
+		return key;
+	}
+	key = rz_hash_cfg_calculate_small_block_string(pages->hash, "sha256", page->data, size, NULL, false);
+	if (!key) {
+		return NULL;
 	}
+	if (!sdb_exists(pages->db, key)) {
+		char *edata = sdb_encode(page->data, size);
+		if (!edata) {
+			free(key);
+			return NULL;
+		}
+		sdb_set(pages->db, key, edata, 0);
+		free(edata);
+	}
+	ht_up_insert(pages->keys, (ut64)(size_t)page, key);
+	return key;
+}
 
+static bool serialize_snap_pages(PJ *j, SerializePages *pages, RzDebugSnap *snap) {
+	pj_ka(j, "pages");
+	for (ut64 off = 0, idx = 0; off < snap->size; off += RZ_DEBUG_SNAP_PAGE_SIZE, idx++) {
+		const char *key = serialize_page(pages, snap->pages[idx], RZ_MIN(RZ_DEBUG_SNAP_PAGE_SIZE, snap->size - off));
+		if (!key) {
+			return false;
+		}
+		pj_s(j, key);
+	}
 	pj_end(j);
-	sdb_set(db, rz_strf(tmpbuf, "0x%" PFMT64x, k), pj_string(j), 0);
-	pj_free(j);
 	return true;
 }
 
-static void serialize_memory(Sdb *db, HtUP *memory) {
-	ht_up_foreach(memory, serialize_memory_cb, db);
-}
-
-static void serialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *checkpoints) {
+static void serialize_checkpoints(Sdb *db, Sdb *pages_db, RzVector /*<RzDebugCheckpoint>*/ *checkpoints) {
 	size_t i;
 	RzDebugCheckpoint *chkpt;
 	RzDebugSnap *snap;
 	RzListIter *iter;
 	char tmpbuf[32];
 
+	SerializePages pages = { pages_db, rz_hash_new(), ht_up_new(NULL, page_key_free, NULL) };
+	if (!pages.hash || !pages.keys) {
+		goto beach;
+	}
 	rz_vector_foreach(checkpoints, chkpt) {
 		// 0x<cnum>={
 		//   registers:{"<RzRegisterType>":<RzRegArena>, ...},
@@ -317,7 +607,7 @@ static void serialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *che
 		// }
 		PJ *j = pj_new();
 		if (!j) {
-			return;
+			goto beach;
 		}
 		pj_o(j);
 
@@ -340,7 +630,7 @@ static void serialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *che
 
 		// Serialize RzDebugSnap to "snaps"
 		// {"name":<str>, "addr":<ut64>, "addr_end":<ut64>, "size":<ut64>,
-		//  "data":"<base64>", "perm":<int>, "user":<int>, "shared":<bool>}
+		//  "pages":["<sha256>", ...], "perm":<int>, "user":<int>, "shared":<bool>}
 		pj_ka(j, "snaps");
 		rz_list_foreach (chkpt->snaps, iter, snap) {
 			pj_o(j);
@@ -348,13 +638,10 @@ static void serialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *che
 			pj_kn(j, "addr", snap->addr);
 			pj_kn(j, "addr_end", snap->addr_end);
 			pj_kn(j, "size", snap->size);
-			char *edata = sdb_encode((const void *)snap->data, snap->size);
-			if (!edata) {
+			if (!serialize_snap_pages(j, &pages, snap)) {
 				pj_free(j);
-				return;
+				goto beach;
 			}
-			pj_ks(j, "data", edata);
-			free(edata);
 			pj_kn(j, "perm", snap->perm);
 			pj_kn(j, "user", snap->user);
 			pj_kb(j, "shared", snap->shared);
@@ -366,6 +653,9 @@ static void serialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *che
 		sdb_set(db, rz_strf(tmpbuf, "0x%x", chkpt->cnum), pj_string(j), 0);
 		pj_free(j);
 	}
+beach:
+	ht_up_free(pages.keys);
+	rz_hash_free(pages.hash);
 }
 
 /*
@@ -378,7 +668,7 @@ static void serialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *che
  *     0x<addr>={"size":<size_t>, "a":[<RzDebugChangeReg>]}
  *
  *   /memory
- *     0x<addr>={"size":<size_t>, "a":[<RzDebugChangeMem>]}
+ *     0x<cnum>=[<RzDebugChangeMem>]
  *
  *   /checkpoints
  *     0x<cnum>={
@@ -386,27 +676,35 @@ static void serialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *che
  *       snaps:{"size":<size_t>, "a":[<RzDebugSnap>]}
  *     }
  *
+ *   /pages
+ *     <sha256>="<base64>"
+ *
  * RzDebugChangeReg JSON:
  * {"cnum":<int>, "data":<ut64>}
  *
  * RzDebugChangeMem JSON:
- * {"cnum":<int>, "data":<ut8>}
+ * {"addr":<ut64>, "data":"<base64>"}
  *
  * RzRegArena JSON:
  * {"size":<int>, "bytes":"<base64>"}
  *
  * RzDebugSnap JSON:
  * {"name":<str>, "addr":<ut64>, "addr_end":<ut64>, "size":<ut64>,
- *  "data":"<base64>", "perm":<int>, "user":<int>, "shared":<bool>}
+ *  "pages":["<sha256>", ...], "perm":<int>, "user":<int>, "shared":<bool>}
  *
  * Notes:
  * - This mostly follows rz-db-style serialization
+ * - The pages of RZ_DEBUG_SNAP_PAGE_SIZE bytes of the snaps are stored once in
+ *   /pages, keyed by the hash of their contents, and shared again on load.
+ *   Snaps saved by older versions have their whole contents in "data" instead.
+ * - Memory saved by older versions is keyed by address instead, with
+ *   changes of a single byte: 0x<addr>=[{"cnum":<int>, "data":<ut8>}]
  */
 RZ_API void rz_debug_session_serialize(RzDebugSession *session, Sdb *db) {
 	sdb_num_set(db, "maxcnum", session->maxcnum, 0);
 	serialize_registers(sdb_ns(db, "registers", true), session->registers);
-	serialize_memory(sdb_ns(db, "memory", true), session->memory);
-	serialize_checkpoints(sdb_ns(db, "checkpoints", true), session->checkpoints);
+	serialize_memory(sdb_ns(db, "memory", true), session);
+	serialize_checkpoints(sdb_ns(db, "checkpoints", true), sdb_ns(db, "pages", true), session->checkpoints);
 }
 
 static bool session_sdb_save(Sdb *db, const char *path) {
@@ -464,53 +762,76 @@ RZ_API bool rz_debug_session_save(RzDebugSession *session, const char *path) {
 	if (!v || v->type != t) \
 	continue
 
-static bool deserialize_memory_cb(void *user, const char *addr, const char *v) {
+static bool deserialize_memory_cb(void *user, const char *k, const char *v) {
 	RzJson *child;
 	char *json_str = strdup(v);
 	if (!json_str) {
 		return true;
 	}
-	RzJson *reg_json = rz_json_parse(json_str);
-	if (!reg_json || reg_json->type != RZ_JSON_ARRAY) {
+	RzJson *mem_json = rz_json_parse(json_str);
+	if (!mem_json || mem_json->type != RZ_JSON_ARRAY) {
 		free(json_str);
 		return true;
 	}
 
-	HtUP *memory = user;
-	// Insert a new vector into `memory` HtUP at `addr`
-	RzVector *vmem = rz_vector_new(sizeof(RzDebugChangeMem), NULL, NULL);
-	if (!vmem) {
-		eprintf("Error: failed to allocate RzVector vmem.\n");
-		free(json_str);
-		rz_json_free(reg_json);
-		return false;
-	}
-	ht_up_insert(memory, sdb_atoi(addr), vmem);
-
-	// Extract <RzDebugChangeMem>'s into the new vector
-	for (child = reg_json->children.first; child; child = child->next) {
+	RzDebugSession *session = user;
+	ut64 key = sdb_atoi(k);
+	// Extract <RzDebugChangeMem>'s, the key is the address in the old format
+	for (child = mem_json->children.first; child; child = child->next) {
 		if (child->type != RZ_JSON_OBJECT) {
 			continue;
 		}
-		const RzJson *baby = rz_json_get(child, "cnum");
-		CHECK_TYPE(baby, RZ_JSON_INTEGER);
-		int cnum = baby->num.s_value;
+		const RzJson *cnumj = rz_json_get(child, "cnum");
+		const RzJson *valj = cnumj ? cnumj : rz_json_get(child, "addr");
+		CHECK_TYPE(valj, RZ_JSON_INTEGER);
+		RzDebugChangeMem mem = {
+			.cnum = cnumj ? valj->num.s_value : key,
+			.addr = cnumj ? key : valj->num.u_value,
+			.data = session->memory_data->len
+		};
 
-		baby = rz_json_get(child, "data");
-		CHECK_TYPE(baby, RZ_JSON_INTEGER);
-		ut64 data = baby->num.u_value;
-
-		RzDebugChangeMem mem = { cnum, data };
-		rz_vector_push(vmem, &mem);
+		const RzJson *dataj = rz_json_get(child, "data");
+		if (dataj && dataj->type == RZ_JSON_INTEGER) {
+			ut8 byte = dataj->num.u_value;
+			rz_vector_push(session->memory_data, &byte);
+			mem.size = 1;
+		} else {
+			CHECK_TYPE(dataj, RZ_JSON_STRING);
+			int size = 0;
+			ut8 *data = sdb_decode(dataj->str_value, &size);
+			if (!data || size <= 0) {
+				free(data);
+				continue;
+			}
+			rz_vector_insert_range(session->memory_data, mem.data, data, size);
+			mem.size = size;
+			free(data);
+		}
+		rz_vector_push(session->memory, &mem);
 	}
 
 	free(json_str);
-	rz_json_free(reg_json);
+	rz_json_free(mem_json);
 	return true;
 }
 
-static void deserialize_memory(Sdb *db, HtUP *memory) {
-	sdb_foreach(db, deserialize_memory_cb, memory);
+static int cmp_mem_cnum(const void *a, const void *b, void *user) {
+	const RzDebugChangeMem *ma = a;
+	const RzDebugChangeMem *mb = b;
+	if (ma->cnum != mb->cnum) {
+		return (ma->cnum > mb->cnum) - (ma->cnum < mb->cnum);
+	}
+	// the sort is not stable, but the bytes are stored in load order,
+	// which keeps the writes of the same step in the order they were done
+	return (ma->data > mb->data) - (ma->data < mb->data);
+}
+
+static void deserialize_memory(Sdb *db, RzDebugSession *session) {
+	sdb_foreach(db, deserialize_memory_cb, session);
+	if (!rz_vector_empty(session->memory)) {
+		rz_vector_sort(session->memory, cmp_mem_cnum, false, NULL);
+	}
+	memory_index_rebuild(session);
 }
 
 static bool deserialize_registers_cb(void *user, const char *addr, const char *v) {
@@ -562,6 +883,83 @@ static void deserialize_registers(Sdb *db, HtUP *registers) {
 	sdb_foreach(db, deserialize_registers_cb, registers);
 }
 
+typedef struct {
+	RzDebugSnapPage *page;
+	ut32 size;
+} LoadedPage;
+
+typedef struct {
+	RzVector /*<RzDebugCheckpoint>*/ *checkpoints;
+	Sdb *pages_db; ///< Contents of the pages by their hash, NULL for older sessions
+	HtPP /*<char *, LoadedPage *>*/ *pages; ///< Pages already loaded, shared by the snaps
+} DeserializeCheckpoints;
+
+static void loaded_page_free(HtPPKv *kv) {
+	free(kv->key);
+	LoadedPage *lp = kv->value;
+	if (lp) {
+		rz_debug_snap_page_unref(lp->page);
+		free(lp);
+	}
+}
+
+static RzDebugSnapPage *deserialize_page(DeserializeCheckpoints *ctx, const char *key, ut32 size) {
+	LoadedPage *lp = ht_pp_find(ctx->pages, key, NULL);
+	if (!lp) {
+		const char *edata = ctx->pages_db ? sdb_const_get(ctx->pages_db, key, 0) : NULL;
+		if (!edata) {
+			return NULL;
+		}
+		int data_size = 0;
+		ut8 *data = sdb_decode(edata, &data_size);
+		lp = data && data_size > 0 ? RZ_NEW0(LoadedPage) : NULL;
+		if (!lp || !(lp->page = rz_debug_snap_page_new(data, data_size))) {
+			free(lp);
+			free(data);
+			return NULL;
+		}
+		free(data);
+		lp->size = data_size;
+		ht_pp_insert(ctx->pages, key, lp);
+	}
+	if (lp->size != size) {
+		return NULL;
+	}
+	lp->page->refs++;
+	return lp->page;
+}
+
+static bool deserialize_snap_pages(DeserializeCheckpoints *ctx, RzDebugSnap *snap, const RzJson *pages_json) {
+	ut64 count = ((ut64)snap->size + RZ_DEBUG_SNAP_PAGE_SIZE - 1) / RZ_DEBUG_SNAP_PAGE_SIZE;
+	if (!count || pages_json->children.count != count) {
+		return false;
+	}
+	snap->pages = RZ_NEWS0(RzDebugSnapPage *, count);
+	if (!snap->pages) {
+		return false;
+	}
+	ut64 idx = 0;
+	for (const RzJson *child = pages_json->children.first; child; child = child->next, idx++) {
+		if (child->type != RZ_JSON_STRING) {
+			return false;
+		}
+		ut32 size = RZ_MIN(RZ_DEBUG_SNAP_PAGE_SIZE, snap->size - idx * RZ_DEBUG_SNAP_PAGE_SIZE);
+		snap->pages[idx] = deserialize_page(ctx, child->str_value, size);
+		if (!snap->pages[idx]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool deserialize_snap_data(RzDebugSnap *snap, const RzJson *data_json) {
+	int data_size = 0;
+	ut8 *data = sdb_decode(data_json->str_value, &data_size);
+	bool r = data && data_size >= snap->size && rz_debug_snap_set_data(snap, data);
+	free(data);
+	return r;
+}
+
 static bool deserialize_checkpoints_cb(void *user, const char *cnum, const char *v) {
 	const RzJson *child;
 	char *json_str = strdup(v);
@@ -574,7 +972,7 @@ static bool deserialize_checkpoints_cb(void *user, const char *cnum, const char
 		return true;
 	}
 
-	RzVector *checkpoints = user;
+	DeserializeCheckpoints *ctx = user;
 	RzDebugCheckpoint checkpoint = { 0 };
 	checkpoint.cnum = (int)sdb_atoi(cnum);
 
@@ -622,8 +1020,14 @@ static bool deserialize_checkpoints_cb(void *user, const char *cnum, const char
 	for (child = snaps_json->children.first; child; child = child->next) {
 		const RzJson *namej = rz_json_get(child, "name");
 		CHECK_TYPE(namej, RZ_JSON_STRING);
-		const RzJson *dataj = rz_json_get(child, "data");
-		CHECK_TYPE(dataj, RZ_JSON_STRING);
+		// the contents are in "data" for older sessions
+		const RzJson *pagesj = rz_json_get(child, "pages");
+		const RzJson *dataj = pagesj ? NULL : rz_json_get(child, "data");
+		if (pagesj) {
+			CHECK_TYPE(pagesj, RZ_JSON_ARRAY);
+		} else {
+			CHECK_TYPE(dataj, RZ_JSON_STRING);
+		}
 		const RzJson *sizej = rz_json_get(child, "size");
 		CHECK_TYPE(sizej, RZ_JSON_INTEGER);
 		const RzJson *addrj = rz_json_get(child, "addr");
@@ -646,7 +1050,10 @@ static bool deserialize_checkpoints_cb(void *user, const char *cnum, const char
 		snap->addr = addrj->num.u_value;
 		snap->addr_end = addr_endj->num.u_value;
 		snap->size = sizej->num.u_value;
-		snap->data = sdb_decode(dataj->str_value, NULL);
+		if (!(pagesj ? deserialize_snap_pages(ctx, snap, pagesj) : deserialize_snap_data(snap, dataj))) {
+			rz_debug_snap_free(snap);
+			continue;
+		}
 		snap->perm = permj->num.s_value;
 		snap->user = userj->num.s_value;
 		snap->shared = sharedj->num.u_value;
@@ -656,12 +1063,17 @@ static bool deserialize_checkpoints_cb(void *user, const char *cnum, const char
 end:
 	free(json_str);
 	rz_json_free(chkpt_json);
-	rz_vector_push(checkpoints, &checkpoint);
+	rz_vector_push(ctx->checkpoints, &checkpoint);
 	return true;
 }
 
-static void deserialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *checkpoints) {
-	sdb_foreach(db, deserialize_checkpoints_cb, checkpoints);
+static void deserialize_checkpoints(Sdb *db, RZ_NULLABLE Sdb *pages_db, RzVector /*<RzDebugCheckpoint>*/ *checkpoints) {
+	DeserializeCheckpoints ctx = { checkpoints, pages_db, ht_pp_new(NULL, loaded_page_free, NULL) };
+	if (!ctx.pages) {
+		return;
+	}
+	sdb_foreach(db, deserialize_checkpoints_cb, &ctx);
+	ht_pp_free(ctx.pages);
 }
 
 static bool session_sdb_load_ns(Sdb *db, const char *nspath, const char *filename) {
@@ -698,6 +1110,13 @@ static Sdb *session_sdb_load(const char *path) {
 	SDB_LOAD("registers", "registers");
 	SDB_LOAD("memory", "memory");
 	SDB_LOAD("checkpoints", "checkpoints");
+	// older sessions have the contents of the snaps in the checkpoints
+	filename = rz_str_newf("%s%spages.sdb", path, RZ_SYS_DIR);
+	if (rz_file_exists(filename) && !session_sdb_load_ns(db, "pages", filename)) {
+		free(filename);
+		goto error;
+	}
+	free(filename);
 	return db;
 error:
 	sdb_free(db);
@@ -719,9 +1138,9 @@ RZ_API void rz_debug_session_deserialize(RzDebugSession *session, Sdb *db) {
 		func; \
 	} while (0)
 
-	DESERIALIZE("memory", deserialize_memory(subdb, session->memory));
+	DESERIALIZE("memory", deserialize_memory(subdb, session));
 	DESERIALIZE("registers", deserialize_registers(subdb, session->registers));
-	DESERIALIZE("checkpoints", deserialize_checkpoints(subdb, session->checkpoints));
+	DESERIALIZE("checkpoints", deserialize_checkpoints(subdb, sdb_ns(db, "pages", false), session->checkpoints));
 }
 
 RZ_API bool rz_debug_session_load(RzDebug *dbg, const char *path) {
@@ -730,8 +1149,9 @@ RZ_API bool rz_debug_session_load(RzDebug *dbg, const char *path) {
 		return false;
 	}
 	rz_debug_session_deserialize(dbg->session, db);
-	// Restore debugger to the beginning of the session
-	rz_debug_session_restore_reg_mem(dbg, 0);
+	// Restore debugger to the beginning of the session, nothing is known about the current memory
+	_restore_reg_mem(dbg, 0, true);
+	dbg->session->cnum = 0;
 	sdb_free(db);
 	return true;
 }
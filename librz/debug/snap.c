@@ -4,15 +4,92 @@
 
 #include <rz_debug.h>
 
+// number of pages read from the debuggee at once
+#define SNAP_READ_PAGES 0x100
+
+#define snap_pages_count(snap) (((ut64)(snap)->size + RZ_DEBUG_SNAP_PAGE_SIZE - 1) / RZ_DEBUG_SNAP_PAGE_SIZE)
+
+static inline ut32 snap_page_size(RzDebugSnap *snap, ut64 idx) {
+	return RZ_MIN(RZ_DEBUG_SNAP_PAGE_SIZE, snap->size - idx * RZ_DEBUG_SNAP_PAGE_SIZE);
+}
+
+/**
+ * \brief Allocate a page holding the \p size bytes in \p data, with a single reference
+ */
+RZ_API RZ_OWN RzDebugSnapPage *rz_debug_snap_page_new(RZ_NONNULL const ut8 *data, ut32 size) {
+	rz_return_val_if_fail(data, NULL);
+	RzDebugSnapPage *page = malloc(sizeof(RzDebugSnapPage) + size);
+	if (!page) {
+		return NULL;
+	}
+	page->refs = 1;
+	memcpy(page->data, data, size);
+	return page;
+}
+
+/**
+ * \brief Drop a reference to \p page, freeing it once no snapshot references it anymore
+ */
+RZ_API void rz_debug_snap_page_unref(RZ_NULLABLE RzDebugSnapPage *page) {
+	if (page && !--page->refs) {
+		free(page);
+	}
+}
+
+static void snap_pages_free(RzDebugSnap *snap) {
+	if (!snap->pages) {
+		return;
+	}
+	for (ut64 i = 0; i < snap_pages_count(snap); i++) {
+		rz_debug_snap_page_unref(snap->pages[i]);
+	}
+	RZ_FREE(snap->pages);
+}
+
+/**
+ * Stores the \p len bytes in \p data as the pages of \p snap starting at \p idx,
+ * sharing the ones that are the same in \p prev instead of copying them.
+ */
+static bool snap_pages_set(RzDebugSnap *snap, ut64 idx, const ut8 *data, ut64 len, RZ_NULLABLE RzDebugSnap *prev) {
+	for (ut64 off = 0; off < len; off += RZ_DEBUG_SNAP_PAGE_SIZE, idx++) {
+		ut32 size = snap_page_size(snap, idx);
+		RzDebugSnapPage *old = prev ? prev->pages[idx] : NULL;
+		if (old && !memcmp(old->data, data + off, size)) {
+			old->refs++;
+			snap->pages[idx] = old;
+			continue;
+		}
+		snap->pages[idx] = rz_debug_snap_page_new(data + off, size);
+		if (!snap->pages[idx]) {
+			return false;
+		}
+	}
+	return true;
+}
+
 RZ_API void rz_debug_snap_free(RzDebugSnap *snap) {
 	if (snap) {
 		free(snap->name);
-		free(snap->data);
+		snap_pages_free(snap);
 		RZ_FREE(snap);
 	}
 }
 
+/**
+ * \brief Take a snapshot of the memory of \p map
+ */
 RZ_API RzDebugSnap *rz_debug_snap_map(RzDebug *dbg, RzDebugMap *map) {
+	return rz_debug_snap_map_from(dbg, map, NULL);
+}
+
+/**
+ * \brief Take a snapshot of the memory of \p map, sharing the unchanged pages with \p prev
+ *
+ * The memory is stored in pages of RZ_DEBUG_SNAP_PAGE_SIZE bytes. If \p prev
+ * is a previous snapshot of the same map, the pages which did not change since
+ * then are shared with it instead of being copied.
+ */
+RZ_API RzDebugSnap *rz_debug_snap_map_from(RzDebug *dbg, RzDebugMap *map, RZ_NULLABLE RzDebugSnap *prev) {
 	rz_return_val_if_fail(dbg && map, NULL);
 	if (map->size < 1) {
 		eprintf("Invalid map size\n");
@@ -31,37 +108,107 @@ RZ_API RzDebugSnap *rz_debug_snap_map(RzDebug *dbg, RzDebugMap *map) {
 	snap->perm = map->perm;
 	snap->user = map->user;
 	snap->shared = map->shared;
+	if (prev && (prev->addr != snap->addr || prev->size != snap->size || !prev->pages)) {
+		prev = NULL;
+	}
 
-	snap->data = malloc(map->size);
-	if (!snap->data) {
+	ut64 count = snap_pages_count(snap);
+	snap->pages = RZ_NEWS0(RzDebugSnapPage *, count);
+	ut8 *buf = malloc(RZ_MIN(snap->size, SNAP_READ_PAGES * RZ_DEBUG_SNAP_PAGE_SIZE));
+	if (!snap->pages || !buf) {
+		free(buf);
 		rz_debug_snap_free(snap);
 		return NULL;
 	}
 	eprintf("Reading %d byte(s) from 0x%08" PFMT64x "...\n", snap->size, snap->addr);
-	dbg->iob.read_at(dbg->iob.io, snap->addr, snap->data, snap->size);
-
+	for (ut64 idx = 0; idx < count; idx += SNAP_READ_PAGES) {
+		ut64 off = idx * RZ_DEBUG_SNAP_PAGE_SIZE;
+		ut64 len = RZ_MIN(snap->size - off, SNAP_READ_PAGES * RZ_DEBUG_SNAP_PAGE_SIZE);
+		dbg->iob.read_at(dbg->iob.io, snap->addr + off, buf, len);
+		if (!snap_pages_set(snap, idx, buf, len, prev)) {
+			free(buf);
+			rz_debug_snap_free(snap);
+			return NULL;
+		}
+	}
+	free(buf);
 	return snap;
 }
 
+/**
+ * \brief Replace the contents of \p snap with the snap->size bytes in \p data
+ */
+RZ_API bool rz_debug_snap_set_data(RZ_NONNULL RzDebugSnap *snap, RZ_NONNULL const ut8 *data) {
+	rz_return_val_if_fail(snap && data, false);
+	snap_pages_free(snap);
+	snap->pages = RZ_NEWS0(RzDebugSnapPage *, snap_pages_count(snap));
+	if (!snap->pages) {
+		return false;
+	}
+	if (!snap_pages_set(snap, 0, data, snap->size, NULL)) {
+		snap_pages_free(snap);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Get the contents of \p snap as a single buffer of snap->size bytes
+ */
+RZ_API RZ_OWN ut8 *rz_debug_snap_get_data(RZ_NONNULL RzDebugSnap *snap) {
+	rz_return_val_if_fail(snap && snap->pages, NULL);
+	ut8 *data = malloc(snap->size);
+	if (!data) {
+		return NULL;
+	}
+	for (ut64 i = 0; i < snap_pages_count(snap); i++) {
+		memcpy(data + i * RZ_DEBUG_SNAP_PAGE_SIZE, snap->pages[i]->data, snap_page_size(snap, i));
+	}
+	return data;
+}
+
+/**
+ * \brief Write the memory of \p snap back to the debuggee
+ */
+RZ_API void rz_debug_snap_restore(RzDebug *dbg, RzDebugSnap *snap) {
+	rz_return_if_fail(dbg && snap && snap->pages);
+	for (ut64 i = 0; i < snap_pages_count(snap); i++) {
+		dbg->iob.write_at(dbg->iob.io, snap->addr + i * RZ_DEBUG_SNAP_PAGE_SIZE, snap->pages[i]->data, snap_page_size(snap, i));
+	}
+}
+
 RZ_API bool rz_debug_snap_contains(RzDebugSnap *snap, ut64 addr) {
 	return (snap->addr <= addr && addr >= snap->addr_end);
 }
 
 RZ_API ut8 *rz_debug_snap_get_hash(RzDebug *dbg, RzDebugSnap *snap, RzHashSize *size) {
-	ut8 *digest = rz_hash_cfg_calculate_small_block(dbg->hash, "sha256", snap->data, snap->size, size);
-	if (!digest) {
+	RzHashCfg *md = rz_hash_cfg_new_with_algo(dbg->hash, "sha256", NULL, 0);
+	if (!md) {
 		return NULL;
 	}
+	for (ut64 i = 0; i < snap_pages_count(snap); i++) {
+		rz_hash_cfg_update(md, snap->pages[i]->data, snap_page_size(snap, i));
+	}
+	rz_hash_cfg_final(md);
+	RzHashSize digest_size = 0;
+	const ut8 *result = rz_hash_cfg_get_result(md, "sha256", &digest_size);
+	ut8 *digest = result ? rz_mem_dup(result, digest_size) : NULL;
+	rz_hash_cfg_free(md);
+	if (digest && size) {
+		*size = digest_size;
+	}
 	return digest;
 }
 
 RZ_API bool rz_debug_snap_is_equal(RzDebug *dbg, RzDebugSnap *a, RzDebugSnap *b) {
-	RzHashSize digest_size = 0;
-	ut8 *a_dgst = rz_debug_snap_get_hash(dbg, a, &digest_size);
-	ut8 *b_dgst = rz_debug_snap_get_hash(dbg, b, NULL);
-
-	bool ret = a_dgst && b_dgst && !memcmp(a_dgst, b_dgst, digest_size);
-	free(a_dgst);
-	free(b_dgst);
-	return ret;
+	if (a->size != b->size) {
+		return false;
+	}
+	for (ut64 i = 0; i < snap_pages_count(a); i++) {
+		// pages shared between snapshots are equal without looking at them
+		if (a->pages[i] != b->pages[i] && memcmp(a->pages[i]->data, b->pages[i]->data, snap_page_size(a, i))) {
+			return false;
+		}
+	}
+	return true;
 }
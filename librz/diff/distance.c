@@ -4,33 +4,85 @@
 #include <rz_diff.h>
 #include <rz_util/rz_assert.h>
 
-/**
- * \brief Calculates the distance between two buffers using the Myers algorithm
+/** \file distance.c
+ * Edit distances between two buffers.
  *
- * Calculates the distance between two buffers using the Eugene W. Myers' O(ND) diff algorithm.
- * - distance:   is the minimum number of edits needed to transform A into B
- * - similarity: is a number that defines how similar/identical the 2 buffers are.
- * */
-RZ_API bool rz_diff_myers_distance(RZ_NONNULL const ut8 *a, ut32 la, RZ_NONNULL const ut8 *b, ut32 lb, RZ_NULLABLE ut32 *distance, RZ_NULLABLE double *similarity) {
-	rz_return_val_if_fail(a && b, false);
+ * Both distances are computed with bit-parallel algorithms over the shorter
+ * buffer, which is split into blocks of 64 bytes: each byte of the longer
+ * buffer updates a whole block of the dynamic programming column with a few
+ * word operations instead of one cell at a time.
+ * - Levenshtein: G. Myers, "A fast bit-vector algorithm for approximate string
+ *   matching based on dynamic programming" (1999), in the blocked form given
+ *   by H. Hyyrö, "A bit-vector algorithm for computing Levenshtein and
+ *   Damerau edit distances" (2003).
+ * - Myers (insertions and deletions only): the distance is la + lb - 2 * LCS,
+ *   with the LCS computed as in H. Hyyrö, "Bit-parallel LCS-length
+ *   computation revisited" (2004).
+ */
 
-	const ut32 length = la + lb;
-	const ut8 *ea = a + la, *eb = b + lb;
+#define WORD_BITS 64
+#define WORD_HIGH (1ULL << (WORD_BITS - 1))
 
-	for (; a < ea && b < eb && *a == *b; a++, b++) {
+#define MYERS_OND_MIN_DISTANCE 16
+
+typedef struct pattern_masks_t {
+	ut64 *peq; ///< For each byte value, the bitmask of its positions in the pattern
+	ut32 n_words; ///< Number of 64 bit blocks of the pattern
+	ut64 last_bit; ///< Bit of the last pattern byte in the last block
+} PatternMasks;
+
+static bool pattern_masks_init(PatternMasks *pm, const ut8 *pattern, ut32 size) {
+	pm->n_words = (size + WORD_BITS - 1) / WORD_BITS;
+	pm->last_bit = 1ULL << ((size - 1) % WORD_BITS);
+	if (SZT_MUL_OVFCHK(256 * sizeof(ut64), pm->n_words) ||
+		!(pm->peq = calloc(256 * (size_t)pm->n_words, sizeof(ut64)))) {
+		return false;
 	}
-	for (; a < ea && b < eb && ea[-1] == eb[-1]; ea--, eb--) {
+	for (ut32 i = 0; i < size; i++) {
+		pm->peq[(size_t)pattern[i] * pm->n_words + i / WORD_BITS] |= 1ULL << (i % WORD_BITS);
 	}
-	la = ea - a;
-	lb = eb - b;
-	ut32 *v0, *v;
+	return true;
+}
+
+static inline const ut64 *pattern_masks_get(const PatternMasks *pm, ut8 byte) {
+	return pm->peq + (size_t)byte * pm->n_words;
+}
+
+static inline ut32 popcount64(ut64 x) {
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (ut32)((x * 0x0101010101010101ULL) >> 56);
+}
+
+/**
+ * Strips the common prefix and suffix, which do not change the distances.
+ */
+static void strip_common(const ut8 **a, ut32 *la, const ut8 **b, ut32 *lb) {
+	const ut8 *ea = *a + *la, *eb = *b + *lb;
+	for (; *a < ea && *b < eb && **a == **b; (*a)++, (*b)++) {
+	}
+	for (; *a < ea && *b < eb && ea[-1] == eb[-1]; ea--, eb--) {
+	}
+	*la = ea - *a;
+	*lb = eb - *b;
+}
+
+/**
+ * Computes the distance with the Myers' O(ND) algorithm, which is faster
+ * than the bit-parallel one when the buffers are almost identical. It gives
+ * up when the distance is above \p max_distance, returning UT64_MAX.
+ */
+static bool myers_ond(const ut8 *a, ut32 la, const ut8 *b, ut32 lb, ut64 max_distance, ut64 *distance) {
 	st64 m = (st64)la + lb, di = 0, low, high, i, x, y;
-	if (m + 2 > SIZE_MAX / sizeof(st64) || !(v0 = malloc((m + 2) * sizeof(ut32)))) {
+	st64 max_di = RZ_MIN(m, (st64)max_distance);
+	st64 *v0, *v;
+	if (max_di + 2 > SIZE_MAX / (2 * sizeof(st64)) || !(v0 = malloc((2 * max_di + 3) * sizeof(st64)))) {
 		return false;
 	}
-	v = v0 + lb;
+	v = v0 + max_di + 1;
 	v[1] = 0;
-	for (di = 0; di <= m; di++) {
+	for (di = 0; di <= max_di; di++) {
 		low = -di + 2 * RZ_MAX(0, di - (st64)lb);
 		high = di - 2 * RZ_MAX(0, di - (st64)la);
 		for (i = low; i <= high; i += 2) {
@@ -46,11 +98,209 @@ RZ_API bool rz_diff_myers_distance(RZ_NONNULL const ut8 *a, ut32 la, RZ_NONNULL
 			}
 		}
 	}
+	di = -1;
 
 out:
 	free(v0);
+	*distance = di < 0 ? UT64_MAX : (ut64)di;
+	return true;
+}
+
+/**
+ * Computes the length of the longest common subsequence of \p text and the
+ * pattern in \p pm. V holds a zero for each pattern byte that is part of
+ * the LCS so far.
+ */
+static bool lcs_bitparallel(const PatternMasks *pm, ut32 pattern_size, const ut8 *text, ut32 text_size, ut32 *lcs) {
+	ut32 n_words = pm->n_words;
+	ut64 *v = malloc(n_words * sizeof(ut64));
+	if (!v) {
+		return false;
+	}
+	memset(v, 0xff, n_words * sizeof(ut64));
+	for (ut32 j = 0; j < text_size; j++) {
+		const ut64 *eq = pattern_masks_get(pm, text[j]);
+		ut64 carry = 0;
+		for (ut32 w = 0; w < n_words; w++) {
+			ut64 u = v[w] & eq[w];
+			ut64 sum = v[w] + u;
+			ut64 next = sum < u;
+			sum += carry;
+			next |= sum < carry;
+			v[w] = sum | (v[w] - u);
+			carry = next;
+		}
+	}
+	ut32 ones = 0;
+	for (ut32 w = 0; w + 1 < n_words; w++) {
+		ones += popcount64(v[w]);
+	}
+	ones += popcount64(v[n_words - 1] & (pm->last_bit | (pm->last_bit - 1)));
+	free(v);
+	*lcs = pattern_size - ones;
+	return true;
+}
+
+/**
+ * Advances one block of the Levenshtein column by one text byte.
+ *
+ * \param pv    Positive vertical deltas of the block
+ * \param mv    Negative vertical deltas of the block
+ * \param eq    Positions of the text byte in the block
+ * \param hbit  Bit of the last row of the block
+ * \param hin   Horizontal delta entering the first row of the block
+ * \return The horizontal delta of the last row of the block
+ */
+static inline int levenshtein_advance_block(ut64 *pv, ut64 *mv, ut64 eq, ut64 hbit, int hin) {
+	ut64 xv = eq | *mv;
+	if (hin < 0) {
+		eq |= 1;
+	}
+	ut64 xh = (((eq & *pv) + *pv) ^ *pv) | eq;
+	ut64 ph = *mv | ~(xh | *pv);
+	ut64 mh = *pv & xh;
+	int hout = ph & hbit ? 1 : (mh & hbit ? -1 : 0);
+	ph <<= 1;
+	mh <<= 1;
+	if (hin < 0) {
+		mh |= 1;
+	} else if (hin > 0) {
+		ph |= 1;
+	}
+	*pv = mh | ~(xv | ph);
+	*mv = ph & xv;
+	return hout;
+}
+
+/**
+ * Computes the Levenshtein distance between \p text and the pattern in \p pm.
+ *
+ * When \p max_distance is given, only the cells within \p max_distance of
+ * the main diagonal are computed: the blocks below are added when the
+ * diagonal gets close to them, starting from an upper bound of their
+ * values, and the blocks above stop being updated once the diagonal has
+ * moved past them, feeding the first active block with an upper bound too.
+ * Cells whose distance is at most \p max_distance are still exact, since
+ * their optimal paths only go through such cells.
+ * The computation stops as soon as the distance is known to be above
+ * \p max_distance, in which case UT32_MAX is returned as distance.
+ */
+static bool levenshtein_bitparallel(const PatternMasks *pm, ut32 pattern_size, const ut8 *text, ut32 text_size, ut32 max_distance, ut32 *distance) {
+	ut32 n_words = pm->n_words;
+	ut64 *pv = malloc(2 * n_words * sizeof(ut64));
+	if (!pv) {
+		return false;
+	}
+	ut64 *mv = pv + n_words;
+	ut64 k = max_distance;
+	ut32 first = 0, last = 0;
+	pv[0] = UT64_MAX;
+	mv[0] = 0;
+
+	// score is the value of the bottom row of the last active block
+	ut64 score = RZ_MIN(pattern_size, WORD_BITS);
+	for (ut32 j = 0; j < text_size; j++) {
+		// rows are 1-based, row i of the next column can be within the distance only if i <= j + 1 + k
+		while (last + 1 < n_words && (ut64)(last + 1) * WORD_BITS < j + 1 + k) {
+			last++;
+			pv[last] = UT64_MAX;
+			mv[last] = 0;
+			score += RZ_MIN(pattern_size - last * WORD_BITS, WORD_BITS);
+		}
+
+		const ut64 *eq = pattern_masks_get(pm, text[j]);
+		int h = 1;
+		for (ut32 w = first; w < last; w++) {
+			h = levenshtein_advance_block(pv + w, mv + w, eq[w], WORD_HIGH, h);
+		}
+		score += levenshtein_advance_block(pv + last, mv + last, eq[last], last + 1 == n_words ? pm->last_bit : WORD_HIGH, h);
+
+		// rows i with j + 1 - i > k are out of reach
+		while (first <= last && (ut64)RZ_MIN((first + 1) * WORD_BITS, pattern_size) + k < j + 1) {
+			first++;
+		}
+		// each remaining text byte can lower the score by one at most
+		if (first > last || (last + 1 == n_words && score > k + (text_size - j - 1))) {
+			score = UT32_MAX;
+			break;
+		}
+	}
+	free(pv);
+	*distance = last + 1 == n_words ? (ut32)score : UT32_MAX;
+	return true;
+}
+
+static bool levenshtein_distance(const ut8 *a, ut32 la, const ut8 *b, ut32 lb, ut32 max_distance, ut32 *distance) {
+	strip_common(&a, &la, &b, &lb);
+	if (la < lb) {
+		const ut8 *t = a;
+		a = b;
+		b = t;
+		ut32 l = la;
+		la = lb;
+		lb = l;
+	}
+	if (la - lb > max_distance) {
+		*distance = UT32_MAX;
+		return true;
+	} else if (!lb) {
+		*distance = la;
+		return true;
+	}
+
+	PatternMasks pm;
+	if (!pattern_masks_init(&pm, b, lb)) {
+		return false;
+	}
+	bool ret = levenshtein_bitparallel(&pm, lb, a, la, max_distance, distance);
+	free(pm.peq);
+	return ret;
+}
+
+/**
+ * \brief Calculates the distance between two buffers using the Myers algorithm
+ *
+ * Calculates the distance between two buffers using the Eugene W. Myers' O(ND) diff algorithm.
+ * - distance:   is the minimum number of edits needed to transform A into B
+ * - similarity: is a number that defines how similar/identical the 2 buffers are.
+ * */
+RZ_API bool rz_diff_myers_distance(RZ_NONNULL const ut8 *a, ut32 la, RZ_NONNULL const ut8 *b, ut32 lb, RZ_NULLABLE ut32 *distance, RZ_NULLABLE double *similarity) {
+	rz_return_val_if_fail(a && b, false);
+
+	const ut64 length = (ut64)la + lb;
+	ut64 di = 0;
+	ut32 lcs = 0;
+	strip_common(&a, &la, &b, &lb);
+	if (la < lb) {
+		const ut8 *t = a;
+		a = b;
+		b = t;
+		ut32 l = la;
+		la = lb;
+		lb = l;
+	}
+	// try first the O(ND) algorithm, while its cost stays below the bit-parallel one
+	ut64 max_ond = RZ_MAX(MYERS_OND_MIN_DISTANCE, lb / WORD_BITS);
+	if (!myers_ond(a, la, b, lb, max_ond, &di)) {
+		return false;
+	}
+	if (di == UT64_MAX) {
+		if (lb) {
+			PatternMasks pm;
+			if (!pattern_masks_init(&pm, b, lb)) {
+				return false;
+			}
+			bool ret = lcs_bitparallel(&pm, lb, a, la, &lcs);
+			free(pm.peq);
+			if (!ret) {
+				return false;
+			}
+		}
+		di = (ut64)la + lb - 2 * (ut64)lcs;
+	}
+
 	if (distance) {
-		*distance = di;
+		*distance = (ut32)di;
 	}
 	if (similarity) {
 		*similarity = length ? 1.0 - (double)di / length : 1.0;
@@ -69,46 +319,40 @@ RZ_API bool rz_diff_levenshtein_distance(RZ_NONNULL const ut8 *a, ut32 la, RZ_NO
 	rz_return_val_if_fail(a && b, false);
 
 	const ut32 length = RZ_MAX(la, lb);
-	const ut8 *ea = a + la, *eb = b + lb, *t;
-	ut32 *d, i, j;
-
-	for (; a < ea && b < eb && *a == *b; a++, b++) {
+	ut32 d = 0;
+	if (!levenshtein_distance(a, la, b, lb, UT32_MAX, &d)) {
+		return false;
 	}
-	for (; a < ea && b < eb && ea[-1] == eb[-1]; ea--, eb--) {
+
+	if (distance) {
+		*distance = d;
 	}
-	la = ea - a;
-	lb = eb - b;
-	if (la < lb) {
-		i = la;
-		la = lb;
-		lb = i;
-		t = a;
-		a = b;
-		b = t;
+	if (similarity) {
+		*similarity = length ? 1.0 - (double)d / length : 1.0;
 	}
+	return true;
+}
+
+/**
+ * \brief Checks if the Levenshtein distance between two buffers is at most \p max_distance
+ *
+ * Same as rz_diff_levenshtein_distance(), but gives up as soon as the
+ * distance is known to be above \p max_distance, which is much faster when
+ * only similar buffers are of interest.
+ *
+ * \param  max_distance  The maximum distance of interest
+ * \param  distance      Set to the distance when it is at most \p max_distance
+ * \return true if the distance is at most \p max_distance, false otherwise or on failure
+ * */
+RZ_API bool rz_diff_levenshtein_distance_within(RZ_NONNULL const ut8 *a, ut32 la, RZ_NONNULL const ut8 *b, ut32 lb, ut32 max_distance, RZ_NULLABLE ut32 *distance) {
+	rz_return_val_if_fail(a && b, false);
 
-	if (sizeof(ut32) > SIZE_MAX / (lb + 1) || !(d = malloc((lb + 1) * sizeof(ut32)))) {
+	ut32 d = 0;
+	if (!levenshtein_distance(a, la, b, lb, max_distance, &d) || d > max_distance) {
 		return false;
 	}
-	for (i = 0; i <= lb; i++) {
-		d[i] = i;
-	}
-	for (i = 0; i < la; i++) {
-		ut32 ul = d[0];
-		d[0] = i + 1;
-		for (j = 0; j < lb; j++) {
-			ut32 u = d[j + 1];
-			d[j + 1] = a[i] == b[j] ? ul : RZ_MIN(ul, RZ_MIN(d[j], u)) + 1;
-			ul = u;
-		}
-	}
-
 	if (distance) {
-		*distance = d[lb];
-	}
-	if (similarity) {
-		*similarity = length ? 1.0 - (double)d[lb] / length : 1.0;
+		*distance = d;
 	}
-	free(d);
 	return true;
 }
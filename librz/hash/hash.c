@@ -4,6 +4,7 @@
 #include "config.h"
 #include <rz_hash.h>
 #include <rz_util.h>
+#include <rz_th.h>
 #include <rz_lib.h>
 #include <xxhash.h>
 #include "algorithms/ssdeep/ssdeep.h"
@@ -418,6 +419,56 @@ RZ_API bool rz_hash_cfg_update(RZ_NONNULL RzHashCfg *md, RZ_NONNULL const ut8 *d
 	return true;
 }
 
+typedef struct {
+	const ut8 *data;
+	ut64 size;
+	RzAtomicBool *failed;
+} HashCfgUpdate;
+
+static void hash_cfg_update_config(HashCfgConfig *mdc, HashCfgUpdate *up) {
+	if (rz_atomic_bool_get(up->failed)) {
+		return;
+	}
+	if (!mdc->plugin->update(mdc->context, up->data, up->size)) {
+		RZ_LOG_ERROR("msg digest: failed to call update for %s.\n", mdc->plugin->name);
+		rz_atomic_bool_set(up->failed, true);
+	}
+}
+
+/**
+ * \brief Inserts data into each the message digest contextes in parallel
+ *
+ * Same as rz_hash_cfg_update, but every configured algorithm consumes the
+ * data on its own thread, so a single read pass of the input feeds all of
+ * them at once. This pays off only with multiple algorithms and large
+ * blocks, since the threads are started on each call.
+ * */
+RZ_API bool rz_hash_cfg_update_mt(RZ_NONNULL RzHashCfg *md, RZ_NONNULL const ut8 *data, ut64 size, size_t max_threads) {
+	rz_return_val_if_fail(md && hash_cfg_can_update(md), false);
+	if (max_threads == 1 || rz_list_length(md->configurations) < 2) {
+		return rz_hash_cfg_update(md, data, size);
+	}
+
+	HashCfgUpdate up = { .data = data, .size = size };
+	up.failed = rz_atomic_bool_new(false);
+	if (!up.failed) {
+		RZ_LOG_ERROR("msg digest: cannot allocate memory for the update status.\n");
+		return false;
+	}
+	if (!max_threads || max_threads > rz_list_length(md->configurations)) {
+		max_threads = rz_list_length(md->configurations);
+	}
+	bool res = rz_th_iterate_list(md->configurations, (RzThreadIterator)hash_cfg_update_config, max_threads, &up) &&
+		!rz_atomic_bool_get(up.failed);
+	rz_atomic_bool_free(up.failed);
+	if (!res) {
+		return false;
+	}
+
+	md->status = RZ_MSG_DIGEST_STATUS_UPDATE;
+	return true;
+}
+
 /**
  * \brief Generates the final value of the message digest contextes
  *
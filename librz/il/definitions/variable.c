@@ -33,10 +33,28 @@ RZ_API void rz_il_variable_free(RZ_NULLABLE RzILVar *var) {
 	if (!var) {
 		return;
 	}
+	rz_il_value_free(var->val);
 	free(var->name);
 	free(var);
 }
 
+/**
+ * Set the contents of \p var to \p val, if the sort of \p val matches the variable's sort.
+ *
+ * \return whether the value was successfully bound
+ */
+RZ_API bool rz_il_variable_bind(RZ_NONNULL RzILVar *var, RZ_OWN RZ_NONNULL RzILVal *val) {
+	rz_return_val_if_fail(var && val, false);
+	if (!rz_il_sort_pure_eq(var->sort, rz_il_value_get_sort(val))) {
+		RZ_LOG_ERROR("Attempted to bind mis-sorted value to variable \"%s\"\n", var->name);
+		rz_il_value_free(val);
+		return false;
+	}
+	rz_il_value_free(var->val);
+	var->val = val;
+	return true;
+}
+
 // Variable Set
 
 static void var_ht_free(HtPPKv *kv) {
@@ -44,11 +62,6 @@ static void var_ht_free(HtPPKv *kv) {
 	rz_il_variable_free(kv->value);
 }
 
-static void val_ht_free(HtPPKv *kv) {
-	free(kv->key);
-	rz_il_value_free(kv->value);
-}
-
 /**
  * Initialize \p vs as an empty variable set
  *
@@ -61,24 +74,18 @@ RZ_API bool rz_il_var_set_init(RzILVarSet *vs) {
 	rz_return_val_if_fail(vs, false);
 	memset(vs, 0, sizeof(*vs));
 	vs->vars = ht_pp_new(NULL, var_ht_free, NULL);
-	if (!vs->vars) {
-		return false;
-	}
-	vs->contents = ht_pp_new(NULL, val_ht_free, NULL);
-	if (!vs->contents) {
-		ht_pp_free(vs->vars);
-		vs->vars = NULL;
-		return false;
-	}
-	return true;
+	return vs->vars != NULL;
 }
 
 RZ_API void rz_il_var_set_fini(RzILVarSet *vs) {
 	ht_pp_free(vs->vars);
-	ht_pp_free(vs->contents);
 }
 
 RZ_API void rz_il_var_set_reset(RzILVarSet *vs) {
+	if (vs->vars && !vs->vars->count) {
+		// nothing to remove, keep the tables
+		return;
+	}
 	rz_il_var_set_fini(vs);
 	rz_il_var_set_init(vs);
 }
@@ -106,14 +113,13 @@ RZ_API RZ_BORROW RzILVar *rz_il_var_set_create_var(RzILVarSet *vs, const char *n
  */
 RZ_API RZ_OWN RZ_NULLABLE RzILVal *rz_il_var_set_remove_var(RzILVarSet *vs, const char *name) {
 	rz_return_val_if_fail(vs && name, NULL);
-	ht_pp_delete(vs->vars, name);
-	HtPPKv *kv = ht_pp_find_kv(vs->contents, name, NULL);
-	if (!kv) {
+	RzILVar *var = ht_pp_find(vs->vars, name, NULL);
+	if (!var) {
 		return NULL;
 	}
-	RzILVal *r = kv->value;
-	kv->value = NULL;
-	ht_pp_delete(vs->contents, name);
+	RzILVal *r = var->val;
+	var->val = NULL;
+	ht_pp_delete(vs->vars, name);
 	return r;
 }
 
@@ -129,17 +135,12 @@ RZ_API RZ_OWN RZ_NULLABLE RzILVal *rz_il_var_set_remove_var(RzILVarSet *vs, cons
 RZ_API bool rz_il_var_set_bind(RzILVarSet *vs, const char *name, RZ_OWN RzILVal *val) {
 	rz_return_val_if_fail(vs && name && val, false);
 	RzILVar *var = ht_pp_find(vs->vars, name, NULL);
-	if (!var || !rz_il_sort_pure_eq(var->sort, rz_il_value_get_sort(val))) {
-		if (!var) {
-			RZ_LOG_ERROR("Attempted to bind value to non-existent variable \"%s\"\n", name);
-		} else {
-			RZ_LOG_ERROR("Attempted to bind mis-sorted value to variable \"%s\"\n", name);
-		}
+	if (!var) {
+		RZ_LOG_ERROR("Attempted to bind value to non-existent variable \"%s\"\n", name);
 		rz_il_value_free(val);
 		return false;
 	}
-	ht_pp_update(vs->contents, name, val);
-	return true;
+	return rz_il_variable_bind(var, val);
 }
 
 /**
@@ -172,7 +173,8 @@ RZ_API RZ_OWN RzPVector /*<RzILVar *>*/ *rz_il_var_set_get_all(RzILVarSet *vs) {
  */
 RZ_API RZ_BORROW RzILVal *rz_il_var_set_get_value(RzILVarSet *vs, const char *name) {
 	rz_return_val_if_fail(vs && name, NULL);
-	return ht_pp_find(vs->contents, name, NULL);
+	RzILVar *var = ht_pp_find(vs->vars, name, NULL);
+	return var ? var->val : NULL;
 }
 
 /**
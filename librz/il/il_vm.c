@@ -27,6 +27,8 @@ static void free_label_kv(HtPPKv *kv) {
 RZ_API bool rz_il_vm_init(RzILVM *vm, ut64 start_addr, ut32 addr_size, bool big_endian) {
 	rz_return_val_if_fail(vm, false);
 
+	rz_pvector_init(&vm->free_bvs, free);
+	rz_pvector_init(&vm->free_bools, free);
 	if (!rz_il_var_set_init(&vm->global_vars)) {
 		rz_il_vm_fini(vm);
 		return false;
@@ -110,6 +112,9 @@ RZ_API void rz_il_vm_fini(RzILVM *vm) {
 
 	rz_pvector_free(vm->events);
 	vm->events = NULL;
+
+	rz_pvector_fini(&vm->free_bvs);
+	rz_pvector_fini(&vm->free_bools);
 }
 
 /**
@@ -266,6 +271,241 @@ RZ_API RZ_BORROW RzILVal *rz_il_vm_get_var_value(RZ_NONNULL RzILVM *vm, RzILVarK
 	return rz_il_var_set_get_value(var_set_of_kind(vm, kind), name);
 }
 
+#define RESOLVE_1(sort, s, v0) \
+	resolve_##sort(vm, op->op.s.v0);
+
+#define RESOLVE_2(sort, s, v0, v1) \
+	resolve_##sort(vm, op->op.s.v0); \
+	resolve_##sort(vm, op->op.s.v1);
+
+#define RESOLVE_3(sort, s, v0, v1, v2) \
+	resolve_##sort(vm, op->op.s.v0); \
+	resolve_##sort(vm, op->op.s.v1); \
+	resolve_##sort(vm, op->op.s.v2);
+
+static void resolve_pure(RzILVM *vm, RzILOpPure *op) {
+	if (!op) {
+		return;
+	}
+	switch (op->code) {
+	case RZ_IL_OP_VAR:
+		if (op->op.var.kind == RZ_IL_VAR_KIND_GLOBAL) {
+			op->op.var.slot = rz_il_vm_get_var(vm, RZ_IL_VAR_KIND_GLOBAL, op->op.var.v);
+		}
+		break;
+	case RZ_IL_OP_ITE:
+		RESOLVE_3(pure, ite, condition, x, y);
+		break;
+	case RZ_IL_OP_LET:
+		RESOLVE_2(pure, let, exp, body);
+		break;
+	case RZ_IL_OP_B0:
+	case RZ_IL_OP_B1:
+		break;
+	case RZ_IL_OP_INV:
+		RESOLVE_1(pure, boolinv, x);
+		break;
+	case RZ_IL_OP_AND:
+	case RZ_IL_OP_OR:
+	case RZ_IL_OP_XOR:
+		// BoolXor, BoolOr and BoolAnd shares the same struct
+		RESOLVE_2(pure, boolxor, x, y);
+		break;
+	case RZ_IL_OP_BITV:
+		break;
+	case RZ_IL_OP_MSB:
+		RESOLVE_1(pure, msb, bv);
+		break;
+	case RZ_IL_OP_LSB:
+		RESOLVE_1(pure, lsb, bv);
+		break;
+	case RZ_IL_OP_IS_ZERO:
+		RESOLVE_1(pure, is_zero, bv);
+		break;
+	case RZ_IL_OP_NEG:
+		RESOLVE_1(pure, neg, bv);
+		break;
+	case RZ_IL_OP_LOGNOT:
+		RESOLVE_1(pure, lognot, bv);
+		break;
+	case RZ_IL_OP_ADD:
+		RESOLVE_2(pure, add, x, y);
+		break;
+	case RZ_IL_OP_SUB:
+		RESOLVE_2(pure, sub, x, y);
+		break;
+	case RZ_IL_OP_MUL:
+		RESOLVE_2(pure, mul, x, y);
+		break;
+	case RZ_IL_OP_DIV:
+		RESOLVE_2(pure, div, x, y);
+		break;
+	case RZ_IL_OP_SDIV:
+		RESOLVE_2(pure, sdiv, x, y);
+		break;
+	case RZ_IL_OP_MOD:
+		RESOLVE_2(pure, mod, x, y);
+		break;
+	case RZ_IL_OP_SMOD:
+		RESOLVE_2(pure, smod, x, y);
+		break;
+	case RZ_IL_OP_LOGAND:
+		RESOLVE_2(pure, logand, x, y);
+		break;
+	case RZ_IL_OP_LOGOR:
+		RESOLVE_2(pure, logor, x, y);
+		break;
+	case RZ_IL_OP_LOGXOR:
+		RESOLVE_2(pure, logxor, x, y);
+		break;
+	case RZ_IL_OP_SHIFTR:
+		RESOLVE_3(pure, shiftr, fill_bit, x, y);
+		break;
+	case RZ_IL_OP_SHIFTL:
+		RESOLVE_3(pure, shiftl, fill_bit, x, y);
+		break;
+	case RZ_IL_OP_EQ:
+		RESOLVE_2(pure, eq, x, y);
+		break;
+	case RZ_IL_OP_SLE:
+		RESOLVE_2(pure, sle, x, y);
+		break;
+	case RZ_IL_OP_ULE:
+		RESOLVE_2(pure, ule, x, y);
+		break;
+	case RZ_IL_OP_CAST:
+		RESOLVE_2(pure, cast, fill, val);
+		break;
+	case RZ_IL_OP_APPEND:
+		RESOLVE_2(pure, append, high, low);
+		break;
+	case RZ_IL_OP_LOAD:
+		RESOLVE_1(pure, load, key);
+		break;
+	case RZ_IL_OP_LOADW:
+		RESOLVE_1(pure, loadw, key);
+		break;
+	case RZ_IL_OP_FLOAT:
+		RESOLVE_1(pure, float_, bv);
+		break;
+	case RZ_IL_OP_FBITS:
+	case RZ_IL_OP_IS_FINITE:
+	case RZ_IL_OP_IS_NAN:
+	case RZ_IL_OP_IS_INF:
+	case RZ_IL_OP_IS_FZERO:
+	case RZ_IL_OP_IS_FNEG:
+	case RZ_IL_OP_IS_FPOS:
+	case RZ_IL_OP_FNEG:
+	case RZ_IL_OP_FABS:
+		RESOLVE_1(pure, fabs, f);
+		break;
+	case RZ_IL_OP_FSUCC:
+	case RZ_IL_OP_FPRED:
+		RESOLVE_1(pure, fpred, f);
+		break;
+	case RZ_IL_OP_FCAST_INT:
+	case RZ_IL_OP_FCAST_SINT:
+	case RZ_IL_OP_FCONVERT:
+		RESOLVE_1(pure, fconvert, f);
+		break;
+	case RZ_IL_OP_FCAST_FLOAT:
+	case RZ_IL_OP_FCAST_SFLOAT:
+		RESOLVE_1(pure, fcast_sfloat, bv);
+		break;
+	case RZ_IL_OP_FREQUAL:
+		break;
+	case RZ_IL_OP_FORDER:
+		RESOLVE_2(pure, forder, x, y);
+		break;
+	case RZ_IL_OP_FROUND:
+	case RZ_IL_OP_FSQRT:
+	case RZ_IL_OP_FRSQRT:
+		RESOLVE_1(pure, fsqrt, f);
+		break;
+	case RZ_IL_OP_FADD:
+	case RZ_IL_OP_FSUB:
+	case RZ_IL_OP_FMUL:
+	case RZ_IL_OP_FDIV:
+	case RZ_IL_OP_FMOD:
+	case RZ_IL_OP_FHYPOT:
+	case RZ_IL_OP_FPOW:
+		RESOLVE_2(pure, fpow, x, y);
+		break;
+	case RZ_IL_OP_FMAD:
+		RESOLVE_3(pure, fmad, x, y, z);
+		break;
+	case RZ_IL_OP_FROOTN:
+	case RZ_IL_OP_FPOWN:
+	case RZ_IL_OP_FCOMPOUND:
+		RESOLVE_2(pure, fcompound, f, n);
+		break;
+	default:
+		break;
+	}
+}
+
+static void resolve_effect(RzILVM *vm, RzILOpEffect *op) {
+	if (!op) {
+		return;
+	}
+	switch (op->code) {
+	case RZ_IL_OP_EMPTY:
+		break;
+	case RZ_IL_OP_STORE:
+		RESOLVE_2(pure, store, key, value);
+		break;
+	case RZ_IL_OP_STOREW:
+		RESOLVE_2(pure, storew, key, value);
+		break;
+	case RZ_IL_OP_NOP:
+		break;
+	case RZ_IL_OP_SET:
+		if (!op->op.set.is_local) {
+			op->op.set.slot = rz_il_vm_get_var(vm, RZ_IL_VAR_KIND_GLOBAL, op->op.set.v);
+		}
+		RESOLVE_1(pure, set, x);
+		break;
+	case RZ_IL_OP_JMP:
+		RESOLVE_1(pure, jmp, dst);
+		break;
+	case RZ_IL_OP_GOTO:
+		break;
+	case RZ_IL_OP_SEQ:
+		RESOLVE_2(effect, seq, x, y);
+		break;
+	case RZ_IL_OP_BLK:
+		RESOLVE_2(effect, blk, data_eff, ctrl_eff);
+		break;
+	case RZ_IL_OP_REPEAT:
+		resolve_pure(vm, op->op.repeat.condition);
+		RESOLVE_1(effect, repeat, data_eff);
+		break;
+	case RZ_IL_OP_BRANCH:
+		resolve_pure(vm, op->op.branch.condition);
+		RESOLVE_2(effect, branch, true_eff, false_eff);
+		break;
+	default:
+		break;
+	}
+}
+
+#undef RESOLVE_1
+#undef RESOLVE_2
+#undef RESOLVE_3
+
+/**
+ * \brief Binds the global variables read and set by \p op to the variables of \p vm
+ *
+ * The evaluation of the resolved ops then accesses the variables directly
+ * instead of looking them up by name, which pays off for ops evaluated many
+ * times. The ops must only be evaluated by \p vm afterwards, and not after
+ * \p vm is freed.
+ */
+RZ_API void rz_il_vm_resolve_vars(RZ_NONNULL RzILVM *vm, RZ_NULLABLE RzILOpEffect *op) {
+	rz_return_if_fail(vm);
+	resolve_effect(vm, op);
+}
+
 /**
  * Find the bitvector address by given name
  * \param vm RzILVM* vm, pointer to VM
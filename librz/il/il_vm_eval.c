@@ -7,6 +7,7 @@
  */
 
 #include <rz_il/rz_il_vm.h>
+#include "il_vm_private.h"
 
 // Handler for core theory opcodes
 void *rz_il_handler_ite(RzILVM *vm, RzILOpPure *op, RzILTypePure *type);
@@ -286,6 +287,73 @@ RZ_API void rz_il_vm_clear_events(RzILVM *vm) {
 	rz_pvector_clear(vm->events);
 }
 
+/**
+ * Get a zeroed bitvector of \p length bits, reusing a released one when
+ * possible. Like any other bitvector, it can be freed with rz_bv_free().
+ */
+RZ_IPI RZ_OWN RzBitVector *rz_il_vm_bv_new(RZ_NONNULL RzILVM *vm, ut32 length) {
+	if (length > 64 || rz_pvector_empty(&vm->free_bvs)) {
+		return rz_bv_new(length);
+	}
+	RzBitVector *bv = rz_pvector_pop(&vm->free_bvs);
+	bv->bits.small_u = 0;
+	bv->len = length;
+	return bv;
+}
+
+/**
+ * Duplicate \p bv, reusing a released bitvector when possible.
+ */
+RZ_IPI RZ_OWN RzBitVector *rz_il_vm_bv_dup(RZ_NONNULL RzILVM *vm, RZ_NONNULL const RzBitVector *bv) {
+	if (bv->len > 64) {
+		return rz_bv_dup(bv);
+	}
+	RzBitVector *ret = rz_il_vm_bv_new(vm, bv->len);
+	if (ret) {
+		ret->bits.small_u = bv->bits.small_u;
+	}
+	return ret;
+}
+
+/**
+ * Give back a bitvector which is not referenced anymore, so it can be
+ * reused by rz_il_vm_bv_new() during the evaluation of the next ops.
+ */
+RZ_IPI void rz_il_vm_bv_release(RZ_NONNULL RzILVM *vm, RZ_NULLABLE RZ_OWN RzBitVector *bv) {
+	if (!bv) {
+		return;
+	}
+	if (bv->len > 64 || rz_pvector_len(&vm->free_bvs) >= RZ_IL_VM_FREE_VALUES_MAX || !rz_pvector_push(&vm->free_bvs, bv)) {
+		rz_bv_free(bv);
+	}
+}
+
+/**
+ * Get a bool set to \p b, reusing a released one when possible.
+ * Like any other bool, it can be freed with rz_il_bool_free().
+ */
+RZ_IPI RZ_OWN RzILBool *rz_il_vm_bool_new(RZ_NONNULL RzILVM *vm, bool b) {
+	if (rz_pvector_empty(&vm->free_bools)) {
+		return rz_il_bool_new(b);
+	}
+	RzILBool *ret = rz_pvector_pop(&vm->free_bools);
+	ret->b = b;
+	return ret;
+}
+
+/**
+ * Give back a bool which is not referenced anymore, so it can be
+ * reused by rz_il_vm_bool_new().
+ */
+RZ_IPI void rz_il_vm_bool_release(RZ_NONNULL RzILVM *vm, RZ_NULLABLE RZ_OWN RzILBool *b) {
+	if (!b) {
+		return;
+	}
+	if (rz_pvector_len(&vm->free_bools) >= RZ_IL_VM_FREE_VALUES_MAX || !rz_pvector_push(&vm->free_bools, b)) {
+		rz_il_bool_free(b);
+	}
+}
+
 /**
  * Execute the opcodes uplifted from raw instructions.A list may contain multiple opcode trees
  * \param vm pointer to VM
@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef RZ_IL_VM_PRIVATE_H
+#define RZ_IL_VM_PRIVATE_H
+
+#include <rz_il/rz_il_vm.h>
+
+/**
+ * Maximum number of released values kept by the VM for reuse, per type.
+ */
+#define RZ_IL_VM_FREE_VALUES_MAX 64
+
+RZ_IPI RZ_OWN RzBitVector *rz_il_vm_bv_new(RZ_NONNULL RzILVM *vm, ut32 length);
+RZ_IPI RZ_OWN RzBitVector *rz_il_vm_bv_dup(RZ_NONNULL RzILVM *vm, RZ_NONNULL const RzBitVector *bv);
+RZ_IPI void rz_il_vm_bv_release(RZ_NONNULL RzILVM *vm, RZ_NULLABLE RZ_OWN RzBitVector *bv);
+RZ_IPI RZ_OWN RzILBool *rz_il_vm_bool_new(RZ_NONNULL RzILVM *vm, bool b);
+RZ_IPI void rz_il_vm_bool_release(RZ_NONNULL RzILVM *vm, RZ_NULLABLE RZ_OWN RzILBool *b);
+
+#endif // RZ_IL_VM_PRIVATE_H
@@ -3,14 +3,90 @@
 
 #include <rz_il/rz_il_opcodes.h>
 #include <rz_il/rz_il_vm.h>
+#include "il_vm_private.h"
+
+/*
+ * Bitvectors of up to 64 bits hold their value inline, so the handlers below
+ * compute the results for them directly in the storage of the first operand,
+ * and give the other operands back to the VM for reuse, which avoids any
+ * allocation during the evaluation. Longer bitvectors use the generic
+ * rz_bv_* functions.
+ */
+
+#define SMALL_MASK(len) (UT64_MAX >> (64 - (len)))
+
+typedef ut64 (*SmallBinOp)(ut64 x, ut64 y);
+typedef RzBitVector *(*BinOp)(RzBitVector *x, RzBitVector *y);
+
+static inline bool is_small_pair(const RzBitVector *x, const RzBitVector *y) {
+	return x->len <= 64 && x->len == y->len;
+}
+
+/**
+ * Evaluates both operands and applies the operation to them, in place with
+ * \p small_op when possible, otherwise with \p op.
+ */
+static RzBitVector *eval_binop(RzILVM *vm, RzILOpBitVector *x_op, RzILOpBitVector *y_op, SmallBinOp small_op, BinOp op) {
+	RzBitVector *x = rz_il_evaluate_bitv(vm, x_op);
+	RzBitVector *y = rz_il_evaluate_bitv(vm, y_op);
+	RzBitVector *result = NULL;
+	if (x && y) {
+		if (small_op && is_small_pair(x, y)) {
+			x->bits.small_u = small_op(x->bits.small_u, y->bits.small_u) & SMALL_MASK(x->len);
+			result = x;
+			x = NULL;
+		} else {
+			result = op(x, y);
+		}
+	}
+	rz_il_vm_bv_release(vm, x);
+	rz_il_vm_bv_release(vm, y);
+	return result;
+}
+
+static ut64 small_add(ut64 x, ut64 y) {
+	return x + y;
+}
+
+static ut64 small_sub(ut64 x, ut64 y) {
+	return x - y;
+}
+
+static ut64 small_mul(ut64 x, ut64 y) {
+	return x * y;
+}
+
+static ut64 small_mod(ut64 x, ut64 y) {
+	return y ? x % y : x;
+}
+
+static ut64 small_and(ut64 x, ut64 y) {
+	return x & y;
+}
+
+static ut64 small_or(ut64 x, ut64 y) {
+	return x | y;
+}
+
+static ut64 small_xor(ut64 x, ut64 y) {
+	return x ^ y;
+}
+
+static RzBitVector *bv_add(RzBitVector *x, RzBitVector *y) {
+	return rz_bv_add(x, y, NULL);
+}
+
+static RzBitVector *bv_sub(RzBitVector *x, RzBitVector *y) {
+	return rz_bv_sub(x, y, NULL);
+}
 
 void *rz_il_handler_msb(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsMsb *op_msb = &op->op.msb;
 	RzBitVector *bv = rz_il_evaluate_bitv(vm, op_msb->bv);
-	RzILBool *result = bv ? rz_il_bool_new(rz_bv_msb(bv)) : NULL;
-	rz_bv_free(bv);
+	RzILBool *result = bv ? rz_il_vm_bool_new(vm, rz_bv_msb(bv)) : NULL;
+	rz_il_vm_bv_release(vm, bv);
 
 	*type = RZ_IL_TYPE_PURE_BOOL;
 	return result;
@@ -21,8 +97,8 @@ void *rz_il_handler_lsb(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 
 	RzILOpArgsLsb *op_lsb = &op->op.lsb;
 	RzBitVector *bv = rz_il_evaluate_bitv(vm, op_lsb->bv);
-	RzILBool *result = bv ? rz_il_bool_new(rz_bv_lsb(bv)) : NULL;
-	rz_bv_free(bv);
+	RzILBool *result = bv ? rz_il_vm_bool_new(vm, rz_bv_lsb(bv)) : NULL;
+	rz_il_vm_bv_release(vm, bv);
 
 	*type = RZ_IL_TYPE_PURE_BOOL;
 	return result;
@@ -33,8 +109,8 @@ void *rz_il_handler_is_zero(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type)
 
 	RzILOpArgsLsb *op_lsb = &op->op.lsb;
 	RzBitVector *bv = rz_il_evaluate_bitv(vm, op_lsb->bv);
-	RzILBool *result = bv ? rz_il_bool_new(rz_bv_is_zero_vector(bv)) : NULL;
-	rz_bv_free(bv);
+	RzILBool *result = bv ? rz_il_vm_bool_new(vm, rz_bv_is_zero_vector(bv)) : NULL;
+	rz_il_vm_bv_release(vm, bv);
 
 	*type = RZ_IL_TYPE_PURE_BOOL;
 	return result;
@@ -46,8 +122,15 @@ void *rz_il_handler_neg(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	RzILOpArgsNeg *neg = &op->op.neg;
 
 	RzBitVector *bv_arg = rz_il_evaluate_bitv(vm, neg->bv);
-	RzBitVector *bv_result = bv_arg ? rz_bv_neg(bv_arg) : NULL;
-	rz_bv_free(bv_arg);
+	RzBitVector *bv_result = NULL;
+	if (bv_arg && bv_arg->len <= 64) {
+		bv_arg->bits.small_u = (0 - bv_arg->bits.small_u) & SMALL_MASK(bv_arg->len);
+		bv_result = bv_arg;
+		bv_arg = NULL;
+	} else if (bv_arg) {
+		bv_result = rz_bv_neg(bv_arg);
+	}
+	rz_il_vm_bv_release(vm, bv_arg);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return bv_result;
@@ -59,8 +142,15 @@ void *rz_il_handler_logical_not(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *t
 	RzILOpArgsLogNot *op_not = &op->op.lognot;
 
 	RzBitVector *bv = rz_il_evaluate_bitv(vm, op_not->bv);
-	RzBitVector *result = bv ? rz_bv_not(bv) : NULL;
-	rz_bv_free(bv);
+	RzBitVector *result = NULL;
+	if (bv && bv->len <= 64) {
+		bv->bits.small_u = ~bv->bits.small_u & SMALL_MASK(bv->len);
+		result = bv;
+		bv = NULL;
+	} else if (bv) {
+		result = rz_bv_not(bv);
+	}
+	rz_il_vm_bv_release(vm, bv);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -73,9 +163,9 @@ void *rz_il_handler_eq(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 
 	RzBitVector *x = rz_il_evaluate_bitv(vm, op_sle->x);
 	RzBitVector *y = rz_il_evaluate_bitv(vm, op_sle->y);
-	RzILBool *result = x && y ? rz_il_bool_new(rz_bv_eq(x, y)) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzILBool *result = x && y ? rz_il_vm_bool_new(vm, rz_bv_eq(x, y)) : NULL;
+	rz_il_vm_bv_release(vm, x);
+	rz_il_vm_bv_release(vm, y);
 
 	*type = RZ_IL_TYPE_PURE_BOOL;
 	return result;
@@ -88,9 +178,9 @@ void *rz_il_handler_sle(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 
 	RzBitVector *x = rz_il_evaluate_bitv(vm, op_sle->x);
 	RzBitVector *y = rz_il_evaluate_bitv(vm, op_sle->y);
-	RzILBool *result = x && y ? rz_il_bool_new(rz_bv_sle(x, y)) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzILBool *result = x && y ? rz_il_vm_bool_new(vm, rz_bv_sle(x, y)) : NULL;
+	rz_il_vm_bv_release(vm, x);
+	rz_il_vm_bv_release(vm, y);
 
 	*type = RZ_IL_TYPE_PURE_BOOL;
 	return result;
@@ -103,9 +193,9 @@ void *rz_il_handler_ule(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 
 	RzBitVector *x = rz_il_evaluate_bitv(vm, op_ule->x);
 	RzBitVector *y = rz_il_evaluate_bitv(vm, op_ule->y);
-	RzILBool *result = x && y ? rz_il_bool_new(rz_bv_ule(x, y)) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzILBool *result = x && y ? rz_il_vm_bool_new(vm, rz_bv_ule(x, y)) : NULL;
+	rz_il_vm_bv_release(vm, x);
+	rz_il_vm_bv_release(vm, y);
 
 	*type = RZ_IL_TYPE_PURE_BOOL;
 	return result;
@@ -115,13 +205,7 @@ void *rz_il_handler_add(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsAdd *op_add = &op->op.add;
-
-	RzBitVector *x = rz_il_evaluate_bitv(vm, op_add->x);
-	RzBitVector *y = rz_il_evaluate_bitv(vm, op_add->y);
-	RzBitVector *result = x && y ? rz_bv_add(x, y, NULL) : NULL;
-
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzBitVector *result = eval_binop(vm, op_add->x, op_add->y, small_add, bv_add);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -134,9 +218,17 @@ void *rz_il_handler_append(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type)
 
 	RzBitVector *high = rz_il_evaluate_bitv(vm, op_append->high);
 	RzBitVector *low = rz_il_evaluate_bitv(vm, op_append->low);
-	RzBitVector *result = high && low ? rz_bv_append(high, low) : NULL;
-	rz_bv_free(low);
-	rz_bv_free(high);
+	RzBitVector *result = NULL;
+	if (high && low && (ut64)high->len + low->len <= 64) {
+		low->bits.small_u |= high->bits.small_u << low->len;
+		low->len += high->len;
+		result = low;
+		low = NULL;
+	} else if (high && low) {
+		result = rz_bv_append(high, low);
+	}
+	rz_il_vm_bv_release(vm, low);
+	rz_il_vm_bv_release(vm, high);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -146,12 +238,7 @@ void *rz_il_handler_logical_and(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *t
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsAdd *op_add = &op->op.add;
-
-	RzBitVector *x = rz_il_evaluate_bitv(vm, op_add->x);
-	RzBitVector *y = rz_il_evaluate_bitv(vm, op_add->y);
-	RzBitVector *result = x && y ? rz_bv_and(x, y) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzBitVector *result = eval_binop(vm, op_add->x, op_add->y, small_and, rz_bv_and);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -161,12 +248,7 @@ void *rz_il_handler_logical_or(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *ty
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsAdd *op_add = &op->op.add;
-
-	RzBitVector *x = rz_il_evaluate_bitv(vm, op_add->x);
-	RzBitVector *y = rz_il_evaluate_bitv(vm, op_add->y);
-	RzBitVector *result = x && y ? rz_bv_or(x, y) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzBitVector *result = eval_binop(vm, op_add->x, op_add->y, small_or, rz_bv_or);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -176,12 +258,7 @@ void *rz_il_handler_logical_xor(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *t
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsAdd *op_add = &op->op.add;
-
-	RzBitVector *x = rz_il_evaluate_bitv(vm, op_add->x);
-	RzBitVector *y = rz_il_evaluate_bitv(vm, op_add->y);
-	RzBitVector *result = x && y ? rz_bv_xor(x, y) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzBitVector *result = eval_binop(vm, op_add->x, op_add->y, small_xor, rz_bv_xor);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -191,12 +268,7 @@ void *rz_il_handler_sub(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsSub *op_sub = &op->op.sub;
-
-	RzBitVector *x = rz_il_evaluate_bitv(vm, op_sub->x);
-	RzBitVector *y = rz_il_evaluate_bitv(vm, op_sub->y);
-	RzBitVector *result = x && y ? rz_bv_sub(x, y, NULL) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzBitVector *result = eval_binop(vm, op_sub->x, op_sub->y, small_sub, bv_sub);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -206,13 +278,7 @@ void *rz_il_handler_mul(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsMul *op_mul = &op->op.mul;
-
-	RzBitVector *x = rz_il_evaluate_bitv(vm, op_mul->x);
-	RzBitVector *y = rz_il_evaluate_bitv(vm, op_mul->y);
-	RzBitVector *result = x && y ? rz_bv_mul(x, y) : NULL;
-
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzBitVector *result = eval_binop(vm, op_mul->x, op_mul->y, small_mul, rz_bv_mul);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -228,16 +294,20 @@ void *rz_il_handler_div(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	RzBitVector *result = NULL;
 	if (x && y) {
 		if (rz_bv_is_zero_vector(y)) {
-			result = rz_bv_new(y->len);
+			result = rz_il_vm_bv_new(vm, y->len);
 			rz_bv_set_all(result, true);
 			rz_il_vm_event_add(vm, rz_il_event_exception_new("division by zero"));
+		} else if (is_small_pair(x, y)) {
+			x->bits.small_u /= y->bits.small_u;
+			result = x;
+			x = NULL;
 		} else {
 			result = rz_bv_div(x, y);
 		}
 	}
 
-	rz_bv_free(x);
-	rz_bv_free(y);
+	rz_il_vm_bv_release(vm, x);
+	rz_il_vm_bv_release(vm, y);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -247,12 +317,7 @@ void *rz_il_handler_sdiv(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsSdiv *op_sdiv = &op->op.sdiv;
-
-	RzBitVector *x = rz_il_evaluate_bitv(vm, op_sdiv->x);
-	RzBitVector *y = rz_il_evaluate_bitv(vm, op_sdiv->y);
-	RzBitVector *result = x && y ? rz_bv_sdiv(x, y) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzBitVector *result = eval_binop(vm, op_sdiv->x, op_sdiv->y, NULL, rz_bv_sdiv);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -262,12 +327,7 @@ void *rz_il_handler_mod(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsMod *op_mod = &op->op.mod;
-
-	RzBitVector *x = rz_il_evaluate_bitv(vm, op_mod->x);
-	RzBitVector *y = rz_il_evaluate_bitv(vm, op_mod->y);
-	RzBitVector *result = x && y ? rz_bv_mod(x, y) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzBitVector *result = eval_binop(vm, op_mod->x, op_mod->y, small_mod, rz_bv_mod);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -277,17 +337,38 @@ void *rz_il_handler_smod(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsSmod *op_smod = &op->op.smod;
-
-	RzBitVector *x = rz_il_evaluate_bitv(vm, op_smod->x);
-	RzBitVector *y = rz_il_evaluate_bitv(vm, op_smod->y);
-	RzBitVector *result = x && y ? rz_bv_smod(x, y) : NULL;
-	rz_bv_free(x);
-	rz_bv_free(y);
+	RzBitVector *result = eval_binop(vm, op_smod->x, op_smod->y, NULL, rz_bv_smod);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
 }
 
+/**
+ * Shifts \p bv in place, by \p shift bits to the left or to the right,
+ * filling the new bits with \p fill_bit.
+ */
+static void shift_fill(RzBitVector *bv, ut32 shift, bool fill_bit, bool left) {
+	if (bv->len > 64) {
+		if (left) {
+			rz_bv_lshift_fill(bv, shift, fill_bit);
+		} else {
+			rz_bv_rshift_fill(bv, shift, fill_bit);
+		}
+		return;
+	}
+	ut64 mask = SMALL_MASK(bv->len);
+	ut64 fill = fill_bit ? mask : 0;
+	if (!shift) {
+		return;
+	} else if (shift >= bv->len) {
+		bv->bits.small_u = fill;
+	} else if (left) {
+		bv->bits.small_u = ((bv->bits.small_u << shift) | (fill >> (bv->len - shift))) & mask;
+	} else {
+		bv->bits.small_u = (bv->bits.small_u >> shift) | ((fill << (bv->len - shift)) & mask);
+	}
+}
+
 void *rz_il_handler_shiftl(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 
@@ -299,12 +380,13 @@ void *rz_il_handler_shiftl(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type)
 
 	RzBitVector *result = NULL;
 	if (bv && shift && fill_bit) {
-		result = rz_bv_dup(bv);
-		rz_bv_lshift_fill(result, rz_bv_to_ut32(shift), fill_bit->b);
+		shift_fill(bv, rz_bv_to_ut32(shift), fill_bit->b, true);
+		result = bv;
+		bv = NULL;
 	}
-	rz_bv_free(shift);
-	rz_bv_free(bv);
-	rz_il_bool_free(fill_bit);
+	rz_il_vm_bv_release(vm, shift);
+	rz_il_vm_bv_release(vm, bv);
+	rz_il_vm_bool_release(vm, fill_bit);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -321,13 +403,14 @@ void *rz_il_handler_shiftr(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type)
 
 	RzBitVector *result = NULL;
 	if (bv && shift && fill_bit) {
-		result = rz_bv_dup(bv);
-		rz_bv_rshift_fill(result, rz_bv_to_ut32(shift), fill_bit->b);
+		shift_fill(bv, rz_bv_to_ut32(shift), fill_bit->b, false);
+		result = bv;
+		bv = NULL;
 	}
 
-	rz_bv_free(shift);
-	rz_bv_free(bv);
-	rz_il_bool_free(fill_bit);
+	rz_il_vm_bv_release(vm, shift);
+	rz_il_vm_bv_release(vm, bv);
+	rz_il_vm_bool_release(vm, fill_bit);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return result;
@@ -337,7 +420,7 @@ void *rz_il_handler_bitv(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 	RzILOpArgsBv *op_bitv = &op->op.bitv;
 
-	RzBitVector *bv = rz_bv_dup(op_bitv->value);
+	RzBitVector *bv = rz_il_vm_bv_dup(vm, op_bitv->value);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return bv;
@@ -353,15 +436,26 @@ void *rz_il_handler_cast(RzILVM *vm, RzILOpBitVector *op, RzILTypePure *type) {
 	}
 	RzBitVector *bv = rz_il_evaluate_bitv(vm, op_cast->val);
 	if (!bv) {
+		rz_il_vm_bool_release(vm, fill);
 		return NULL;
 	}
 
-	RzBitVector *ret = rz_bv_new(op_cast->length);
-	rz_bv_set_all(ret, fill->b);
-	rz_bv_copy_nbits(bv, 0, ret, 0, RZ_MIN(bv->len, ret->len));
+	RzBitVector *ret;
+	if (bv->len <= 64 && op_cast->length && op_cast->length <= 64) {
+		ut64 keep = SMALL_MASK(RZ_MIN(bv->len, op_cast->length));
+		ut64 value = (fill->b ? ~keep : 0) | (bv->bits.small_u & keep);
+		bv->bits.small_u = value & SMALL_MASK(op_cast->length);
+		bv->len = op_cast->length;
+		ret = bv;
+		bv = NULL;
+	} else {
+		ret = rz_bv_new(op_cast->length);
+		rz_bv_set_all(ret, fill->b);
+		rz_bv_copy_nbits(bv, 0, ret, 0, RZ_MIN(bv->len, ret->len));
+	}
 
-	rz_il_bool_free(fill);
-	rz_bv_free(bv);
+	rz_il_vm_bool_release(vm, fill);
+	rz_il_vm_bv_release(vm, bv);
 
 	*type = RZ_IL_TYPE_PURE_BITVECTOR;
 	return ret;
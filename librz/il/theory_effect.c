@@ -4,25 +4,29 @@
 
 #include <rz_il/rz_il_opcodes.h>
 #include <rz_il/rz_il_vm.h>
+#include "il_vm_private.h"
 
 static RzILEvent *il_event_new_write_from_var(RzILVM *vm, RzILVar *var, RzILVal *new_val) {
 	rz_return_val_if_fail(vm && var && new_val, NULL);
-	RzILVal *old_val = rz_il_vm_get_var_value(vm, RZ_IL_VAR_KIND_GLOBAL, var->name);
-	if (!old_val) {
+	if (!var->val) {
 		return NULL;
 	}
-	return rz_il_event_var_write_new(var->name, old_val, new_val);
+	return rz_il_event_var_write_new(var->name, var->val, new_val);
 }
 
-static void rz_il_set(RzILVM *vm, const char *var_name, bool is_local, RZ_OWN RzILVal *val) {
-	if (is_local) {
-		rz_il_vm_set_local_var(vm, var_name, val);
-	} else {
-		RzILVar *var = rz_il_vm_get_var(vm, RZ_IL_VAR_KIND_GLOBAL, var_name);
-		RzILEvent *evt = il_event_new_write_from_var(vm, var, val);
-		rz_il_vm_event_add(vm, evt);
-		rz_il_vm_set_global_var(vm, var_name, val);
+static void rz_il_set(RzILVM *vm, const RzILOpArgsSet *set_op, RZ_OWN RzILVal *val) {
+	if (set_op->is_local) {
+		rz_il_vm_set_local_var(vm, set_op->v, val);
+		return;
+	}
+	RzILVar *var = set_op->slot ? set_op->slot : rz_il_vm_get_var(vm, RZ_IL_VAR_KIND_GLOBAL, set_op->v);
+	if (!var) {
+		// reports the missing variable
+		rz_il_vm_set_global_var(vm, set_op->v, val);
+		return;
 	}
+	rz_il_vm_event_add(vm, il_event_new_write_from_var(vm, var, val));
+	rz_il_variable_bind(var, val);
 }
 
 bool rz_il_handler_empty(RzILVM *vm, RzILOpEffect *op) {
@@ -45,7 +49,7 @@ bool rz_il_handler_set(RzILVM *vm, RzILOpEffect *op) {
 	if (!val) {
 		return false;
 	}
-	rz_il_set(vm, set_op->v, set_op->is_local, val);
+	rz_il_set(vm, set_op, val);
 	return true;
 }
 
@@ -113,9 +117,9 @@ bool rz_il_handler_repeat(RzILVM *vm, RzILOpEffect *op) {
 			res = false;
 			break;
 		}
-		rz_il_bool_free(condition);
+		rz_il_vm_bool_release(vm, condition);
 	}
-	rz_il_bool_free(condition);
+	rz_il_vm_bool_release(vm, condition);
 
 	return res;
 }
@@ -135,7 +139,7 @@ bool rz_il_handler_branch(RzILVM *vm, RzILOpEffect *op) {
 	} else {
 		ret = rz_il_evaluate_effect(vm, op_branch->false_eff);
 	}
-	rz_il_bool_free(condition);
+	rz_il_vm_bool_release(vm, condition);
 
 	return ret;
 }
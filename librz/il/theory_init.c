@@ -3,6 +3,7 @@
 
 #include <rz_il/rz_il_opcodes.h>
 #include <rz_il/rz_il_vm.h>
+#include "il_vm_private.h"
 
 void *rz_il_handler_ite(RzILVM *vm, RzILOpPure *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
@@ -19,7 +20,7 @@ void *rz_il_handler_ite(RzILVM *vm, RzILOpPure *op, RzILTypePure *type) {
 	} else {
 		ret = rz_il_evaluate_pure(vm, op_ite->y, type); // false branch
 	}
-	rz_il_bool_free(condition);
+	rz_il_vm_bool_release(vm, condition);
 	return ret;
 }
 
@@ -27,7 +28,7 @@ void *rz_il_handler_var(RzILVM *vm, RzILOpPure *op, RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 
 	RzILOpArgsVar *var_op = &op->op.var;
-	RzILVal *val = rz_il_vm_get_var_value(vm, var_op->kind, var_op->v);
+	RzILVal *val = var_op->slot ? var_op->slot->val : rz_il_vm_get_var_value(vm, var_op->kind, var_op->v);
 	if (!val) {
 		RZ_LOG_ERROR("RzIL: reading value of variable \"%s\" of kind %s failed.\n",
 			var_op->v, rz_il_var_kind_name(var_op->kind));
@@ -42,11 +43,11 @@ void *rz_il_handler_var(RzILVM *vm, RzILOpPure *op, RzILTypePure *type) {
 	switch (val->type) {
 	case RZ_IL_TYPE_PURE_BOOL:
 		*type = RZ_IL_TYPE_PURE_BOOL;
-		ret = rz_il_bool_new(val->data.b->b);
+		ret = rz_il_vm_bool_new(vm, val->data.b->b);
 		break;
 	case RZ_IL_TYPE_PURE_BITVECTOR:
 		*type = RZ_IL_TYPE_PURE_BITVECTOR;
-		ret = rz_bv_dup(val->data.bv);
+		ret = rz_il_vm_bv_dup(vm, val->data.bv);
 		break;
 	case RZ_IL_TYPE_PURE_FLOAT:
 		*type = RZ_IL_TYPE_PURE_FLOAT;
@@ -449,6 +449,36 @@ typedef struct rz_analysis_hint_cb_t {
 
 typedef struct rz_analysis_il_vm_t RzAnalysisILVM;
 
+#define RZ_ANALYSIS_OP_CACHE_MAX_OP_SIZE 32
+
+#define RZ_ANALYSIS_OP_CACHE_DEFAULT_SIZE 16384
+
+#define RZ_ANALYSIS_IL_VM_CACHE_DEFAULT_SIZE 16384
+
+/**
+ * \brief Bounded, address-keyed store of already decoded RzAnalysisOp.
+ *
+ * All the entries were decoded with the same plugin, cpu, os, endianness, gp, segment granularity
+ * and register profile.
+ * When full, the oldest inserted entries are evicted first.
+ */
+typedef struct rz_analysis_op_cache_t {
+	HtUP /*<ut64, OpCacheEntry *>*/ *entries;
+	RzVector /*<ut64>*/ order; ///< Addresses in insertion order, used as a ring to evict the oldest entries
+	ut32 order_pos; ///< Next slot of order to reuse once the ring is full
+	ut32 max_entries; ///< Maximum number of stored ops, 0 disables the cache
+	ut64 hits; ///< Number of lookups answered by the cache
+	ut64 misses; ///< Number of lookups that required to decode the op
+	const struct rz_analysis_plugin_t *plugin; ///< Plugin used to decode the stored ops
+	char *cpu; ///< Cpu used to decode the stored ops
+	char *os; ///< Os used to decode the stored ops
+	int big_endian; ///< Endianness used to decode the stored ops
+	ut64 gp; ///< Global pointer used to decode the stored ops
+	int seggrn; ///< Segment granularity used to decode the stored ops
+	const struct rz_reg_t *reg; ///< Register profile the RzRegItem of the stored ops belong to
+	ut32 reg_gen; ///< Value of reg->items_gen when the first op was stored
+} RzAnalysisOpCache;
+
 typedef struct {
 	HtUP /*<ut64, RzAnalysisDwarfFunction *>*/ *function_by_offset; ///< Store all functions parsed from DWARF by DIE offset
 	HtUP /*<ut64, const RzAnalysisDwarfFunction *>*/ *function_by_addr; ///< Store all functions parsed from DWARF by address (some functions may have the same address)
@@ -498,8 +528,7 @@ typedef struct rz_analysis_t {
 	RzList /*<RzAnalysisPlugin *>*/ *plugins;
 	Sdb *sdb_noret;
 	Sdb *sdb_fmts;
-	HtUP *ht_xrefs_from;
-	HtUP *ht_xrefs_to;
+	struct rz_analysis_xref_store_t *xref_store;
 	bool recursive_noreturn; // analysis.rnr
 	// moved from RzAnalysisFcn
 	Sdb *sdb; // root
@@ -520,6 +549,7 @@ typedef struct rz_analysis_t {
 	RzListComparator columnSort;
 	bool (*log)(struct rz_analysis_t *analysis, const char *msg);
 	bool (*read_at)(struct rz_analysis_t *analysis, ut64 addr, ut8 *buf, int len);
+	void *read_at_user; ///< Opaque data for read_at, owned by whoever set the callback
 	int seggrn;
 	RzFlagGetAtAddr flag_get;
 	RzEvent *ev;
@@ -535,6 +565,7 @@ typedef struct rz_analysis_t {
 	RzAnalysisDebugInfo *debug_info; ///< store all debug info parsed from DWARF, etc..
 	ut64 cmpval; ///< last compare value for jump table.
 	ut64 lea_jmptbl_ip; ///< jump table x86 lea ip
+	RzAnalysisOpCache *op_cache; ///< already decoded ops, reused by rz_analysis_op()
 } RzAnalysis;
 
 typedef enum rz_analysis_addr_hint_type_t {
@@ -899,6 +930,7 @@ typedef struct rz_analysis_op_t {
 	int id; /* instruction id */
 	bool eob; /* end of block (boolean) */
 	bool sign; /* operates on signed values, false by default */
+	bool reads_memory; /* decoding read bytes out of the op with analysis->read_at, so it may change even if the op bytes do not */
 	/* Run N instructions before executing the current one */
 	int delay; /* delay N slots (mips, ..)*/
 	ut64 jump; /* true jmp */
@@ -1000,6 +1032,9 @@ typedef struct rz_analysis_ref_t {
 	ut64 to;
 	RzAnalysisXRefType type;
 } RzAnalysisXRef;
+
+typedef struct rz_analysis_xref_store_t RzAnalysisXRefStore;
+typedef bool (*RzAnalysisXRefCb)(const RzAnalysisXRef *xref, void *user);
 RZ_API const char *rz_analysis_ref_type_tostring(RzAnalysisXRefType t);
 
 /* represents a reference line from one address (from) to another (to) */
@@ -1263,6 +1298,8 @@ struct rz_analysis_il_vm_t {
 	RZ_NONNULL RzILVM *vm; ///< low-level vm to execute IL code
 	RZ_NONNULL RzBuffer *io_buf; ///< buffer to use for memory 0 (io)
 	RZ_NONNULL RzILRegBinding *reg_binding; ///< specifies which (global) variables are bound to registers
+	RZ_NULLABLE struct rz_analysis_il_lift_cache_t *lift_cache; ///< effects already lifted by address, reused while the bytes at the address do not change
+	ut32 lift_cache_max_entries; ///< number of lifted effects kept before dropping them all, 0 to lift every instruction again
 } /* RzAnalysisILVM */;
 
 typedef enum {
@@ -1350,6 +1387,7 @@ typedef struct rz_analysis_plugin_t {
 	int bits;
 	int esil; // can do esil or not
 	int fileformat_type;
+	bool op_reentrant; ///< op() only depends on its arguments and plugin_data (unless it sets RzAnalysisOp.reads_memory), thus its results can be cached and separate RzAnalysis instances can decode concurrently
 	bool (*init)(void **user);
 	bool (*fini)(void *user);
 	// int (*reset_counter) (RzAnalysis *analysis, ut64 start_addr);
@@ -1602,6 +1640,17 @@ RZ_API int rz_analysis_op(RZ_NONNULL RzAnalysis *analysis, RZ_OUT RzAnalysisOp *
 RZ_API RzAnalysisOp *rz_analysis_op_hexstr(RzAnalysis *analysis, ut64 addr, const char *hexstr);
 RZ_API char *rz_analysis_op_to_string(RzAnalysis *analysis, RzAnalysisOp *op);
 
+/* op_cache.c */
+RZ_API RZ_OWN RzAnalysisOpCache *rz_analysis_op_cache_new(void);
+RZ_API void rz_analysis_op_cache_free(RZ_NULLABLE RzAnalysisOpCache *cache);
+RZ_API void rz_analysis_op_cache_clear(RZ_NONNULL RzAnalysis *analysis);
+RZ_API ut32 rz_analysis_op_cache_size(RZ_NONNULL RzAnalysis *analysis);
+RZ_API bool rz_analysis_op_cache_set(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL RzAnalysisOp *op, int ret, RZ_NONNULL const ut8 *bytes, RzAnalysisOpMask mask);
+RZ_API bool rz_analysis_op_cache_get(RZ_NONNULL RzAnalysis *analysis, RZ_OUT RzAnalysisOp *op, ut64 addr, RZ_NONNULL const ut8 *data, int len, RzAnalysisOpMask mask, RZ_OUT int *ret);
+RZ_API void rz_analysis_op_cache_invalidate(RZ_NONNULL RzAnalysis *analysis, ut64 addr, ut64 len);
+RZ_API void rz_analysis_op_cache_set_max_entries(RZ_NONNULL RzAnalysis *analysis, ut32 max_entries);
+RZ_API void rz_analysis_op_cache_reset_stats(RZ_NONNULL RzAnalysis *analysis);
+
 RZ_API RzAnalysisEsil *rz_analysis_esil_new(int stacksize, int iotrap, unsigned int addrsize);
 RZ_API bool rz_analysis_esil_set_pc(RzAnalysisEsil *esil, ut64 addr);
 RZ_API bool rz_analysis_esil_setup(RzAnalysisEsil *esil, RzAnalysis *analysis, int romem, int stats, int nonull);
@@ -1707,6 +1756,9 @@ RZ_API bool rz_analysis_il_vm_sync_to_reg(RzAnalysisILVM *vm, RZ_NONNULL RzReg *
 RZ_API RzAnalysisILStepResult rz_analysis_il_vm_step(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL RzAnalysisILVM *vm, RZ_NULLABLE RzReg *reg);
 RZ_API RzAnalysisILStepResult rz_analysis_il_vm_step_while(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL RzAnalysisILVM *vm, RZ_NULLABLE RzReg *reg,
 	bool (*cond)(RzAnalysisILVM *vm, void *user), void *user);
+RZ_API void rz_analysis_il_vm_cache_clear(RZ_NONNULL RzAnalysisILVM *vm);
+RZ_API ut32 rz_analysis_il_vm_cache_size(RZ_NONNULL RzAnalysisILVM *vm);
+RZ_API void rz_analysis_il_vm_cache_set_max_entries(RZ_NONNULL RzAnalysisILVM *vm, ut32 max_entries);
 RZ_API bool rz_analysis_il_vm_setup(RzAnalysis *analysis);
 RZ_API void rz_analysis_il_vm_cleanup(RzAnalysis *analysis);
 
@@ -1763,6 +1815,9 @@ RZ_API RzAnalysisXRefType rz_analysis_xrefs_type(char ch);
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_to(RzAnalysis *analysis, ut64 addr);
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_from(RzAnalysis *analysis, ut64 addr);
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_list(RzAnalysis *analysis);
+RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_from_range(RZ_NONNULL RzAnalysis *analysis, ut64 start, ut64 end);
+RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_to_range(RZ_NONNULL RzAnalysis *analysis, ut64 start, ut64 end);
+RZ_API bool rz_analysis_xrefs_foreach(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL RzAnalysisXRefCb cb, void *user);
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_function_get_xrefs_from(const RzAnalysisFunction *fcn);
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_function_get_xrefs_to(const RzAnalysisFunction *fcn);
 RZ_API bool rz_analysis_xrefs_set(RzAnalysis *analysis, ut64 from, ut64 to, RzAnalysisXRefType type);
@@ -1923,6 +1978,8 @@ typedef struct rz_analysis_match_options_t {
 	RZ_NONNULL RzAnalysis *analysis_b; ///< Analysis context for the second input (can be the same as analysis_a)
 	RzAnalysisMatchThreadInfoCb callback; ///< When set allows to get the thread information
 	void *user; ///< User pointer to pass to the callback function for the thread info
+	double candidate_threshold; ///< When above 0, only the pairs likely to have a 4-gram similarity of at least this value (up to 1.0) are compared
+	double candidate_recall; ///< Minimum probability for a pair at candidate_threshold to be compared, 0 for RZ_ANALYSIS_MATCH_CANDIDATE_RECALL
 } RzAnalysisMatchOpt;
 
 typedef struct rz_analysis_match_pair_t {
@@ -1937,7 +1994,8 @@ typedef struct rz_analysis_match_result_t {
 	RzList /*<void *>*/ *unmatch_b; ///< List of unmatched elements from input B (the pointers are either RzAnalysisBlock or RzAnalysisFunction)
 } RzAnalysisMatchResult;
 
-#define RZ_ANALYSIS_SIMILARITY_THRESHOLD (0.5)
+#define RZ_ANALYSIS_SIMILARITY_THRESHOLD   (0.5)
+#define RZ_ANALYSIS_MATCH_CANDIDATE_RECALL (0.95)
 
 #define RZ_ANALYSIS_SIMILARITY_TYPE(sim) \
 	(sim < RZ_ANALYSIS_SIMILARITY_THRESHOLD ? RZ_ANALYSIS_SIMILARITY_UNLIKE : (sim >= 1.0 ? RZ_ANALYSIS_SIMILARITY_COMPLETE : RZ_ANALYSIS_SIMILARITY_PARTIAL))
@@ -259,6 +259,7 @@ typedef struct rz_bin_file_load_options_t {
 } RzBinObjectLoadOptions;
 
 typedef struct rz_bin_string_database_t RzBinStrDb;
+typedef struct rz_bin_object_index_t RzBinObjectIndex;
 
 typedef struct rz_bin_object_t {
 	RzBinObjectLoadOptions opts;
@@ -296,6 +297,8 @@ typedef struct rz_bin_object_t {
 	RzBinLanguage lang;
 	RZ_DEPRECATE RZ_BORROW Sdb *kv; ///< deprecated, put info in C structures instead of this (holds a copy of another pointer.)
 	void *bin_obj; // internal pointer used by formats
+	RzBinObjectIndex *addr_index; ///< Lookup structures of sections, maps and symbols by address, built on demand
+	ut32 addr_gen; ///< Incremented by rz_bin_object_addrs_changed(), the address lookups are rebuilt when it changes
 } RzBinObject;
 
 // XXX: RbinFile may hold more than one RzBinObject
@@ -912,6 +915,7 @@ RZ_API void rz_bin_file_hash_free(RZ_NULLABLE RzBinFileHash *fhash);
 // binobject functions
 RZ_API bool rz_bin_object_process_plugin_data(RZ_NONNULL RzBinFile *bf, RZ_NONNULL RzBinObject *o);
 RZ_API ut64 rz_bin_object_addr_with_base(RzBinObject *o, ut64 addr);
+RZ_API void rz_bin_object_addrs_changed(RZ_NONNULL RzBinObject *o);
 RZ_API ut64 rz_bin_object_get_vaddr(RzBinObject *o, ut64 paddr, ut64 vaddr);
 RZ_API const RzBinAddr *rz_bin_object_get_special_symbol(RzBinObject *o, RzBinSpecialSymbol sym);
 RZ_API RzBinRelocStorage *rz_bin_object_patch_relocs(RzBinFile *bf, RzBinObject *o);
@@ -1083,8 +1083,12 @@ typedef struct rz_bin_dwarf_comp_unit_t {
 	ut64 addr_base;
 	ut64 loclists_base;
 	ut64 rnglists_base;
+	bool dies_decoded; ///< Whether dies holds the decoded DIEs of the unit
+	ut64 last_use; ///< Value of RzBinDwarfInfo.use_count when the DIEs were last accessed
 } RzBinDwarfCompUnit;
 
+struct rz_core_bin_dwarf_t;
+
 typedef struct {
 	RzBinEndianReader *reader;
 	RzVector /*<RzBinDwarfCompUnit>*/ units;
@@ -1098,8 +1102,27 @@ typedef struct {
 	 */
 	HtUP /*<ut64, char *>*/ *offset_comp_dir;
 	HtUP /*<ut64, const RzBinDwarfEncoding*>*/ *location_encoding;
+	/**
+	 * In lazy mode only the unit headers and root DIEs are read upfront and the
+	 * DIEs of a unit are decoded when first accessed. rz_bin_dwarf_info_trim()
+	 * then drops the least recently used units beyond this count.
+	 * 0 if all the DIEs are decoded upfront.
+	 */
+	size_t max_decoded_units;
+	RzPVector /*<RzBinDwarfCompUnit *>*/ decoded_units; ///< Units with decoded DIEs in lazy mode
+	ut64 use_count; ///< Incremented on each access to the DIEs of a unit in lazy mode
+	bool locations_loaded; ///< location_encoding has the entries of all the units in lazy mode
+	struct rz_core_bin_dwarf_t *dw; ///< Owner, used to decode the DIEs in lazy mode
 } RzBinDwarfInfo;
 
+/**
+ * \brief Options for parsing .debug_info
+ */
+typedef struct {
+	size_t max_decoded_units; ///< See RzBinDwarfInfo.max_decoded_units, 0 to decode all the DIEs upfront
+	size_t max_threads; ///< Number of threads parsing the DIEs of the units (1: no threads, 0: all the available cores)
+} RzBinDwarfInfoOptions;
+
 typedef struct {
 	ut64 code;
 	DW_TAG tag;
@@ -1493,10 +1516,23 @@ RZ_API RZ_BORROW RzBinDwarfAttrSpec *rz_bin_dwarf_abbrev_attr_by_name(
 RZ_API RZ_OWN RzBinDwarfInfo *rz_bin_dwarf_info_from_buf(
 	RZ_OWN RZ_NONNULL RzBinEndianReader *reader,
 	RZ_BORROW RZ_NONNULL RzBinDWARF *dw);
+RZ_API RZ_OWN RzBinDwarfInfo *rz_bin_dwarf_info_from_buf_opt(
+	RZ_OWN RZ_NONNULL RzBinEndianReader *reader,
+	RZ_BORROW RZ_NONNULL RzBinDWARF *dw,
+	RZ_NONNULL const RzBinDwarfInfoOptions *opt);
 RZ_API RZ_OWN RzBinDwarfInfo *rz_bin_dwarf_info_from_file(
 	RZ_BORROW RZ_NONNULL RzBinFile *bf,
 	RZ_BORROW RZ_NONNULL RzBinDWARF *dw,
 	bool is_dwo);
+RZ_API bool rz_bin_dwarf_info_unit_load(
+	RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info,
+	RZ_BORROW RZ_NONNULL RzBinDwarfCompUnit *unit);
+RZ_API RZ_BORROW RzBinDwarfCompUnit *rz_bin_dwarf_info_unit_at(
+	RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info, ut64 offset);
+RZ_API RZ_BORROW RzBinDwarfDie *rz_bin_dwarf_info_die_at(
+	RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info, ut64 offset);
+RZ_API void rz_bin_dwarf_info_trim(RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info);
+RZ_API void rz_bin_dwarf_info_locations_load(RZ_BORROW RZ_NONNULL RzBinDwarfInfo *info);
 
 RZ_API void rz_bin_dwarf_info_free(RZ_OWN RZ_NULLABLE RzBinDwarfInfo *info);
 RZ_API RZ_BORROW RzBinDwarfAttr *rz_bin_dwarf_die_get_attr(
@@ -1515,6 +1551,7 @@ RZ_API void rz_bin_dwarf_line_op_fini(RZ_OWN RZ_NULLABLE RzBinDwarfLineOp *op);
 RZ_API void rz_bin_dwarf_line_free(RZ_OWN RZ_NULLABLE RzBinDwarfLine *li);
 
 RZ_API RZ_OWN RzBinDWARF *rz_bin_dwarf_from_file(RZ_BORROW RZ_NONNULL RzBinFile *bf);
+RZ_API RZ_OWN RzBinDWARF *rz_bin_dwarf_from_file_opt(RZ_BORROW RZ_NONNULL RzBinFile *bf, RZ_NONNULL const RzBinDwarfInfoOptions *opt);
 RZ_API RZ_OWN RzBinDWARF *rz_bin_dwarf_from_path(
 	RZ_BORROW RZ_NONNULL const char *filepath, bool is_dwo);
 RZ_API RZ_OWN RzBinDWARF *rz_bin_dwarf_search_debug_file_directory(
@@ -5,6 +5,9 @@
 #include <rz_lib.h>
 #include <rz_io.h>
 #include <rz_list.h>
+#include <rz_vector.h>
+#include <rz_util/rz_intervaltree.h>
+#include <rz_util/rz_bitvector.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +62,7 @@ typedef struct rz_bp_item_t {
 	char *data;
 	char *cond; /* used for conditional breakpoints */
 	char *expr; /* to be used for named breakpoints (see rz_debug_bp_update) */
+	bool coverage; ///< One-shot breakpoint of RzBreakpoint.coverage
 } RzBreakpointItem;
 
 struct rz_bp_t;
@@ -75,6 +79,19 @@ typedef struct rz_bp_context_t {
 	int (*bits_at)(ut64 addr, void *user); ///< get the arch-bitness to use at the given address (e.g. thumb or 32)
 } RzBreakpointContext;
 
+/**
+ * \brief Coverage tracing with one-shot breakpoints
+ *
+ * Every traced address gets a breakpoint which is written once and stays in
+ * memory until it is hit, then it is removed for good and the hit is recorded.
+ * rz_bp_coverage_hide() hides the ones still in memory from reads.
+ */
+typedef struct rz_bp_coverage_t {
+	RzVector /*<ut64>*/ addrs; ///< Traced addresses, sorted
+	RzBitVector hits; ///< Bit i is set once addrs[i] has been hit
+	ut32 pending; ///< Number of hit breakpoints not removed yet
+} RzBreakpointCoverage;
+
 typedef struct rz_bp_t {
 	void *user;
 	RzBreakpointContext ctx;
@@ -91,9 +108,12 @@ typedef struct rz_bp_t {
 	int nbps;
 	int nhwbps;
 	RzList /*<RzBreakpointItem *>*/ *bps; // list of breakpoints
+	RzIntervalTree bps_tree; ///< Breakpoints indexed by the [addr, addr + size) range they cover
 	RzBreakpointItem **bps_idx;
 	int bps_idx_count;
+	int bps_idx_free; ///< No slot of bps_idx below this one is free
 	ut64 baddr;
+	RzBreakpointCoverage *coverage; ///< Running coverage or NULL
 } RzBreakpoint;
 
 typedef struct rz_bp_trace_t {
@@ -143,6 +163,7 @@ RZ_API bool rz_bp_item_set_cond(RZ_NONNULL RzBreakpointItem *item, RZ_NULLABLE c
 RZ_API bool rz_bp_item_set_data(RZ_NONNULL RzBreakpointItem *item, RZ_NULLABLE const char *data);
 RZ_API bool rz_bp_item_set_expr(RZ_NONNULL RzBreakpointItem *item, RZ_NULLABLE const char *expr);
 RZ_API bool rz_bp_item_set_name(RZ_NONNULL RzBreakpointItem *item, RZ_NULLABLE const char *name);
+RZ_API void rz_bp_item_set_addr(RZ_NONNULL RzBreakpoint *bp, RZ_NONNULL RzBreakpointItem *item, ut64 addr);
 
 RZ_API int rz_bp_add_fault(RzBreakpoint *bp, ut64 addr, int size, int perm);
 
@@ -163,6 +184,13 @@ RZ_API void rz_bp_traptrace_list(RzBreakpoint *bp);
 RZ_API int rz_bp_traptrace_at(RzBreakpoint *bp, ut64 from, int len);
 RZ_API RzList /*<RzBreakpointTrace *>*/ *rz_bp_traptrace_new(void);
 
+/* coverage */
+RZ_API bool rz_bp_coverage_start(RZ_NONNULL RzBreakpoint *bp, RZ_NONNULL RzVector /*<ut64>*/ *addrs);
+RZ_API RZ_OWN RzVector /*<ut64>*/ *rz_bp_coverage_stop(RZ_NONNULL RzBreakpoint *bp);
+RZ_API bool rz_bp_coverage_hit(RZ_NONNULL RzBreakpoint *bp, RZ_NONNULL RzBreakpointItem *b);
+RZ_API void rz_bp_coverage_flush(RZ_NONNULL RzBreakpoint *bp);
+RZ_API void rz_bp_coverage_hide(RZ_NONNULL RzBreakpoint *bp, ut64 addr, RZ_NONNULL ut8 *buf, size_t len);
+
 /* watchpoint */
 RZ_API RZ_BORROW RzBreakpointItem *rz_bp_watch_add(RZ_NONNULL RzBreakpoint *bp, ut64 addr, int size, int hw, int perm);
 
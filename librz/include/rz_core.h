@@ -108,6 +108,7 @@ typedef struct rz_core_plugin_t {
 } RzCorePlugin;
 
 typedef struct rz_core_rtr_host_t RzCoreRtrHost;
+typedef struct rz_core_block_hash_cache_t RzCoreBlockHashCache;
 
 typedef enum {
 	AUTOCOMPLETE_DEFAULT,
@@ -331,6 +332,9 @@ struct rz_core_t {
 	RzList /*<char *>*/ *ropchain;
 	RzCoreSeekHistory seek_history;
 	RzHash *hash;
+	RzCoreBlockHashCache *block_hashes; ///< Digests of the blocks hashed by rz_core_block_hash()
+	RzFlirtNode *sigdb_node; ///< Merged signatures applied by the last rz_core_analysis_sigdb_apply()
+	char *sigdb_node_key; ///< Architecture, paths and sizes of the files merged in sigdb_node
 
 	bool marks_init;
 	ut64 marks[UT8_MAX + 1];
@@ -586,6 +590,9 @@ RZ_API void rz_core_debug_map_print(RzCore *core, ut64 addr, RzCmdStateOutput *s
 
 /* chash.c */
 RZ_API RzCmdStatus rz_core_hash_plugins_print(RzHash *hash, RzCmdStateOutput *state);
+RZ_API RZ_OWN ut8 *rz_core_block_hash(RZ_NONNULL RzCore *core, RZ_NONNULL const char *algo, ut64 from, ut64 blocksize, size_t nblocks, RZ_NULLABLE RzHashSize *digest_size);
+RZ_API RZ_OWN double *rz_core_block_entropy(RZ_NONNULL RzCore *core, ut64 from, ut64 blocksize, size_t nblocks);
+RZ_API void rz_core_block_hash_invalidate(RZ_NONNULL RzCore *core, ut64 addr, ut64 len);
 
 /* ccrypto.c */
 RZ_API RzCmdStatus rz_core_crypto_plugins_print(RzCrypto *cry, RzCmdStateOutput *state);
@@ -906,7 +913,7 @@ RZ_API RZ_OWN char *rz_core_bin_dwarf_attr_to_string(
 	RZ_NONNULL RZ_BORROW const RzBinDwarfAttr *attr,
 	RzBinDWARF *dw, ut64 stroffsets_base);
 RZ_API RZ_OWN char *rz_core_bin_dwarf_debug_info_to_string(
-	RZ_NONNULL RZ_BORROW const RzBinDwarfInfo *info,
+	RZ_NONNULL RZ_BORROW RzBinDwarfInfo *info,
 	const RzBinDWARF *dw);
 RZ_API RZ_OWN char *rz_core_bin_dwarf_loc_to_string(
 	RZ_NONNULL RZ_BORROW RzBinDwarfLocLists *loclists,
@@ -159,12 +159,22 @@ typedef struct rz_debug_desc_t {
 	ut64 off;
 } RzDebugDesc;
 
+#define RZ_DEBUG_SNAP_PAGE_SIZE 0x1000
+
+/**
+ * \brief Page of memory of a snapshot, shared by the snapshots in which it is the same
+ */
+typedef struct rz_debug_snap_page_t {
+	ut32 refs; ///< Number of snapshots referencing the page
+	ut8 data[];
+} RzDebugSnapPage;
+
 typedef struct rz_debug_snap_t {
 	char *name;
 	ut64 addr;
 	ut64 addr_end;
 	ut32 size;
-	ut8 *data;
+	RzDebugSnapPage **pages; ///< Contents in pages of RZ_DEBUG_SNAP_PAGE_SIZE bytes, the last one may be shorter
 	int perm;
 	int user;
 	bool shared;
@@ -175,9 +185,14 @@ typedef struct {
 	ut64 data;
 } RzDebugChangeReg;
 
+/**
+ * \brief Bytes written to memory at one step of the session
+ */
 typedef struct {
 	int cnum;
-	ut8 data;
+	ut32 size; ///< Number of bytes written
+	ut64 addr;
+	size_t data; ///< Offset of the written bytes in RzDebugSession.memory_data
 } RzDebugChangeMem;
 
 typedef struct rz_debug_checkpoint_t {
@@ -191,7 +206,9 @@ typedef struct rz_debug_session_t {
 	ut32 maxcnum;
 	RzDebugCheckpoint *cur_chkpt;
 	RzVector /*<RzDebugCheckpoint>*/ *checkpoints;
-	HtUP *memory; /* RzVector<RzDebugChangeMem> */
+	RzVector /*<RzDebugChangeMem>*/ *memory; ///< Memory writes, sorted by cnum
+	RzVector /*<ut8>*/ *memory_data; ///< Bytes of all the memory writes
+	RzIntervalTree memory_index; ///< Indices in memory of the writes, by the (inclusive) range of addresses they cover
 	HtUP *registers; /* RzVector<RzDebugChangeReg> */
 	int reasontype /*RzDebugReasonType*/;
 	RzBreakpointItem *bp;
@@ -572,7 +589,7 @@ RZ_API void rz_debug_esil_prestep(RzDebug *d, int p);
 // RZ_API ut8 rz_debug_get_byte(RzDebug *dbg, ut32 cnum, ut64 addr);
 RZ_API bool rz_debug_add_checkpoint(RzDebug *dbg);
 RZ_API bool rz_debug_session_add_reg_change(RzDebugSession *session, int arena, ut64 offset, ut64 data);
-RZ_API bool rz_debug_session_add_mem_change(RzDebugSession *session, ut64 addr, ut8 data);
+RZ_API bool rz_debug_session_add_mem_change(RzDebugSession *session, ut64 addr, RZ_NONNULL const ut8 *data, ut32 size);
 RZ_API void rz_debug_session_restore_reg_mem(RzDebug *dbg, ut32 cnum);
 RZ_API void rz_debug_session_list_memory(RzDebug *dbg);
 RZ_API void rz_debug_session_serialize(RzDebugSession *session, Sdb *db);
@@ -586,6 +603,12 @@ RZ_API RzDebugSession *rz_debug_session_new(void);
 RZ_API void rz_debug_session_free(RzDebugSession *session);
 
 RZ_API RzDebugSnap *rz_debug_snap_map(RzDebug *dbg, RzDebugMap *map);
+RZ_API RzDebugSnap *rz_debug_snap_map_from(RzDebug *dbg, RzDebugMap *map, RZ_NULLABLE RzDebugSnap *prev);
+RZ_API RZ_OWN RzDebugSnapPage *rz_debug_snap_page_new(RZ_NONNULL const ut8 *data, ut32 size);
+RZ_API void rz_debug_snap_page_unref(RZ_NULLABLE RzDebugSnapPage *page);
+RZ_API bool rz_debug_snap_set_data(RZ_NONNULL RzDebugSnap *snap, RZ_NONNULL const ut8 *data);
+RZ_API RZ_OWN ut8 *rz_debug_snap_get_data(RZ_NONNULL RzDebugSnap *snap);
+RZ_API void rz_debug_snap_restore(RzDebug *dbg, RzDebugSnap *snap);
 RZ_API bool rz_debug_snap_contains(RzDebugSnap *snap, ut64 addr);
 RZ_API ut8 *rz_debug_snap_get_hash(RzDebug *dbg, RzDebugSnap *snap, RzHashSize *size);
 RZ_API bool rz_debug_snap_is_equal(RzDebug *dbg, RzDebugSnap *a, RzDebugSnap *b);
@@ -19,18 +19,19 @@ extern "C" {
 typedef struct rz_il_var_t {
 	char *name;
 	RzILSortPure sort; ///< "type" of the variable
+	RzILVal *val; ///< Current contents, NULL while unbound
 } RzILVar;
 
 RZ_API RZ_OWN RzILVar *rz_il_variable_new(RZ_NONNULL const char *name, RzILSortPure sort);
 RZ_API void rz_il_variable_free(RZ_NULLABLE RzILVar *var);
+RZ_API bool rz_il_variable_bind(RZ_NONNULL RzILVar *var, RZ_OWN RZ_NONNULL RzILVal *val);
 
 /**
  * \brief Holds a set of variable definitions and their current contents
  * This is meant only as a low-level container to be used in RzILVM.
  */
 typedef struct rz_il_var_set_t {
-	HtPP /*<char *, RzILVar *>*/ *vars;
-	HtPP /*<char *, RzILVal *>*/ *contents;
+	HtPP /*<char *, RzILVar *>*/ *vars; ///< Variables by name, holding their contents
 } RzILVarSet;
 
 RZ_API bool rz_il_var_set_init(RzILVarSet *vs);
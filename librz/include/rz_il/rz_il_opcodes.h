@@ -169,6 +169,7 @@ typedef struct rz_il_op_args_set_t {
 	const char *v; ///< name of variable, const one
 	bool is_local; ///< whether a global variable should be set or a local optionally created and set
 	RzILOpPure *x; ///< value to set the variable to
+	RzILVar *slot; ///< global variable resolved by rz_il_vm_resolve_vars(), NULL to look it up by name
 } RzILOpArgsSet;
 
 /**
@@ -261,6 +262,7 @@ typedef struct rz_il_op_args_ite_t {
 typedef struct rz_il_op_args_var_t {
 	const char *v; ///< name of variable, const one
 	RzILVarKind kind; ///< set of variables to pick from
+	RzILVar *slot; ///< global variable resolved by rz_il_vm_resolve_vars(), NULL to look it up by name
 } RzILOpArgsVar;
 
 /**
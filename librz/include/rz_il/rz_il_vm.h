@@ -48,6 +48,8 @@ struct rz_il_vm_t {
 	RzILOpEffectHandler *op_handler_effect_table; ///< Array of Handler, handler can be indexed by opcode
 	RzPVector /*<RzILEvent *>*/ *events; ///< List of events that has happened in the last step
 	bool big_endian; ///< Sets the endianness of the memory reads/writes operations
+	RzPVector /*<RzBitVector *>*/ free_bvs; ///< Released bitvectors of up to 64 bits, reused by the op handlers instead of allocating new ones
+	RzPVector /*<RzILBool *>*/ free_bools; ///< Released bools, reused by the op handlers instead of allocating new ones
 };
 
 // VM high level operations
@@ -87,6 +89,7 @@ typedef RZ_NULLABLE RzILVal *RzILLocalPurePrev;
 RZ_API RzILLocalPurePrev rz_il_vm_push_local_pure_var(RZ_NONNULL RzILVM *vm, RZ_NONNULL const char *name, RzILVal *val);
 RZ_API void rz_il_vm_pop_local_pure_var(RZ_NONNULL RzILVM *vm, RZ_NONNULL const char *name, RzILLocalPurePrev prev);
 RZ_API RZ_BORROW RzILVar *rz_il_vm_get_var(RZ_NONNULL RzILVM *vm, RzILVarKind kind, const char *name);
+RZ_API void rz_il_vm_resolve_vars(RZ_NONNULL RzILVM *vm, RZ_NULLABLE RzILOpEffect *op);
 RZ_API RZ_OWN RzPVector /*<RzILVar *>*/ *rz_il_vm_get_all_vars(RZ_NONNULL RzILVM *vm, RzILVarKind kind);
 RZ_API RZ_BORROW RzILVal *rz_il_vm_get_var_value(RZ_NONNULL RzILVM *vm, RzILVarKind kind, const char *name);
 
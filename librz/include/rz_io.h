@@ -73,8 +73,12 @@ typedef struct rz_io_t {
 	RzPVector /*<RzIOMap *>*/ maps; // from tail backwards maps with higher priority are found
 	RzSkyline map_skyline; // map parts that are not covered by others
 	RzIDStorage *files;
-	RzPVector /*<RzIOCache *>*/ cache;
-	RzSkyline cache_skyline;
+	RBTree cache; ///< Extents of the write cache sorted by address, never overlapping nor adjacent
+	RzList /*<void *>*/ cache_writes; ///< Writes done in the cache, in the order they were done
+	ut64 cache_seq; ///< Incremented by every change of the write cache
+	RzPVector /*<void *>*/ cache_stack; ///< Cache states saved by rz_io_cache_push()
+	void (*read_filter)(void *user, ut64 addr, ut8 *buf, size_t len); ///< Optional, fixes up the bytes read before the write cache is applied
+	void *read_filter_user; ///< Passed to read_filter
 	ut8 *write_mask;
 	int write_mask_len;
 	RzList /*<RzIOPlugin *>*/ *plugins;
@@ -111,6 +115,16 @@ typedef struct {
 	void *data;
 } RzIODescData;
 
+/**
+ * \brief One read of a batch, see rz_io_read_at_batch()
+ */
+typedef struct rz_io_read_req_t {
+	ut64 addr; ///< Address to read from
+	ut8 *buf; ///< Receives the len bytes read
+	size_t len; ///< Number of bytes to read
+	bool ok; ///< Set by the read, true if it succeeded as rz_io_read_at() would have
+} RzIOReadReq;
+
 typedef struct rz_io_plugin_t {
 	const char *name;
 	const char *desc;
@@ -127,6 +141,7 @@ typedef struct rz_io_plugin_t {
 	RzIODesc *(*open)(RzIO *io, const char *, int perm, int mode);
 	RzList /*<RzIODesc *>*/ *(*open_many)(RzIO *io, const char *, int perm, int mode);
 	int (*read)(RzIO *io, RzIODesc *fd, ut8 *buf, size_t len);
+	bool (*read_batch)(RzIO *io, RzIODesc *fd, RzIOReadReq *reqs, size_t count); ///< Optional, reads at several offsets of fd at once
 	ut64 (*lseek)(RzIO *io, RzIODesc *fd, ut64 offset, int whence);
 	int (*write)(RzIO *io, RzIODesc *fd, const ut8 *buf, size_t len);
 	int (*close)(RzIODesc *desc);
@@ -176,6 +191,7 @@ typedef struct rz_event_io_write_t {
 	ut64 addr;
 	const ut8 *buf;
 	size_t len;
+	int fd; ///< Descriptor addr is a physical offset of, or -1 when addr is an address of the io space
 } RzEventIOWrite;
 
 typedef struct rz_event_io_desc_close_t {
@@ -327,6 +343,7 @@ RZ_API bool rz_io_vread_at_mapped(RzIO *io, ut64 vaddr, ut8 *buf, size_t len);
 RZ_API bool rz_io_read_at(RzIO *io, ut64 addr, ut8 *buf, size_t len);
 RZ_API bool rz_io_read_at_mapped(RzIO *io, ut64 addr, ut8 *buf, size_t len);
 RZ_API int rz_io_nread_at(RzIO *io, ut64 addr, ut8 *buf, size_t len);
+RZ_API bool rz_io_read_at_batch(RzIO *io, RZ_NONNULL RzIOReadReq *reqs, size_t count);
 RZ_API bool rz_io_write_at(RzIO *io, ut64 addr, const ut8 *buf, size_t len);
 RZ_API bool rz_io_read(RzIO *io, ut8 *buf, size_t len);
 RZ_API bool rz_io_write(RzIO *io, const ut8 *buf, size_t len);
@@ -391,6 +408,9 @@ RZ_API void rz_io_cache_fini(RzIO *io);
 RZ_API void rz_io_cache_reset(RzIO *io, int set);
 RZ_API bool rz_io_cache_write(RzIO *io, ut64 addr, const ut8 *buf, size_t len);
 RZ_API bool rz_io_cache_read(RzIO *io, ut64 addr, ut8 *buf, size_t len);
+RZ_API RZ_OWN RzList /*<RzIOCache *>*/ *rz_io_cache_list(RZ_NONNULL RzIO *io);
+RZ_API bool rz_io_cache_push(RzIO *io);
+RZ_API bool rz_io_cache_pop(RzIO *io);
 
 /* io/p_cache.c */
 RZ_API bool rz_io_desc_cache_init(RzIODesc *desc);
@@ -156,6 +156,7 @@ typedef struct rz_reg_t {
 	int size;
 	bool is_thumb;
 	bool big_endian;
+	ut32 items_gen; ///< Incremented whenever the register items are freed, so that stale RzRegItem pointers can be detected
 } RzReg;
 
 typedef struct rz_reg_flags_t {
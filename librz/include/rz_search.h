@@ -51,6 +51,8 @@ typedef struct rz_search_hit_t {
 
 typedef int (*RzSearchCallback)(RzSearchKeyword *kw, void *user, ut64 where);
 
+typedef struct rz_search_automaton_t RzSearchAutomaton;
+
 typedef struct rz_search_t {
 	int n_kws; // hit${n_kws}_${count}
 	int mode;
@@ -70,6 +72,7 @@ typedef struct rz_search_t {
 	int align;
 	int (*update)(struct rz_search_t *s, ut64 from, const ut8 *buf, int len);
 	RzList /*<RzSearchKeyword *>*/ *kws; // TODO: Use rz_search_kw_new ()
+	RzSearchAutomaton *automaton; // keywords compiled for the single pass keyword search, built on demand
 	RzIOBind iob;
 	char bckwrds;
 } RzSearch;
@@ -86,6 +89,7 @@ RZ_API RzSearch *rz_search_free(RzSearch *s);
 RZ_API RzList /*<RzSearchHit *>*/ *rz_search_find(RzSearch *s, ut64 addr, const ut8 *buf, int len);
 RZ_API int rz_search_update(RzSearch *s, ut64 from, const ut8 *buf, long len);
 RZ_API int rz_search_update_i(RzSearch *s, ut64 from, const ut8 *buf, long len);
+RZ_API int rz_search_update_parallel(RZ_NONNULL RzSearch *s, ut64 from, RZ_NONNULL const ut8 *buf, long len, size_t max_threads);
 
 RZ_API void rz_search_keyword_free(RzSearchKeyword *kw);
 RZ_API RzSearchKeyword *rz_search_keyword_new(const ut8 *kw, int kwlen, const ut8 *bm, int bmlen, const char *data);
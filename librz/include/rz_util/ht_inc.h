@@ -14,6 +14,7 @@
 #undef VALUE_TYPE
 #undef KEY_TO_HASH
 #undef HT_NULL_VALUE
+#undef HT_OPEN_ADDRESSING
 
 #if HT_TYPE == 1
 #define HtName_(name)  name##PP
@@ -52,6 +53,13 @@
 #include "ls.h"
 #include <rz_types.h>
 
+// HtUP and HtUU are open addressing tables when built with ht_open_addressing
+#if (HT_TYPE == 2 || HT_TYPE == 3) && WITH_HT_OPEN_ADDRESSING
+#define HT_OPEN_ADDRESSING 1
+#else
+#define HT_OPEN_ADDRESSING 0
+#endif
+
 /* Kv represents a single key/value element in the hashtable */
 typedef struct Ht_(kv) {
 	KEY_TYPE key;
@@ -96,6 +104,19 @@ typedef struct Ht_(options_t) {
 }
 HT_(Options);
 
+#if HT_OPEN_ADDRESSING
+/* Ht is the hashtable structure, storing the elements in the table itself */
+typedef struct Ht_(t) {
+	ut32 size; // size of the hash table in slots, a power of two.
+	ut32 count; // number of stored elements.
+	HT_(Kv) * table; // Actual table.
+	ut8 *dist; // distance + 1 of the element in each slot from its ideal slot, 0 for free slots.
+	ut32 shift; // 64 - log2(size), to pick the slot from the high bits of the hash
+	HT_(Options)
+	opt;
+}
+HtName_(Ht);
+#else
 /* Ht is the hashtable structure */
 typedef struct Ht_(t) {
 	ut32 size; // size of the hash table in buckets.
@@ -106,6 +127,7 @@ typedef struct Ht_(t) {
 	opt;
 }
 HtName_(Ht);
+#endif
 
 // Create a new Ht with the provided Options
 RZ_API HtName_(Ht) * Ht_(new_opt)(HT_(Options) * opt);
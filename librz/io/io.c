@@ -105,6 +105,12 @@ static st64 on_map_skyline(RzIO *io, ut64 vaddr, ut8 *buf, size_t len, int match
 	return prefix_mode ? addr - vaddr : ret;
 }
 
+static inline void read_filter(RzIO *io, ut64 addr, ut8 *buf, size_t len) {
+	if (io->read_filter) {
+		io->read_filter(io->read_filter_user, addr, buf, len);
+	}
+}
+
 RZ_API RzIO *rz_io_new(void) {
 	return rz_io_init(RZ_NEW0(RzIO));
 }
@@ -303,6 +309,7 @@ RZ_API bool rz_io_read_at(RzIO *io, ut64 addr, ut8 *buf, size_t len) {
 	bool ret = (io->va)
 		? rz_io_vread_at_mapped(io, addr, buf, len)
 		: rz_io_pread_at(io, addr, buf, len) > 0;
+	read_filter(io, addr, buf, len);
 	if (io->cached & RZ_PERM_R) {
 		ret |= rz_io_cache_read(io, addr, buf, len);
 	}
@@ -324,6 +331,7 @@ RZ_API bool rz_io_read_at_mapped(RzIO *io, ut64 addr, ut8 *buf, size_t len) {
 	} else {
 		ret = rz_io_pread_at(io, addr, buf, len) > 0;
 	}
+	read_filter(io, addr, buf, len);
 	if (io->cached & RZ_PERM_R) {
 		ret |= rz_io_cache_read(io, addr, buf, len);
 	}
@@ -347,12 +355,91 @@ RZ_API int rz_io_nread_at(RzIO *io, ut64 addr, ut8 *buf, size_t len) {
 	} else {
 		ret = rz_io_pread_at(io, addr, buf, len);
 	}
+	if (ret > 0) {
+		read_filter(io, addr, buf, ret);
+	}
 	if (ret > 0 && io->cached & RZ_PERM_R) {
 		(void)rz_io_cache_read(io, addr, buf, len);
 	}
 	return ret;
 }
 
+/**
+ * Returns the desc whose plugin can read [addr, addr + len) as part of a batch,
+ * with the offset of addr in it, or NULL if the range must be read on its own.
+ */
+static RzIODesc *batch_desc_at(RzIO *io, ut64 addr, size_t len, ut64 *paddr) {
+	RzIODesc *desc = io->desc;
+	*paddr = addr;
+	if (io->va) {
+		const RzSkylineItem *part = rz_skyline_get_item(&io->map_skyline, addr);
+		// the whole range must be visible through a single readable map
+		if (!part || addr + len - 1 < addr || addr + len - 1 > rz_itv_end(part->itv) - 1) {
+			return NULL;
+		}
+		RzIOMap *map = part->user;
+		if (!(map->perm & RZ_PERM_R)) {
+			return NULL;
+		}
+		desc = rz_io_desc_get(io, map->fd);
+		*paddr = map->delta + addr - map->itv.addr;
+	}
+	if (!desc || !desc->plugin || !desc->plugin->read_batch || !(desc->perm & RZ_PERM_R)) {
+		return NULL;
+	}
+	return desc;
+}
+
+/**
+ * \brief Does several reads at once, each one as rz_io_read_at() would
+ *
+ * The reads which fall in a single map of a plugin able to batch them, such as
+ * ptrace with process_vm_readv(), are done with a single call to the plugin.
+ * The others are done one by one.
+ *
+ * \param reqs The reads to do, their \p ok field is set accordingly
+ * \param count Number of elements in \p reqs
+ * \return true if all the reads succeeded
+ */
+RZ_API bool rz_io_read_at_batch(RzIO *io, RZ_NONNULL RzIOReadReq *reqs, size_t count) {
+	rz_return_val_if_fail(io && reqs, false);
+	// these need to see every read of the desc on its own
+	const bool can_batch = count > 1 && !io->cachemode && !io->p_cache;
+	RzIOReadReq *batch = can_batch ? RZ_NEWS(RzIOReadReq, count) : NULL;
+	size_t *batch_idx = batch ? RZ_NEWS(size_t, count) : NULL;
+	RzIODesc *batch_desc = NULL;
+	size_t n = 0;
+	bool ret = true;
+	for (size_t i = 0; i < count; i++) {
+		RzIOReadReq *req = &reqs[i];
+		ut64 paddr;
+		RzIODesc *desc = batch_idx && req->len ? batch_desc_at(io, req->addr, req->len, &paddr) : NULL;
+		if (desc && (!batch_desc || desc == batch_desc)) {
+			batch_desc = desc;
+			batch[n] = (RzIOReadReq){ paddr, req->buf, req->len, false };
+			batch_idx[n++] = i;
+			continue;
+		}
+		req->ok = rz_io_read_at(io, req->addr, req->buf, req->len);
+		ret &= req->ok;
+	}
+	if (n) {
+		batch_desc->plugin->read_batch(io, batch_desc, batch, n);
+		for (size_t j = 0; j < n; j++) {
+			RzIOReadReq *req = &reqs[batch_idx[j]];
+			req->ok = batch[j].ok;
+			read_filter(io, req->addr, req->buf, req->len);
+			if (io->cached & RZ_PERM_R) {
+				req->ok |= rz_io_cache_read(io, req->addr, req->buf, req->len);
+			}
+			ret &= req->ok;
+		}
+	}
+	free(batch);
+	free(batch_idx);
+	return ret;
+}
+
 /**
  * \brief Writes \p len bytes of data from \p buf to \p addr into the given \p io.
  *
@@ -1,8 +1,84 @@
 // SPDX-FileCopyrightText: 2008-2020 pancake <pancake@nopcode.org>
 // SPDX-License-Identifier: LGPL-3.0-only
 
+/** \file io_cache.c
+ * Write cache of RzIO.
+ *
+ * The cached bytes are only stored in extents kept in a red-black tree
+ * sorted by address. Writes that overlap or touch existing extents are
+ * merged into them, so the tree never contains overlapping nor adjacent
+ * extents and every write lies within a single extent.
+ *
+ * The writes do not keep a copy of the bytes they wrote, only what is needed
+ * to undo them: the bytes read before the write and the cached bytes it
+ * overwrote, if any. Each extent lists its writes in the order they were
+ * done, so reads, commits and invalidations only visit the extents within
+ * the requested range. The bytes of a write that were overwritten later
+ * are rebuilt by undoing the later writes, which only listing the cache
+ * needs.
+ */
+
 #include <rz_io.h>
-#include <rz_skyline.h>
+
+typedef struct cache_extent_t CacheExtent;
+
+/**
+ * \brief Write done in the cache, keeping only what is needed to undo it
+ */
+typedef struct {
+	ut64 seq; ///< Value of io->cache_seq when written, increasing along io->cache_writes
+	RzInterval itv;
+	ut8 *odata; ///< Bytes read before the write, written back to the io when invalidating it
+	ut8 *prev; ///< Cached bytes overwritten by the write, NULL if the write did not overlap the cache
+	ut8 *prev_mask; ///< Bitmap of the bytes of prev that were cached
+	bool written; ///< Whether the write has been committed
+	bool removed; ///< Whether the write is about to be removed by extent_remove_writes()
+	CacheExtent *extent; ///< Extent holding the bytes of the write
+	RzListIter *log; ///< Position of the write in io->cache_writes
+} CacheWrite;
+
+/**
+ * \brief Coalesced bytes of one or more writes
+ */
+struct cache_extent_t {
+	RzInterval itv;
+	ut8 *data;
+	RzPVector /*<CacheWrite *>*/ writes; ///< Writes within the extent, in the order they were done
+	RBNode rb;
+};
+
+/**
+ * \brief Write rebuilt with its bytes by cache_materialize()
+ */
+typedef struct {
+	ut64 seq;
+	RzIOCache c;
+} CacheSaved;
+
+/**
+ * \brief Cache state saved by rz_io_cache_push()
+ *
+ * Popping undoes the writes done after the push, which is enough as long as
+ * the older writes are left untouched. Before invalidating, committing or
+ * resetting them, the older writes are saved and popping rebuilds the cache
+ * from them instead.
+ */
+typedef struct {
+	ut64 seq; ///< Value of io->cache_seq when pushing
+	RzPVector /*<CacheSaved *>*/ *saved; ///< Writes done until the push, saved before modifying them, or NULL
+} CacheState;
+
+static inline bool mask_get(const ut8 *mask, ut64 i) {
+	return mask[i >> 3] & (1 << (i & 7));
+}
+
+static inline void mask_set(ut8 *mask, ut64 i, bool set) {
+	if (set) {
+		mask[i >> 3] |= 1 << (i & 7);
+	} else {
+		mask[i >> 3] &= ~(1 << (i & 7));
+	}
+}
 
 static void cache_item_free(RzIOCache *cache) {
 	if (!cache) {
@@ -13,124 +89,651 @@ static void cache_item_free(RzIOCache *cache) {
 	free(cache);
 }
 
+static void cache_write_free(CacheWrite *w) {
+	if (!w) {
+		return;
+	}
+	free(w->odata);
+	free(w->prev);
+	free(w->prev_mask);
+	free(w);
+}
+
+static void cache_saved_free(CacheSaved *saved) {
+	if (!saved) {
+		return;
+	}
+	free(saved->c.data);
+	free(saved->c.odata);
+	free(saved);
+}
+
+static void cache_state_free(CacheState *state) {
+	if (!state) {
+		return;
+	}
+	rz_pvector_free(state->saved);
+	free(state);
+}
+
+static CacheExtent *extent_new(RzInterval itv, ut8 *data) {
+	CacheExtent *extent = RZ_NEW0(CacheExtent);
+	if (!extent) {
+		return NULL;
+	}
+	extent->itv = itv;
+	extent->data = data;
+	rz_pvector_init(&extent->writes, NULL);
+	return extent;
+}
+
+static void extent_free(CacheExtent *extent) {
+	if (!extent) {
+		return;
+	}
+	free(extent->data);
+	rz_pvector_fini(&extent->writes);
+	free(extent);
+}
+
+static void extent_free_rb(RBNode *node, void *user) {
+	extent_free(container_of(node, CacheExtent, rb));
+}
+
+/**
+ * The buffers of the extents are allocated in powers of two, so that
+ * sequences of small writes growing the same extent do not reallocate
+ * it every time.
+ */
+static ut64 extent_capacity(ut64 size) {
+	ut64 cap = 16;
+	while (cap < size && cap <= UT64_MAX / 2) {
+		cap <<= 1;
+	}
+	return RZ_MAX(cap, size);
+}
+
+static ut8 *extent_buf_dup(const ut8 *src, ut64 size) {
+	ut8 *ret = malloc(extent_capacity(size));
+	if (ret) {
+		memcpy(ret, src, size);
+	}
+	return ret;
+}
+
+static inline ut64 extent_last(const CacheExtent *extent) {
+	return rz_itv_end(extent->itv) - 1;
+}
+
+static int extent_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	ut64 addr = *(const ut64 *)incoming;
+	const CacheExtent *extent = container_of(in_tree, const CacheExtent, rb);
+	if (addr < rz_itv_begin(extent->itv)) {
+		return -1;
+	}
+	if (addr > extent_last(extent)) {
+		return 1;
+	}
+	return 0;
+}
+
+static void extent_delete(RzIO *io, CacheExtent *extent) {
+	ut64 addr = rz_itv_begin(extent->itv);
+	rz_rbtree_delete(&io->cache, &addr, extent_cmp, NULL, extent_free_rb, NULL);
+}
+
+static int write_seq_cmp(const void *a, const void *b, void *user) {
+	ut64 sa = ((const CacheWrite *)a)->seq;
+	ut64 sb = ((const CacheWrite *)b)->seq;
+	return sa < sb ? -1 : (sa > sb ? 1 : 0);
+}
+
+static int saved_seq_cmp(const void *a, const void *b, void *user) {
+	ut64 sa = ((const CacheSaved *)a)->seq;
+	ut64 sb = ((const CacheSaved *)b)->seq;
+	return sa < sb ? -1 : (sa > sb ? 1 : 0);
+}
+
+static int ptr_cmp(const void *a, const void *b, void *user) {
+	return (size_t)a < (size_t)b ? -1 : ((size_t)a > (size_t)b ? 1 : 0);
+}
+
+static int itv_cmp(const void *a, const void *b, void *user) {
+	ut64 aa = rz_itv_begin(*(const RzInterval *)a);
+	ut64 ab = rz_itv_begin(*(const RzInterval *)b);
+	return aa < ab ? -1 : (aa > ab ? 1 : 0);
+}
+
+/**
+ * Reports every cached range as written, for the listeners of the writes to
+ * notice the bytes read there are about to change or just changed
+ */
+static void cache_notify(RzIO *io) {
+	RBIter it;
+	CacheExtent *e;
+	rz_rbtree_foreach (io->cache, it, e, CacheExtent, rb) {
+		RzEventIOWrite iow = { rz_itv_begin(e->itv), e->data, rz_itv_size(e->itv), -1 };
+		rz_event_send(io->event, RZ_EVENT_IO_WRITE, &iow);
+	}
+}
+
+static void cache_clear(RzIO *io) {
+	rz_rbtree_free(io->cache, extent_free_rb, NULL);
+	io->cache = NULL;
+	rz_list_purge(&io->cache_writes);
+}
+
+/**
+ * Adds the write \p seq of \p len bytes of \p buf at \p addr (not wrapping
+ * around), merging all the extents overlapping or touching it. On success
+ * \p odata is owned by the returned write.
+ */
+static CacheWrite *cache_insert(RzIO *io, ut64 seq, ut64 addr, const ut8 *buf, ut8 *odata, ut64 len) {
+	const ut64 end = addr + len;
+	CacheWrite *w = RZ_NEW0(CacheWrite);
+	if (!w) {
+		return NULL;
+	}
+	w->seq = seq;
+	w->itv = (RzInterval){ addr, len };
+	w->log = rz_list_append(&io->cache_writes, w);
+	if (!w->log) {
+		free(w);
+		return NULL;
+	}
+	RzPVector merged;
+	rz_pvector_init(&merged, NULL);
+	size_t nwrites = 1;
+	ut64 lookup = addr ? addr - 1 : 0;
+	RBIter iter = rz_rbtree_lower_bound_forward(io->cache, &lookup, extent_cmp, NULL);
+	CacheExtent *e;
+	rz_rbtree_iter_while(iter, e, CacheExtent, rb) {
+		if (rz_itv_begin(e->itv) > end) {
+			break;
+		}
+		if (!rz_pvector_push(&merged, e)) {
+			goto err;
+		}
+		nwrites += rz_pvector_len(&e->writes);
+		if (!rz_itv_overlap(e->itv, w->itv)) {
+			continue;
+		}
+		// save the cached bytes about to be overwritten, to undo the write
+		if (!w->prev) {
+			w->prev = malloc(len);
+			w->prev_mask = calloc(1, len / 8 + 1);
+			if (!w->prev || !w->prev_mask) {
+				goto err;
+			}
+		}
+		RzInterval in = rz_itv_intersect(e->itv, w->itv);
+		memcpy(w->prev + (rz_itv_begin(in) - addr), e->data + (rz_itv_begin(in) - rz_itv_begin(e->itv)), rz_itv_size(in));
+		for (ut64 a = rz_itv_begin(in); a < rz_itv_end(in); a++) {
+			mask_set(w->prev_mask, a - addr, true);
+		}
+	}
+	CacheExtent *first = rz_pvector_len(&merged) ? rz_pvector_at(&merged, 0) : NULL;
+	CacheExtent *last = rz_pvector_len(&merged) ? rz_pvector_tail(&merged) : NULL;
+	const ut64 start = first ? RZ_MIN(addr, rz_itv_begin(first->itv)) : addr;
+	const ut64 size = (last ? RZ_MAX(end, rz_itv_end(last->itv)) : end) - start;
+	if (first && !rz_pvector_reserve(&first->writes, nwrites)) {
+		goto err;
+	}
+	ut8 *data;
+	if (first && rz_itv_begin(first->itv) == start) {
+		// appending to an existing extent, its content stays in place
+		const ut64 capacity = extent_capacity(size);
+		if (capacity != extent_capacity(rz_itv_size(first->itv))) {
+			data = realloc(first->data, capacity);
+			if (!data) {
+				goto err;
+			}
+			first->data = data;
+		}
+	} else {
+		data = malloc(extent_capacity(size));
+		if (!data) {
+			goto err;
+		}
+		if (first) {
+			// prepending to an existing extent
+			memcpy(data + (rz_itv_begin(first->itv) - start), first->data, rz_itv_size(first->itv));
+			free(first->data);
+			first->data = data;
+		}
+	}
+	if (first) {
+		// move the content and the writes of the other extents into the first one
+		for (size_t i = 1; i < rz_pvector_len(&merged); i++) {
+			e = rz_pvector_at(&merged, i);
+			memcpy(first->data + (rz_itv_begin(e->itv) - start), e->data, rz_itv_size(e->itv));
+			void **it;
+			rz_pvector_foreach (&e->writes, it) {
+				CacheWrite *moved = *it;
+				moved->extent = first;
+				rz_pvector_push(&first->writes, moved);
+			}
+			extent_delete(io, e);
+		}
+		if (rz_pvector_len(&merged) > 1) {
+			rz_pvector_sort(&first->writes, write_seq_cmp, NULL);
+		}
+		// the key may only decrease down to addr, which does not touch the previous extent
+		first->itv = (RzInterval){ start, size };
+	} else {
+		first = extent_new((RzInterval){ start, size }, data);
+		if (!first || !rz_pvector_reserve(&first->writes, 1)) {
+			if (first) {
+				extent_free(first);
+			} else {
+				free(data);
+			}
+			goto err;
+		}
+		rz_rbtree_insert(&io->cache, &first->itv.addr, &first->rb, extent_cmp, NULL);
+	}
+	memcpy(first->data + (addr - start), buf, len);
+	w->odata = odata;
+	w->extent = first;
+	rz_pvector_push(&first->writes, w);
+	rz_pvector_fini(&merged);
+	return w;
+err:
+	rz_pvector_fini(&merged);
+	rz_list_delete(&io->cache_writes, w->log);
+	return NULL;
+}
+
+/**
+ * Undoes the write at \p idx in the writes of \p extent: the bytes it
+ * overwrote go back into the first later write covering them, or into the
+ * extent if there is none. \p done must hold a bit for each byte of the write.
+ */
+static void extent_unstack(CacheExtent *extent, size_t idx, ut8 *done) {
+	CacheWrite *w = rz_pvector_at(&extent->writes, idx);
+	const ut64 begin = rz_itv_begin(w->itv);
+	const ut64 size = rz_itv_size(w->itv);
+	memset(done, 0, size / 8 + 1);
+	for (size_t j = idx + 1; j < rz_pvector_len(&extent->writes); j++) {
+		CacheWrite *above = rz_pvector_at(&extent->writes, j);
+		if (!rz_itv_overlap(above->itv, w->itv)) {
+			continue;
+		}
+		// above overwrote bytes of w, so it has its prev buffer
+		RzInterval in = rz_itv_intersect(above->itv, w->itv);
+		for (ut64 a = rz_itv_begin(in); a < rz_itv_end(in); a++) {
+			const ut64 i = a - begin;
+			if (mask_get(done, i)) {
+				continue;
+			}
+			mask_set(done, i, true);
+			const ut64 ai = a - rz_itv_begin(above->itv);
+			const bool cached = w->prev && mask_get(w->prev_mask, i);
+			mask_set(above->prev_mask, ai, cached);
+			if (cached) {
+				above->prev[ai] = w->prev[i];
+			}
+		}
+	}
+	if (!w->prev) {
+		return;
+	}
+	ut8 *dst = extent->data + (begin - rz_itv_begin(extent->itv));
+	for (ut64 i = 0; i < size; i++) {
+		if (!mask_get(done, i) && mask_get(w->prev_mask, i)) {
+			dst[i] = w->prev[i];
+		}
+	}
+}
+
+/**
+ * Makes \p extent cover exactly the bytes of its writes, splitting it where
+ * they left holes, or deletes it if it has no writes anymore.
+ */
+static bool extent_split(RzIO *io, CacheExtent *extent) {
+	if (rz_pvector_empty(&extent->writes)) {
+		extent_delete(io, extent);
+		return true;
+	}
+	bool ret = false;
+	RzVector parts;
+	rz_vector_init(&parts, sizeof(RzInterval), NULL, NULL);
+	RzPVector tails;
+	rz_pvector_init(&tails, NULL);
+	RzVector itvs;
+	rz_vector_init(&itvs, sizeof(RzInterval), NULL, NULL);
+	if (!rz_vector_reserve(&itvs, rz_pvector_len(&extent->writes))) {
+		goto beach;
+	}
+	void **it;
+	rz_pvector_foreach (&extent->writes, it) {
+		CacheWrite *w = *it;
+		rz_vector_push(&itvs, &w->itv);
+	}
+	rz_vector_sort(&itvs, itv_cmp, false, NULL);
+	RzInterval *itv;
+	rz_vector_foreach(&itvs, itv) {
+		RzInterval *part = rz_vector_empty(&parts) ? NULL : rz_vector_tail(&parts);
+		if (part && rz_itv_begin(*itv) <= rz_itv_end(*part)) {
+			part->size = RZ_MAX(rz_itv_end(*part), rz_itv_end(*itv)) - part->addr;
+		} else if (!rz_vector_push(&parts, itv)) {
+			goto beach;
+		}
+	}
+	RzInterval *head = rz_vector_index_ptr(&parts, 0);
+	if (rz_vector_len(&parts) == 1 && rz_itv_eq(*head, extent->itv)) {
+		ret = true;
+		goto beach;
+	}
+	// allocate the extents of the other parts first, so that a failure leaves the cache untouched
+	for (size_t i = 1; i < rz_vector_len(&parts); i++) {
+		RzInterval *part = rz_vector_index_ptr(&parts, i);
+		ut8 *data = extent_buf_dup(extent->data + (rz_itv_begin(*part) - rz_itv_begin(extent->itv)), rz_itv_size(*part));
+		CacheExtent *tail = data ? extent_new(*part, data) : NULL;
+		if (!tail || !rz_pvector_push(&tails, tail) ||
+			!rz_pvector_reserve(&tail->writes, rz_pvector_len(&extent->writes))) {
+			if (tail) {
+				extent_free(tail);
+			} else {
+				free(data);
+			}
+			goto beach;
+		}
+	}
+	// the key may only increase within the old extent, which keeps the order of the tree
+	memmove(extent->data, extent->data + (rz_itv_begin(*head) - rz_itv_begin(extent->itv)), rz_itv_size(*head));
+	extent->itv = *head;
+	size_t kept = 0;
+	for (size_t i = 0; i < rz_pvector_len(&extent->writes); i++) {
+		CacheWrite *w = rz_pvector_at(&extent->writes, i);
+		if (rz_itv_include(extent->itv, w->itv)) {
+			rz_pvector_set(&extent->writes, kept++, w);
+			continue;
+		}
+		void **t;
+		rz_pvector_foreach (&tails, t) {
+			CacheExtent *tail = *t;
+			if (rz_itv_include(tail->itv, w->itv)) {
+				w->extent = tail;
+				rz_pvector_push(&tail->writes, w);
+				break;
+			}
+		}
+	}
+	while (rz_pvector_len(&extent->writes) > kept) {
+		rz_pvector_pop(&extent->writes);
+	}
+	rz_pvector_foreach (&tails, it) {
+		CacheExtent *tail = *it;
+		rz_rbtree_insert(&io->cache, &tail->itv.addr, &tail->rb, extent_cmp, NULL);
+	}
+	rz_pvector_clear(&tails);
+	ret = true;
+beach:
+	rz_pvector_foreach (&tails, it) {
+		extent_free(*it);
+	}
+	rz_pvector_fini(&tails);
+	rz_vector_fini(&itvs);
+	rz_vector_fini(&parts);
+	return ret;
+}
+
+/**
+ * Removes the writes of \p extent flagged as removed, from the newest to
+ * the oldest, then shrinks or splits \p extent to the bytes still cached.
+ */
+static bool extent_remove_writes(RzIO *io, CacheExtent *extent) {
+	ut64 max = 0;
+	void **it;
+	rz_pvector_foreach (&extent->writes, it) {
+		CacheWrite *w = *it;
+		if (w->removed) {
+			max = RZ_MAX(max, rz_itv_size(w->itv));
+		}
+	}
+	ut8 *done = malloc(max / 8 + 1);
+	if (!done) {
+		return false;
+	}
+	for (size_t i = rz_pvector_len(&extent->writes); i--;) {
+		CacheWrite *w = rz_pvector_at(&extent->writes, i);
+		if (!w->removed) {
+			continue;
+		}
+		extent_unstack(extent, i, done);
+		rz_pvector_remove_at(&extent->writes, i);
+		rz_list_delete(&io->cache_writes, w->log);
+	}
+	free(done);
+	return extent_split(io, extent);
+}
+
+/**
+ * Rebuilds the writes done until \p max_seq along with their bytes, by
+ * undoing the later writes of each extent one after the other, and returns
+ * them in the order they were done.
+ */
+static RzPVector /*<CacheSaved *>*/ *cache_materialize(RzIO *io, ut64 max_seq) {
+	RzPVector *ret = rz_pvector_new((RzPVectorFree)cache_saved_free);
+	if (!ret) {
+		return NULL;
+	}
+	RBIter iter;
+	CacheExtent *e;
+	rz_rbtree_foreach (io->cache, iter, e, CacheExtent, rb) {
+		ut8 *bytes = rz_mem_dup(e->data, rz_itv_size(e->itv));
+		if (!bytes) {
+			goto err;
+		}
+		for (size_t i = rz_pvector_len(&e->writes); i--;) {
+			CacheWrite *w = rz_pvector_at(&e->writes, i);
+			const ut64 off = rz_itv_begin(w->itv) - rz_itv_begin(e->itv);
+			const ut64 size = rz_itv_size(w->itv);
+			if (w->seq <= max_seq) {
+				CacheSaved *saved = RZ_NEW0(CacheSaved);
+				if (!saved || !rz_pvector_push(ret, saved)) {
+					free(saved);
+					free(bytes);
+					goto err;
+				}
+				saved->seq = w->seq;
+				saved->c.itv = w->itv;
+				saved->c.written = w->written;
+				saved->c.data = rz_mem_dup(bytes + off, size);
+				saved->c.odata = rz_mem_dup(w->odata, size);
+				if (!saved->c.data || !saved->c.odata) {
+					free(bytes);
+					goto err;
+				}
+			}
+			if (!w->prev) {
+				continue;
+			}
+			for (ut64 j = 0; j < size; j++) {
+				if (mask_get(w->prev_mask, j)) {
+					bytes[off + j] = w->prev[j];
+				}
+			}
+		}
+		free(bytes);
+	}
+	rz_pvector_sort(ret, saved_seq_cmp, NULL);
+	return ret;
+err:
+	rz_pvector_free(ret);
+	return NULL;
+}
+
+/**
+ * Saves the writes done until the last rz_io_cache_push() before they are
+ * modified, so that rz_io_cache_pop() can restore them.
+ */
+static void cache_save(RzIO *io) {
+	CacheState *state = rz_pvector_empty(&io->cache_stack) ? NULL : rz_pvector_tail(&io->cache_stack);
+	if (!state || state->saved) {
+		return;
+	}
+	state->saved = cache_materialize(io, state->seq);
+	if (!state->saved) {
+		RZ_LOG_ERROR("io: cannot save the write cache, popping it will not restore it\n");
+	}
+}
+
+/**
+ * Pushes into \p out the extents which may contain writes overlapping
+ * [from, to), with the same bounds as rz_itv_overlap().
+ */
+static void extents_in(RzIO *io, ut64 from, ut64 to, RzPVector /*<CacheExtent *>*/ *out) {
+	RBIter iter = rz_rbtree_lower_bound_forward(io->cache, &from, extent_cmp, NULL);
+	CacheExtent *e;
+	rz_rbtree_iter_while(iter, e, CacheExtent, rb) {
+		if (to && rz_itv_begin(e->itv) >= to) {
+			break;
+		}
+		rz_pvector_push(out, e);
+	}
+}
+
 RZ_API bool rz_io_cache_at(RzIO *io, ut64 addr) {
 	rz_return_val_if_fail(io, false);
-	return rz_skyline_contains(&io->cache_skyline, addr);
+	return rz_rbtree_find(io->cache, &addr, extent_cmp, NULL);
 }
 
 RZ_API void rz_io_cache_init(RzIO *io) {
 	rz_return_if_fail(io);
-	rz_pvector_init(&io->cache, (RzPVectorFree)cache_item_free);
-	rz_skyline_init(&io->cache_skyline);
+	io->cache = NULL;
+	rz_list_init(&io->cache_writes);
+	io->cache_writes.free = (RzListFree)cache_write_free;
+	io->cache_seq = 0;
+	rz_pvector_init(&io->cache_stack, (RzPVectorFree)cache_state_free);
 	io->cached = 0;
 }
 
 RZ_API void rz_io_cache_fini(RzIO *io) {
 	rz_return_if_fail(io);
-	rz_pvector_fini(&io->cache);
-	rz_skyline_fini(&io->cache_skyline);
+	cache_clear(io);
+	rz_pvector_fini(&io->cache_stack);
 	io->cached = 0;
 }
 
 RZ_API void rz_io_cache_commit(RzIO *io, ut64 from, ut64 to) {
-	void **iter;
-	RzIOCache *c;
-	RzInterval range = (RzInterval){ from, to - from };
 	rz_return_if_fail(io);
-	rz_pvector_foreach (&io->cache, iter) {
-		// if (from <= c->to - 1 && c->from <= to - 1) {
-		c = *iter;
-		if (rz_itv_overlap(c->itv, range)) {
+	RzInterval range = (RzInterval){ from, to - from };
+	RzPVector extents;
+	rz_pvector_init(&extents, NULL);
+	extents_in(io, from, to, &extents);
+	if (!rz_pvector_empty(&extents)) {
+		cache_save(io);
+	}
+	void **it, **wit;
+	rz_pvector_foreach (&extents, it) {
+		CacheExtent *e = *it;
+		rz_pvector_foreach (&e->writes, wit) {
+			CacheWrite *w = *wit;
+			if (!rz_itv_overlap(w->itv, range)) {
+				continue;
+			}
 			int cached = io->cached;
 			io->cached = 0;
-			if (rz_io_write_at(io, rz_itv_begin(c->itv), c->data, rz_itv_size(c->itv))) {
-				c->written = true;
+			const ut8 *data = e->data + (rz_itv_begin(w->itv) - rz_itv_begin(e->itv));
+			if (rz_io_write_at(io, rz_itv_begin(w->itv), data, rz_itv_size(w->itv))) {
+				w->written = true;
 			} else {
-				eprintf("Error writing change at 0x%08" PFMT64x "\n", rz_itv_begin(c->itv));
+				eprintf("Error writing change at 0x%08" PFMT64x "\n", rz_itv_begin(w->itv));
 			}
 			io->cached = cached;
-			// break; // XXX old behavior, revisit this
 		}
 	}
+	rz_pvector_fini(&extents);
 }
 
 RZ_API void rz_io_cache_reset(RzIO *io, int set) {
 	rz_return_if_fail(io);
 	io->cached = set;
-	rz_pvector_clear(&io->cache);
-	rz_skyline_clear(&io->cache_skyline);
+	cache_save(io);
+	cache_notify(io);
+	cache_clear(io);
+	io->cache_seq++;
 }
 
 RZ_API int rz_io_cache_invalidate(RzIO *io, ut64 from, ut64 to) {
 	rz_return_val_if_fail(io, 0);
 	int invalidated = 0;
-	void **iter;
-	RzIOCache *c;
 	RzInterval range = (RzInterval){ from, to - from };
-	rz_pvector_foreach_prev(&io->cache, iter) {
-		c = *iter;
-		if (rz_itv_overlap(c->itv, range)) {
+	RzPVector extents;
+	rz_pvector_init(&extents, NULL);
+	extents_in(io, from, to, &extents);
+	void **it, **wit;
+	rz_pvector_foreach (&extents, it) {
+		CacheExtent *e = *it;
+		rz_pvector_foreach (&e->writes, wit) {
+			CacheWrite *w = *wit;
+			if (rz_itv_overlap(w->itv, range)) {
+				invalidated++;
+			}
+		}
+	}
+	if (invalidated) {
+		cache_save(io);
+	}
+	rz_pvector_foreach (&extents, it) {
+		CacheExtent *e = *it;
+		bool removed = false;
+		for (size_t i = rz_pvector_len(&e->writes); i--;) {
+			CacheWrite *w = rz_pvector_at(&e->writes, i);
+			if (!rz_itv_overlap(w->itv, range)) {
+				continue;
+			}
 			int cached = io->cached;
 			io->cached = 0;
-			rz_io_write_at(io, rz_itv_begin(c->itv), c->odata, rz_itv_size(c->itv));
+			rz_io_write_at(io, rz_itv_begin(w->itv), w->odata, rz_itv_size(w->itv));
 			io->cached = cached;
-			c->written = false;
-			rz_pvector_remove_data(&io->cache, c);
-			free(c->data);
-			free(c->odata);
-			free(c);
-			invalidated++;
+			w->removed = true;
+			removed = true;
+		}
+		if (removed && !extent_remove_writes(io, e)) {
+			RZ_LOG_ERROR("io: cannot invalidate the write cache at 0x%08" PFMT64x "\n", rz_itv_begin(e->itv));
 		}
 	}
-	rz_skyline_clear(&io->cache_skyline);
-	rz_pvector_foreach (&io->cache, iter) {
-		c = *iter;
-		rz_skyline_add(&io->cache_skyline, c->itv, c);
+	rz_pvector_fini(&extents);
+	if (invalidated) {
+		io->cache_seq++;
 	}
 	return invalidated;
 }
 
 RZ_API bool rz_io_cache_write(RzIO *io, ut64 addr, const ut8 *buf, size_t len) {
 	rz_return_val_if_fail(io && buf, false);
-	RzIOCache *ch = RZ_NEW0(RzIOCache);
-	if (!ch) {
-		return false;
-	}
 	if (UT64_ADD_OVFCHK(addr, len)) {
 		const ut64 first_len = UT64_MAX - addr;
 		rz_io_cache_write(io, 0, buf + first_len, len - first_len);
 		len = first_len;
 	}
-	ch->itv = (RzInterval){ addr, len };
-	ch->odata = (ut8 *)calloc(1, len + 1);
-	if (!ch->odata) {
-		free(ch);
-		return false;
+	if (!len) {
+		return true;
 	}
-	ch->data = (ut8 *)calloc(1, len + 1);
-	if (!ch->data) {
-		free(ch->odata);
-		free(ch);
+	ut8 *odata = calloc(1, len);
+	if (!odata) {
 		return false;
 	}
-	ch->written = false;
 	{
 		const bool cm = io->cachemode;
 		io->cachemode = false;
-		rz_io_read_at(io, addr, ch->odata, len);
+		rz_io_read_at(io, addr, odata, len);
 		io->cachemode = cm;
 	}
-	memcpy(ch->data, buf, len);
-	rz_pvector_push(&io->cache, ch);
-	rz_skyline_add(&io->cache_skyline, ch->itv, ch);
-	RzEventIOWrite iow = { addr, buf, len };
+	if (!cache_insert(io, ++io->cache_seq, addr, buf, odata, len)) {
+		free(odata);
+		return false;
+	}
+	RzEventIOWrite iow = { addr, buf, len, -1 };
 	rz_event_send(io->event, RZ_EVENT_IO_WRITE, &iow);
 	return true;
 }
 
 RZ_API bool rz_io_cache_read(RzIO *io, ut64 addr, ut8 *buf, size_t len) {
 	rz_return_val_if_fail(io && buf, false);
-	RzSkyline *skyline = &io->cache_skyline;
 	if (!len) {
 		return true;
 	}
@@ -139,31 +742,127 @@ RZ_API bool rz_io_cache_read(RzIO *io, ut64 addr, ut8 *buf, size_t len) {
 		rz_io_cache_read(io, 0, buf + first_len, len - first_len);
 		len = first_len;
 	}
-	const RzSkylineItem *iter = rz_skyline_get_item_intersect(skyline, addr, len);
-	if (!iter) {
-		return false;
-	}
-	const RzSkylineItem *last = (RzSkylineItem *)skyline->v.a + skyline->v.len;
+	const ut64 end = addr + len;
 	bool covered = false;
-	while (iter != last) {
-		const ut64 begin = rz_itv_begin(iter->itv);
-		const st64 addr_offset = begin - addr;
-		const ut64 buf_offset = addr_offset > 0 ? addr_offset : 0;
-		const ut64 cur_addr = addr + buf_offset;
-		const ut64 left = len - buf_offset;
-		if (begin > cur_addr + left) {
+	RBIter iter = rz_rbtree_lower_bound_forward(io->cache, &addr, extent_cmp, NULL);
+	CacheExtent *e;
+	rz_rbtree_iter_while(iter, e, CacheExtent, rb) {
+		const ut64 begin = RZ_MAX(rz_itv_begin(e->itv), addr);
+		if (begin >= end) {
 			break;
 		}
-		RzIOCache *cache = iter->user;
-		const ut64 cache_shift = addr_offset < 0 ? -addr_offset : 0;
-		const ut64 cache_offset = begin - rz_itv_begin(cache->itv) + cache_shift;
-		const ut64 read = RZ_MIN(left, rz_itv_size(iter->itv) - cache_shift);
-		memcpy(buf + buf_offset, cache->data + cache_offset, read);
+		const ut64 read = RZ_MIN(rz_itv_end(e->itv), end) - begin;
+		memcpy(buf + (begin - addr), e->data + (begin - rz_itv_begin(e->itv)), read);
 		covered = true;
-		if (left - read <= 0) {
+	}
+	return covered;
+}
+
+/**
+ * \brief Returns the writes done in the cache along with the bytes they
+ * wrote, in the order they were done
+ */
+RZ_API RZ_OWN RzList /*<RzIOCache *>*/ *rz_io_cache_list(RZ_NONNULL RzIO *io) {
+	rz_return_val_if_fail(io, NULL);
+	RzPVector *saved = cache_materialize(io, UT64_MAX);
+	RzList *ret = saved ? rz_list_newf((RzListFree)cache_item_free) : NULL;
+	if (!ret) {
+		rz_pvector_free(saved);
+		return NULL;
+	}
+	void **it;
+	rz_pvector_foreach (saved, it) {
+		CacheSaved *s = *it;
+		RzIOCache *c = RZ_NEW(RzIOCache);
+		if (!c || !rz_list_append(ret, c)) {
+			free(c);
+			rz_list_free(ret);
+			ret = NULL;
 			break;
 		}
-		iter++;
+		*c = s->c;
+		s->c.data = NULL;
+		s->c.odata = NULL;
 	}
-	return covered;
+	rz_pvector_free(saved);
+	return ret;
+}
+
+/**
+ * \brief Saves the state of the cache, so that all the writes done until
+ * the next rz_io_cache_pop() can be discarded
+ *
+ * Nothing is copied as long as the writes done before the push are not
+ * invalidated, committed or reset.
+ */
+RZ_API bool rz_io_cache_push(RzIO *io) {
+	rz_return_val_if_fail(io, false);
+	CacheState *state = RZ_NEW0(CacheState);
+	if (!state) {
+		return false;
+	}
+	state->seq = io->cache_seq;
+	if (!rz_pvector_push(&io->cache_stack, state)) {
+		free(state);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Discards all the writes done in the cache since the last rz_io_cache_push()
+ */
+RZ_API bool rz_io_cache_pop(RzIO *io) {
+	rz_return_val_if_fail(io, false);
+	if (rz_pvector_empty(&io->cache_stack)) {
+		return false;
+	}
+	bool ret = true;
+	CacheState *state = rz_pvector_pop(&io->cache_stack);
+	cache_notify(io);
+	if (state->saved) {
+		cache_clear(io);
+		void **it;
+		rz_pvector_foreach (state->saved, it) {
+			CacheSaved *s = *it;
+			ut8 *odata = rz_mem_dup(s->c.odata, rz_itv_size(s->c.itv));
+			CacheWrite *w = odata ? cache_insert(io, s->seq, rz_itv_begin(s->c.itv), s->c.data, odata, rz_itv_size(s->c.itv)) : NULL;
+			if (!w) {
+				free(odata);
+				ret = false;
+				break;
+			}
+			w->written = s->c.written;
+		}
+	} else {
+		// the writes done since the push are the last ones of the log
+		RzPVector extents;
+		rz_pvector_init(&extents, NULL);
+		for (RzListIter *it = io->cache_writes.tail; it; it = it->prev) {
+			CacheWrite *w = it->elem;
+			if (w->seq <= state->seq) {
+				break;
+			}
+			w->removed = true;
+			rz_pvector_push(&extents, w->extent);
+		}
+		rz_pvector_sort(&extents, ptr_cmp, NULL);
+		CacheExtent *prev = NULL;
+		void **it;
+		rz_pvector_foreach (&extents, it) {
+			CacheExtent *e = *it;
+			if (e != prev && !extent_remove_writes(io, e)) {
+				ret = false;
+			}
+			prev = e;
+		}
+		rz_pvector_fini(&extents);
+	}
+	if (!ret) {
+		RZ_LOG_ERROR("io: cannot restore the write cache\n");
+	}
+	cache_state_free(state);
+	io->cache_seq++;
+	cache_notify(io);
+	return ret;
 }
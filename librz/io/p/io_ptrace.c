@@ -15,11 +15,20 @@
 #include <sys/wait.h>
 #include <errno.h>
 
+// process_vm_readv() and process_vm_writev() are available since linux 3.2
+#if __linux__ && !(defined(__ANDROID__) && __ANDROID_API__ < 23)
+#define USE_PROCESS_VM 1
+#include <sys/uio.h>
+#else
+#define USE_PROCESS_VM 0
+#endif
+
 typedef struct {
 	int pid;
 	int tid;
 	int fd;
 	int opid;
+	bool use_vm; ///< Try process_vm_readv() and process_vm_writev() before ptrace
 } RzIOPtrace;
 #define RzIOPTRACE_OPID(x) (((RzIOPtrace *)(x)->data)->opid)
 #define RzIOPTRACE_PID(x)  (((RzIOPtrace *)(x)->data)->pid)
@@ -81,15 +90,14 @@ static int debug_os_read_at(RzIO *io, int pid, ut32 *buf, int sz, ut64 addr) {
 	return sz;
 }
 
-static int __read(RzIO *io, RzIODesc *desc, ut8 *buf, size_t len) {
+/**
+ * Reads through /proc/pid/mem or ptrace, which can also read the pages
+ * mapped without read permission.
+ */
+static int ptrace_read_at(RzIO *io, RzIODesc *desc, ut8 *buf, size_t len, ut64 addr) {
 #if USE_PROC_PID_MEM
 	int ret, fd;
 #endif
-	ut64 addr = io->off;
-	if (!desc || !desc->data) {
-		return -1;
-	}
-	memset(buf, '\xff', len); // TODO: only memset the non-readed bytes
 	/* reopen procpidmem if necessary */
 #if USE_PROC_PID_MEM
 	fd = RzIOPTRACE_FD(desc);
@@ -127,6 +135,140 @@ static int __read(RzIO *io, RzIODesc *desc, ut8 *buf, size_t len) {
 	return -1;
 }
 
+#if USE_PROCESS_VM
+#define VM_PAGE_SIZE 0x1000
+
+/**
+ * Reads with process_vm_readv(), which costs a single syscall instead of one
+ * per word with ptrace. It does not force the access like ptrace though, so
+ * the pages it cannot read (e.g. PROT_NONE or execute-only) are read one by
+ * one with ptrace_read_at().
+ * Returns the number of bytes read before process_vm_readv() failed for
+ * another reason, in which case the caller falls back to ptrace for the rest.
+ */
+static size_t process_vm_read_at(RzIO *io, RzIODesc *desc, ut8 *buf, size_t len, ut64 addr) {
+	RzIOPtrace *iop = desc->data;
+	size_t done = 0;
+	while (done < len) {
+		struct iovec local = { buf + done, len - done };
+		struct iovec remote = { (void *)(size_t)(addr + done), len - done };
+		ssize_t r = process_vm_readv(iop->pid, &local, 1, &remote, 1, 0);
+		if (r > 0) {
+			done += r;
+			continue;
+		}
+		if (r < 0 && errno != EFAULT && errno != EIO) {
+			if (errno == ENOSYS) {
+				// not supported by the kernel, do not try again
+				iop->use_vm = false;
+			}
+			break;
+		}
+		const ut64 page_end = (addr + done + VM_PAGE_SIZE) & ~(ut64)(VM_PAGE_SIZE - 1);
+		const size_t chunk = RZ_MIN(page_end - (addr + done), len - done);
+		ptrace_read_at(io, desc, buf + done, chunk, addr + done);
+		done += chunk;
+	}
+	return done;
+}
+
+/**
+ * Writes with process_vm_writev(), which fails on read-only pages unlike ptrace.
+ * Returns the number of bytes written, -1 if process_vm_writev() failed for
+ * another reason than an unwritable page.
+ */
+static int process_vm_write_at(RzIOPtrace *iop, const ut8 *buf, size_t len, ut64 addr) {
+	struct iovec local = { (void *)buf, len };
+	struct iovec remote = { (void *)(size_t)addr, len };
+	ssize_t r = process_vm_writev(iop->pid, &local, 1, &remote, 1, 0);
+	if (r < 0) {
+		if (errno == EFAULT || errno == EIO) {
+			return 0;
+		}
+		if (errno == ENOSYS) {
+			// not supported by the kernel, do not try again
+			iop->use_vm = false;
+		}
+		return -1;
+	}
+	return r;
+}
+#endif
+
+static int read_at(RzIO *io, RzIODesc *desc, ut8 *buf, size_t len, ut64 addr) {
+	memset(buf, '\xff', len); // TODO: only memset the non-readed bytes
+#if USE_PROCESS_VM
+	RzIOPtrace *iop = desc->data;
+	if (iop->use_vm && len > 0 && addr != UT64_MAX) {
+		size_t done = process_vm_read_at(io, desc, buf, len, addr);
+		if (done == len) {
+			return len;
+		}
+		if (done) {
+			// e.g. forbidden by seccomp, read the rest with ptrace
+			ptrace_read_at(io, desc, buf + done, len - done, addr + done);
+			return len;
+		}
+	}
+#endif
+	return ptrace_read_at(io, desc, buf, len, addr);
+}
+
+static int __read(RzIO *io, RzIODesc *desc, ut8 *buf, size_t len) {
+	if (!desc || !desc->data) {
+		return -1;
+	}
+	return read_at(io, desc, buf, len, io->off);
+}
+
+#if USE_PROCESS_VM
+#define VM_BATCH_MAX 1024 // IOV_MAX on linux
+
+/**
+ * Reads the requests with as few process_vm_readv() calls as possible.
+ * The request it stops in, e.g. because of an unreadable page, is read on its
+ * own with read_at() and the batch goes on from the next one.
+ */
+static bool __read_batch(RzIO *io, RzIODesc *desc, RzIOReadReq *reqs, size_t count) {
+	if (!desc || !desc->data) {
+		return false;
+	}
+	RzIOPtrace *iop = desc->data;
+	struct iovec local[VM_BATCH_MAX], remote[VM_BATCH_MAX];
+	bool ret = true, vm = iop->use_vm;
+	size_t i = 0;
+	while (i < count) {
+		size_t n = 0;
+		for (; vm && n < VM_BATCH_MAX && i + n < count; n++) {
+			RzIOReadReq *req = &reqs[i + n];
+			local[n] = (struct iovec){ req->buf, req->len };
+			remote[n] = (struct iovec){ (void *)(size_t)req->addr, req->len };
+		}
+		ssize_t r = n ? process_vm_readv(iop->pid, local, n, remote, n, 0) : -1;
+		if (r < 0 && errno != EFAULT && errno != EIO) {
+			// e.g. forbidden by seccomp, read the rest one by one
+			if (errno == ENOSYS) {
+				iop->use_vm = false;
+			}
+			vm = false;
+		}
+		size_t done = r > 0 ? r : 0;
+		const size_t end = i + n;
+		for (; i < end && done >= reqs[i].len; i++) {
+			done -= reqs[i].len;
+			reqs[i].ok = true;
+		}
+		if (i < count) {
+			RzIOReadReq *req = &reqs[i];
+			req->ok = read_at(io, desc, req->buf, req->len, req->addr) == req->len;
+			ret &= req->ok;
+			i++;
+		}
+	}
+	return ret;
+}
+#endif
+
 static int ptrace_write_at(RzIO *io, int pid, const ut8 *pbuf, int sz, ut64 addr) {
 	ptrace_word *buf = (ptrace_word *)pbuf;
 	ut32 words = sz / sizeof(ptrace_word);
@@ -156,6 +298,20 @@ static int __write(RzIO *io, RzIODesc *fd, const ut8 *buf, size_t len) {
 	if (!fd || !fd->data) {
 		return -1;
 	}
+#if USE_PROCESS_VM
+	RzIOPtrace *iop = fd->data;
+	if (iop->use_vm && len > 0 && io->off != UT64_MAX) {
+		int res = process_vm_write_at(iop, buf, len, io->off);
+		if (res == len) {
+			return res;
+		}
+		if (res > 0) {
+			// the rest is probably in a read-only page, which only ptrace can write
+			int rest = ptrace_write_at(io, iop->pid, buf + res, len - res, io->off + res);
+			return rest < 0 ? res : res + rest;
+		}
+	}
+#endif
 	return ptrace_write_at(io, RzIOPTRACE_PID(fd), buf, len, io->off);
 }
 
@@ -253,6 +409,7 @@ static RzIODesc *__open(RzIO *io, const char *file, int rw, int mode) {
 	}
 
 	riop->pid = riop->tid = pid;
+	riop->use_vm = USE_PROCESS_VM;
 	open_pidmem(riop);
 	desc = rz_io_desc_new(io, &rz_io_plugin_ptrace, file, rw | RZ_PERM_X, mode, riop);
 	desc->name = rz_sys_pid_to_path(pid);
@@ -305,13 +462,15 @@ static char *__system(RzIO *io, RzIODesc *fd, const char *cmd) {
 	if (!strcmp(cmd, "help")) {
 		eprintf("Usage: R!cmd args\n"
 			" R!ptrace   - use ptrace io\n"
-			" R!mem      - use /proc/pid/mem io if possible\n"
+			" R!mem      - use process_vm_readv or /proc/pid/mem io if possible\n"
 			" R!pid      - show targeted pid\n"
 			" R!pid <#>  - select new pid\n");
 	} else if (!strcmp(cmd, "ptrace")) {
 		close_pidmem(iop);
+		iop->use_vm = false;
 	} else if (!strcmp(cmd, "mem")) {
 		open_pidmem(iop);
+		iop->use_vm = USE_PROCESS_VM;
 	} else if (!strncmp(cmd, "pid", 3)) {
 		if (iop) {
 			if (cmd[3] == ' ') {
@@ -349,6 +508,9 @@ RzIOPlugin rz_io_plugin_ptrace = {
 	.open = __open,
 	.close = __close,
 	.read = __read,
+#if USE_PROCESS_VM
+	.read_batch = __read_batch,
+#endif
 	.check = __plugin_open,
 	.lseek = __lseek,
 	.system = __system,
@@ -134,7 +134,7 @@ RZ_API int rz_io_desc_cache_write(RzIODesc *desc, ut64 paddr, const ut8 *buf, si
 		caddr++;
 		cbaddr = 0;
 	}
-	RzEventIOWrite iow = { paddr, buf, len };
+	RzEventIOWrite iow = { paddr, buf, len, desc->fd };
 	rz_event_send(desc->io->event, RZ_EVENT_IO_WRITE, &iow);
 	return written;
 }
@@ -73,6 +73,7 @@ typedef struct diff_context_t {
 	DiffOption option;
 	DiffDistance distance;
 	ut32 arch_bits;
+	double candidate_threshold;
 	bool compare_addresses;
 	bool show_time;
 	bool colors;
@@ -213,6 +214,7 @@ static void rz_diff_show_help(bool usage_only) {
 		"-H",       "",             "Hexadecimal visual mode",
 		"-h",       "",             "Show this help",
 		"-j",       "",             "JSON output",
+		"-m",       "[ratio]",      "Only compare functions with an estimated similarity >= ratio (0.0-1.0)",
 		"-q",       "",             "Quite output",
 		"-V",       "",             "Show version information",
 		"-v",       "",             "Be more verbose (stderr output)",
@@ -291,7 +293,7 @@ static void rz_diff_parse_arguments(int argc, const char **argv, DiffContext *ct
 
 	RzGetopt opt;
 	int c;
-	rz_getopt_init(&opt, argc, argv, "hHjqvViABCTa:b:e:d:t:0:1:S:");
+	rz_getopt_init(&opt, argc, argv, "hHjqvViABCTa:b:e:d:m:t:0:1:S:");
 	while ((c = rz_getopt_next(&opt)) != -1) {
 		switch (c) {
 		case '0': rz_diff_ctx_set_def(ctx, input_a, NULL, opt.arg); break;
@@ -303,6 +305,14 @@ static void rz_diff_parse_arguments(int argc, const char **argv, DiffContext *ct
 		case 'a': rz_diff_ctx_set_def(ctx, architecture, NULL, opt.arg); break;
 		case 'b': rz_diff_ctx_set_unsigned(ctx, arch_bits, opt.arg); break;
 		case 'd': rz_diff_set_def(algorithm, NULL, opt.arg); break;
+		case 'm': {
+			char *end = NULL;
+			ctx->candidate_threshold = strtod(opt.arg, &end);
+			if (end == opt.arg || *end || !(ctx->candidate_threshold >= 0.0 && ctx->candidate_threshold <= 1.0)) {
+				rz_diff_error_opt(ctx, DIFF_OPT_ERROR, "option -m argument '%s' is not a ratio between 0.0 and 1.0.\n", opt.arg);
+			}
+			break;
+		}
 		case 'h': rz_diff_ctx_set_opt(ctx, DIFF_OPT_HELP); break;
 		case 'i': rz_diff_ctx_set_def(ctx, command_line, false, true); break;
 		case 'j': rz_diff_ctx_set_mode(ctx, DIFF_MODE_JSON); break;
@@ -1887,7 +1897,7 @@ static bool diff_check_ctrl_c(const size_t n_left, const size_t n_matches, void
 	return !rz_cons_is_breaked();
 }
 
-static RzAnalysisFunction *find_best_matching_function(RzAnalysis *analysis_a, RzAnalysis *analysis_b, RzAnalysisFunction *find, bool verbose) {
+static RzAnalysisFunction *find_best_matching_function(RzAnalysis *analysis_a, RzAnalysis *analysis_b, RzAnalysisFunction *find, double candidate_threshold, bool verbose) {
 	RzAnalysisMatchPair *pair = NULL;
 	RzAnalysisFunction *match = NULL;
 	RzAnalysisMatchResult *result = NULL;
@@ -1901,6 +1911,7 @@ static RzAnalysisFunction *find_best_matching_function(RzAnalysis *analysis_a, R
 	opts.callback = verbose ? diff_progess_status : diff_check_ctrl_c;
 	opts.analysis_a = analysis_a;
 	opts.analysis_b = analysis_b;
+	opts.candidate_threshold = candidate_threshold;
 
 	result = rz_analysis_match_functions(list_a, analysis_b->fcns, &opts);
 	if (result && rz_list_length(result->matches) > 0) {
@@ -1930,7 +1941,7 @@ static int comparePairBlocks(const RzAnalysisMatchPair *ma, const RzAnalysisMatc
  * Each node that doesn't match 100% with the other function will include
  * a unified diff of the assembly of the same basic block.
  * */
-static void core_show_function_diff(RzCore *core_a, ut64 addr_a, RzCore *core_b, ut64 addr_b, DiffMode mode, bool verbose) {
+static void core_show_function_diff(RzCore *core_a, ut64 addr_a, RzCore *core_b, ut64 addr_b, DiffMode mode, double candidate_threshold, bool verbose) {
 	rz_return_if_fail(core_a && core_b);
 
 	PJ *pj = NULL;
@@ -1947,7 +1958,7 @@ static void core_show_function_diff(RzCore *core_a, ut64 addr_a, RzCore *core_b,
 
 	if (addr_b == UT64_MAX) {
 		// find matching function on core B
-		fcn_b = find_best_matching_function(core_a->analysis, core_b->analysis, fcn_a, verbose);
+		fcn_b = find_best_matching_function(core_a->analysis, core_b->analysis, fcn_a, candidate_threshold, verbose);
 		if (!fcn_b) {
 			RZ_LOG_ERROR("rz-diff: cannot find best matching function for function at 0x%" PFMT64x "\n", addr_a);
 			return;
@@ -2077,7 +2088,7 @@ static int comparePairFunctions(const RzAnalysisMatchPair *ma, const RzAnalysisM
  * Then the scores are shown in a table (when in quiet mode, the table
  * is headerless)
  * */
-static void core_diff_show(RzCore *core_a, RzCore *core_b, DiffMode mode, bool verbose) {
+static void core_diff_show(RzCore *core_a, RzCore *core_b, DiffMode mode, double candidate_threshold, bool verbose) {
 	rz_return_if_fail(core_a && core_b);
 
 	char *output = NULL;
@@ -2106,6 +2117,7 @@ static void core_diff_show(RzCore *core_a, RzCore *core_b, DiffMode mode, bool v
 	opts.callback = verbose ? diff_progess_status : diff_check_ctrl_c;
 	opts.analysis_a = core_a->analysis;
 	opts.analysis_b = core_b->analysis;
+	opts.candidate_threshold = candidate_threshold;
 
 	// calculate all the matches between the functions of the 2 different core files.
 	result = rz_analysis_match_functions(fcns_a, fcns_b, &opts);
@@ -2282,7 +2294,7 @@ static bool rz_diff_graphs_files(DiffContext *ctx) {
 		if (ctx->verbose) {
 			fprintf(stderr, "rz-diff: start diffing.\n");
 		}
-		core_show_function_diff(a->core, address_a, b->core, address_b, ctx->mode, ctx->verbose);
+		core_show_function_diff(a->core, address_a, b->core, address_b, ctx->mode, ctx->candidate_threshold, ctx->verbose);
 	} else {
 		if (ctx->verbose) {
 			fprintf(stderr, "rz-diff: analysing file '%s'\n", ctx->file_a);
@@ -2301,7 +2313,7 @@ static bool rz_diff_graphs_files(DiffContext *ctx) {
 		if (ctx->verbose) {
 			fprintf(stderr, "rz-diff: start diffing.\n");
 		}
-		core_diff_show(a->core, b->core, ctx->mode, ctx->verbose);
+		core_diff_show(a->core, b->core, ctx->mode, ctx->candidate_threshold, ctx->verbose);
 	}
 
 	success = true;
@@ -10,8 +10,11 @@
 #include <rz_util.h>
 #include <rz_crypto.h>
 #include <rz_lib.h>
+#include <rz_th.h>
 
-#define RZ_HASH_DEFAULT_BLOCK_SIZE 0x1000
+#define RZ_HASH_DEFAULT_BLOCK_SIZE  0x1000
+#define RZ_HASH_FANOUT_CHUNK_SIZE   0x400000
+#define RZ_HASH_PARALLEL_BATCH_SIZE 256
 
 typedef struct {
 	ut8 *buf;
@@ -52,6 +55,7 @@ typedef struct rz_hash_context {
 	bool show_blocks;
 	bool use_stdin;
 	char *algorithm;
+	RzList /*<char *>*/ *algorithms;
 	char *compare;
 	char *input;
 	char *iv;
@@ -64,15 +68,19 @@ typedef struct rz_hash_context {
 	ut32 nfiles;
 	ut64 block_size;
 	ut64 iterate;
+	size_t threads;
 	/* Output here */
 	PJ *pj;
 } RzHashContext;
 
 typedef bool (*RzHashRun)(RzHashContext *ctx, RzIO *io, const char *filename);
 
+static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename);
+static bool hash_context_run_parallel(RzHashContext *ctx);
+
 static void rz_hash_show_help(bool usage_only) {
 	printf("%s%s%s", Color_CYAN, "Usage: ", Color_RESET);
-	printf("rz-hash [-vhBkjLq] [-b S] [-a A] [-c H] [-E A] [-D A] [-s S] [-x S] [-f O] [-t O] [files|-] ...\n");
+	printf("rz-hash [-vhBkjLq] [-b S] [-a A] [-c H] [-E A] [-D A] [-s S] [-x S] [-f O] [-t O] [-T N] [files|-] ...\n");
 	if (usage_only) {
 		return;
 	}
@@ -91,6 +99,7 @@ static void rz_hash_show_help(bool usage_only) {
 		"-E",     "algo",   "Encrypt the given input; use -S to set key and -I to set IV (if needed)",
 		"-f",     "from",   "Start the calculation at given offset",
 		"-t",     "to",     "Stop the calculation at given offset",
+		"-T",     "num",    "Set the number of threads (default: all cores, 1 disables threading)",
 		"-I",     "iv",     "Set the initialization vector (IV)",
 		"-i",     "times",  "Repeat the calculation N times",
 		"-j",     "",       "Output the result as a JSON structure",
@@ -340,7 +349,7 @@ static void hash_parse_cmdline(int argc, const char **argv, RzHashContext *ctx)
 
 	RzGetopt opt;
 	int c;
-	rz_getopt_init(&opt, argc, argv, "jD:e:vE:a:i:I:S:K:s:x:b:nBhf:t:kLqc:");
+	rz_getopt_init(&opt, argc, argv, "jD:e:vE:a:i:I:S:K:s:x:b:nBhf:t:T:kLqc:");
 	while ((c = rz_getopt_next(&opt)) != -1) {
 		switch (c) {
 		case 'q': rz_hash_ctx_set_quiet(ctx); break;
@@ -368,6 +377,7 @@ static void hash_parse_cmdline(int argc, const char **argv, RzHashContext *ctx)
 		case 'b': rz_hash_ctx_set_unsigned(ctx, block_size, opt.arg); break;
 		case 'f': rz_hash_ctx_set_unsigned(ctx, offset.from, opt.arg); break;
 		case 't': rz_hash_ctx_set_unsigned(ctx, offset.to, opt.arg); break;
+		case 'T': rz_hash_ctx_set_unsigned(ctx, threads, opt.arg); break;
 		case 'v': ctx->operation = RZ_HASH_OP_VERSION; break;
 		case 'h': ctx->operation = RZ_HASH_OP_HELP; break;
 		case 's': rz_hash_ctx_set_input(ctx, input, opt.arg, false); break;
@@ -506,6 +516,7 @@ static void hash_parse_cmdline(int argc, const char **argv, RzHashContext *ctx)
 }
 
 static void hash_context_fini(RzHashContext *ctx) {
+	rz_list_free(ctx->algorithms);
 	free(ctx->algorithm);
 	free(ctx->compare);
 	free(ctx->iv);
@@ -652,6 +663,10 @@ static bool hash_context_run(RzHashContext *ctx, RzHashRun run) {
 		if (ctx->mode == RZ_HASH_MODE_JSON) {
 			pj_end(ctx->pj);
 		}
+	} else if (run == calculate_hash && !ctx->show_blocks && ctx->nfiles > 1 && ctx->threads != 1) {
+		if (!hash_context_run_parallel(ctx)) {
+			goto rz_hash_context_run_end;
+		}
 	} else {
 		for (ut32 i = 0; i < ctx->nfiles; ++i) {
 			desc = rz_io_open_nomap(io, ctx->files[i], RZ_PERM_R, 0);
@@ -817,168 +832,197 @@ static RzList /*<char *>*/ *parse_hash_algorithms(RzHashContext *ctx) {
 	return rz_str_split_list(ctx->algorithm, ",", 0);
 }
 
-static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename) {
-	bool result = false;
-	const char *algorithm;
-	RzList *algorithms = NULL;
-	RzListIter *it;
-	RzHashCfg *md = NULL;
-	ut64 bsize = 0;
-	ut64 filesize;
-	ut8 *block = NULL;
-	ut8 *cmphash = NULL;
-	const ut8 *digest = NULL;
-	RzHashSize digest_size = 0;
-
-	algorithms = parse_hash_algorithms(ctx);
-	if (!algorithms || rz_list_length(algorithms) < 1) {
-		RZ_LOG_ERROR("rz-hash: error, empty list of hash algorithms\n");
-		goto calculate_hash_end;
-	}
-
-	filesize = rz_io_desc_size(io->desc);
-
-	md = rz_hash_cfg_new(ctx->rh);
-	if (!md) {
-		RZ_LOG_ERROR("rz-hash: error, cannot allocate hash context memory\n");
-		goto calculate_hash_end;
+static RzList /*<char *>*/ *hash_context_algorithms(RzHashContext *ctx) {
+	if (!ctx->algorithms) {
+		// the list borrows the names from ctx->algorithm, which is split in place
+		ctx->algorithms = parse_hash_algorithms(ctx);
 	}
+	return ctx->algorithms;
+}
 
+static bool hash_check_range(RzHashContext *ctx, ut64 filesize) {
 	if (ctx->offset.to > filesize) {
 		RZ_LOG_ERROR("rz-hash: error, -t value is greater than file size\n");
-		goto calculate_hash_end;
+		return false;
 	}
-
 	if (ctx->offset.from > filesize) {
 		RZ_LOG_ERROR("rz-hash: error, -f value is greater than file size\n");
-		goto calculate_hash_end;
+		return false;
 	}
+	return true;
+}
 
-	bsize = ctx->block_size;
-	block = malloc(bsize);
-	if (!block) {
-		RZ_LOG_ERROR("rz-hash: error, cannot allocate block memory\n");
-		goto calculate_hash_end;
+static RzHashCfg *hash_cfg_new_configured(RzHashContext *ctx, RzList /*<char *>*/ *algorithms) {
+	const char *algorithm;
+	RzListIter *it;
+
+	RzHashCfg *md = rz_hash_cfg_new(ctx->rh);
+	if (!md) {
+		RZ_LOG_ERROR("rz-hash: error, cannot allocate hash context memory\n");
+		return NULL;
 	}
 
 	rz_list_foreach (algorithms, it, algorithm) {
 		if (!rz_hash_cfg_configure(md, algorithm)) {
-			goto calculate_hash_end;
+			rz_hash_cfg_free(md);
+			return NULL;
 		}
 	}
 
 	if (ctx->key.len > 0 && !rz_hash_cfg_hmac(md, ctx->key.buf, ctx->key.len)) {
-		goto calculate_hash_end;
+		rz_hash_cfg_free(md);
+		return NULL;
 	}
+	return md;
+}
 
-	if (ctx->compare) {
-		ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
-		size_t cmphashlen = 0;
-		bool result = false;
+/**
+ * Computes the digests of the selected range in one read pass.
+ * With multiple algorithms and \p threads != 1 the data is read in
+ * bigger chunks and each chunk is fed to all the algorithms in parallel.
+ */
+static bool hash_compute(RzHashContext *ctx, RzIO *io, RzHashCfg *md, ut64 filesize, size_t threads) {
+	bool result = false;
+	ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
+	ut64 bsize = ctx->block_size;
+	bool fanout = threads != 1 && rz_list_length(md->configurations) > 1 && to - ctx->offset.from > bsize;
+	if (fanout && bsize < RZ_HASH_FANOUT_CHUNK_SIZE) {
+		bsize *= RZ_HASH_FANOUT_CHUNK_SIZE / bsize;
+	}
 
-		if (!hash_parse_hexadecimal("-c", ctx->compare, &cmphash, &cmphashlen)) {
-			// RZ_LOG_ERROR("rz-hash: error, cannot allocate block memory\n");
-			goto calculate_hash_end;
-		}
+	ut8 *block = malloc(bsize);
+	if (!block) {
+		RZ_LOG_ERROR("rz-hash: error, cannot allocate block memory\n");
+		return false;
+	}
 
-		if (!rz_hash_cfg_init(md)) {
-			goto calculate_hash_end;
-		}
+	if (!rz_hash_cfg_init(md)) {
+		goto hash_compute_end;
+	}
 
-		if (ctx->as_prefix && ctx->seed.buf &&
-			!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
-			goto calculate_hash_end;
-		}
+	if (ctx->as_prefix && ctx->seed.buf &&
+		!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
+		goto hash_compute_end;
+	}
 
-		for (ut64 j = ctx->offset.from; j < to; j += bsize) {
-			int read = rz_io_pread_at(io, j, block, to - j > bsize ? bsize : (to - j));
-			if (!rz_hash_cfg_update(md, block, read)) {
-				goto calculate_hash_end;
-			}
+	for (ut64 j = ctx->offset.from; j < to; j += bsize) {
+		int read = rz_io_pread_at(io, j, block, to - j > bsize ? bsize : (to - j));
+		if (!(fanout ? rz_hash_cfg_update_mt(md, block, read, threads) : rz_hash_cfg_update(md, block, read))) {
+			goto hash_compute_end;
 		}
+	}
 
-		if (!ctx->as_prefix && ctx->seed.buf &&
-			!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
-			goto calculate_hash_end;
-		}
-		if (!rz_hash_cfg_final(md) ||
-			!rz_hash_cfg_iterate(md, ctx->iterate)) {
-			goto calculate_hash_end;
-		}
+	if (!ctx->as_prefix && ctx->seed.buf &&
+		!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
+		goto hash_compute_end;
+	}
 
-		rz_list_foreach (algorithms, it, algorithm) {
-			digest = rz_hash_cfg_get_result(md, algorithm, &digest_size);
-			if (digest_size != cmphashlen) {
-				result = false;
-			} else {
-				result = !memcmp(cmphash, digest, digest_size);
-			}
+	result = rz_hash_cfg_final(md) && rz_hash_cfg_iterate(md, ctx->iterate);
+
+hash_compute_end:
+	free(block);
+	return result;
+}
+
+static bool hash_print_results(RzHashContext *ctx, RzHashCfg *md, RzList /*<char *>*/ *algorithms, ut64 filesize, const char *filename) {
+	const char *algorithm;
+	RzListIter *it;
+	const ut8 *digest = NULL;
+	RzHashSize digest_size = 0;
+	ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
 
+	if (!ctx->compare) {
+		rz_list_foreach (algorithms, it, algorithm) {
 			if (ctx->mode == RZ_HASH_MODE_JSON) {
 				pj_o(ctx->pj);
 			}
-			hash_context_compare_hashes(ctx, filesize, result, algorithm, filename);
+			hash_print_digest(ctx, md, algorithm, ctx->offset.from, to, filename);
 			if (ctx->mode == RZ_HASH_MODE_JSON) {
 				pj_end(ctx->pj);
 			}
 		}
-	} else if (ctx->show_blocks) {
-		ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
-		for (ut64 j = ctx->offset.from; j < to; j += bsize) {
-			int read = rz_io_pread_at(io, j, block, to - j > bsize ? bsize : (to - j));
-			if (!rz_hash_cfg_init(md) ||
-				!rz_hash_cfg_update(md, block, read) ||
-				!rz_hash_cfg_final(md) ||
-				!rz_hash_cfg_iterate(md, ctx->iterate)) {
-				goto calculate_hash_end;
-			}
+		return true;
+	}
 
-			rz_list_foreach (algorithms, it, algorithm) {
-				digest = rz_hash_cfg_get_result(md, algorithm, &digest_size);
-				if (ctx->mode == RZ_HASH_MODE_JSON) {
-					pj_o(ctx->pj);
-				}
-				hash_print_digest(ctx, md, algorithm, j, j + bsize, filename);
-				if (ctx->mode == RZ_HASH_MODE_JSON) {
-					pj_end(ctx->pj);
-				}
-			}
-		}
-	} else {
-		ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
-		if (!rz_hash_cfg_init(md)) {
-			goto calculate_hash_end;
-		}
+	ut8 *cmphash = NULL;
+	size_t cmphashlen = 0;
+	if (!hash_parse_hexadecimal("-c", ctx->compare, &cmphash, &cmphashlen)) {
+		return false;
+	}
 
-		if (ctx->as_prefix && ctx->seed.buf &&
-			!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
-			goto calculate_hash_end;
+	rz_list_foreach (algorithms, it, algorithm) {
+		bool result = false;
+		digest = rz_hash_cfg_get_result(md, algorithm, &digest_size);
+		if (digest_size == cmphashlen) {
+			result = !memcmp(cmphash, digest, digest_size);
 		}
 
-		for (ut64 j = ctx->offset.from; j < to; j += bsize) {
-			int read = rz_io_pread_at(io, j, block, to - j > bsize ? bsize : (to - j));
-			if (!rz_hash_cfg_update(md, block, read)) {
-				goto calculate_hash_end;
-			}
+		if (ctx->mode == RZ_HASH_MODE_JSON) {
+			pj_o(ctx->pj);
 		}
-
-		if (!ctx->as_prefix && ctx->seed.buf &&
-			!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
-			goto calculate_hash_end;
+		hash_context_compare_hashes(ctx, filesize, result, algorithm, filename);
+		if (ctx->mode == RZ_HASH_MODE_JSON) {
+			pj_end(ctx->pj);
 		}
+	}
+	free(cmphash);
+	return true;
+}
+
+static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename) {
+	bool result = false;
+	RzList *algorithms = NULL;
+	RzHashCfg *md = NULL;
+	ut64 bsize = 0;
+	ut64 filesize;
+	ut8 *block = NULL;
+
+	algorithms = hash_context_algorithms(ctx);
+	if (!algorithms || rz_list_length(algorithms) < 1) {
+		RZ_LOG_ERROR("rz-hash: error, empty list of hash algorithms\n");
+		goto calculate_hash_end;
+	}
+
+	filesize = rz_io_desc_size(io->desc);
+	if (!hash_check_range(ctx, filesize)) {
+		goto calculate_hash_end;
+	}
+
+	md = hash_cfg_new_configured(ctx, algorithms);
+	if (!md) {
+		goto calculate_hash_end;
+	}
+
+	if (!ctx->show_blocks) {
+		result = hash_compute(ctx, io, md, filesize, ctx->threads) &&
+			hash_print_results(ctx, md, algorithms, filesize, filename);
+		goto calculate_hash_end;
+	}
+
+	bsize = ctx->block_size;
+	block = malloc(bsize);
+	if (!block) {
+		RZ_LOG_ERROR("rz-hash: error, cannot allocate block memory\n");
+		goto calculate_hash_end;
+	}
 
-		if (!rz_hash_cfg_final(md) ||
+	ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
+	for (ut64 j = ctx->offset.from; j < to; j += bsize) {
+		int read = rz_io_pread_at(io, j, block, to - j > bsize ? bsize : (to - j));
+		if (!rz_hash_cfg_init(md) ||
+			!rz_hash_cfg_update(md, block, read) ||
+			!rz_hash_cfg_final(md) ||
 			!rz_hash_cfg_iterate(md, ctx->iterate)) {
 			goto calculate_hash_end;
 		}
 
+		const char *algorithm;
+		RzListIter *it;
 		rz_list_foreach (algorithms, it, algorithm) {
-			digest = rz_hash_cfg_get_result(md, algorithm, &digest_size);
-
 			if (ctx->mode == RZ_HASH_MODE_JSON) {
 				pj_o(ctx->pj);
 			}
-			hash_print_digest(ctx, md, algorithm, ctx->offset.from, to, filename);
+			hash_print_digest(ctx, md, algorithm, j, j + bsize, filename);
 			if (ctx->mode == RZ_HASH_MODE_JSON) {
 				pj_end(ctx->pj);
 			}
@@ -987,10 +1031,99 @@ static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename) {
 	result = true;
 
 calculate_hash_end:
-	rz_list_free(algorithms);
 	free(block);
-	free(cmphash);
-	rz_hash_cfg_free(md);
+	if (md) {
+		rz_hash_cfg_free(md);
+	}
+	return result;
+}
+
+typedef struct {
+	const char *filename;
+	RzHashCfg *md;
+	ut64 filesize;
+	bool success;
+} RzHashFileJob;
+
+static void hash_file_job_run(RzHashFileJob *job, RzHashContext *ctx) {
+	RzIO *io = rz_io_new();
+	if (!io) {
+		RZ_LOG_ERROR("rz-hash: error, cannot allocate io memory\n");
+		return;
+	}
+	RzIODesc *desc = rz_io_open_nomap(io, job->filename, RZ_PERM_R, 0);
+	if (!desc) {
+		RZ_LOG_ERROR("rz-hash: error, cannot open file '%s'\n", job->filename);
+		goto hash_file_job_run_end;
+	}
+
+	job->filesize = rz_io_desc_size(desc);
+	if (!hash_check_range(ctx, job->filesize)) {
+		goto hash_file_job_run_end;
+	}
+	job->md = hash_cfg_new_configured(ctx, ctx->algorithms);
+	// the files are already hashed in parallel, so each one uses a single thread
+	job->success = job->md && hash_compute(ctx, io, job->md, job->filesize, 1);
+
+hash_file_job_run_end:
+	rz_io_desc_close(desc);
+	rz_io_free(io);
+}
+
+/**
+ * Hashes the files on multiple threads, each file with its own RzIO and
+ * RzHashCfg. The files are processed in batches and the results of each
+ * batch are printed in the command line order, so the output is the same
+ * as hashing the files one after the other.
+ */
+static bool hash_context_run_parallel(RzHashContext *ctx) {
+	RzList *algorithms = hash_context_algorithms(ctx);
+	if (!algorithms || rz_list_length(algorithms) < 1) {
+		RZ_LOG_ERROR("rz-hash: error, empty list of hash algorithms\n");
+		return false;
+	}
+
+	ut32 batch_size = RZ_MIN(ctx->nfiles, RZ_HASH_PARALLEL_BATCH_SIZE);
+	RzHashFileJob *jobs = RZ_NEWS(RzHashFileJob, batch_size);
+	RzPVector *vec = rz_pvector_new(NULL);
+	if (!jobs || !vec || !rz_pvector_reserve(vec, batch_size)) {
+		RZ_LOG_ERROR("rz-hash: error, cannot allocate file jobs memory\n");
+		free(jobs);
+		rz_pvector_free(vec);
+		return false;
+	}
+
+	bool result = true;
+	for (ut32 start = 0; result && start < ctx->nfiles; start += batch_size) {
+		ut32 n = RZ_MIN(batch_size, ctx->nfiles - start);
+		rz_pvector_clear(vec);
+		for (ut32 i = 0; i < n; ++i) {
+			jobs[i] = (RzHashFileJob){ .filename = ctx->files[start + i] };
+			rz_pvector_push(vec, &jobs[i]);
+		}
+		rz_th_iterate_pvector(vec, (RzThreadIterator)hash_file_job_run, ctx->threads, ctx);
+
+		for (ut32 i = 0; i < n; ++i) {
+			RzHashFileJob *job = &jobs[i];
+			if (result && job->success) {
+				if (ctx->mode == RZ_HASH_MODE_JSON) {
+					pj_ka(ctx->pj, job->filename);
+				}
+				result = hash_print_results(ctx, job->md, algorithms, job->filesize, job->filename);
+				if (ctx->mode == RZ_HASH_MODE_JSON) {
+					pj_end(ctx->pj);
+				}
+			} else {
+				result = false;
+			}
+			if (job->md) {
+				rz_hash_cfg_free(job->md);
+			}
+		}
+	}
+
+	free(jobs);
+	rz_pvector_free(vec);
 	return result;
 }
 
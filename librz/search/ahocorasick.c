@@ -0,0 +1,343 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file ahocorasick.c
+ * Aho-Corasick automaton matching many keywords in a single pass.
+ *
+ * Keywords may contain bytes which are masked or compared ignoring the case,
+ * so the automaton is built on the longest run of exactly matching bytes of
+ * each keyword (its anchor) and reports the positions where the keyword may
+ * start. These positions are then verified against the whole keyword by the
+ * caller. Keywords without any exact byte cannot be anchored and are reported
+ * at every position.
+ *
+ * While the automaton is in its initial state, the input is skipped with a
+ * table of the pairs of bytes which may start an anchor.
+ */
+
+#include "search_private.h"
+#include <ctype.h>
+
+#define ROOT 0
+
+typedef struct {
+	ut8 byte;
+	ut32 state;
+} AcEdge;
+
+typedef struct {
+	ut32 fail; ///< State of the longest proper suffix which is also in the trie
+	ut32 dict; ///< First state with outputs in the chain of fail states, ROOT if none
+	ut32 out; ///< First output of the state, as index + 1 into outputs, 0 if none
+	ut32 edges; ///< Index of the first edge, edges are sorted by byte
+	ut32 n_edges;
+} AcState;
+
+typedef struct {
+	RzSearchKeyword *kw;
+	ut32 index; ///< Position of the keyword in the list the automaton was built from
+	ut32 anchor_end; ///< Offset in the keyword of the byte after the anchor
+	ut32 next; ///< Next output of the same state, as index + 1, 0 if none
+} AcOutput;
+
+struct rz_search_automaton_t {
+	RzVector /*<AcState>*/ states;
+	RzVector /*<AcEdge>*/ edges;
+	RzVector /*<AcOutput>*/ outputs;
+	RzVector /*<AcOutput>*/ unanchored; ///< Keywords without anchor, reported at every position
+	ut32 root[256]; ///< Transitions of the root, ROOT if none
+	ut8 first[256 / 8]; ///< Bytes starting an anchor
+	ut8 pairs[256 * 256 / 8]; ///< Pairs of bytes starting an anchor
+};
+
+#define BIT_SET(bits, i) ((bits)[(i) >> 3] |= 1 << ((i)&7))
+#define BIT_GET(bits, i) ((bits)[(i) >> 3] & (1 << ((i)&7)))
+
+static inline AcState *state_at(RzSearchAutomaton *ac, ut32 state) {
+	return rz_vector_index_ptr(&ac->states, state);
+}
+
+static bool keyword_byte_is_exact(RzSearchKeyword *kw, ut32 i) {
+	if (kw->binmask_length && kw->bin_binmask[i % kw->binmask_length] != 0xff) {
+		return false;
+	}
+	return !kw->icase || !isalpha(kw->bin_keyword[i]);
+}
+
+/**
+ * Finds the longest run of bytes of \p kw which must match exactly.
+ */
+static ut32 keyword_anchor(RzSearchKeyword *kw, ut32 *anchor_off) {
+	ut32 best = 0, cur = 0;
+	for (ut32 i = 0; i < kw->keyword_length; i++) {
+		if (!keyword_byte_is_exact(kw, i)) {
+			cur = 0;
+			continue;
+		}
+		cur++;
+		if (cur > best) {
+			best = cur;
+			*anchor_off = i + 1 - cur;
+		}
+	}
+	return best;
+}
+
+static ut32 state_new(RzSearchAutomaton *ac, RzVector /*<RzVector<AcEdge>>*/ *build_edges) {
+	AcState *st = rz_vector_push(&ac->states, NULL);
+	RzVector *edges = rz_vector_push(build_edges, NULL);
+	if (!st || !edges) {
+		return ROOT;
+	}
+	memset(st, 0, sizeof(*st));
+	rz_vector_init(edges, sizeof(AcEdge), NULL, NULL);
+	return rz_vector_len(&ac->states) - 1;
+}
+
+static ut32 build_edge_find(RzVector /*<AcEdge>*/ *edges, ut8 byte) {
+	AcEdge *e;
+	rz_vector_foreach(edges, e) {
+		if (e->byte == byte) {
+			return e->state;
+		}
+	}
+	return ROOT;
+}
+
+static bool trie_add(RzSearchAutomaton *ac, RzVector *build_edges, RzSearchKeyword *kw, ut32 index, ut32 anchor_off, ut32 anchor_len) {
+	const ut8 *anchor = kw->bin_keyword + anchor_off;
+	ut32 state = ROOT;
+	for (ut32 i = 0; i < anchor_len; i++) {
+		ut32 next = state == ROOT ? ac->root[anchor[i]] : build_edge_find(rz_vector_index_ptr(build_edges, state), anchor[i]);
+		if (next == ROOT) {
+			next = state_new(ac, build_edges);
+			if (next == ROOT) {
+				return false;
+			}
+			if (state == ROOT) {
+				ac->root[anchor[i]] = next;
+			} else {
+				AcEdge edge = { anchor[i], next };
+				if (!rz_vector_push(rz_vector_index_ptr(build_edges, state), &edge)) {
+					return false;
+				}
+			}
+		}
+		state = next;
+	}
+	AcOutput *out = rz_vector_push(&ac->outputs, NULL);
+	if (!out) {
+		return false;
+	}
+	out->kw = kw;
+	out->index = index;
+	out->anchor_end = anchor_off + anchor_len;
+	out->next = state_at(ac, state)->out;
+	state_at(ac, state)->out = rz_vector_len(&ac->outputs);
+	BIT_SET(ac->first, anchor[0]);
+	if (anchor_len == 1) {
+		for (ut32 b = 0; b < 256; b++) {
+			BIT_SET(ac->pairs, (anchor[0] << 8) | b);
+		}
+	} else {
+		BIT_SET(ac->pairs, (anchor[0] << 8) | anchor[1]);
+	}
+	return true;
+}
+
+static void build_edges_free(void *e, void *user) {
+	rz_vector_fini(e);
+}
+
+static int edge_cmp(const void *a, const void *b, void *user) {
+	const AcEdge *ea = a, *eb = b;
+	return (int)ea->byte - (int)eb->byte;
+}
+
+static ut32 goto_state(RzSearchAutomaton *ac, ut32 state, ut8 byte) {
+	if (state == ROOT) {
+		return ac->root[byte];
+	}
+	AcState *st = state_at(ac, state);
+	AcEdge *edges = rz_vector_index_ptr(&ac->edges, st->edges);
+	ut32 lo = 0, hi = st->n_edges;
+	while (lo < hi) {
+		ut32 mid = (lo + hi) / 2;
+		if (edges[mid].byte == byte) {
+			return edges[mid].state;
+		}
+		if (edges[mid].byte < byte) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return ROOT;
+}
+
+static inline ut32 next_state(RzSearchAutomaton *ac, ut32 state, ut8 byte) {
+	while (state != ROOT) {
+		ut32 next = goto_state(ac, state, byte);
+		if (next != ROOT) {
+			return next;
+		}
+		state = state_at(ac, state)->fail;
+	}
+	return ac->root[byte];
+}
+
+/**
+ * Flattens the edges of the trie and computes the fail and dict links
+ * visiting the states in breadth-first order.
+ */
+static bool automaton_link(RzSearchAutomaton *ac, RzVector *build_edges) {
+	for (ut32 i = 0; i < rz_vector_len(build_edges); i++) {
+		RzVector *edges = rz_vector_index_ptr(build_edges, i);
+		if (rz_vector_len(edges) > 1) {
+			rz_vector_sort(edges, edge_cmp, false, NULL);
+		}
+		AcState *st = state_at(ac, i);
+		st->edges = rz_vector_len(&ac->edges);
+		st->n_edges = rz_vector_len(edges);
+		if (st->n_edges && !rz_vector_insert_range(&ac->edges, st->edges, edges->a, st->n_edges)) {
+			return false;
+		}
+	}
+	RzVector queue;
+	rz_vector_init(&queue, sizeof(ut32), NULL, NULL);
+	for (ut32 b = 0; b < 256; b++) {
+		if (ac->root[b] != ROOT) {
+			rz_vector_push(&queue, &ac->root[b]);
+		}
+	}
+	for (size_t head = 0; head < rz_vector_len(&queue); head++) {
+		ut32 state = *(ut32 *)rz_vector_index_ptr(&queue, head);
+		AcState *st = state_at(ac, state);
+		AcState *fail = state_at(ac, st->fail);
+		st->dict = fail->out ? st->fail : fail->dict;
+		for (ut32 e = 0; e < st->n_edges; e++) {
+			AcEdge *edge = rz_vector_index_ptr(&ac->edges, st->edges + e);
+			// the fail state of the parent is closer to the root, so its links are already computed
+			state_at(ac, edge->state)->fail = next_state(ac, state_at(ac, state)->fail, edge->byte);
+			if (!rz_vector_push(&queue, &edge->state)) {
+				rz_vector_fini(&queue);
+				return false;
+			}
+		}
+	}
+	rz_vector_fini(&queue);
+	return true;
+}
+
+/**
+ * \brief Compiles all the keywords in \p kws into a single automaton
+ */
+RZ_IPI RZ_OWN RzSearchAutomaton *rz_search_automaton_new(RZ_NONNULL RzList /*<RzSearchKeyword *>*/ *kws) {
+	rz_return_val_if_fail(kws, NULL);
+	RzSearchAutomaton *ac = RZ_NEW0(RzSearchAutomaton);
+	if (!ac) {
+		return NULL;
+	}
+	rz_vector_init(&ac->states, sizeof(AcState), NULL, NULL);
+	rz_vector_init(&ac->edges, sizeof(AcEdge), NULL, NULL);
+	rz_vector_init(&ac->outputs, sizeof(AcOutput), NULL, NULL);
+	rz_vector_init(&ac->unanchored, sizeof(AcOutput), NULL, NULL);
+	RzVector build_edges;
+	rz_vector_init(&build_edges, sizeof(RzVector), build_edges_free, NULL);
+	bool ok = state_new(ac, &build_edges) == ROOT && rz_vector_len(&ac->states) == 1;
+	RzListIter *iter;
+	RzSearchKeyword *kw;
+	ut32 index = 0;
+	rz_list_foreach (kws, iter, kw) {
+		if (!ok) {
+			break;
+		}
+		ut32 anchor_off = 0;
+		ut32 anchor_len = keyword_anchor(kw, &anchor_off);
+		if (anchor_len) {
+			ok = trie_add(ac, &build_edges, kw, index, anchor_off, anchor_len);
+		} else {
+			AcOutput out = { kw, index, 0, 0 };
+			ok = rz_vector_push(&ac->unanchored, &out);
+		}
+		index++;
+	}
+	ok = ok && automaton_link(ac, &build_edges);
+	rz_vector_fini(&build_edges);
+	if (!ok) {
+		rz_search_automaton_free(ac);
+		return NULL;
+	}
+	return ac;
+}
+
+RZ_IPI void rz_search_automaton_free(RZ_NULLABLE RzSearchAutomaton *ac) {
+	if (!ac) {
+		return;
+	}
+	rz_vector_fini(&ac->states);
+	rz_vector_fini(&ac->edges);
+	rz_vector_fini(&ac->outputs);
+	rz_vector_fini(&ac->unanchored);
+	free(ac);
+}
+
+static bool report_outputs(RzSearchAutomaton *ac, ut32 state, int pos, int len, RzSearchAutomatonCallback cb, void *user) {
+	AcState *st = state_at(ac, state);
+	if (!st->out) {
+		state = st->dict;
+	}
+	while (state != ROOT) {
+		st = state_at(ac, state);
+		for (ut32 o = st->out; o; o = ((AcOutput *)rz_vector_index_ptr(&ac->outputs, o - 1))->next) {
+			AcOutput *out = rz_vector_index_ptr(&ac->outputs, o - 1);
+			const st64 start = (st64)pos + 1 - out->anchor_end;
+			if (start >= 0 && start + out->kw->keyword_length <= len && !cb(out->kw, out->index, (int)start, user)) {
+				return false;
+			}
+		}
+		state = st->dict;
+	}
+	return true;
+}
+
+/**
+ * \brief Scans \p buf once, calling \p cb for every position where a keyword may start
+ *
+ * The positions of a keyword are reported in increasing order, but the
+ * positions of different keywords may be interleaved in any order.
+ *
+ * \return false if \p cb asked to stop the scan
+ */
+RZ_IPI bool rz_search_automaton_scan(RZ_NONNULL RzSearchAutomaton *ac, RZ_NONNULL const ut8 *buf, int len, RzSearchAutomatonCallback cb, void *user) {
+	rz_return_val_if_fail(ac && buf && cb, false);
+	AcOutput *out;
+	rz_vector_foreach(&ac->unanchored, out) {
+		for (int i = 0; i + (st64)out->kw->keyword_length <= len; i++) {
+			if (!cb(out->kw, out->index, i, user)) {
+				return false;
+			}
+		}
+	}
+	if (rz_vector_len(&ac->states) < 2) {
+		return true;
+	}
+	ut32 state = ROOT;
+	for (int i = 0; i < len; i++) {
+		if (state == ROOT) {
+			// skip the bytes which cannot start any anchor
+			while (i + 1 < len && !BIT_GET(ac->pairs, (buf[i] << 8) | buf[i + 1])) {
+				i++;
+			}
+			if (i + 1 == len && !BIT_GET(ac->first, buf[i])) {
+				break;
+			}
+		}
+		state = next_state(ac, state, buf[i]);
+		if (state != ROOT && (state_at(ac, state)->out || state_at(ac, state)->dict) &&
+			!report_outputs(ac, state, i, len, cb, user)) {
+			return false;
+		}
+	}
+	return true;
+}
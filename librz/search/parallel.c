@@ -0,0 +1,249 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file parallel.c
+ * Splits a search buffer into overlapping chunks which are scanned on a
+ * thread pool. Every chunk is searched by a private copy of the RzSearch
+ * collecting all its hits; these are then reported in address order by
+ * the caller thread through rz_search_hit_new(), so that the callback,
+ * search.maxhits and search.overlap behave as with rz_search_update().
+ */
+
+#include <rz_th.h>
+#include "search_private.h"
+
+#define SEARCH_CHUNK_MIN          0x10000
+#define SEARCH_CHUNKS_PER_THREAD  4
+// Bytes read after the start of a hit by the AES and private key finders
+#define SEARCH_AES_OVERLAP        40
+#define SEARCH_PRIVKEY_OVERLAP    32
+
+typedef struct {
+	ut64 addr;
+	RzSearchKeyword *kw; ///< Keyword of the caller search
+	ut32 index; ///< Position of the keyword in the list
+	ut32 len; ///< Length of the keyword when it was found
+} RzSearchChunkHit;
+
+typedef struct {
+	ut64 from;
+	const ut8 *buf;
+	int len;
+	ut64 end; ///< Hits starting from it belong to the next chunk
+	RzSearchLeftover *left; ///< Leftover of the block before the chunk, then of the chunk once searched
+	RzVector /*<RzSearchChunkHit>*/ hits;
+	bool failed;
+} RzSearchChunk;
+
+static void chunk_free(void *ptr) {
+	RzSearchChunk *chunk = ptr;
+	rz_vector_fini(&chunk->hits);
+	free(chunk->left);
+	free(chunk);
+}
+
+static int chunk_hit_cb(RzSearchKeyword *kw, void *user, ut64 addr) {
+	RzSearchChunk *chunk = user;
+	if (addr >= chunk->end) {
+		return 1;
+	}
+	RzSearchChunkHit hit = { addr, kw->data, kw->kwidx, kw->keyword_length };
+	if (!rz_vector_push(&chunk->hits, &hit)) {
+		chunk->failed = true;
+		return 0;
+	}
+	return 1;
+}
+
+static int chunk_hit_cmp(const void *a, const void *b, void *user) {
+	const RzSearchChunkHit *ha = a, *hb = b;
+	if (ha->addr != hb->addr) {
+		return ha->addr < hb->addr ? -1 : 1;
+	}
+	return ha->index < hb->index ? -1 : (ha->index > hb->index ? 1 : 0);
+}
+
+/**
+ * Returns a copy of \p s reporting every hit of its keywords to \p chunk.
+ * The copied keywords share the buffers of the original ones, which are
+ * kept in their data.
+ */
+static RzSearch *search_worker_new(RzSearch *s, RzSearchChunk *chunk) {
+	RzSearch *w = rz_search_new(s->mode);
+	if (!w) {
+		return NULL;
+	}
+	// the hits which would be skipped are filtered when reported to the caller
+	w->inverse = s->inverse;
+	w->distance = s->distance;
+	w->pattern_size = s->pattern_size;
+	w->contiguous = true;
+	w->overlap = true;
+	w->kws->free = free;
+	RzListIter *iter;
+	RzSearchKeyword *kw;
+	ut32 index = 0;
+	rz_list_foreach (s->kws, iter, kw) {
+		RzSearchKeyword *copy = RZ_NEWCOPY(RzSearchKeyword, kw);
+		if (!copy || !rz_list_append(w->kws, copy)) {
+			free(copy);
+			rz_search_free(w);
+			return NULL;
+		}
+		copy->count = 0;
+		copy->last = 0;
+		copy->kwidx = index++;
+		copy->data = kw;
+	}
+	w->n_kws = index;
+	rz_search_set_callback(w, chunk_hit_cb, chunk);
+	return w;
+}
+
+static void search_chunk_run(void *element, void *user) {
+	RzSearchChunk *chunk = element;
+	RzSearch *w = search_worker_new(user, chunk);
+	if (!w) {
+		chunk->failed = true;
+		return;
+	}
+	w->data = chunk->left;
+	w->update(w, chunk->from, chunk->buf, chunk->len);
+	chunk->left = w->data;
+	w->data = NULL;
+	rz_search_free(w);
+	if (rz_vector_len(&chunk->hits) > 1) {
+		rz_vector_sort(&chunk->hits, chunk_hit_cmp, false, NULL);
+	}
+}
+
+static int search_chunk_overlap(RzSearch *s) {
+	switch (s->mode) {
+	case RZ_SEARCH_AES:
+		return SEARCH_AES_OVERLAP;
+	case RZ_SEARCH_PRIV_KEY:
+		return SEARCH_PRIVKEY_OVERLAP;
+	case RZ_SEARCH_KEYWORD:
+	case RZ_SEARCH_REGEXP:
+		break;
+	default:
+		// the other modes are not searched in chunks
+		return 0;
+	}
+	RzListIter *iter;
+	RzSearchKeyword *kw;
+	int longest = 0;
+	rz_list_foreach (s->kws, iter, kw) {
+		longest = RZ_MAX(longest, kw->keyword_length);
+	}
+	return longest;
+}
+
+/**
+ * \brief Searches \p buf as rz_search_update() does, on up to \p max_threads threads
+ *
+ * The buffer is split into chunks overlapping by the longest keyword, so
+ * that the keywords crossing two chunks are found, and the hits are then
+ * reported in address order from the caller thread. Only the keyword,
+ * regexp, AES and private key forward searches are run in parallel, the
+ * others fall back to rz_search_update().
+ *
+ * \param s The search, whose keywords are not modified until the chunks are searched
+ * \param from Address of \p buf
+ * \param buf Buffer to search
+ * \param len Length of \p buf
+ * \param max_threads Maximum number of threads, 0 to use all the available cores
+ * \return The number of new hits, -1 on error
+ */
+RZ_API int rz_search_update_parallel(RZ_NONNULL RzSearch *s, ut64 from, RZ_NONNULL const ut8 *buf, long len, size_t max_threads) {
+	rz_return_val_if_fail(s && buf, -1);
+	const size_t threads = rz_th_request_physical_cores(max_threads);
+	const int overlap = search_chunk_overlap(s);
+	const long chunk_size = RZ_MAX(len / (long)(threads * SEARCH_CHUNKS_PER_THREAD), RZ_MAX(SEARCH_CHUNK_MIN, 4L * overlap));
+	if (threads < 2 || s->bckwrds || !overlap || len < 2 * chunk_size) {
+		return rz_search_update(s, from, buf, len);
+	}
+	if (s->maxhits && s->nhits >= s->maxhits) {
+		return 0;
+	}
+
+	RzPVector chunks;
+	rz_pvector_init(&chunks, chunk_free);
+	for (long off = 0; off < len; off += chunk_size) {
+		RzSearchChunk *chunk = RZ_NEW0(RzSearchChunk);
+		if (!chunk || !rz_pvector_push(&chunks, chunk)) {
+			free(chunk);
+			rz_pvector_fini(&chunks);
+			return -1;
+		}
+		// the tail is searched with the last chunk
+		bool last = len - off < 2 * chunk_size;
+		chunk->from = from + off;
+		chunk->buf = buf + off;
+		chunk->len = last ? len - off : RZ_MIN(chunk_size + overlap, len - off);
+		chunk->end = last ? UT64_MAX : from + off + chunk_size;
+		rz_vector_init(&chunk->hits, sizeof(RzSearchChunkHit), NULL, NULL);
+		if (last) {
+			break;
+		}
+	}
+	// the leftover of the previous block is searched with the first chunk, the last one leaves it for the next block
+	RzSearchChunk *first = rz_pvector_head(&chunks);
+	first->left = s->data;
+	s->data = NULL;
+
+	rz_th_iterate_pvector(&chunks, search_chunk_run, threads, s);
+
+	RzSearchChunk *last = rz_pvector_tail(&chunks);
+	s->data = last->left;
+	last->left = NULL;
+
+	// without search.overlap, the hits of a keyword which overlap its previous one are skipped
+	ut64 *next = NULL;
+	if (s->mode == RZ_SEARCH_KEYWORD && !s->overlap) {
+		next = RZ_NEWS0(ut64, rz_list_length(s->kws));
+		if (!next) {
+			rz_pvector_fini(&chunks);
+			return -1;
+		}
+		RzListIter *iter;
+		RzSearchKeyword *kw;
+		ut32 index = 0;
+		rz_list_foreach (s->kws, iter, kw) {
+			next[index++] = kw->count ? kw->last : 0;
+		}
+	}
+	const int old_nhits = s->nhits;
+	int ret = 0;
+	void **it;
+	rz_pvector_foreach (&chunks, it) {
+		RzSearchChunk *chunk = *it;
+		if (chunk->failed) {
+			ret = -1;
+			break;
+		}
+		RzSearchChunkHit *hit;
+		rz_vector_foreach(&chunk->hits, hit) {
+			if (next && hit->addr < next[hit->index]) {
+				continue;
+			}
+			// the AES and private key finders store the length of the hit in the keyword
+			hit->kw->keyword_length = hit->len;
+			int t = rz_search_hit_new(s, hit->kw, hit->addr);
+			if (!t) {
+				ret = -1;
+				goto beach;
+			}
+			if (t > 1) {
+				goto beach;
+			}
+			if (next) {
+				next[hit->index] = hit->addr + hit->len;
+			}
+		}
+	}
+beach:
+	free(next);
+	rz_pvector_fini(&chunks);
+	return ret < 0 ? -1 : s->nhits - old_nhits;
+}
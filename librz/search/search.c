@@ -4,6 +4,7 @@
 #include <rz_search.h>
 #include <rz_list.h>
 #include <ctype.h>
+#include "search_private.h"
 
 // Experimental search engine (fails, because stops at first hit of every block read
 #define USE_BMH 0
@@ -11,10 +12,22 @@
 RZ_LIB_VERSION(rz_search);
 
 typedef struct {
-	ut64 end;
-	int len;
-	ut8 data[];
-} RzSearchLeftover;
+	int start;
+	ut32 index;
+	RzSearchKeyword *kw;
+} RzSearchCandidate;
+
+typedef struct {
+	RzSearch *s;
+	const ut8 *buf;
+	int limit; ///< Only the keywords starting before it are collected
+	RzVector /*<RzSearchCandidate>*/ hits;
+} RzSearchMultiCtx;
+
+static void search_automaton_reset(RzSearch *s) {
+	rz_search_automaton_free(s->automaton);
+	s->automaton = NULL;
+}
 
 RZ_API RzSearch *rz_search_new(int mode) {
 	RzSearch *s = RZ_NEW0(RzSearch);
@@ -55,6 +68,7 @@ RZ_API RzSearch *rz_search_free(RzSearch *s) {
 	}
 	rz_list_free(s->hits);
 	rz_list_free(s->kws);
+	rz_search_automaton_free(s->automaton);
 	// rz_io_free(s->iob.io); this is supposed to be a weak reference
 	free(s->data);
 	free(s);
@@ -135,6 +149,8 @@ RZ_API int rz_search_begin(RzSearch *s) {
 		kw->count = 0;
 		kw->last = 0;
 	}
+	// the keywords may have been changed since the last search
+	search_automaton_reset(s);
 	return true;
 }
 
@@ -390,6 +406,99 @@ static bool brute_force_match(RzSearch *s, RzSearchKeyword *kw, const ut8 *buf,
 	return j == kw->keyword_length;
 }
 
+/**
+ * Returns the first index of the block where \p kw may be found without
+ * overlapping its last hit. The block is the leftover of the previous one
+ * if \p leftover is true, which starts left_len bytes before \p from: only
+ * the keywords crossing into the new data are searched there, the others
+ * were already found with the previous block.
+ */
+static int keyword_first_index(RzSearch *s, RzSearchKeyword *kw, ut64 from, int left_len, bool leftover) {
+	int i = 0;
+	if (leftover) {
+		i = RZ_MAX(left_len - (int)kw->keyword_length + 1, 0);
+	}
+	if (s->overlap || !kw->count) {
+		return i;
+	}
+	if (leftover) {
+		int after_last = s->bckwrds ? kw->last - from < left_len ? from + left_len - kw->last : 0
+			: from - kw->last < left_len                     ? kw->last + left_len - from
+									 : 0;
+		return RZ_MAX(i, after_last);
+	}
+	return s->bckwrds ? from > kw->last ? from - kw->last : 0
+		: from < kw->last                   ? kw->last - from
+						    : 0;
+}
+
+static bool multi_collect_cb(RzSearchKeyword *kw, ut32 index, int start, void *user) {
+	RzSearchMultiCtx *ctx = user;
+	if (start < ctx->limit && brute_force_match(ctx->s, kw, ctx->buf, start)) {
+		RzSearchCandidate hit = { start, index, kw };
+		return rz_vector_push(&ctx->hits, &hit);
+	}
+	return true;
+}
+
+static int multi_hit_cmp(const void *a, const void *b, void *user) {
+	const RzSearchCandidate *ha = a, *hb = b;
+	if (ha->start != hb->start) {
+		return ha->start < hb->start ? -1 : 1;
+	}
+	return ha->index < hb->index ? -1 : (ha->index > hb->index ? 1 : 0);
+}
+
+/**
+ * Finds the keywords starting in buf[0, limit) with a single pass of the
+ * automaton and reports them in address order, skipping the hits of each
+ * keyword as the keyword loop of rz_search_mybinparse_update() does.
+ *
+ * Returns -1 on error, 2 if search.maxhits is reached, otherwise 1
+ */
+static int multi_update(RzSearch *s, ut64 from, const ut8 *buf, int len, int left_len, bool leftover) {
+	RzSearchMultiCtx ctx = { s, buf, leftover ? left_len : len };
+	rz_vector_init(&ctx.hits, sizeof(RzSearchCandidate), NULL, NULL);
+	int *next = RZ_NEWS(int, rz_list_length(s->kws));
+	if (!next) {
+		return -1;
+	}
+	RzListIter *iter;
+	RzSearchKeyword *kw;
+	ut32 index = 0;
+	rz_list_foreach (s->kws, iter, kw) {
+		next[index++] = keyword_first_index(s, kw, from, left_len, leftover);
+	}
+	int ret = 1;
+	if (!rz_search_automaton_scan(s->automaton, buf, len, multi_collect_cb, &ctx)) {
+		ret = -1;
+		goto beach;
+	}
+	if (rz_vector_len(&ctx.hits) > 1) {
+		rz_vector_sort(&ctx.hits, multi_hit_cmp, false, NULL);
+	}
+	const int shift = leftover ? left_len : 0;
+	RzSearchCandidate *hit;
+	rz_vector_foreach(&ctx.hits, hit) {
+		if (hit->start < next[hit->index]) {
+			continue;
+		}
+		kw = hit->kw;
+		int t = rz_search_hit_new(s, kw, s->bckwrds ? from - kw->keyword_length - hit->start + shift : from + hit->start - shift);
+		if (!t || t > 1) {
+			ret = t ? t : -1;
+			break;
+		}
+		if (!s->overlap) {
+			next[hit->index] = hit->start + kw->keyword_length;
+		}
+	}
+beach:
+	free(next);
+	rz_vector_fini(&ctx.hits);
+	return ret;
+}
+
 // Supported search variants: backward, binmask, icase, inverse, overlap
 RZ_API int rz_search_mybinparse_update(RzSearch *s, ut64 from, const ut8 *buf, int len) {
 	RzSearchKeyword *kw;
@@ -429,10 +538,23 @@ RZ_API int rz_search_mybinparse_update(RzSearch *s, ut64 from, const ut8 *buf, i
 
 	ut64 len1 = left->len + RZ_MIN(longest - 1, len);
 	memcpy(left->data + left->len, buf, len1 - left->len);
+	// many keywords are matched at once by an automaton, unless a distance or inverse match is requested
+	if (!s->distance && !s->inverse && rz_list_length(s->kws) > 1 &&
+		(s->automaton || (s->automaton = rz_search_automaton_new(s->kws)))) {
+		int t = multi_update(s, from, left->data, len1, left->len, true);
+		if (t == 1) {
+			t = multi_update(s, from, buf, len, left->len, false);
+		}
+		if (t < 0) {
+			return -1;
+		}
+		if (t > 1) {
+			return s->nhits - old_nhits;
+		}
+		goto leftover;
+	}
 	rz_list_foreach (s->kws, iter, kw) {
-		i = s->overlap || !kw->count ? 0 : s->bckwrds ? kw->last - from < left->len ? from + left->len - kw->last : 0
-			: from - kw->last < left->len         ? kw->last + left->len - from
-							      : 0;
+		i = keyword_first_index(s, kw, from, left->len, true);
 		for (; i + kw->keyword_length <= len1 && i < left->len; i++) {
 			if (brute_force_match(s, kw, left->data, i) != s->inverse) {
 				int t = rz_search_hit_new(s, kw, s->bckwrds ? from - kw->keyword_length - i + left->len : from + i - left->len);
@@ -447,9 +569,7 @@ RZ_API int rz_search_mybinparse_update(RzSearch *s, ut64 from, const ut8 *buf, i
 				}
 			}
 		}
-		i = s->overlap || !kw->count ? 0 : s->bckwrds ? from > kw->last ? from - kw->last : 0
-			: from < kw->last                     ? kw->last - from
-							      : 0;
+		i = keyword_first_index(s, kw, from, left->len, false);
 		for (; i + kw->keyword_length <= len; i++) {
 			if (brute_force_match(s, kw, buf, i) != s->inverse) {
 				int t = rz_search_hit_new(s, kw, s->bckwrds ? from - kw->keyword_length - i : from + i);
@@ -465,6 +585,7 @@ RZ_API int rz_search_mybinparse_update(RzSearch *s, ut64 from, const ut8 *buf, i
 			}
 		}
 	}
+leftover:
 	if (len < longest - 1) {
 		if (len1 < longest) {
 			left->len = len1;
@@ -544,6 +665,7 @@ RZ_API int rz_search_kw_add(RzSearch *s, RzSearchKeyword *kw) {
 	}
 	kw->kwidx = s->n_kws++;
 	rz_list_append(s->kws, kw);
+	search_automaton_reset(s);
 	return true;
 }
 
@@ -551,6 +673,7 @@ RZ_API int rz_search_kw_add(RzSearch *s, RzSearchKeyword *kw) {
 RZ_API void rz_search_string_prepare_backward(RzSearch *s) {
 	RzListIter *iter;
 	RzSearchKeyword *kw;
+	search_automaton_reset(s);
 	// Precondition: !kw->binmask_length || kw->keyword_length % kw->binmask_length == 0
 	rz_list_foreach (s->kws, iter, kw) {
 		ut8 *i = kw->bin_keyword, *j = kw->bin_keyword + kw->keyword_length;
@@ -580,4 +703,5 @@ RZ_API void rz_search_kw_reset(RzSearch *s) {
 	rz_list_purge(s->kws);
 	rz_list_purge(s->hits);
 	RZ_FREE(s->data);
+	search_automaton_reset(s);
 }
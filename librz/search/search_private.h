@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef RZ_SEARCH_PRIVATE_H
+#define RZ_SEARCH_PRIVATE_H
+
+#include <rz_search.h>
+
+/**
+ * \brief Last bytes of the previous block, searched again with the next one
+ *
+ * It is allocated with room for twice the longest keyword minus one byte.
+ */
+typedef struct {
+	ut64 end; ///< Address following the previous block
+	int len;
+	ut8 data[];
+} RzSearchLeftover;
+
+/**
+ * \brief Called for every position where \p kw, the \p index th keyword of the automaton, may start
+ *
+ * The match must be verified by the caller.
+ */
+typedef bool (*RzSearchAutomatonCallback)(RzSearchKeyword *kw, ut32 index, int start, void *user);
+
+RZ_IPI RZ_OWN RzSearchAutomaton *rz_search_automaton_new(RZ_NONNULL RzList /*<RzSearchKeyword *>*/ *kws);
+RZ_IPI void rz_search_automaton_free(RZ_NULLABLE RzSearchAutomaton *ac);
+RZ_IPI bool rz_search_automaton_scan(RZ_NONNULL RzSearchAutomaton *ac, RZ_NONNULL const ut8 *buf, int len, RzSearchAutomatonCallback cb, void *user);
+
+#endif /* RZ_SEARCH_PRIVATE_H */
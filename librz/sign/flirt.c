@@ -102,8 +102,12 @@
 
 #include <rz_lib.h>
 #include <rz_flirt.h>
+#include <rz_th.h>
 #define MAX_WBITS 15
 
+/* number of functions read and matched at once */
+#define FLIRT_MATCH_BATCH_SIZE 0x1000
+
 #if 0
 #define sig_dbg(...) eprintf(__VA_ARGS__)
 static void sig_dbg_buffer(const char *name, const ut8 *buffer, ut32 b_size) {
@@ -347,7 +351,7 @@ static bool is_pattern_matching(ut32 p_size, const ut8 *pattern, const ut8 *mask
 	return true;
 }
 
-static bool check_crc16(const RzFlirtModule *module, ut8 *b, ut32 b_size) {
+static bool check_crc16(const RzFlirtModule *module, const ut8 *b, ut32 b_size) {
 	if (!module->crc_length) {
 		return true;
 	} else if ((b_size - RZ_FLIRT_MAX_PRELUDE_SIZE) < module->crc_length) {
@@ -366,22 +370,17 @@ static bool try_rename_function(RzAnalysis *analysis, RzAnalysisFunction *fcn, c
 }
 
 /**
- * \brief Checks if the module matches the buffer and renames the matched functions
+ * \brief Checks if the module matches the buffer
  *
- * \param analysis  The RzAnalysis struct from where to fetch and modify the functions
  * \param module    The FLIRT module to match against the buffer
  * \param b         Buffer to check
- * \param address   Function address
  * \param buf_size  Size of the buffer to check
  *
- * \return True if pattern does match, false otherwise.
+ * \return True if the crc16 and the tail bytes do match, false otherwise.
  */
-static int module_match_buffer(RzAnalysis *analysis, const RzFlirtModule *module, ut8 *b, ut64 address, ut32 buf_size) {
-	RzFlirtFunction *flirt_func = NULL;
-	RzAnalysisFunction *next_module_function = NULL;
+static bool module_match_buffer(const RzFlirtModule *module, const ut8 *b, ut32 buf_size) {
 	RzListIter *it = NULL;
 	RzFlirtTailByte *tail_byte = NULL;
-	ut32 name_index = 0;
 
 	if (!check_crc16(module, b, buf_size)) {
 		return false;
@@ -395,6 +394,23 @@ static int module_match_buffer(RzAnalysis *analysis, const RzFlirtModule *module
 			}
 		}
 	}
+	return true;
+}
+
+/**
+ * \brief Renames the functions of a module matched at \p address
+ *
+ * \param analysis  The RzAnalysis struct from where to fetch and modify the functions
+ * \param module    The FLIRT module matched at \p address
+ * \param address   Function address
+ *
+ * \return False on allocation failure, otherwise true.
+ */
+static bool module_apply(RzAnalysis *analysis, const RzFlirtModule *module, ut64 address) {
+	RzFlirtFunction *flirt_func = NULL;
+	RzAnalysisFunction *next_module_function = NULL;
+	RzListIter *it = NULL;
+	ut32 name_index = 0;
 
 	rz_list_foreach (module->public_functions, it, flirt_func) {
 		if (next_module_function && (address + flirt_func->offset) == next_module_function->addr) {
@@ -477,7 +493,12 @@ static int module_match_buffer(RzAnalysis *analysis, const RzFlirtModule *module
 	return true;
 }
 
-static int node_match_buffer(RzAnalysis *analysis, const RzFlirtNode *node, ut8 *b, ut64 address, ut32 buf_size, ut32 buf_idx) {
+/**
+ * \brief Finds the first module of the tree in \p node matching the buffer
+ *
+ * The tree is only read, thus it can be walked by many threads at once.
+ */
+static const RzFlirtModule *node_match_buffer(const RzFlirtNode *node, const ut8 *b, ut32 buf_size, ut32 buf_idx) {
 	RzListIter *node_child_it, *module_it;
 	RzFlirtNode *child;
 	RzFlirtModule *module;
@@ -485,31 +506,82 @@ static int node_match_buffer(RzAnalysis *analysis, const RzFlirtNode *node, ut8
 	if (is_pattern_matching(node->length, node->pattern_bytes, node->pattern_mask, b + buf_idx, buf_size - buf_idx)) {
 		if (node->child_list) {
 			rz_list_foreach (node->child_list, node_child_it, child) {
-				if (node_match_buffer(analysis, child, b, address, buf_size, buf_idx + node->length)) {
-					return true;
+				const RzFlirtModule *found = node_match_buffer(child, b, buf_size, buf_idx + node->length);
+				if (found) {
+					return found;
 				}
 			}
 		} else if (node->module_list) {
 			rz_list_foreach (node->module_list, module_it, module) {
-				if (module_match_buffer(analysis, module, b, address, buf_size)) {
-					return true;
+				if (module_match_buffer(module, b, buf_size)) {
+					return module;
 				}
 			}
 		}
 	}
 
-	return false;
+	return NULL;
+}
+
+typedef struct flirt_function_match_t {
+	ut64 address;
+	ut8 *buf;
+	ut32 size;
+	ut64 func_size; ///< Linear size of the function when it was read
+	const RzFlirtModule *module; ///< First module matching the function, NULL if none
+} FlirtFunctionMatch;
+
+static bool function_match_read(RzAnalysis *analysis, RzAnalysisFunction *func, FlirtFunctionMatch *match) {
+	ut64 func_size = rz_analysis_function_linear_size(func);
+	ut64 malloc_size = RZ_MAX(func_size, RZ_FLIRT_MAX_PRELUDE_SIZE);
+	match->address = func->addr;
+	match->size = (ut32)malloc_size;
+	match->func_size = func_size;
+	match->module = NULL;
+	if (!(match->buf = calloc(1, malloc_size))) {
+		return false;
+	}
+	if (!analysis->iob.read_at(analysis->iob.io, func->addr, match->buf, (int)func_size)) {
+		RZ_LOG_ERROR("FLIRT: Couldn't read function %s at 0x%" PFMT64x "\n", func->name, func->addr);
+		RZ_FREE(match->buf);
+		return false;
+	}
+	return true;
+}
+
+static void function_match_run(FlirtFunctionMatch *match, const RzFlirtNode *root_node) {
+	match->module = node_match_buffer(root_node, match->buf, match->size, 0);
+}
+
+static bool is_flirt_function(const RzAnalysisFunction *func) {
+	return func->name && !strncmp(func->name, "flirt.", strlen("flirt."));
 }
 
 /**
  * \brief Tries to find matching functions between the signature infos in root_node and the analyzed functions in analysis
  *
- * \param analysis   The analysis
- * \param root_node  The root node
+ * The functions are handled in batches: the bytes of each function are read
+ * once, then matched against the whole tree in parallel, and finally the
+ * matches are applied in order. Since applying a match may rename, resize or
+ * merge other functions, these are looked up again by address before being
+ * applied and matched again if their size changed, so the result is the same
+ * as matching and renaming them one by one.
+ *
+ * When \p root_node holds many signature files (see rz_sign_flirt_node_merge()),
+ * each function is matched against all of them before the next function,
+ * whereas applying the files one after the other matches all the functions
+ * against a file before the next file. The two only differ when a module
+ * matched by one file also names other functions of the module (public
+ * functions at an offset) which another file matched on their own: the last
+ * match applied names them.
+ *
+ * \param analysis     The analysis
+ * \param root_node    The root node
+ * \param max_threads  Maximum number of threads used to match the functions
  *
  * \return False on error, otherwise true
  */
-static bool node_match_functions(RzAnalysis *analysis, const RzFlirtNode *root_node) {
+static bool node_match_functions(RzAnalysis *analysis, const RzFlirtNode *root_node, size_t max_threads) {
 	bool ret = true;
 
 	if (rz_list_length(analysis->fcns) == 0) {
@@ -517,38 +589,81 @@ static bool node_match_functions(RzAnalysis *analysis, const RzFlirtNode *root_n
 		return ret;
 	}
 
-	analysis->flb.push_fs(analysis->flb.f, "flirt");
+	RzVector addrs;
+	rz_vector_init(&addrs, sizeof(ut64), NULL, NULL);
+	if (!rz_vector_reserve(&addrs, rz_list_length(analysis->fcns))) {
+		return false;
+	}
 	RzListIter *it_func;
 	RzAnalysisFunction *func;
 	rz_list_foreach (analysis->fcns, it_func, func) {
-		if (func->name && !strncmp(func->name, "flirt.", strlen("flirt."))) {
-			continue;
+		if (!is_flirt_function(func)) {
+			rz_vector_push(&addrs, &func->addr);
 		}
+	}
 
-		ut64 func_size = rz_analysis_function_linear_size(func);
-		ut64 malloc_size = RZ_MAX(func_size, RZ_FLIRT_MAX_PRELUDE_SIZE);
-		ut8 *func_buf = calloc(1, malloc_size);
-		if (!func_buf) {
-			ret = false;
-			break;
+	FlirtFunctionMatch *matches = RZ_NEWS0(FlirtFunctionMatch, FLIRT_MATCH_BATCH_SIZE);
+	RzPVector batch;
+	rz_pvector_init(&batch, NULL);
+	if (!matches || !rz_pvector_reserve(&batch, FLIRT_MATCH_BATCH_SIZE)) {
+		rz_vector_fini(&addrs);
+		free(matches);
+		return false;
+	}
+
+	analysis->flb.push_fs(analysis->flb.f, "flirt");
+	for (size_t start = 0; ret && start < addrs.len; start += FLIRT_MATCH_BATCH_SIZE) {
+		size_t end = RZ_MIN(start + FLIRT_MATCH_BATCH_SIZE, addrs.len);
+		rz_pvector_clear(&batch);
+		for (size_t i = start; i < end; i++) {
+			ut64 addr = *(ut64 *)rz_vector_index_ptr(&addrs, i);
+			func = rz_analysis_get_function_at(analysis, addr);
+			if (!func || is_flirt_function(func)) {
+				continue;
+			}
+			FlirtFunctionMatch *match = &matches[rz_pvector_len(&batch)];
+			if (!function_match_read(analysis, func, match)) {
+				ret = false;
+				break;
+			}
+			rz_pvector_push(&batch, match);
 		}
-		if (!analysis->iob.read_at(analysis->iob.io, func->addr, func_buf, (int)func_size)) {
-			RZ_LOG_ERROR("FLIRT: Couldn't read function %s at 0x%" PFMT64x "\n", func->name, func->addr);
-			RZ_FREE(func_buf);
+		// the functions read before an error are still matched, like when scanning them one by one
+		if (!rz_th_iterate_pvector(&batch, (RzThreadIterator)function_match_run, max_threads, (void *)root_node)) {
 			ret = false;
-			break;
 		}
-		RzListIter *node_child_it;
-		RzFlirtNode *child;
-		rz_list_foreach (root_node->child_list, node_child_it, child) {
-			if (node_match_buffer(analysis, child, func_buf, func->addr, malloc_size, 0)) {
-				break;
+		void **it;
+		bool read_error = false;
+		rz_pvector_foreach (&batch, it) {
+			FlirtFunctionMatch *match = *it;
+			RZ_FREE(match->buf);
+			if (read_error) {
+				continue;
+			}
+			func = rz_analysis_get_function_at(analysis, match->address);
+			if (!func || is_flirt_function(func)) {
+				continue;
+			}
+			if (rz_analysis_function_linear_size(func) != match->func_size) {
+				// resized by a previous match, the bytes read before are not the ones of the function anymore
+				if (!function_match_read(analysis, func, match)) {
+					read_error = true;
+					ret = false;
+					continue;
+				}
+				function_match_run(match, root_node);
+				RZ_FREE(match->buf);
+			}
+			if (match->module && !module_apply(analysis, match->module, match->address)) {
+				ret = false;
 			}
 		}
-		RZ_FREE(func_buf);
 	}
 	analysis->flb.pop_fs(analysis->flb.f);
 
+	rz_pvector_fini(&batch);
+	rz_vector_fini(&addrs);
+	free(matches);
 	return ret;
 }
 
@@ -1303,31 +1418,31 @@ exit:
 }
 
 /**
- * \brief Parses the FLIRT file and applies the signatures
+ * \brief Parses a FLIRT file (.sig or .pat)
  *
- * \param  analysis    The RzAnalysis structure
- * \param  flirt_file  The FLIRT file to parse
- * \return true if the signatures were sucessfully applied to the file
+ * \param  flirt_file     The FLIRT file to parse
+ * \param  expected_arch  The expected architecture of .sig files (RZ_FLIRT_SIG_ARCH_ANY for any)
+ * \return On success the root node of the signatures, otherwise NULL
  */
-RZ_API bool rz_sign_flirt_apply(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const char *flirt_file, ut8 expected_arch) {
-	rz_return_val_if_fail(analysis && RZ_STR_ISNOTEMPTY(flirt_file), false);
+RZ_API RZ_OWN RzFlirtNode *rz_sign_flirt_parse_file(RZ_NONNULL const char *flirt_file, ut8 expected_arch) {
+	rz_return_val_if_fail(RZ_STR_ISNOTEMPTY(flirt_file), NULL);
 	RzBuffer *flirt_buf = NULL;
 	RzFlirtNode *node = NULL;
 
 	if (expected_arch > RZ_FLIRT_SIG_ARCH_ANY) {
 		RZ_LOG_ERROR("FLIRT: unknown architecture %u\n", expected_arch);
-		return false;
+		return NULL;
 	}
 
 	const char *extension = rz_str_lchr(flirt_file, '.');
 	if (RZ_STR_ISEMPTY(extension) || (strcmp(extension, ".sig") != 0 && strcmp(extension, ".pat") != 0)) {
 		RZ_LOG_ERROR("FLIRT: unknown extension '%s'\n", extension);
-		return false;
+		return NULL;
 	}
 
 	if (!(flirt_buf = rz_buf_new_slurp(flirt_file))) {
 		RZ_LOG_ERROR("FLIRT: Can't open %s\n", flirt_file);
-		return false;
+		return NULL;
 	}
 
 	if (!strcmp(extension, ".pat")) {
@@ -1337,15 +1452,66 @@ RZ_API bool rz_sign_flirt_apply(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL cons
 	}
 
 	rz_buf_free(flirt_buf);
-	if (node) {
-		if (!node_match_functions(analysis, node)) {
-			RZ_LOG_ERROR("FLIRT: Error while scanning the file %s\n", flirt_file);
-		}
-		rz_sign_flirt_node_free(node);
-		return true;
+	if (!node) {
+		RZ_LOG_ERROR("FLIRT: We encountered an error while parsing the file %s. Sorry.\n", flirt_file);
 	}
-	RZ_LOG_ERROR("FLIRT: We encountered an error while parsing the file %s. Sorry.\n", flirt_file);
-	return false;
+	return node;
+}
+
+/**
+ * \brief Appends the signatures of \p node to the ones of \p root
+ *
+ * The resulting tree matches a function against the signatures of \p root
+ * first and then against the ones of \p node, thus many signature files can
+ * be applied with a single walk over the functions.
+ *
+ * \param  root  The root node to extend
+ * \param  node  The root node of the signatures to add; owned by \p root on success
+ * \return true on success, false otherwise
+ */
+RZ_API bool rz_sign_flirt_node_merge(RZ_NONNULL RzFlirtNode *root, RZ_NONNULL RZ_OWN RzFlirtNode *node) {
+	rz_return_val_if_fail(root && node && root != node && !root->length && !root->module_list, false);
+	if (!root->child_list && !(root->child_list = rz_list_newf((RzListFree)rz_sign_flirt_node_free))) {
+		return false;
+	}
+	return rz_list_append(root->child_list, node) != NULL;
+}
+
+/**
+ * \brief Applies the signatures in \p node to the analyzed functions
+ *
+ * \param  analysis     The RzAnalysis structure
+ * \param  node         The root node of the signatures
+ * \param  max_threads  Maximum number of threads used to match the functions (RZ_THREAD_POOL_ALL_CORES for all the cores)
+ * \return false on error, otherwise true
+ */
+RZ_API bool rz_sign_flirt_apply_node(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const RzFlirtNode *node, size_t max_threads) {
+	rz_return_val_if_fail(analysis && node, false);
+	if (!node_match_functions(analysis, node, max_threads)) {
+		RZ_LOG_ERROR("FLIRT: Error while scanning the functions\n");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Parses the FLIRT file and applies the signatures
+ *
+ * \param  analysis    The RzAnalysis structure
+ * \param  flirt_file  The FLIRT file to parse
+ * \return true if the signatures were sucessfully applied to the file
+ */
+RZ_API bool rz_sign_flirt_apply(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const char *flirt_file, ut8 expected_arch) {
+	rz_return_val_if_fail(analysis && RZ_STR_ISNOTEMPTY(flirt_file), false);
+	RzFlirtNode *node = rz_sign_flirt_parse_file(flirt_file, expected_arch);
+	if (!node) {
+		return false;
+	}
+	if (!node_match_functions(analysis, node, RZ_THREAD_POOL_ALL_CORES)) {
+		RZ_LOG_ERROR("FLIRT: Error while scanning the file %s\n", flirt_file);
+	}
+	rz_sign_flirt_node_free(node);
+	return true;
 }
 
 /**
@@ -1311,6 +1311,34 @@ RZ_DEPRECATE RZ_API RZ_BORROW ut8 *rz_buf_data(RZ_NONNULL RzBuffer *b, RZ_NONNUL
 	return get_whole_buf(b, size);
 }
 
+/**
+ * \brief Return the buffer data if it is already entirely in memory.
+ * \param b Buffer to get the data from.
+ * \param size Size of the returned data.
+ *
+ * Unlike rz_buf_data(), this never allocates nor reads anything and does not
+ * modify the buffer, so it can be called concurrently by multiple readers.
+ * Only bytes and mmap buffers, or slices of them, have their data directly
+ * addressable; NULL is returned for all the others.
+ */
+RZ_API RZ_BORROW const ut8 *rz_buf_direct_data(RZ_NONNULL RzBuffer *b, RZ_NONNULL RZ_OUT ut64 *size) {
+	rz_return_val_if_fail(b && size, NULL);
+	if (b->methods == &buffer_bytes_methods || b->methods == &buffer_mmap_methods) {
+		return b->methods->get_whole_buf(b, size);
+	}
+	if (b->methods != &buffer_ref_methods) {
+		return NULL;
+	}
+	struct buf_ref_priv *priv = get_priv_ref(b);
+	ut64 parent_size;
+	const ut8 *data = rz_buf_direct_data(priv->parent, &parent_size);
+	if (!data || priv->base > parent_size) {
+		return NULL;
+	}
+	*size = RZ_MIN(priv->size, parent_size - priv->base);
+	return data + priv->base;
+}
+
 /**
  * \brief Scans buffer linearly in chunks calling \p fwd_scan for each chunk.
  *
@@ -211,6 +211,18 @@ RZ_API ut64 rz_file_size(const char *str) {
 	return (ut64)buf.st_size;
 }
 
+/**
+ * \brief Returns the last modification time of the file \p str, in seconds since the epoch, or 0 on failure
+ */
+RZ_API ut64 rz_file_mtime(RZ_NONNULL const char *str) {
+	rz_return_val_if_fail(!RZ_STR_ISEMPTY(str), 0);
+	StructStat buf = { 0 };
+	if (file_stat(str, &buf) == -1) {
+		return 0;
+	}
+	return (ut64)buf.st_mtime;
+}
+
 RZ_API bool rz_file_is_abspath(const char *file) {
 	rz_return_val_if_fail(!RZ_STR_ISEMPTY(file), 0);
 	return ((*file && file[1] == ':') || *file == '/');
@@ -3,6 +3,44 @@
 // SPDX-FileCopyrightText: 2016-2018 ret2libc <sirmy15@gmail.com>
 // SPDX-License-Identifier: BSD-3-Clause
 
+static inline KEY_TYPE dupkey(HtName_(Ht) * ht, const KEY_TYPE k) {
+	return ht->opt.dupkey ? ht->opt.dupkey(k) : (KEY_TYPE)k;
+}
+
+static inline VALUE_TYPE dupval(HtName_(Ht) * ht, const VALUE_TYPE v) {
+	return ht->opt.dupvalue ? ht->opt.dupvalue(v) : (VALUE_TYPE)v;
+}
+
+static inline ut32 calcsize_key(HtName_(Ht) * ht, const KEY_TYPE k) {
+	return ht->opt.calcsizeK ? ht->opt.calcsizeK(k) : 0;
+}
+
+static inline ut32 calcsize_val(HtName_(Ht) * ht, const VALUE_TYPE v) {
+	return ht->opt.calcsizeV ? ht->opt.calcsizeV(v) : 0;
+}
+
+static inline void freefn(HtName_(Ht) * ht, HT_(Kv) * kv) {
+	if (ht->opt.freefn) {
+		ht->opt.freefn(kv);
+	}
+}
+
+static inline bool is_kv_equal(HtName_(Ht) * ht, const KEY_TYPE key, const ut32 key_len, const HT_(Kv) * kv) {
+	if (key_len != kv->key_len) {
+		return false;
+	}
+
+	bool res = key == kv->key;
+	if (!res && ht->opt.cmp) {
+		res = !ht->opt.cmp(key, kv->key);
+	}
+	return res;
+}
+
+#if HT_OPEN_ADDRESSING
+#include "ht_oa_inc.c"
+#else
+
 #define LOAD_FACTOR     1
 #define S_ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
@@ -27,28 +65,6 @@ static inline ut32 bucketfn(HtName_(Ht) * ht, const KEY_TYPE k) {
 	return hashfn(ht, k) % ht->size;
 }
 
-static inline KEY_TYPE dupkey(HtName_(Ht) * ht, const KEY_TYPE k) {
-	return ht->opt.dupkey ? ht->opt.dupkey(k) : (KEY_TYPE)k;
-}
-
-static inline VALUE_TYPE dupval(HtName_(Ht) * ht, const VALUE_TYPE v) {
-	return ht->opt.dupvalue ? ht->opt.dupvalue(v) : (VALUE_TYPE)v;
-}
-
-static inline ut32 calcsize_key(HtName_(Ht) * ht, const KEY_TYPE k) {
-	return ht->opt.calcsizeK ? ht->opt.calcsizeK(k) : 0;
-}
-
-static inline ut32 calcsize_val(HtName_(Ht) * ht, const VALUE_TYPE v) {
-	return ht->opt.calcsizeV ? ht->opt.calcsizeV(v) : 0;
-}
-
-static inline void freefn(HtName_(Ht) * ht, HT_(Kv) * kv) {
-	if (ht->opt.freefn) {
-		ht->opt.freefn(kv);
-	}
-}
-
 static inline ut32 next_idx(ut32 idx) {
 	if (idx != UT32_MAX && idx < S_ARRAY_SIZE(ht_primes_sizes) - 1) {
 		return idx + 1;
@@ -62,18 +78,6 @@ static inline ut32 compute_size(ut32 idx, ut32 sz) {
 	return idx != UT32_MAX && idx < S_ARRAY_SIZE(ht_primes_sizes) ? ht_primes_sizes[idx] : (sz | 1);
 }
 
-static inline bool is_kv_equal(HtName_(Ht) * ht, const KEY_TYPE key, const ut32 key_len, const HT_(Kv) * kv) {
-	if (key_len != kv->key_len) {
-		return false;
-	}
-
-	bool res = key == kv->key;
-	if (!res && ht->opt.cmp) {
-		res = !ht->opt.cmp(key, kv->key);
-	}
-	return res;
-}
-
 static inline HT_(Kv) * kv_at(HtName_(Ht) * ht, HT_(Bucket) * bt, ut32 i) {
 	return (HT_(Kv) *)((char *)bt->arr + i * ht->opt.elem_size);
 }
@@ -123,6 +127,22 @@ static HtName_(Ht) * internal_ht_new(ut32 size, ut32 prime_idx, HT_(Options) * o
 	return ht;
 }
 
+// Create a new hashtable with room for initial_size elements before growing.
+static inline HtName_(Ht) * internal_ht_new_size(ut32 initial_size, HT_(Options) * opt) {
+	ut32 i = 0;
+
+	while (i < S_ARRAY_SIZE(ht_primes_sizes) &&
+		ht_primes_sizes[i] * LOAD_FACTOR < initial_size) {
+		i++;
+	}
+	if (i == S_ARRAY_SIZE(ht_primes_sizes)) {
+		i = UT32_MAX;
+	}
+
+	ut32 sz = compute_size(i, (ut32)(initial_size * (2 - LOAD_FACTOR)));
+	return internal_ht_new(sz, i, opt);
+}
+
 RZ_API HtName_(Ht) * Ht_(new_opt)(HT_(Options) * opt) {
 	return internal_ht_new(ht_primes_sizes[0], 0, opt);
 }
@@ -367,3 +387,5 @@ RZ_API void Ht_(foreach)(HtName_(Ht) * ht, HT_(ForeachCallback) cb, void *user)
 		}
 	}
 }
+
+#endif
@@ -0,0 +1,356 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: BSD-3-Clause
+
+/** \file ht_oa_inc.c
+ * Open addressing implementation of the hashtables, included by ht_inc.c
+ * when HT_OPEN_ADDRESSING is set.
+ *
+ * The elements are stored in the table itself, whose size is a power of
+ * two, and placed with Robin Hood hashing: an element being inserted takes
+ * the slot of the first element closer to its own ideal slot, which is
+ * shifted forward with the rest of the run. The elements with the same
+ * ideal slot are thus contiguous and lookups stop at the first element
+ * closer to its ideal slot than the searched key would be. Deletions shift
+ * back the following elements of the run instead of leaving tombstones.
+ */
+
+#define HT_OA_MIN_SIZE 8
+#define HT_OA_MAX_DIST UT8_MAX
+// Maximum load of the table, in quarters of its size
+#define HT_OA_MAX_LOAD 3
+#define HT_OA_NO_SLOT  UT32_MAX
+
+static inline ut32 slot_of(HtName_(Ht) * ht, const KEY_TYPE k) {
+	// Fibonacci hashing, the high bits of the product depend on all the bits of the hash
+	ut64 hash = ht->opt.hashfn ? ht->opt.hashfn(k) : (ut64)k;
+	return (ut32)((hash * 0x9e3779b97f4a7c15ULL) >> ht->shift);
+}
+
+static inline HT_(Kv) * kv_at(HtName_(Ht) * ht, ut32 i) {
+	return (HT_(Kv) *)((char *)ht->table + (size_t)i * ht->opt.elem_size);
+}
+
+static bool table_alloc(HtName_(Ht) * ht, ut32 size) {
+	HT_(Kv) *table = calloc(size, ht->opt.elem_size);
+	ut8 *dist = calloc(size, sizeof(ut8));
+	if (!table || !dist) {
+		free(table);
+		free(dist);
+		return false;
+	}
+	ht->table = table;
+	ht->dist = dist;
+	ht->size = size;
+	ht->count = 0;
+	ht->shift = 64;
+	for (ut32 s = size; s > 1; s >>= 1) {
+		ht->shift--;
+	}
+	return true;
+}
+
+// Create a new hashtable of size slots, which must be a power of two.
+static HtName_(Ht) * internal_ht_new(ut32 size, HT_(Options) * opt) {
+	HtName_(Ht) *ht = calloc(1, sizeof(*ht));
+	if (!ht) {
+		return NULL;
+	}
+	ht->opt = *opt;
+	// if not provided, assume we are dealing with a regular HtName_(Ht), with
+	// HT_(Kv) as elements
+	if (ht->opt.elem_size == 0) {
+		ht->opt.elem_size = sizeof(HT_(Kv));
+	}
+	if (!table_alloc(ht, size)) {
+		free(ht);
+		return NULL;
+	}
+	return ht;
+}
+
+// Create a new hashtable with room for initial_size elements before growing.
+static inline HtName_(Ht) * internal_ht_new_size(ut32 initial_size, HT_(Options) * opt) {
+	ut32 size = HT_OA_MIN_SIZE;
+	while (size <= UT32_MAX / 4 && (ut64)size * HT_OA_MAX_LOAD < (ut64)initial_size * 4) {
+		size <<= 1;
+	}
+	return internal_ht_new(size, opt);
+}
+
+RZ_API HtName_(Ht) * Ht_(new_opt)(HT_(Options) * opt) {
+	return internal_ht_new(HT_OA_MIN_SIZE, opt);
+}
+
+RZ_API void Ht_(free)(HtName_(Ht) * ht) {
+	if (!ht) {
+		return;
+	}
+
+	if (ht->opt.freefn) {
+		for (ut32 i = 0; i < ht->size; i++) {
+			if (ht->dist[i]) {
+				ht->opt.freefn(kv_at(ht, i));
+			}
+		}
+	}
+	free(ht->table);
+	free(ht->dist);
+	free(ht);
+}
+
+// Returns the slot of the element with the given key, or HT_OA_NO_SLOT.
+static ut32 find_slot(HtName_(Ht) * ht, const KEY_TYPE key, const ut32 key_len) {
+	const ut32 mask = ht->size - 1;
+	ut32 i = slot_of(ht, key);
+	for (ut32 d = 1; ht->dist[i] >= d; d++) {
+		if (ht->dist[i] == d && is_kv_equal(ht, key, key_len, kv_at(ht, i))) {
+			return i;
+		}
+		i = (i + 1) & mask;
+	}
+	return HT_OA_NO_SLOT;
+}
+
+// Takes a slot for the key, which must not be in the table, and returns it.
+// Fails with HT_OA_NO_SLOT, leaving the table untouched, when an element
+// would end up too far from its ideal slot.
+static ut32 take_slot(HtName_(Ht) * ht, const KEY_TYPE key) {
+	const ut32 mask = ht->size - 1;
+	ut32 i = slot_of(ht, key);
+	ut32 d = 1;
+	while (ht->dist[i] >= d) {
+		i = (i + 1) & mask;
+		d++;
+	}
+	if (d > HT_OA_MAX_DIST) {
+		return HT_OA_NO_SLOT;
+	}
+	// the elements up to the next free slot are moved one slot forward
+	ut32 end = i;
+	while (ht->dist[end]) {
+		if (ht->dist[end] == HT_OA_MAX_DIST) {
+			return HT_OA_NO_SLOT;
+		}
+		end = (end + 1) & mask;
+	}
+	while (end != i) {
+		ut32 prev = (end - 1) & mask;
+		memcpy(kv_at(ht, end), kv_at(ht, prev), ht->opt.elem_size);
+		ht->dist[end] = ht->dist[prev] + 1;
+		end = prev;
+	}
+	ht->dist[i] = d;
+	ht->count++;
+	return i;
+}
+
+static void release_slot(HtName_(Ht) * ht, ut32 i) {
+	const ut32 mask = ht->size - 1;
+	ut32 next = (i + 1) & mask;
+	while (ht->dist[next] > 1) {
+		memcpy(kv_at(ht, i), kv_at(ht, next), ht->opt.elem_size);
+		ht->dist[i] = ht->dist[next] - 1;
+		i = next;
+		next = (next + 1) & mask;
+	}
+	ht->dist[i] = 0;
+	ht->count--;
+}
+
+// Doubles the size of the hashtable.
+static bool internal_ht_grow(HtName_(Ht) * ht) {
+	if (ht->size > UT32_MAX / 4) {
+		return false;
+	}
+	HtName_(Ht) grown = *ht;
+	if (!table_alloc(&grown, ht->size * 2)) {
+		return false;
+	}
+	for (ut32 i = 0; i < ht->size; i++) {
+		if (!ht->dist[i]) {
+			continue;
+		}
+		HT_(Kv) *kv = kv_at(ht, i);
+		ut32 j = take_slot(&grown, kv->key);
+		if (j == HT_OA_NO_SLOT) {
+			free(grown.table);
+			free(grown.dist);
+			return false;
+		}
+		memcpy(kv_at(&grown, j), kv, ht->opt.elem_size);
+	}
+	free(ht->table);
+	free(ht->dist);
+	*ht = grown;
+	return true;
+}
+
+static HT_(Kv) * reserve_kv(HtName_(Ht) * ht, const KEY_TYPE key, const int key_len, bool update) {
+	ut32 i = find_slot(ht, key, key_len);
+	if (i != HT_OA_NO_SLOT) {
+		HT_(Kv) *kv = kv_at(ht, i);
+		if (update) {
+			freefn(ht, kv);
+			return kv;
+		}
+		return NULL;
+	}
+
+	// the table grows before the insertion, so that the returned element stays in place
+	if ((ut64)(ht->count + 1) * 4 > (ut64)ht->size * HT_OA_MAX_LOAD &&
+		!internal_ht_grow(ht) && ht->count + 1 >= ht->size) {
+		// we can't grow the ht anymore, but we can continue while at least a slot is free
+		return NULL;
+	}
+	i = take_slot(ht, key);
+	if (i == HT_OA_NO_SLOT) {
+		// too many keys share the same ideal slot, growing only helps if the table is not mostly empty
+		if ((ut64)ht->count * 8 < ht->size || !internal_ht_grow(ht)) {
+			return NULL;
+		}
+		i = take_slot(ht, key);
+		if (i == HT_OA_NO_SLOT) {
+			return NULL;
+		}
+	}
+	return kv_at(ht, i);
+}
+
+RZ_API bool Ht_(insert_kv)(HtName_(Ht) * ht, HT_(Kv) * kv, bool update) {
+	HT_(Kv) *kv_dst = reserve_kv(ht, kv->key, kv->key_len, update);
+	if (!kv_dst) {
+		return false;
+	}
+
+	memcpy(kv_dst, kv, ht->opt.elem_size);
+	return true;
+}
+
+static bool insert_update(HtName_(Ht) * ht, const KEY_TYPE key, VALUE_TYPE value, bool update) {
+	ut32 key_len = calcsize_key(ht, key);
+	HT_(Kv) *kv_dst = reserve_kv(ht, key, key_len, update);
+	if (!kv_dst) {
+		return false;
+	}
+
+	kv_dst->key = dupkey(ht, key);
+	kv_dst->key_len = key_len;
+	kv_dst->value = dupval(ht, value);
+	kv_dst->value_len = calcsize_val(ht, value);
+	return true;
+}
+
+// Inserts the key value pair key, value into the hashtable.
+// Doesn't allow for "update" of the value.
+RZ_API bool Ht_(insert)(HtName_(Ht) * ht, const KEY_TYPE key, VALUE_TYPE value) {
+	return insert_update(ht, key, value, false);
+}
+
+// Inserts the key value pair key, value into the hashtable.
+// Does allow for "update" of the value.
+RZ_API bool Ht_(update)(HtName_(Ht) * ht, const KEY_TYPE key, VALUE_TYPE value) {
+	return insert_update(ht, key, value, true);
+}
+
+// Update the key of an element that has old_key as key and replace it with new_key
+RZ_API bool Ht_(update_key)(HtName_(Ht) * ht, const KEY_TYPE old_key, const KEY_TYPE new_key) {
+	// First look for the value associated with old_key
+	bool found;
+	VALUE_TYPE value = Ht_(find)(ht, old_key, &found);
+	if (!found) {
+		return false;
+	}
+
+	// Associate the existing value with new_key
+	bool inserted = insert_update(ht, new_key, value, false);
+	if (!inserted) {
+		return false;
+	}
+
+	// Remove the old_key kv, which may have moved, paying attention to not double free the value
+	ut32 i = find_slot(ht, old_key, calcsize_key(ht, old_key));
+	if (i == HT_OA_NO_SLOT) {
+		return false;
+	}
+	HT_(Kv) *kv = kv_at(ht, i);
+	if (!ht->opt.dupvalue) {
+		// do not free the value part if dupvalue is not
+		// set, because the old value has been
+		// associated with the new key and it should not
+		// be freed
+		kv->value = HT_NULL_VALUE;
+		kv->value_len = 0;
+	}
+	freefn(ht, kv);
+	release_slot(ht, i);
+	return true;
+}
+
+// Returns the corresponding SdbKv entry from the key.
+// If `found` is not NULL, it will be set to true if the entry was found, false
+// otherwise.
+RZ_API HT_(Kv) * Ht_(find_kv)(HtName_(Ht) * ht, const KEY_TYPE key, bool *found) {
+	if (found) {
+		*found = false;
+	}
+	if (!ht) {
+		return NULL;
+	}
+
+	ut32 i = find_slot(ht, key, calcsize_key(ht, key));
+	if (i == HT_OA_NO_SLOT) {
+		return NULL;
+	}
+	if (found) {
+		*found = true;
+	}
+	return kv_at(ht, i);
+}
+
+// Looks up the corresponding value from the key.
+// If `found` is not NULL, it will be set to true if the entry was found, false
+// otherwise.
+RZ_API VALUE_TYPE Ht_(find)(HtName_(Ht) * ht, const KEY_TYPE key, bool *found) {
+	HT_(Kv) *res = Ht_(find_kv)(ht, key, found);
+	return res ? res->value : HT_NULL_VALUE;
+}
+
+// Deletes a entry from the hash table from the key, if the pair exists.
+RZ_API bool Ht_(delete)(HtName_(Ht) * ht, const KEY_TYPE key) {
+	ut32 i = find_slot(ht, key, calcsize_key(ht, key));
+	if (i == HT_OA_NO_SLOT) {
+		return false;
+	}
+	freefn(ht, kv_at(ht, i));
+	release_slot(ht, i);
+	return true;
+}
+
+RZ_API void Ht_(foreach)(HtName_(Ht) * ht, HT_(ForeachCallback) cb, void *user) {
+	if (!ht->count) {
+		return;
+	}
+	// Start after a free slot: deletions only move elements back within a
+	// run of used slots, so none of them can cross it.
+	const ut32 mask = ht->size - 1;
+	ut32 start = 0;
+	while (ht->dist[start]) {
+		start++;
+	}
+	for (ut32 n = 0; n < ht->size;) {
+		ut32 i = (start + n) & mask;
+		if (!ht->dist[i]) {
+			n++;
+			continue;
+		}
+		HT_(Kv) *kv = kv_at(ht, i);
+		KEY_TYPE key = kv->key;
+		if (!cb(user, key, kv->value)) {
+			return;
+		}
+		// if the callback deleted an element, the slot may hold one not visited yet
+		if (!ht->dist[i] || kv_at(ht, i)->key == key) {
+			n++;
+		}
+	}
+}
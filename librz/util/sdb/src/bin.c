@@ -0,0 +1,425 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: MIT
+
+#include "sdb.h"
+
+#include <fcntl.h>
+#include <rz_endian.h>
+#include <rz_util/ht_pu.h>
+#include <rz_util/rz_file.h>
+#include <rz_vector.h>
+#include "sdb_private.h"
+
+/**
+ * *****************
+ * Binary SDB Format
+ * *****************
+ *
+ * Meant for big databases like projects, the file can be memory-mapped and
+ * loaded without any parsing or unescaping. All the integers are little
+ * endian and all the offsets are from the beginning of the file.
+ *
+ * Header:
+ *
+ *   ut8  magic[8]      "RZSDBBIN"
+ *   ut32 version       SDB_BIN_VERSION
+ *   ut32 ns_count      number of namespaces, including the root
+ *   ut64 ns_offset     offset of the namespace table
+ *
+ * The strings follow the header, each one terminated by a '\0'. Strings of up
+ * to SDB_BIN_SHARED_MAX bytes, which covers most keys and small values, are
+ * stored only once and shared by all the records using them.
+ *
+ * Then come the key-value records of all the namespaces, 16 bytes each,
+ * sorted by key within a namespace:
+ *
+ *   ut64 key           offset of the key string
+ *   ut64 value         offset of the value string
+ *
+ * At last the namespace table, 24 bytes per namespace. The root is the
+ * first one and every namespace comes after its parent:
+ *
+ *   ut32 parent        index of the parent namespace, ignored for the root
+ *   ut32 kv_count      number of key-value records
+ *   ut64 name          offset of the name string
+ *   ut64 kv_offset     offset of the first key-value record
+ */
+
+#define SDB_BIN_MAGIC       "RZSDBBIN"
+#define SDB_BIN_MAGIC_SIZE  8
+#define SDB_BIN_VERSION     1
+#define SDB_BIN_HEADER_SIZE 24
+#define SDB_BIN_KV_SIZE     16
+#define SDB_BIN_NS_SIZE     24
+#define SDB_BIN_WRITE_BUF   0x10000
+#define SDB_BIN_SHARED_MAX  256
+
+typedef struct {
+	ut32 parent;
+	ut32 kv_count;
+	ut64 name;
+	ut64 kv_index; ///< Index of the first record while saving
+} BinNs;
+
+typedef struct {
+	ut64 key;
+	ut64 value;
+} BinKv;
+
+typedef struct {
+	int fd;
+	ut8 *buf;
+	size_t buf_len;
+	ut64 off; ///< Offset of the next byte written
+	RzVector /*<BinKv>*/ kvs;
+	RzVector /*<BinNs>*/ nss;
+	HtPU /*<char *, ut64>*/ *strings; ///< Offsets of the shared strings already written
+	bool failed;
+} SaveCtx;
+
+struct sdb_bin_t {
+	RzMmap *map;
+	const ut8 *buf;
+	ut64 size;
+	ut32 ns_count;
+	ut64 ns_offset;
+};
+
+static bool save_flush(SaveCtx *ctx) {
+	if (ctx->buf_len && write(ctx->fd, ctx->buf, ctx->buf_len) != (ssize_t)ctx->buf_len) {
+		ctx->failed = true;
+	}
+	ctx->buf_len = 0;
+	return !ctx->failed;
+}
+
+static void save_write(SaveCtx *ctx, const void *data, size_t len) {
+	if (ctx->buf_len + len > SDB_BIN_WRITE_BUF && !save_flush(ctx)) {
+		return;
+	}
+	if (len > SDB_BIN_WRITE_BUF) {
+		if (write(ctx->fd, data, len) != (ssize_t)len) {
+			ctx->failed = true;
+		}
+	} else {
+		memcpy(ctx->buf + ctx->buf_len, data, len);
+		ctx->buf_len += len;
+	}
+	ctx->off += len;
+}
+
+static ut64 save_string(SaveCtx *ctx, const char *str) {
+	size_t len = strlen(str);
+	bool found = false;
+	ut64 off = len <= SDB_BIN_SHARED_MAX ? ht_pu_find(ctx->strings, str, &found) : 0;
+	if (found) {
+		return off;
+	}
+	off = ctx->off;
+	save_write(ctx, str, len + 1);
+	if (len <= SDB_BIN_SHARED_MAX) {
+		ht_pu_insert(ctx->strings, (void *)str, off);
+	}
+	return off;
+}
+
+static ut32 string_hash(const void *k) {
+	return sdb_hash(k);
+}
+
+static int string_cmp(const void *a, const void *b) {
+	return strcmp(a, b);
+}
+
+static void *string_dup(const void *k) {
+	return strdup(k);
+}
+
+static void string_kv_free(HtPUKv *kv) {
+	free(kv->key);
+}
+
+static int cmp_ns(const void *a, const void *b) {
+	const SdbNs *nsa = a;
+	const SdbNs *nsb = b;
+	return strcmp(nsa->name, nsb->name);
+}
+
+static void bin_save(SaveCtx *ctx, Sdb *s, ut32 parent, const char *name) {
+	ut32 index = rz_vector_len(&ctx->nss);
+	BinNs *ns = rz_vector_push(&ctx->nss, NULL);
+	if (!ns) {
+		ctx->failed = true;
+		return;
+	}
+	ns->parent = parent;
+	ns->name = save_string(ctx, name);
+	ns->kv_index = rz_vector_len(&ctx->kvs);
+	ns->kv_count = 0;
+
+	SdbList *l = sdb_foreach_list(s, true);
+	SdbKv *kv;
+	SdbListIter *it;
+	ut32 kv_count = 0;
+	ls_foreach (l, it, kv) {
+		BinKv *rec = rz_vector_push(&ctx->kvs, NULL);
+		if (!rec) {
+			ctx->failed = true;
+			break;
+		}
+		rec->key = save_string(ctx, sdbkv_key(kv));
+		rec->value = save_string(ctx, sdbkv_value(kv));
+		kv_count++;
+	}
+	ls_free(l);
+	// the vector may have been reallocated by the sub-namespaces
+	((BinNs *)rz_vector_index_ptr(&ctx->nss, index))->kv_count = kv_count;
+
+	l = ls_clone(s->ns);
+	if (!l) {
+		ctx->failed = true;
+		return;
+	}
+	ls_sort(l, cmp_ns);
+	SdbNs *sub;
+	ls_foreach (l, it, sub) {
+		if (ctx->failed) {
+			break;
+		}
+		bin_save(ctx, sub->sdb, index, sub->name);
+	}
+	ls_free(l);
+}
+
+RZ_API bool sdb_bin_save_fd(Sdb *s, int fd) {
+	SaveCtx ctx = { 0 };
+	ctx.fd = fd;
+	ctx.buf = malloc(SDB_BIN_WRITE_BUF);
+	HtPUOptions opt = { 0 };
+	opt.cmp = string_cmp;
+	opt.hashfn = string_hash;
+	opt.dupkey = string_dup;
+	opt.freefn = string_kv_free;
+	ctx.strings = ht_pu_new_opt(&opt);
+	if (!ctx.buf || !ctx.strings) {
+		ht_pu_free(ctx.strings);
+		free(ctx.buf);
+		return false;
+	}
+	rz_vector_init(&ctx.kvs, sizeof(BinKv), NULL, NULL);
+	rz_vector_init(&ctx.nss, sizeof(BinNs), NULL, NULL);
+
+	// the header is written once everything else is
+	ut8 header[SDB_BIN_HEADER_SIZE] = { 0 };
+	save_write(&ctx, header, sizeof(header));
+	bin_save(&ctx, s, 0, "");
+
+	ut8 rec[SDB_BIN_NS_SIZE];
+	const ut64 kv_offset = ctx.off;
+	BinKv *kv;
+	rz_vector_foreach(&ctx.kvs, kv) {
+		rz_write_le64(rec, kv->key);
+		rz_write_le64(rec + 8, kv->value);
+		save_write(&ctx, rec, SDB_BIN_KV_SIZE);
+	}
+	const ut64 ns_offset = ctx.off;
+	BinNs *ns;
+	rz_vector_foreach(&ctx.nss, ns) {
+		rz_write_le32(rec, ns->parent);
+		rz_write_le32(rec + 4, ns->kv_count);
+		rz_write_le64(rec + 8, ns->name);
+		rz_write_le64(rec + 16, kv_offset + ns->kv_index * SDB_BIN_KV_SIZE);
+		save_write(&ctx, rec, SDB_BIN_NS_SIZE);
+	}
+	save_flush(&ctx);
+
+	memcpy(header, SDB_BIN_MAGIC, SDB_BIN_MAGIC_SIZE);
+	rz_write_le32(header + 8, SDB_BIN_VERSION);
+	rz_write_le32(header + 12, rz_vector_len(&ctx.nss));
+	rz_write_le64(header + 16, ns_offset);
+	if (!ctx.failed && (lseek(fd, 0, SEEK_SET) != 0 || write(fd, header, sizeof(header)) != sizeof(header))) {
+		ctx.failed = true;
+	}
+
+	rz_vector_fini(&ctx.kvs);
+	rz_vector_fini(&ctx.nss);
+	ht_pu_free(ctx.strings);
+	free(ctx.buf);
+	return !ctx.failed;
+}
+
+RZ_API bool sdb_bin_save(Sdb *s, const char *file) {
+	int fd = open(file, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+	if (fd < 0) {
+		return false;
+	}
+	bool r = sdb_bin_save_fd(s, fd);
+	close(fd);
+	return r;
+}
+
+/**
+ * \brief Checks whether \p file starts like a binary SDB file
+ */
+RZ_API bool sdb_bin_check(const char *file) {
+	int fd = open(file, O_RDONLY | O_BINARY);
+	if (fd < 0) {
+		return false;
+	}
+	char magic[SDB_BIN_MAGIC_SIZE];
+	bool r = read(fd, magic, sizeof(magic)) == sizeof(magic) && !memcmp(magic, SDB_BIN_MAGIC, sizeof(magic));
+	close(fd);
+	return r;
+}
+
+/**
+ * \brief Maps a binary SDB file, whose namespaces can then be loaded on demand
+ */
+RZ_API SdbBin *sdb_bin_open(const char *file) {
+	SdbBin *b = RZ_NEW0(SdbBin);
+	if (!b) {
+		return NULL;
+	}
+	b->map = rz_file_mmap(file, O_RDONLY, 0, 0);
+	if (!b->map || !b->map->buf || b->map->len < SDB_BIN_HEADER_SIZE) {
+		goto fail;
+	}
+	b->buf = b->map->buf;
+	b->size = b->map->len;
+	if (memcmp(b->buf, SDB_BIN_MAGIC, SDB_BIN_MAGIC_SIZE) || rz_read_le32(b->buf + 8) != SDB_BIN_VERSION) {
+		goto fail;
+	}
+	b->ns_count = rz_read_le32(b->buf + 12);
+	b->ns_offset = rz_read_le64(b->buf + 16);
+	if (!b->ns_count || b->ns_offset > b->size || (b->size - b->ns_offset) / SDB_BIN_NS_SIZE < b->ns_count) {
+		goto fail;
+	}
+	return b;
+fail:
+	sdb_bin_close(b);
+	return NULL;
+}
+
+RZ_API void sdb_bin_close(SdbBin *b) {
+	if (!b) {
+		return;
+	}
+	rz_file_mmap_free(b->map);
+	free(b);
+}
+
+static const char *bin_string(SdbBin *b, ut64 off) {
+	if (off >= b->size || !memchr(b->buf + off, '\0', b->size - off)) {
+		return NULL;
+	}
+	return (const char *)b->buf + off;
+}
+
+static bool bin_ns_get(SdbBin *b, ut32 index, BinNs *ns) {
+	const ut8 *rec = b->buf + b->ns_offset + (ut64)index * SDB_BIN_NS_SIZE;
+	ns->parent = rz_read_le32(rec);
+	ns->kv_count = rz_read_le32(rec + 4);
+	ns->name = rz_read_le64(rec + 8);
+	ns->kv_index = rz_read_le64(rec + 16);
+	return (index == 0 || ns->parent < index) && ns->kv_index <= b->size &&
+		(b->size - ns->kv_index) / SDB_BIN_KV_SIZE >= ns->kv_count;
+}
+
+static bool bin_load_kvs(SdbBin *b, BinNs *ns, Sdb *s) {
+	const ut8 *rec = b->buf + ns->kv_index;
+	for (ut32 i = 0; i < ns->kv_count; i++, rec += SDB_BIN_KV_SIZE) {
+		const char *k = bin_string(b, rz_read_le64(rec));
+		const char *v = bin_string(b, rz_read_le64(rec + 8));
+		if (!k || !v) {
+			return false;
+		}
+		sdb_set(s, k, v, 0);
+	}
+	return true;
+}
+
+static bool bin_ns_find(SdbBin *b, const char *path, ut32 *index) {
+	BinNs ns;
+	ut32 i = 0;
+	// the ancestors of a namespace come before it
+	const char *token = path;
+	while (token && *token) {
+		const char *end = strchr(token, '/');
+		size_t len = end ? end - token : strlen(token);
+		ut32 parent = i;
+		for (i++; i < b->ns_count; i++) {
+			if (!bin_ns_get(b, i, &ns)) {
+				return false;
+			}
+			const char *name = bin_string(b, ns.name);
+			if (ns.parent == parent && name && !strncmp(name, token, len) && !name[len]) {
+				break;
+			}
+		}
+		if (i >= b->ns_count) {
+			return false;
+		}
+		token = end ? end + 1 : NULL;
+	}
+	*index = i;
+	return true;
+}
+
+/**
+ * \brief Loads the namespace at \p path of the mapped file, with all of its sub-namespaces, into \p s
+ * \param path Names of the namespaces separated by '/', NULL or "" for the root
+ */
+RZ_API bool sdb_bin_load_ns(SdbBin *b, Sdb *s, const char *path) {
+	ut32 i;
+	if (!bin_ns_find(b, path, &i)) {
+		return false;
+	}
+	Sdb **dbs = RZ_NEWS0(Sdb *, b->ns_count);
+	if (!dbs) {
+		return false;
+	}
+	bool r = false;
+	BinNs ns;
+	dbs[i] = s;
+	for (ut32 j = i; j < b->ns_count; j++) {
+		if (!bin_ns_get(b, j, &ns)) {
+			goto beach;
+		}
+		if (j != i) {
+			if (!dbs[ns.parent]) {
+				continue;
+			}
+			const char *name = bin_string(b, ns.name);
+			if (!name || !(dbs[j] = sdb_ns(dbs[ns.parent], name, true))) {
+				goto beach;
+			}
+		}
+		if (!bin_load_kvs(b, &ns, dbs[j])) {
+			goto beach;
+		}
+	}
+	r = true;
+beach:
+	free(dbs);
+	return r;
+}
+
+/**
+ * \brief Loads only the keys of the namespace at \p path of the mapped file into \p s, without its sub-namespaces
+ * \param path Names of the namespaces separated by '/', NULL or "" for the root
+ */
+RZ_API bool sdb_bin_load_kvs(SdbBin *b, Sdb *s, const char *path) {
+	ut32 i;
+	BinNs ns;
+	return bin_ns_find(b, path, &i) && bin_ns_get(b, i, &ns) && bin_load_kvs(b, &ns, s);
+}
+
+RZ_API bool sdb_bin_load(Sdb *s, const char *file) {
+	SdbBin *b = sdb_bin_open(file);
+	if (!b) {
+		return false;
+	}
+	bool r = sdb_bin_load_ns(b, s, NULL);
+	sdb_bin_close(b);
+	return r;
+}
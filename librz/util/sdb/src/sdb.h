@@ -198,6 +198,17 @@ RZ_API bool sdb_text_save(Sdb *s, const char *file, bool sort);
 RZ_API bool sdb_text_load_buf(Sdb *s, char *buf, size_t sz);
 RZ_API bool sdb_text_load(Sdb *s, const char *file);
 
+/* binary sdb files */
+typedef struct sdb_bin_t SdbBin;
+RZ_API bool sdb_bin_save_fd(Sdb *s, int fd);
+RZ_API bool sdb_bin_save(Sdb *s, const char *file);
+RZ_API bool sdb_bin_check(const char *file);
+RZ_API SdbBin *sdb_bin_open(const char *file);
+RZ_API void sdb_bin_close(SdbBin *b);
+RZ_API bool sdb_bin_load_ns(SdbBin *b, Sdb *s, const char *path);
+RZ_API bool sdb_bin_load_kvs(SdbBin *b, Sdb *s, const char *path);
+RZ_API bool sdb_bin_load(Sdb *s, const char *file);
+
 /* iterate */
 RZ_API void sdb_dump_begin(Sdb *s);
 RZ_API SdbKv *sdb_dump_next(Sdb *s);
@@ -7,6 +7,15 @@
 #include <rz_util/rz_utf32.h>
 #include <rz_util/rz_ebcdic.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define STR_SEARCH_NEON 1
+#endif
+
 typedef enum {
 	SKIP_STRING,
 	RETRY_ASCII,
@@ -347,6 +356,230 @@ static inline bool can_be_ebcdic(const ut8 *buf, ut64 size) {
 	return buf[0] < 0x20 || buf[0] > 0x3f;
 }
 
+/**
+ * Classes of bytes, tested in bulk to skip the positions where no string can start
+ */
+typedef enum {
+	DEAD_CTRL, ///< Control characters which are not escape sequences, \0 included
+	DEAD_8BIT, ///< DEAD_CTRL, DEL and the bytes which cannot start an UTF-8 sequence
+	DEAD_ZERO, ///< Only \0
+} DeadClass;
+
+static inline bool is_dead_ctrl(ut8 b) {
+	return b < 0x20 && (b < 0x07 || b > 0x0d) && b != 0x1b;
+}
+
+static inline bool is_dead_8bit(ut8 b) {
+	return is_dead_ctrl(b) || b == 0x7f || (b >= 0x80 && b < 0xc2) || b >= 0xf8;
+}
+
+/**
+ * \brief Returns the size of the code units of \p type, or 0 if it is not handled by is_dead_start()
+ */
+static inline ut64 dead_unit_size(RzStrEnc type) {
+	switch (type) {
+	case RZ_STRING_ENC_8BIT:
+	case RZ_STRING_ENC_UTF8:
+		return 1;
+	case RZ_STRING_ENC_UTF16LE:
+	case RZ_STRING_ENC_UTF16BE:
+		return 2;
+	case RZ_STRING_ENC_UTF32LE:
+	case RZ_STRING_ENC_UTF32BE:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * \brief Tells whether the code unit at \p buf decodes to a control character ending any string
+ */
+static inline bool is_dead_unit(const ut8 *buf, ut64 unit, bool big_endian) {
+	const ut8 *low = big_endian ? buf + unit - 1 : buf;
+	for (ut64 i = 0; i < unit; i++) {
+		if (buf + i != low && buf[i]) {
+			return false;
+		}
+	}
+	return is_dead_ctrl(*low);
+}
+
+/**
+ * \brief Tells whether rz_scan_strings_raw() certainly finds no string of \p type at \p buf
+ *
+ * When guessing, the first rune decoded there is neither printable nor an
+ * escape sequence, whatever the encoding guessed for it. Otherwise a control
+ * character is found within the first \p min_len code units, which a string
+ * of \p min_len runes cannot contain. Either way the position is skipped by
+ * rz_scan_strings_raw() without any other side effect.
+ */
+static inline bool is_dead_start(const ut8 *buf, ut64 size, RzStrEnc type, ut64 min_len) {
+	if (type == RZ_STRING_ENC_GUESS) {
+		if (!buf[0]) {
+			// may still be the start of a big endian UTF-16/32 string
+			return size > 3 && is_dead_ctrl(buf[1]) && is_dead_ctrl(buf[3]);
+		}
+		return is_dead_ctrl(buf[0]) || buf[0] == 0xff;
+	}
+	ut64 unit = dead_unit_size(type);
+	if (!unit) {
+		return false;
+	}
+	if (size / unit < min_len || (unit == 1 && is_dead_8bit(buf[0]))) {
+		return true;
+	}
+	bool big_endian = type == RZ_STRING_ENC_UTF16BE || type == RZ_STRING_ENC_UTF32BE;
+	for (ut64 i = 0; i < min_len; i++) {
+		if (is_dead_unit(buf + i * unit, unit, big_endian)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+#if defined(__AVX2__)
+#define DEAD_CHUNK 32
+/**
+ * \brief Returns the bitmask of the DEAD_CHUNK bytes at \p buf that belong to \p cls
+ */
+static inline ut64 dead_mask(const ut8 *buf, DeadClass cls) {
+	__m256i x = _mm256_loadu_si256((const __m256i *)buf);
+	__m256i m = _mm256_cmpeq_epi8(x, _mm256_setzero_si256());
+	if (cls != DEAD_ZERO) {
+		// x <= 0x1f && !(x - 7 <= 6) && x != 0x1b
+		__m256i ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(0x1f)), x);
+		__m256i esc = _mm256_sub_epi8(x, _mm256_set1_epi8(0x07));
+		esc = _mm256_cmpeq_epi8(_mm256_min_epu8(esc, _mm256_set1_epi8(0x06)), esc);
+		esc = _mm256_or_si256(esc, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x1b)));
+		m = _mm256_andnot_si256(esc, ctrl);
+	}
+	if (cls == DEAD_8BIT) {
+		// x == 0x7f || x - 0x80 <= 0x41 || x >= 0xf8
+		__m256i hi = _mm256_sub_epi8(x, _mm256_set1_epi8((char)0x80));
+		hi = _mm256_cmpeq_epi8(_mm256_min_epu8(hi, _mm256_set1_epi8(0x41)), hi);
+		hi = _mm256_or_si256(hi, _mm256_cmpeq_epi8(_mm256_max_epu8(x, _mm256_set1_epi8((char)0xf8)), x));
+		hi = _mm256_or_si256(hi, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x7f)));
+		m = _mm256_or_si256(m, hi);
+	}
+	return (ut32)_mm256_movemask_epi8(m);
+}
+#elif defined(__SSE2__)
+#define DEAD_CHUNK 16
+/**
+ * \brief Returns the bitmask of the DEAD_CHUNK bytes at \p buf that belong to \p cls
+ */
+static inline ut64 dead_mask(const ut8 *buf, DeadClass cls) {
+	__m128i x = _mm_loadu_si128((const __m128i *)buf);
+	__m128i m = _mm_cmpeq_epi8(x, _mm_setzero_si128());
+	if (cls != DEAD_ZERO) {
+		// x <= 0x1f && !(x - 7 <= 6) && x != 0x1b
+		__m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(0x1f)), x);
+		__m128i esc = _mm_sub_epi8(x, _mm_set1_epi8(0x07));
+		esc = _mm_cmpeq_epi8(_mm_min_epu8(esc, _mm_set1_epi8(0x06)), esc);
+		esc = _mm_or_si128(esc, _mm_cmpeq_epi8(x, _mm_set1_epi8(0x1b)));
+		m = _mm_andnot_si128(esc, ctrl);
+	}
+	if (cls == DEAD_8BIT) {
+		// x == 0x7f || x - 0x80 <= 0x41 || x >= 0xf8
+		__m128i hi = _mm_sub_epi8(x, _mm_set1_epi8((char)0x80));
+		hi = _mm_cmpeq_epi8(_mm_min_epu8(hi, _mm_set1_epi8(0x41)), hi);
+		hi = _mm_or_si128(hi, _mm_cmpeq_epi8(_mm_max_epu8(x, _mm_set1_epi8((char)0xf8)), x));
+		hi = _mm_or_si128(hi, _mm_cmpeq_epi8(x, _mm_set1_epi8(0x7f)));
+		m = _mm_or_si128(m, hi);
+	}
+	return (ut32)_mm_movemask_epi8(m);
+}
+#elif STR_SEARCH_NEON
+#define DEAD_CHUNK 16
+/**
+ * \brief Returns the bitmask of the DEAD_CHUNK bytes at \p buf that belong to \p cls
+ */
+static inline ut64 dead_mask(const ut8 *buf, DeadClass cls) {
+	static const ut8 bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t x = vld1q_u8(buf);
+	uint8x16_t m = vceqq_u8(x, vdupq_n_u8(0));
+	if (cls != DEAD_ZERO) {
+		uint8x16_t ctrl = vcleq_u8(x, vdupq_n_u8(0x1f));
+		uint8x16_t esc = vcleq_u8(vsubq_u8(x, vdupq_n_u8(0x07)), vdupq_n_u8(0x06));
+		esc = vorrq_u8(esc, vceqq_u8(x, vdupq_n_u8(0x1b)));
+		m = vbicq_u8(ctrl, esc);
+	}
+	if (cls == DEAD_8BIT) {
+		uint8x16_t hi = vcleq_u8(vsubq_u8(x, vdupq_n_u8(0x80)), vdupq_n_u8(0x41));
+		hi = vorrq_u8(hi, vcgeq_u8(x, vdupq_n_u8(0xf8)));
+		hi = vorrq_u8(hi, vceqq_u8(x, vdupq_n_u8(0x7f)));
+		m = vorrq_u8(m, hi);
+	}
+	m = vandq_u8(m, vld1q_u8(bits));
+	return vaddv_u8(vget_low_u8(m)) | (ut64)vaddv_u8(vget_high_u8(m)) << 8;
+}
+#endif
+
+#ifdef DEAD_CHUNK
+/**
+ * \brief Returns the bitmask of the positions where a code unit ending any string starts
+ *
+ * \p ctrl and \p zero are the DEAD_CTRL and DEAD_ZERO bitmasks of the bytes.
+ */
+static inline ut64 dead_units_mask(ut64 ctrl, ut64 zero, ut64 unit, bool big_endian) {
+	switch (unit) {
+	case 2:
+		return big_endian ? zero & ctrl >> 1 : ctrl & zero >> 1;
+	case 4:
+		return big_endian ? zero & zero >> 1 & zero >> 2 & ctrl >> 3 : ctrl & zero >> 1 & zero >> 2 & zero >> 3;
+	default:
+		return ctrl;
+	}
+}
+#endif
+
+/**
+ * \brief Count the positions from \p buf on where no string of \p type can start
+ *
+ * Whole chunks of bytes are classified at once when SIMD instructions are
+ * available, the last positions are then checked one by one.
+ */
+static ut64 count_dead_starts(const ut8 *buf, ut64 size, RzStrEnc type, ut64 min_len) {
+	if (!is_dead_start(buf, size, type, min_len)) {
+		// most often the case inside strings and code
+		return 0;
+	}
+	ut64 i = 1;
+#ifdef DEAD_CHUNK
+	const ut64 all = (1ULL << DEAD_CHUNK) - 1;
+	if (type == RZ_STRING_ENC_GUESS) {
+		// a \0 is only dead if the 1st and 3rd bytes after it are dead as well
+		for (; i + DEAD_CHUNK + 3 <= size; i += DEAD_CHUNK) {
+			if ((dead_mask(buf + i, DEAD_CTRL) & dead_mask(buf + i + 3, DEAD_CTRL)) != all) {
+				break;
+			}
+		}
+	} else {
+		ut64 unit = dead_unit_size(type);
+		bool big_endian = type == RZ_STRING_ENC_UTF16BE || type == RZ_STRING_ENC_UTF32BE;
+		// the masks of two chunks are enough to look this far ahead
+		ut64 window = RZ_MIN(min_len, DEAD_CHUNK / unit);
+		for (; i + 2 * DEAD_CHUNK <= size; i += DEAD_CHUNK) {
+			ut64 ctrl = dead_mask(buf + i, DEAD_CTRL) | dead_mask(buf + i + DEAD_CHUNK, DEAD_CTRL) << DEAD_CHUNK;
+			ut64 zero = unit > 1 ? dead_mask(buf + i, DEAD_ZERO) | dead_mask(buf + i + DEAD_CHUNK, DEAD_ZERO) << DEAD_CHUNK : 0;
+			ut64 units = dead_units_mask(ctrl, zero, unit, big_endian);
+			ut64 dead = unit == 1 ? dead_mask(buf + i, DEAD_8BIT) : 0;
+			for (ut64 k = 0; k < window; k++) {
+				dead |= units >> (k * unit);
+			}
+			if ((dead & all) != all) {
+				break;
+			}
+		}
+	}
+#endif
+	while (i < size && is_dead_start(buf + i, size - i, type, min_len)) {
+		i++;
+	}
+	return i;
+}
+
 /**
  * \brief Look for strings in a byte array, but returns only the first result.
  *
@@ -409,7 +642,20 @@ RZ_API int rz_scan_strings_raw(RZ_NONNULL const ut8 *buf, RZ_NONNULL RzList /*<R
 	const ut8 *ptr = NULL;
 	ut64 size = 0;
 	int skip_ibm037 = 0;
+	// a position yielding no rune can only be skipped if empty strings are not wanted
+	bool skip_dead = opt->min_str_length > 0;
 	while (needle < to) {
+		if (skip_dead) {
+			ut64 dead = count_dead_starts(buf + needle - from, to - needle, type, opt->min_str_length);
+			if (dead) {
+				needle += dead;
+				// what matters is only whether it dropped below zero
+				skip_ibm037 = skip_ibm037 > 0 && skip_ibm037 > dead ? skip_ibm037 - (int)dead : 0;
+				if (needle >= to) {
+					break;
+				}
+			}
+		}
 		ptr = buf + needle - from;
 		size = to - needle;
 		--skip_ibm037;
@@ -2,14 +2,34 @@
 // SPDX-FileCopyrightText: 2023 deroad <wargio@libero.it>
 // SPDX-License-Identifier: LGPL-3.0-only
 
+/** \file thread_hash_table.c
+ * Thread safe hash tables. The elements are spread by key among shards,
+ * each being a regular hash table with its own lock, so that threads
+ * accessing different keys rarely wait for each other.
+ */
+
 #include <rz_th.h>
 #include <rz_util.h>
 
+#define TH_HT_SHARD_BITS 6
+#define TH_HT_SHARDS     (1 << TH_HT_SHARD_BITS)
+
+/**
+ * Picks the shard from the high bits of the mixed hash, since the low
+ * ones are used by the shard table to pick the bucket.
+ */
+static inline ut32 th_ht_shard_index(ut64 hash) {
+	return (ut32)((hash * 0x9e3779b97f4a7c15ULL) >> (64 - TH_HT_SHARD_BITS));
+}
+
 #define th_ht_type(name) struct rz_th_##name##_t
 #define th_ht_struct(name, type) \
-	th_ht_type(name) { \
+	typedef struct { \
 		type *table; \
 		RzThreadLock *lock; \
+	} rz_th_##name##_shard_t; \
+	th_ht_type(name) { \
+		rz_th_##name##_shard_t shards[TH_HT_SHARDS]; \
 	};
 
 #define th_ht_free(name, v) rz_th_##name##_free(v)
@@ -18,99 +38,162 @@
 		if (!ht) { \
 			return; \
 		} \
-		name##_free(ht->table); \
-		rz_th_lock_free(ht->lock); \
+		for (ut32 i = 0; i < TH_HT_SHARDS; i++) { \
+			name##_free(ht->shards[i].table); \
+			rz_th_lock_free(ht->shards[i].lock); \
+		} \
 		free(ht); \
 	}
 
-#define th_ht_new0_decl(name) \
-	RZ_API th_ht_type(name) * rz_th_##name##_new0(void) { \
+#define th_ht_new_shards_decl(name, type) \
+	static th_ht_type(name) * rz_th_##name##_new_shards(type##Options *opt) { \
 		th_ht_type(name) *ht = RZ_NEW0(th_ht_type(name)); \
 		if (!ht) { \
 			return NULL; \
 		} \
-		ht->table = name##_new0(); \
-		ht->lock = rz_th_lock_new(true); \
-		if (!ht->table || !ht->lock) { \
-			th_ht_free(name, ht); \
-			return NULL; \
+		for (ut32 i = 0; i < TH_HT_SHARDS; i++) { \
+			ht->shards[i].table = opt ? name##_new_opt(opt) : name##_new0(); \
+			ht->shards[i].lock = rz_th_lock_new(true); \
+			if (!ht->shards[i].table || !ht->shards[i].lock) { \
+				th_ht_free(name, ht); \
+				return NULL; \
+			} \
 		} \
 		return ht; \
 	}
 
+#define th_ht_new0_decl(name) \
+	RZ_API th_ht_type(name) * rz_th_##name##_new0(void) { \
+		return rz_th_##name##_new_shards(NULL); \
+	}
+
 #define th_ht_new_opt_decl(name, type) \
 	RZ_API th_ht_type(name) * rz_th_##name##_new_opt(type##Options *opt) { \
-		th_ht_type(name) *ht = RZ_NEW0(th_ht_type(name)); \
-		if (!ht) { \
-			return NULL; \
-		} \
-		ht->table = name##_new_opt(opt); \
-		ht->lock = rz_th_lock_new(true); \
-		if (!ht->table || !ht->lock) { \
-			th_ht_free(name, ht); \
-			return NULL; \
-		} \
-		return ht; \
+		rz_return_val_if_fail(opt, NULL); \
+		return rz_th_##name##_new_shards(opt); \
 	}
 
 #define th_ht_kv_op_decl(name, op, ktype, vtype) \
 	RZ_API bool rz_th_##name##_##op(th_ht_type(name) * ht, ktype key, vtype value) { \
-		rz_return_val_if_fail(ht && ht->table, false); \
-		rz_th_lock_enter(ht->lock); \
-		bool ret = name##_##op(ht->table, key, value); \
-		rz_th_lock_leave(ht->lock); \
+		rz_return_val_if_fail(ht && ht->shards[0].table, false); \
+		rz_th_##name##_shard_t *shard = rz_th_##name##_shard(ht, key); \
+		rz_th_lock_enter(shard->lock); \
+		bool ret = name##_##op(shard->table, key, value); \
+		rz_th_lock_leave(shard->lock); \
 		return ret; \
 	}
 
 #define th_ht_delete_decl(name, ktype) \
 	RZ_API bool rz_th_##name##_delete(th_ht_type(name) * ht, const ktype key) { \
-		rz_return_val_if_fail(ht && ht->table, false); \
-		rz_th_lock_enter(ht->lock); \
-		bool ret = name##_delete(ht->table, key); \
-		rz_th_lock_leave(ht->lock); \
+		rz_return_val_if_fail(ht && ht->shards[0].table, false); \
+		rz_th_##name##_shard_t *shard = rz_th_##name##_shard(ht, key); \
+		rz_th_lock_enter(shard->lock); \
+		bool ret = name##_delete(shard->table, key); \
+		rz_th_lock_leave(shard->lock); \
 		return ret; \
 	}
 
 #define th_ht_find_decl(name, ktype, vtype) \
 	RZ_API vtype rz_th_##name##_find(th_ht_type(name) * ht, const ktype key, bool *found) { \
-		rz_return_val_if_fail(ht && ht->table, 0); \
-		rz_th_lock_enter(ht->lock); \
-		vtype ret = name##_find(ht->table, key, found); \
-		rz_th_lock_leave(ht->lock); \
+		rz_return_val_if_fail(ht && ht->shards[0].table, 0); \
+		rz_th_##name##_shard_t *shard = rz_th_##name##_shard(ht, key); \
+		rz_th_lock_enter(shard->lock); \
+		vtype ret = name##_find(shard->table, key, found); \
+		rz_th_lock_leave(shard->lock); \
 		return ret; \
 	}
 
-#define th_ht_move_decl(name, type) \
+/*
+ * The elements of all the shards are moved into a new table, which is returned.
+ * The shards keep owning the elements until all of them have been inserted, so
+ * that on failure NULL is returned and the shards are left intact.
+ */
+#define th_ht_move_decl(name, type, ktype, vtype) \
+	typedef struct { \
+		type *src; \
+		type *dst; \
+		bool failed; \
+	} rz_th_##name##_merge_t; \
+	static bool rz_th_##name##_merge_cb(void *user, const ktype key, const vtype value) { \
+		rz_th_##name##_merge_t *merge = user; \
+		type##Kv *kv = name##_find_kv(merge->src, key, NULL); \
+		merge->failed = !kv || !name##_insert_kv(merge->dst, kv, false); \
+		return !merge->failed; \
+	} \
 	RZ_API type *rz_th_##name##_move(th_ht_type(name) * ht) { \
-		rz_return_val_if_fail(ht && ht->table, false); \
-		rz_th_lock_enter(ht->lock); \
-		type *ret = ht->table; \
-		ht->table = NULL; \
-		rz_th_lock_leave(ht->lock); \
-		return ret; \
+		rz_return_val_if_fail(ht && ht->shards[0].table, NULL); \
+		for (ut32 i = 0; i < TH_HT_SHARDS; i++) { \
+			rz_th_lock_enter(ht->shards[i].lock); \
+		} \
+		type##Options opt = ht->shards[0].table->opt; \
+		opt.freefn = NULL; \
+		rz_th_##name##_merge_t merge = { .dst = name##_new_opt(&opt), .failed = false }; \
+		merge.failed = !merge.dst; \
+		for (ut32 i = 0; i < TH_HT_SHARDS && !merge.failed; i++) { \
+			merge.src = ht->shards[i].table; \
+			name##_foreach(merge.src, rz_th_##name##_merge_cb, &merge); \
+		} \
+		if (merge.failed) { \
+			name##_free(merge.dst); \
+			merge.dst = NULL; \
+		} else { \
+			/* the elements are owned by the new table now */ \
+			merge.dst->opt.freefn = ht->shards[0].table->opt.freefn; \
+			for (ut32 i = 0; i < TH_HT_SHARDS; i++) { \
+				ht->shards[i].table->opt.freefn = NULL; \
+				name##_free(ht->shards[i].table); \
+				ht->shards[i].table = NULL; \
+			} \
+		} \
+		for (ut32 i = 0; i < TH_HT_SHARDS; i++) { \
+			rz_th_lock_leave(ht->shards[i].lock); \
+		} \
+		return merge.dst; \
 	}
 
-#define th_ht_foreach_decl(name, type) \
+#define th_ht_foreach_decl(name, type, ktype, vtype) \
+	typedef struct { \
+		type##ForeachCallback cb; \
+		void *user; \
+		bool stop; \
+	} rz_th_##name##_foreach_t; \
+	static bool rz_th_##name##_foreach_cb(void *user, const ktype key, const vtype value) { \
+		rz_th_##name##_foreach_t *ctx = user; \
+		ctx->stop = !ctx->cb(ctx->user, key, value); \
+		return !ctx->stop; \
+	} \
 	RZ_API void rz_th_##name##_foreach(th_ht_type(name) * ht, type##ForeachCallback cb, void *user) { \
-		rz_return_if_fail(ht && ht->table && cb); \
-		rz_th_lock_enter(ht->lock); \
-		name##_foreach(ht->table, cb, user); \
-		rz_th_lock_leave(ht->lock); \
+		rz_return_if_fail(ht && ht->shards[0].table && cb); \
+		rz_th_##name##_foreach_t ctx = { cb, user, false }; \
+		for (ut32 i = 0; i < TH_HT_SHARDS && !ctx.stop; i++) { \
+			rz_th_lock_enter(ht->shards[i].lock); \
+			name##_foreach(ht->shards[i].table, rz_th_##name##_foreach_cb, &ctx); \
+			rz_th_lock_leave(ht->shards[i].lock); \
+		} \
 	}
 
-#define th_ht_define(name, type, ktype, vtype) \
+#define th_ht_define(name, type, ktype, vtype, key_to_hash) \
 	th_ht_struct(name, type); \
+	static inline rz_th_##name##_shard_t *rz_th_##name##_shard(th_ht_type(name) * ht, const ktype key) { \
+		type *first = ht->shards[0].table; \
+		ut64 hash = first->opt.hashfn ? first->opt.hashfn(key) : key_to_hash(key); \
+		return &ht->shards[th_ht_shard_index(hash)]; \
+	} \
 	th_ht_free_decl(name); \
+	th_ht_new_shards_decl(name, type); \
 	th_ht_new0_decl(name); \
 	th_ht_new_opt_decl(name, type); \
 	th_ht_kv_op_decl(name, insert, const ktype, vtype); \
 	th_ht_kv_op_decl(name, update, const ktype, vtype); \
 	th_ht_delete_decl(name, ktype); \
 	th_ht_find_decl(name, ktype, vtype); \
-	th_ht_move_decl(name, type); \
-	th_ht_foreach_decl(name, type)
+	th_ht_move_decl(name, type, ktype, vtype); \
+	th_ht_foreach_decl(name, type, ktype, vtype)
+
+#define th_ht_ptr_hash(key) ((ut64)(size_t)(key))
+#define th_ht_ut64_hash(key) (key)
 
-th_ht_define(ht_pp, HtPP, void *, void *);
-th_ht_define(ht_up, HtUP, ut64, void *);
-th_ht_define(ht_uu, HtUU, ut64, ut64);
-th_ht_define(ht_pu, HtPU, void *, ut64);
+th_ht_define(ht_pp, HtPP, void *, void *, th_ht_ptr_hash);
+th_ht_define(ht_up, HtUP, ut64, void *, th_ht_ut64_hash);
+th_ht_define(ht_uu, HtUU, ut64, ut64, th_ht_ut64_hash);
+th_ht_define(ht_pu, HtPU, void *, ut64, th_ht_ptr_hash);
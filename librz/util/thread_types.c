@@ -27,7 +27,7 @@ RZ_API RZ_OWN RzAtomicBool *rz_atomic_bool_new(bool value) {
 		return NULL;
 	}
 	tbool->lock = rz_th_lock_new(false);
-	tbool->value = true;
+	tbool->value = value;
 	return tbool;
 }
 
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file bench.h
+ * Helpers shared by the benchmarks in test/bench.
+ *
+ * They are run with `meson test -C build --benchmark --suite bench` and
+ * print one line per measurement. A benchmark exits with a non-zero code
+ * when the results of the measured code are wrong, so it never reports
+ * the time of a broken implementation. The optional first argument
+ * multiplies the amount of work.
+ */
+
+#ifndef RZ_BENCH_H
+#define RZ_BENCH_H
+
+#include <rz_util.h>
+
+#define bench_check(cond, msg) \
+	do { \
+		if (!(cond)) { \
+			eprintf("%s:%d: check failed: %s\n", __FILE__, __LINE__, msg); \
+			return false; \
+		} \
+	} while (0)
+
+/**
+ * \brief Returns the work multiplier given as first argument, or 1.
+ */
+static inline ut64 bench_scale(int argc, char **argv) {
+	if (argc < 2) {
+		return 1;
+	}
+	ut64 scale = strtoull(argv[1], NULL, 0);
+	return scale ? scale : 1;
+}
+
+/**
+ * \brief Prints the time spent since \p start (from rz_time_now_mono()) for \p ops operations.
+ */
+static inline void bench_report(const char *name, ut64 start, ut64 ops) {
+	ut64 us = rz_time_now_mono() - start;
+	printf("%-48s %10.3f ms %12.3f us/op\n", name, us / 1000.0, ops ? (double)us / ops : 0.0);
+	fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_core.h>
+#include "bench.h"
+
+/**
+ * Steps of the analysis IL VM in an x86 loop, reusing the effects lifted
+ * at the addresses already executed (with their variables resolved) or,
+ * with the cache disabled, lifting every instruction again.
+ */
+
+// loop: inc rax; add rbx, rax; jmp loop
+static const ut8 loop_code[] = { 0x48, 0xff, 0xc0, 0x48, 0x01, 0xc3, 0xeb, 0xf8 };
+
+static bool step_cond(RzAnalysisILVM *vm, void *user) {
+	ut64 *steps = user;
+	return (*steps)-- > 0;
+}
+
+static bool bench_loop(RzCore *core, ut64 n, bool cached) {
+	RzAnalysis *analysis = core->analysis;
+	rz_reg_setv(analysis->reg, "rip", 0);
+	rz_reg_setv(analysis->reg, "rax", 0);
+	rz_reg_setv(analysis->reg, "rbx", 0);
+	bench_check(rz_analysis_il_vm_setup(analysis), "vm setup");
+	rz_analysis_il_vm_cache_set_max_entries(analysis->il_vm, cached ? RZ_ANALYSIS_IL_VM_CACHE_DEFAULT_SIZE : 0);
+	ut64 steps = n * 3;
+	ut64 start = rz_time_now_mono();
+	RzAnalysisILStepResult res = rz_analysis_il_vm_step_while(analysis, analysis->il_vm, analysis->reg, step_cond, &steps);
+	bench_report(cached ? "x86 loop, reuse the lifted effects" : "x86 loop, cache disabled", start, n * 3);
+	bench_check(res == RZ_ANALYSIS_IL_STEP_RESULT_SUCCESS, "steps");
+	bench_check(rz_reg_getv(analysis->reg, "rax") == n, "rax");
+	bench_check(rz_reg_getv(analysis->reg, "rbx") == n * (n + 1) / 2, "rbx");
+	bench_check(rz_analysis_il_vm_cache_size(analysis->il_vm) == (cached ? 3 : 0), "cached effects");
+	rz_analysis_il_vm_cleanup(analysis);
+	return true;
+}
+
+int main(int argc, char **argv) {
+	ut64 n = 20000 * bench_scale(argc, argv);
+	RzCore *core = rz_core_new();
+	if (!core) {
+		return 1;
+	}
+	rz_io_open_at(core->io, "malloc://0x100", RZ_PERM_RWX, 0644, 0, NULL);
+	rz_core_set_asm_configs(core, "x86", 64, 0);
+	rz_io_write_at(core->io, 0, loop_code, sizeof(loop_code));
+	bool ok = bench_loop(core, n, false) && bench_loop(core, n, true);
+	rz_core_free(core);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "bench.h"
+
+/**
+ * Address lookups in an RzBinObject with many sections, maps and symbols,
+ * through the indexes and through a linear scan of the vectors, which is
+ * what the lookups did before the indexes were added.
+ */
+
+#define N_SYMBOLS  200000
+#define N_SECTIONS 2000
+#define BADDR      0x10000
+
+#include "../unit/bin_object_mock.h"
+
+// pseudo random addresses spread over the whole object
+static ut64 addr_at(ut64 i, ut64 range) {
+	return BADDR + (i * 7919) % range;
+}
+
+static bool bench_lookups(RzBinObject *o, ut64 scale) {
+	const ut64 range = N_SECTIONS * SECTION_GAP;
+	const ut64 n_linear = 20000 * scale;
+	const ut64 n_indexed = 1000000 * scale;
+	for (ut64 i = 0; i < 1000; i++) {
+		ut64 off = addr_at(i, range);
+		bench_check(rz_bin_get_section_at(o, off, true) == linear_section_at(o, off, true), "section at");
+		bench_check(rz_bin_object_get_map_at(o, off, true) == linear_map_at(o, off, true), "map at");
+		off &= ~3ULL;
+		bench_check(rz_bin_object_get_symbol_at(o, off, true) == linear_symbol_at(o, off, true), "symbol at");
+	}
+
+	void *volatile r;
+	ut64 start = rz_time_now_mono();
+	for (ut64 i = 0; i < n_linear; i++) {
+		r = linear_section_at(o, addr_at(i, range), true);
+	}
+	bench_report("section at, linear scan", start, n_linear);
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n_indexed; i++) {
+		r = rz_bin_get_section_at(o, addr_at(i, range), true);
+	}
+	bench_report("section at, index", start, n_indexed);
+
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n_linear; i++) {
+		r = linear_map_at(o, addr_at(i, range), true);
+	}
+	bench_report("map at, linear scan", start, n_linear);
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n_indexed; i++) {
+		r = rz_bin_object_get_map_at(o, addr_at(i, range), true);
+	}
+	bench_report("map at, index", start, n_indexed);
+
+	const ut64 n_linear_sym = 200 * scale;
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n_linear_sym; i++) {
+		r = linear_symbol_at(o, addr_at(i, N_SYMBOLS / 3 * 4) & ~3ULL, true);
+	}
+	bench_report("symbol at, linear scan", start, n_linear_sym);
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n_indexed; i++) {
+		r = rz_bin_object_get_symbol_at(o, addr_at(i, N_SYMBOLS / 3 * 4) & ~3ULL, true);
+	}
+	bench_report("symbol at, index", start, n_indexed);
+	(void)r;
+	return true;
+}
+
+int main(int argc, char **argv) {
+	ut64 scale = bench_scale(argc, argv);
+	RzBin *bin = rz_bin_new();
+	RzBuffer *buf = rz_buf_new_with_bytes((const ut8 *)"\x00", 1);
+	RzBinFile *bf = mock_open(bin, buf);
+	if (!bf || !bf->o) {
+		eprintf("cannot open the mock bin\n");
+		return 1;
+	}
+
+	// the first lookups build the indexes
+	ut64 start = rz_time_now_mono();
+	rz_bin_get_section_at(bf->o, BADDR, true);
+	rz_bin_object_get_map_at(bf->o, BADDR, true);
+	rz_bin_object_get_symbol_at(bf->o, BADDR, true);
+	bench_report("build the indexes", start, 1);
+	bool ok = bench_lookups(bf->o, scale);
+
+	rz_bin_free(bin);
+	rz_buf_free(buf);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_diff.h>
+#include "bench.h"
+
+/**
+ * Edit distances of buffers with 10% of their bytes replaced, computed by
+ * the bit-parallel kernels of rz_diff and, up to 16K, by the O(n*m)
+ * dynamic programming that rz_diff_levenshtein_distance() used before.
+ */
+
+#define MAX_SIZE 0x10000
+#define MAX_DP   0x4000
+
+static ut64 rnd_state = 42;
+
+static ut8 rnd(void) {
+	rnd_state = rnd_state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return rnd_state >> 56;
+}
+
+static ut32 dp_levenshtein(const ut8 *a, ut32 la, const ut8 *b, ut32 lb) {
+	ut32 *row = malloc((lb + 1) * sizeof(ut32));
+	if (!row) {
+		return UT32_MAX;
+	}
+	for (ut32 j = 0; j <= lb; j++) {
+		row[j] = j;
+	}
+	for (ut32 i = 1; i <= la; i++) {
+		ut32 diag = row[0];
+		row[0] = i;
+		for (ut32 j = 1; j <= lb; j++) {
+			ut32 up = row[j];
+			ut32 cost = diag + (a[i - 1] != b[j - 1]);
+			row[j] = RZ_MIN(cost, RZ_MIN(up, row[j - 1]) + 1);
+			diag = up;
+		}
+	}
+	ut32 distance = row[lb];
+	free(row);
+	return distance;
+}
+
+static bool bench_size(ut8 *a, ut8 *b, ut32 n, ut64 scale) {
+	for (ut32 i = 0; i < n; i++) {
+		a[i] = b[i] = rnd();
+	}
+	for (ut32 i = 0; i < n / 10; i++) {
+		b[(rnd() << 8 | rnd()) % n] = rnd();
+	}
+	ut64 reps = RZ_MAX(MAX_SIZE / n / 4, 1) * scale;
+	char label[96];
+	ut32 dp = UT32_MAX, distance = 0, myers = 0, within = 0;
+
+	if (n <= MAX_DP) {
+		ut64 start = rz_time_now_mono();
+		for (ut64 r = 0; r < reps; r++) {
+			dp = dp_levenshtein(a, n, b, n);
+		}
+		snprintf(label, sizeof(label), "%5u bytes: levenshtein, dynamic programming", n);
+		bench_report(label, start, reps);
+	}
+
+	ut64 start = rz_time_now_mono();
+	for (ut64 r = 0; r < reps; r++) {
+		rz_diff_levenshtein_distance(a, n, b, n, &distance, NULL);
+	}
+	snprintf(label, sizeof(label), "%5u bytes: levenshtein", n);
+	bench_report(label, start, reps);
+	bench_check(dp == UT32_MAX || dp == distance, "levenshtein distance");
+
+	start = rz_time_now_mono();
+	for (ut64 r = 0; r < reps; r++) {
+		rz_diff_myers_distance(a, n, b, n, &myers, NULL);
+	}
+	snprintf(label, sizeof(label), "%5u bytes: myers", n);
+	bench_report(label, start, reps);
+	bench_check(myers >= distance && myers <= 2 * distance, "myers distance");
+
+	// the bound used by the function matcher is usually well below the distance
+	bool found = false;
+	start = rz_time_now_mono();
+	for (ut64 r = 0; r < reps; r++) {
+		found = rz_diff_levenshtein_distance_within(a, n, b, n, n / 20, &within);
+	}
+	snprintf(label, sizeof(label), "%5u bytes: levenshtein within n/20", n);
+	bench_report(label, start, reps);
+	bench_check(found == (distance <= n / 20) && (!found || within == distance), "bounded distance");
+
+	start = rz_time_now_mono();
+	for (ut64 r = 0; r < reps; r++) {
+		found = rz_diff_levenshtein_distance_within(a, n, b, n, distance, &within);
+	}
+	snprintf(label, sizeof(label), "%5u bytes: levenshtein within the distance", n);
+	bench_report(label, start, reps);
+	bench_check(found && within == distance, "bounded distance");
+	return true;
+}
+
+int main(int argc, char **argv) {
+	ut64 scale = bench_scale(argc, argv);
+	ut8 *a = malloc(MAX_SIZE);
+	ut8 *b = malloc(MAX_SIZE);
+	bool ok = a && b;
+	for (ut32 n = 0x400; ok && n <= MAX_SIZE; n *= 4) {
+		ok = bench_size(a, b, n, scale);
+	}
+	free(a);
+	free(b);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_util.h>
+#include "bench.h"
+
+/**
+ * Inserts, lookups and deletions of ut64 keys in HtUU and HtUP. Which
+ * backend is measured depends on the ht_open_addressing build option,
+ * so compare two builds to compare the backends.
+ */
+
+// consecutive keys, or keys spread over the key space
+static ut64 key_at(ut64 i, bool spread) {
+	return spread ? i * 0x9e37 + (i << 20) : i;
+}
+
+static bool bench_uu(ut64 n, bool spread) {
+	const char *name = spread ? "HtUU, spread keys" : "HtUU, consecutive keys";
+	char label[96];
+	HtUU *ht = ht_uu_new0();
+	bench_check(ht, "new table");
+
+	ut64 start = rz_time_now_mono();
+	for (ut64 i = 0; i < n; i++) {
+		ht_uu_insert(ht, key_at(i, spread), i);
+	}
+	snprintf(label, sizeof(label), "%s: insert", name);
+	bench_report(label, start, n);
+
+	ut64 sum = 0;
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n; i++) {
+		sum += ht_uu_find(ht, key_at(i, spread), NULL);
+	}
+	snprintf(label, sizeof(label), "%s: find", name);
+	bench_report(label, start, n);
+	bench_check(sum == n * (n - 1) / 2, "values found");
+
+	bool found = true;
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n; i++) {
+		ht_uu_find(ht, key_at(i + n, spread), &found);
+		if (found) {
+			break;
+		}
+	}
+	snprintf(label, sizeof(label), "%s: find missing", name);
+	bench_report(label, start, n);
+	bench_check(!found, "missing keys");
+
+	bool deleted = true;
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n; i++) {
+		deleted &= ht_uu_delete(ht, key_at(i, spread));
+	}
+	snprintf(label, sizeof(label), "%s: delete", name);
+	bench_report(label, start, n);
+	bench_check(deleted && !ht->count, "deleted keys");
+	ht_uu_free(ht);
+	return true;
+}
+
+static bool bench_up(ut64 n, bool spread) {
+	const char *name = spread ? "HtUP, spread keys" : "HtUP, consecutive keys";
+	char label[96];
+	HtUP *ht = ht_up_new0();
+	bench_check(ht, "new table");
+
+	ut64 start = rz_time_now_mono();
+	for (ut64 i = 0; i < n; i++) {
+		ht_up_insert(ht, key_at(i, spread), (void *)(size_t)(i + 1));
+	}
+	snprintf(label, sizeof(label), "%s: insert", name);
+	bench_report(label, start, n);
+
+	bool ok = true;
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n; i++) {
+		ok &= ht_up_find(ht, key_at(i, spread), NULL) == (void *)(size_t)(i + 1);
+	}
+	snprintf(label, sizeof(label), "%s: find", name);
+	bench_report(label, start, n);
+	bench_check(ok, "values found");
+
+	start = rz_time_now_mono();
+	for (ut64 i = 0; i < n; i++) {
+		ok &= ht_up_delete(ht, key_at(i, spread));
+	}
+	snprintf(label, sizeof(label), "%s: delete", name);
+	bench_report(label, start, n);
+	bench_check(ok && !ht->count, "deleted keys");
+	ht_up_free(ht);
+	return true;
+}
+
+int main(int argc, char **argv) {
+	ut64 n = 1000000 * bench_scale(argc, argv);
+	printf("HtUP and HtUU backend: %s\n", WITH_HT_OPEN_ADDRESSING ? "open addressing" : "chained");
+	for (int spread = 0; spread < 2; spread++) {
+		if (!bench_uu(n, spread) || !bench_up(n, spread)) {
+			return 1;
+		}
+	}
+	return 0;
+}
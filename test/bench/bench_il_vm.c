@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_il.h>
+#include "bench.h"
+
+#include <rz_il/rz_il_opbuilder_begin.h>
+
+/**
+ * Steps of the RzIL VM over effects shaped like the output of the x86
+ * and arm lifters, and evaluations of a pure expression. Only the VM is
+ * measured, the lifters are not involved.
+ */
+
+#define EAX 0x12345678
+#define EBX 0x1111
+#define R1  0x80000001
+#define R2  0x7fffffff
+#define SP  0x100
+
+// add eax, ebx with all the arithmetic flags
+static RzILOpEffect *x86_add(void) {
+	RzILOpPure *parity = LOGXOR(CAST(1, IL_FALSE, VARL("res")), CAST(1, IL_FALSE, SHIFTR0(VARL("res"), U8(1))));
+	for (int i = 2; i < 8; i++) {
+		parity = LOGXOR(parity, CAST(1, IL_FALSE, SHIFTR0(VARL("res"), U8(i))));
+	}
+	return SEQN(9,
+		SETL("a", VARG("eax")),
+		SETL("b", VARG("ebx")),
+		SETL("res", ADD(VARL("a"), VARL("b"))),
+		SETG("eax", VARL("res")),
+		SETG("cf", ULT(VARL("res"), VARL("a"))),
+		SETG("of", AND(INV(XOR(MSB(VARL("a")), MSB(VARL("b")))), XOR(MSB(VARL("a")), MSB(VARL("res"))))),
+		SETG("sf", MSB(VARL("res"))),
+		SETG("zf", IS_ZERO(VARL("res"))),
+		SETG("pf", INV(NON_ZERO(parity))));
+}
+
+// adds r0, r1, r2 ; str r0, [sp, #4]
+static RzILOpEffect *arm_adds_str(void) {
+	return SEQN(7,
+		SETL("x", ADD(UNSIGNED(33, VARG("r1")), UNSIGNED(33, VARG("r2")))),
+		SETG("r0", UNSIGNED(32, VARL("x"))),
+		SETG("cf", MSB(VARL("x"))),
+		SETG("vf", AND(INV(XOR(MSB(VARG("r1")), MSB(VARG("r2")))), XOR(MSB(VARG("r1")), MSB(VARG("r0"))))),
+		SETG("nf", MSB(VARG("r0"))),
+		SETG("zf", IS_ZERO(VARG("r0"))),
+		STOREW(ADD(VARG("sp"), U32(4)), VARG("r0")));
+}
+
+// parity and compare of an arithmetic result, 40 nodes, evaluating to 2
+// since the low byte of the result (0xac) has an even parity
+static RzILOpPure *pure_expression(void) {
+	RzILOpPure *res = ADD(U32(0x12345678), MUL(U32(3), U32(0x9abc)));
+	RzILOpPure *parity = LOGXOR(CAST(1, IL_FALSE, DUP(res)), CAST(1, IL_FALSE, SHIFTR0(DUP(res), U8(1))));
+	for (int i = 2; i < 8; i++) {
+		parity = LOGXOR(parity, CAST(1, IL_FALSE, SHIFTR0(DUP(res), U8(i))));
+	}
+	RzILOpPure *ret = ITE(AND(INV(IS_ZERO(parity)), ULT(DUP(res), U32(0x20000000))), U8(1), U8(2));
+	rz_il_op_pure_free(res);
+	return ret;
+}
+
+static RzILVM *vm_new(void) {
+	RzILVM *vm = rz_il_vm_new(0, 32, false);
+	if (!vm) {
+		return NULL;
+	}
+	const char *bvs[] = { "eax", "ebx", "r0", "r1", "r2", "sp" };
+	const ut32 vals[] = { EAX, EBX, 0, R1, R2, SP };
+	const char *bools[] = { "cf", "of", "sf", "zf", "pf", "vf", "nf" };
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(bvs); i++) {
+		rz_il_vm_create_global_var(vm, bvs[i], rz_il_sort_pure_bv(32));
+		rz_il_vm_set_global_var(vm, bvs[i], rz_il_value_new_bitv(rz_bv_new_from_ut64(32, vals[i])));
+	}
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(bools); i++) {
+		rz_il_vm_create_global_var(vm, bools[i], rz_il_sort_pure_bool());
+		rz_il_vm_set_global_var(vm, bools[i], rz_il_value_new_bool(rz_il_bool_new(false)));
+	}
+	rz_il_vm_add_mem(vm, 0, rz_il_mem_new(rz_buf_new_empty(0x1000), 32));
+	return vm;
+}
+
+static ut64 global_bv(RzILVM *vm, const char *name) {
+	RzILVal *val = rz_il_vm_get_var_value(vm, RZ_IL_VAR_KIND_GLOBAL, name);
+	return val && val->type == RZ_IL_TYPE_PURE_BITVECTOR ? rz_bv_to_ut64(val->data.bv) : UT64_MAX;
+}
+
+static bool bench_step(RzILVM *vm, const char *name, RzILOpEffect *op, ut64 n) {
+	bench_check(op, "effect");
+	bool ok = true;
+	ut64 start = rz_time_now_mono();
+	for (ut64 i = 0; i < n; i++) {
+		ok &= rz_il_vm_step(vm, op, 0x1000 + i);
+	}
+	bench_report(name, start, n);
+	rz_il_op_effect_free(op);
+	bench_check(ok, "step");
+	return true;
+}
+
+int main(int argc, char **argv) {
+	ut64 n = 200000 * bench_scale(argc, argv);
+	RzILVM *vm = vm_new();
+	if (!vm) {
+		return 1;
+	}
+	bool ok = bench_step(vm, "step x86 add eax, ebx", x86_add(), n) &&
+		bench_step(vm, "step arm adds r0, r1, r2; str r0, [sp, #4]", arm_adds_str(), n);
+	ok &= global_bv(vm, "eax") == ((EAX + n * EBX) & UT32_MAX);
+	ok &= global_bv(vm, "r0") == (((ut64)R1 + R2) & UT32_MAX);
+
+	RzILOpPure *e = pure_expression();
+	RzILTypePure type;
+	ut64 start = rz_time_now_mono();
+	for (ut64 i = 0; ok && i < n; i++) {
+		RzBitVector *r = rz_il_evaluate_pure(vm, e, &type);
+		ok = r && type == RZ_IL_TYPE_PURE_BITVECTOR && rz_bv_to_ut8(r) == 2;
+		rz_bv_free(r);
+	}
+	bench_report("evaluate a pure expression of 40 nodes", start, n);
+	rz_il_op_pure_free(e);
+	rz_il_vm_free(vm);
+	if (!ok) {
+		eprintf("wrong results\n");
+	}
+	return ok ? 0 : 1;
+}
+
+#include <rz_il/rz_il_opbuilder_end.h>
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_th.h>
+#include "bench.h"
+
+/**
+ * Concurrent inserts and lookups in RzThreadHtUP, compared with a single
+ * HtUP behind one recursive lock, which is how the thread safe tables
+ * were built before they were sharded. The keys are either consecutive
+ * or spread over the whole key space.
+ */
+
+#define MAX_THREADS 16
+
+typedef struct {
+	RzThreadHtUP *sharded;
+	HtUP *locked;
+	RzThreadLock *lock;
+	ut64 from;
+	ut64 count;
+	ut64 mul; ///< Multiplier applied to the keys
+} Worker;
+
+static void *sharded_worker(void *user) {
+	Worker *w = user;
+	for (ut64 k = w->from; k < w->from + w->count; k++) {
+		rz_th_ht_up_insert(w->sharded, k * w->mul, (void *)(size_t)(k + 1));
+	}
+	for (ut64 k = w->from; k < w->from + w->count; k++) {
+		if (rz_th_ht_up_find(w->sharded, k * w->mul, NULL) != (void *)(size_t)(k + 1)) {
+			return NULL;
+		}
+	}
+	return w;
+}
+
+static void *locked_worker(void *user) {
+	Worker *w = user;
+	for (ut64 k = w->from; k < w->from + w->count; k++) {
+		rz_th_lock_enter(w->lock);
+		ht_up_insert(w->locked, k * w->mul, (void *)(size_t)(k + 1));
+		rz_th_lock_leave(w->lock);
+	}
+	for (ut64 k = w->from; k < w->from + w->count; k++) {
+		rz_th_lock_enter(w->lock);
+		void *v = ht_up_find(w->locked, k * w->mul, NULL);
+		rz_th_lock_leave(w->lock);
+		if (v != (void *)(size_t)(k + 1)) {
+			return NULL;
+		}
+	}
+	return w;
+}
+
+static bool count_cb(void *user, const ut64 k, const void *v) {
+	(*(ut64 *)user)++;
+	return true;
+}
+
+static bool run(size_t n_threads, ut64 total, ut64 mul, bool sharded) {
+	Worker workers[MAX_THREADS] = { 0 };
+	RzThread *threads[MAX_THREADS] = { 0 };
+	RzThreadHtUP *sht = sharded ? rz_th_ht_up_new0() : NULL;
+	HtUP *ht = sharded ? NULL : ht_up_new0();
+	RzThreadLock *lock = sharded ? NULL : rz_th_lock_new(true);
+	bench_check(sharded ? !!sht : ht && lock, "new table");
+
+	ut64 start = rz_time_now_mono();
+	for (size_t i = 0; i < n_threads; i++) {
+		workers[i].sharded = sht;
+		workers[i].locked = ht;
+		workers[i].lock = lock;
+		workers[i].count = total / n_threads;
+		workers[i].from = i * workers[i].count;
+		workers[i].mul = mul;
+		threads[i] = rz_th_new(sharded ? sharded_worker : locked_worker, &workers[i]);
+		bench_check(threads[i], "new thread");
+	}
+	bool ok = true;
+	for (size_t i = 0; i < n_threads; i++) {
+		rz_th_wait(threads[i]);
+		ok &= rz_th_get_retv(threads[i]) == &workers[i];
+		rz_th_free(threads[i]);
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "%s, %s keys, %zu threads", sharded ? "RzThreadHtUP" : "HtUP + one lock",
+		mul == 1 ? "consecutive" : "spread", n_threads);
+	bench_report(name, start, total);
+	bench_check(ok, "values found");
+
+	ut64 count = 0;
+	if (sharded) {
+		rz_th_ht_up_foreach(sht, count_cb, &count);
+	} else {
+		ht_up_foreach(ht, count_cb, &count);
+	}
+	bench_check(count == total / n_threads * n_threads, "number of keys");
+	rz_th_ht_up_free(sht);
+	ht_up_free(ht);
+	rz_th_lock_free(lock);
+	return true;
+}
+
+int main(int argc, char **argv) {
+	ut64 total = 1000000 * bench_scale(argc, argv);
+	size_t max_threads = RZ_MIN(rz_th_physical_core_number(), MAX_THREADS);
+	const ut64 muls[] = { 1, 0x9e3779b1 };
+	for (size_t m = 0; m < RZ_ARRAY_SIZE(muls); m++) {
+		for (size_t n = 1; n <= max_threads; n *= 2) {
+			if (!run(n, total, muls[m], false) || !run(n, total, muls[m], true)) {
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
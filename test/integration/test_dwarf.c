@@ -1477,6 +1477,39 @@ bool test_dwarf4_loclists(void) {
 	mu_end;
 }
 
+bool test_dwarf4_loclists_lazy(void) {
+	RzBin *bin = rz_bin_new();
+	RzIO *io = rz_io_new();
+	rz_io_bind(io, &bin->iob);
+
+	RzBinOptions opt = { 0 };
+	rz_bin_options_init(&opt, 0, 0, 0, false);
+	RzBinFile *bf = rz_bin_open(bin, "bins/pe/vista-glass.exe", &opt);
+	mu_assert_notnull(bf, "couldn't open file");
+
+	RzBinDWARF *dw = rz_bin_dwarf_from_file(bf);
+	mu_assert_notnull(dw->loclists, ".debug_loc");
+	char *expect = rz_core_bin_dwarf_loc_to_string(dw->loclists, dw);
+	mu_assert_notnull(expect, "loclists dump");
+	rz_bin_dwarf_free(dw);
+
+	RzBinDwarfInfoOptions dw_opt = { .max_decoded_units = 1, .max_threads = 1 };
+	dw = rz_bin_dwarf_from_file_opt(bf, &dw_opt);
+	mu_assert_notnull(dw->loclists, ".debug_loc");
+	mu_assert_false(dw->info->locations_loaded, "units not decoded yet");
+	char *actual = rz_core_bin_dwarf_loc_to_string(dw->loclists, dw);
+	mu_assert_true(dw->info->locations_loaded, "all units decoded once");
+	mu_assert_true(rz_pvector_len(&dw->info->decoded_units) <= 1, "trimmed while loading");
+	mu_assert_streq(actual, expect, "lazy loclists dump has the expressions");
+	free(actual);
+	free(expect);
+
+	rz_bin_dwarf_free(dw);
+	rz_bin_free(bin);
+	rz_io_free(io);
+	mu_end;
+}
+
 bool all_tests() {
 	srand(time(0));
 	mu_run_test(test_dwarf3_c_basic);
@@ -1490,6 +1523,7 @@ bool all_tests() {
 	mu_run_test(test_dwarf3_aranges);
 	mu_run_test(test_dwarf5_loclists);
 	mu_run_test(test_dwarf4_loclists);
+	mu_run_test(test_dwarf4_loclists_lazy);
 	return tests_passed != tests_run;
 }
 
@@ -446,10 +446,153 @@ bool test_dwarf2_big_endian(void) {
 	mu_end;
 }
 
+bool test_dwarf4_lazy(void) {
+	RzBin *bin = rz_bin_new();
+	RzIO *io = rz_io_new();
+	rz_io_bind(io, &bin->iob);
+
+	RzBinOptions opt = { 0 };
+	rz_bin_options_init(&opt, 0, 0, 0, false);
+	RzBinFile *bf = rz_bin_open(bin, "bins/elf/dwarf4_many_comp_units.elf", &opt);
+	mu_assert_notnull(bf, "couldn't open file");
+
+	RzBinDwarfInfoOptions dw_opt = { .max_decoded_units = 1, .max_threads = 1 };
+	RzBinDWARF *dw = rz_bin_dwarf_from_file_opt(bf, &dw_opt);
+	mu_assert_notnull(dw->info, "Failed parsing of debug_info");
+	mu_assert_eq(rz_vector_len(&dw->info->units), 2, "Incorrect number of info compilation units");
+	RzBinDwarfCompUnit *cu0 = rz_vector_index_ptr(&dw->info->units, 0);
+	RzBinDwarfCompUnit *cu1 = rz_vector_index_ptr(&dw->info->units, 1);
+	mu_assert_false(cu0->dies_decoded, "DIEs are not decoded upfront");
+	mu_assert_eq(rz_vector_len(&cu0->dies), 0, "DIEs are not decoded upfront");
+	mu_assert_streq(cu1->producer, "clang version 10.0.0-4ubuntu1 ", "unit attributes are read upfront");
+
+	RzBinDwarfDie *die = rz_bin_dwarf_info_die_at(dw->info, 0x2cf);
+	mu_assert_notnull(die, "DIE decoded on demand");
+	check_die_tag(DW_TAG_compile_unit);
+	mu_assert_eq(rz_vector_len(&cu1->dies), 42, "Wrong attribute information");
+	mu_assert_false(cu0->dies_decoded, "other unit is not decoded");
+	mu_assert_null(rz_bin_dwarf_info_die_at(dw->info, 0x2d0), "not a DIE");
+	mu_assert_ptreq(rz_bin_dwarf_info_unit_at(dw->info, 0x10), cu0, "unit at offset");
+	mu_assert_eq(rz_vector_len(&cu0->dies), 73, "Wrong attribute information");
+
+	rz_bin_dwarf_info_trim(dw->info);
+	mu_assert_true(cu0->dies_decoded, "most recently used unit kept");
+	mu_assert_false(cu1->dies_decoded, "least recently used unit dropped");
+	mu_assert_eq(rz_vector_len(&cu1->dies), 0, "least recently used unit dropped");
+	mu_assert_eq(dw->info->die_count, 73, "DIE count");
+	die = rz_bin_dwarf_info_die_at(dw->info, 0x2cf);
+	mu_assert_notnull(die, "DIE decoded again");
+	check_die_abbr_code(1);
+
+	rz_bin_dwarf_free(dw);
+	rz_bin_free(bin);
+	rz_io_free(io);
+	mu_end;
+}
+
+static RzBinDWARF *dwarf4_many_comp_units(RzBinFile *bf, size_t max_threads) {
+	RzBinDwarfInfoOptions dw_opt = { .max_decoded_units = 0, .max_threads = max_threads };
+	return rz_bin_dwarf_from_file_opt(bf, &dw_opt);
+}
+
+bool test_dwarf4_parallel(void) {
+	RzBin *bin = rz_bin_new();
+	RzIO *io = rz_io_new();
+	rz_io_bind(io, &bin->iob);
+
+	RzBinOptions opt = { 0 };
+	rz_bin_options_init(&opt, 0, 0, 0, false);
+	RzBinFile *bf = rz_bin_open(bin, "bins/elf/dwarf4_many_comp_units.elf", &opt);
+	mu_assert_notnull(bf, "couldn't open file");
+
+	RzBinDWARF *seq = dwarf4_many_comp_units(bf, 1);
+	RzBinDWARF *par = dwarf4_many_comp_units(bf, 4);
+	mu_assert_notnull(seq, "Failed sequential parsing");
+	mu_assert_notnull(seq->info, "Failed sequential parsing of debug_info");
+	mu_assert_notnull(par, "Failed parallel parsing");
+	mu_assert_notnull(par->info, "Failed parallel parsing of debug_info");
+	mu_assert_eq(rz_vector_len(&par->info->units), rz_vector_len(&seq->info->units), "units count");
+	mu_assert_eq(par->info->die_count, seq->info->die_count, "DIE count");
+	RzBinDwarfCompUnit *seq_cu, *par_cu;
+	size_t i;
+	rz_vector_enumerate(&seq->info->units, seq_cu, i) {
+		par_cu = rz_vector_index_ptr(&par->info->units, i);
+		mu_assert_eq(par_cu->offset, seq_cu->offset, "unit offset");
+		mu_assert_streq(par_cu->name, seq_cu->name, "unit name");
+		mu_assert_eq(rz_vector_len(&par_cu->dies), rz_vector_len(&seq_cu->dies), "unit DIE count");
+		RzBinDwarfDie *seq_die, *par_die;
+		size_t j;
+		rz_vector_enumerate(&seq_cu->dies, seq_die, j) {
+			par_die = rz_vector_index_ptr(&par_cu->dies, j);
+			mu_assert_eq(par_die->offset, seq_die->offset, "DIE offset");
+			mu_assert_eq(par_die->tag, seq_die->tag, "DIE tag");
+			mu_assert_eq(par_die->depth, seq_die->depth, "DIE depth");
+			mu_assert_eq(par_die->sibling, seq_die->sibling, "DIE sibling");
+			mu_assert_eq(rz_vector_len(&par_die->attrs), rz_vector_len(&seq_die->attrs), "DIE attributes count");
+			mu_assert_ptreq(rz_bin_dwarf_info_die_at(par->info, par_die->offset), par_die, "DIE by offset");
+		}
+	}
+
+	rz_bin_dwarf_free(seq);
+	rz_bin_dwarf_free(par);
+	rz_bin_free(bin);
+	rz_io_free(io);
+	mu_end;
+}
+
+static RzBinEndianReader *reader_from_bytes(const ut8 *bytes, ut64 size) {
+	RzBinEndianReader *reader = RZ_NEW0(RzBinEndianReader);
+	if (!reader) {
+		return NULL;
+	}
+	reader->buffer = rz_buf_new_with_bytes(bytes, size);
+	return reader;
+}
+
+bool test_dwarf_padded_unit(void) {
+	static const ut8 abbrev[] = {
+		0x01, DW_TAG_compile_unit, DW_CHILDREN_no, DW_AT_name, DW_FORM_string, 0x00, 0x00, 0x00
+	};
+	static const ut8 debug_info[] = {
+		// unit at 0x0, whose root DIE is followed by 4 bytes of padding
+		0x0e, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+		0x01, 'a', 0x00,
+		0x00, 0x00, 0x00, 0x00,
+		// unit at 0x12
+		0x0a, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+		0x01, 'b', 0x00
+	};
+	for (size_t max_threads = 0; max_threads < 2; max_threads++) {
+		RzBinDWARF *dw = RZ_NEW0(RzBinDWARF);
+		mu_assert_notnull(dw, "alloc");
+		dw->abbrev = rz_bin_dwarf_abbrev_new(reader_from_bytes(abbrev, sizeof(abbrev)));
+		mu_assert_notnull(dw->abbrev, "Failed parsing of debug_abbrev");
+		RzBinDwarfInfoOptions dw_opt = { .max_decoded_units = 0, .max_threads = max_threads };
+		dw->info = rz_bin_dwarf_info_from_buf_opt(reader_from_bytes(debug_info, sizeof(debug_info)), dw, &dw_opt);
+		mu_assert_notnull(dw->info, "Failed parsing of debug_info");
+		mu_assert_eq(rz_vector_len(&dw->info->units), 2, "the padding is skipped");
+		RzBinDwarfCompUnit *cu = rz_vector_index_ptr(&dw->info->units, 0);
+		mu_assert_eq(cu->offset, 0x0, "unit offset");
+		mu_assert_streq(cu->name, "a", "unit name");
+		cu = rz_vector_index_ptr(&dw->info->units, 1);
+		mu_assert_eq(cu->offset, 0x12, "unit after the padding");
+		mu_assert_streq(cu->name, "b", "unit name");
+		RzBinDwarfDie *die = rz_vector_head(&cu->dies);
+		mu_assert_notnull(die, "root DIE");
+		mu_assert_eq(die->offset, 0x1d, "root DIE offset");
+		check_die_tag(DW_TAG_compile_unit);
+		rz_bin_dwarf_free(dw);
+	}
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_dwarf3_c);
 	mu_run_test(test_dwarf4_cpp_multiple_modules);
 	mu_run_test(test_dwarf2_big_endian);
+	mu_run_test(test_dwarf4_lazy);
+	mu_run_test(test_dwarf4_parallel);
+	mu_run_test(test_dwarf_padded_unit);
 	return tests_passed != tests_run;
 }
 
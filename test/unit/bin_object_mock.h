@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file bin_object_mock.h
+ * Plugin loading a synthetic RzBinObject with N_SECTIONS sections and maps
+ * and N_SYMBOLS symbols, which the includer defines, and linear scans of
+ * its vectors returning what the address lookups are expected to return.
+ * Shared by test_bin_object.c and bench_bin_object.c.
+ */
+
+#ifndef RZ_BIN_OBJECT_MOCK_H
+#define RZ_BIN_OBJECT_MOCK_H
+
+#include <rz_bin.h>
+
+#define SECTION_GAP 0x100
+
+static bool check_buffer(RzBuffer *b) {
+	return true;
+}
+
+static bool load_buffer(RzBinFile *bf, RzBinObject *obj, RzBuffer *buf, Sdb *sdb) {
+	return true;
+}
+
+static RzBinInfo *info(RzBinFile *bf) {
+	RzBinInfo *ret = RZ_NEW0(RzBinInfo);
+	if (!ret) {
+		return NULL;
+	}
+	ret->file = strdup(bf->file);
+	ret->has_va = 1;
+	return ret;
+}
+
+static ut64 baddr(RzBinFile *bf) {
+	return 0x10000;
+}
+
+static RzPVector *sections(RzBinFile *bf) {
+	RzPVector *ret = rz_pvector_new((RzPVectorFree)rz_bin_section_free);
+	// a segment covering everything, never returned by rz_bin_get_section_at()
+	RzBinSection *s = rz_bin_section_new("segment");
+	s->is_segment = true;
+	s->paddr = 0;
+	s->size = N_SECTIONS * SECTION_GAP;
+	s->vaddr = 0x10000;
+	s->vsize = N_SECTIONS * SECTION_GAP;
+	rz_pvector_push(ret, s);
+	for (ut64 i = 0; i < N_SECTIONS; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "sec%" PFMT64u, i);
+		s = rz_bin_section_new(name);
+		s->paddr = i * SECTION_GAP;
+		// every fourth section overlaps with the next one and every tenth is empty
+		s->size = i % 10 ? (i % 4 ? SECTION_GAP / 2 : SECTION_GAP * 2) : 0;
+		s->vaddr = 0x10000 + i * SECTION_GAP;
+		s->vsize = s->size + 8;
+		rz_pvector_push(ret, s);
+	}
+	return ret;
+}
+
+static RzPVector *maps(RzBinFile *bf) {
+	RzPVector *ret = rz_pvector_new((RzPVectorFree)rz_bin_map_free);
+	for (ut64 i = 0; i < N_SECTIONS; i++) {
+		RzBinMap *map = RZ_NEW0(RzBinMap);
+		map->name = rz_str_newf("map%" PFMT64u, i);
+		map->paddr = (i % 7) * SECTION_GAP;
+		map->psize = SECTION_GAP * (1 + i % 3);
+		map->vaddr = 0x10000 + i * SECTION_GAP / 2;
+		map->vsize = SECTION_GAP;
+		rz_pvector_push(ret, map);
+	}
+	return ret;
+}
+
+static RzPVector *symbols(RzBinFile *bf) {
+	RzPVector *ret = rz_pvector_new((RzPVectorFree)rz_bin_symbol_free);
+	for (ut64 i = 0; i < N_SYMBOLS; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "sym%" PFMT64u, i);
+		// every address holds three symbols
+		rz_pvector_push(ret, rz_bin_symbol_new(name, i / 3 * 4, 0x10000 + i / 3 * 4));
+	}
+	return ret;
+}
+
+static RzBinPlugin mock_plugin = {
+	.name = "mock",
+	.desc = "Testing Plugin",
+	.license = "LGPL3",
+	.load_buffer = load_buffer,
+	.check_buffer = check_buffer,
+	.info = info,
+	.baddr = baddr,
+	.maps = maps,
+	.sections = sections,
+	.symbols = symbols,
+};
+
+/**
+ * \brief Opens a buffer with the mock plugin in \p bin
+ */
+static RzBinFile *mock_open(RzBin *bin, RzBuffer *buf) {
+	rz_bin_plugin_add(bin, &mock_plugin);
+	RzBinOptions opt;
+	rz_bin_options_init(&opt, 0, UT64_MAX, 0, false);
+	opt.pluginname = "mock";
+	opt.filename = "<internal>";
+	return rz_bin_open_buf(bin, buf, &opt);
+}
+
+static RzBinSection *linear_section_at(RzBinObject *o, ut64 off, bool va) {
+	void **it;
+	rz_pvector_foreach (o->sections, it) {
+		RzBinSection *s = *it;
+		if (s->is_segment) {
+			continue;
+		}
+		ut64 from = va ? rz_bin_object_addr_with_base(o, s->vaddr) : s->paddr;
+		ut64 to = from + (va ? s->vsize : s->size);
+		if (off >= from && off < to) {
+			return s;
+		}
+	}
+	return NULL;
+}
+
+static RzBinMap *linear_map_at(RzBinObject *o, ut64 off, bool va) {
+	void **it;
+	rz_pvector_foreach_prev(o->maps, it) {
+		RzBinMap *m = *it;
+		ut64 from = va ? rz_bin_object_addr_with_base(o, m->vaddr) : m->paddr;
+		ut64 to = from + (va ? m->vsize : m->psize);
+		if (off >= from && off < to) {
+			return m;
+		}
+	}
+	return NULL;
+}
+
+static RzBinSymbol *linear_symbol_at(RzBinObject *o, ut64 off, bool va) {
+	void **it;
+	rz_pvector_foreach (o->symbols, it) {
+		RzBinSymbol *s = *it;
+		if (off == (va ? s->vaddr : s->paddr)) {
+			return s;
+		}
+	}
+	return NULL;
+}
+
+#endif
@@ -97,6 +97,186 @@ bool test_rz_analysis_op_val() {
 	mu_end;
 }
 
+bool test_rz_analysis_op_cache() {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzAnalysisOp op;
+	SWITCH_TO_ARCH_BITS("x86", 64);
+	rz_analysis_op_cache_set_max_entries(analysis, 2);
+	RzAnalysisOpCache *cache = analysis->op_cache;
+	// mov rax, [rbx+rcx+4]
+	const ut8 *mov = (const ut8 *)"\x48\x8b\x44\x0b\x04";
+	int len = rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_VAL | RZ_ANALYSIS_OP_MASK_ESIL);
+	mu_assert_eq(len, 5, "Op is of size 5");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(cache->misses, 1, "first decode is a miss");
+	mu_assert_eq(rz_analysis_op_cache_size(analysis), 1, "op stored");
+
+	len = rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_VAL);
+	mu_assert_eq(len, 5, "Cached op is of size 5");
+	mu_assert_eq(cache->hits, 1, "second decode is a hit");
+	mu_assert_eq(op.addr, 0x1000, "cached op address");
+	mu_assert_streq(op.dst->reg->name, "rax", "Dst reg should be rax");
+	mu_assert_streq(op.src[0]->regdelta->name, "rcx", "Source reg delta should be rcx");
+	mu_assert_streq(rz_strbuf_get(&op.esil), "", "esil not requested");
+	rz_analysis_op_fini(&op);
+
+	// mov rax, 4
+	len = rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x48\xc7\xc0\x04\x00\x00\x00", 7, RZ_ANALYSIS_OP_MASK_VAL);
+	mu_assert_eq(len, 7, "different bytes are decoded again");
+	mu_assert_eq(op.src[0]->imm, 4, "Source imm should be 4");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(cache->misses, 2, "different bytes are a miss");
+
+	len = rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x48\xc7\xc0\x04\x00\x00\x00", 7, RZ_ANALYSIS_OP_MASK_DISASM);
+	mu_assert_eq(cache->misses, 3, "mask not stored is a miss");
+	mu_assert_streq(op.mnemonic, "mov rax, 4", "mnemonic");
+	rz_analysis_op_fini(&op);
+	len = rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x48\xc7\xc0\x04\x00\x00\x00", 7, RZ_ANALYSIS_OP_MASK_DISASM);
+	mu_assert_eq(cache->hits, 2, "disasm is cached");
+	mu_assert_streq(op.mnemonic, "mov rax, 4", "cached mnemonic");
+	rz_analysis_op_fini(&op);
+
+	// the oldest entry is evicted
+	rz_analysis_op(analysis, &op, 0x2000, mov, 5, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	rz_analysis_op(analysis, &op, 0x3000, mov, 5, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(rz_analysis_op_cache_size(analysis), 2, "cache is bounded");
+	ut64 misses = cache->misses;
+	rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(cache->misses, misses + 1, "evicted entry is a miss");
+
+	rz_analysis_op_cache_invalidate(analysis, 0x3004, 1);
+	mu_assert_eq(rz_analysis_op_cache_size(analysis), 1, "write inside the op invalidates it");
+	rz_analysis_op_cache_invalidate(analysis, 0x1005, 1);
+	mu_assert_eq(rz_analysis_op_cache_size(analysis), 1, "write after the op keeps it");
+
+	misses = cache->misses;
+	rz_analysis_set_bits(analysis, 32);
+	rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(cache->misses, misses + 1, "ops decoded with other bits are a miss");
+
+	misses = cache->misses;
+	analysis->seggrn = 8;
+	rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(cache->misses, misses + 1, "ops decoded with another segment granularity are a miss");
+	free(analysis->os);
+	analysis->os = strdup("windows");
+	rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(cache->misses, misses + 2, "ops decoded for another os are a miss");
+	rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(cache->misses, misses + 2, "ops decoded with the new config are stored");
+
+	rz_analysis_op_cache_set_max_entries(analysis, 0);
+	mu_assert_eq(rz_analysis_op_cache_size(analysis), 0, "disabling the cache drops the entries");
+	rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(rz_analysis_op_cache_size(analysis), 0, "disabled cache");
+
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+static bool thunk_read_at(RzAnalysis *analysis, ut64 addr, ut8 *buf, int len) {
+	// mov ebx, dword [esp]; ret
+	const ut8 thunk[] = { 0x8b, 0x1c, 0x24, 0xc3 };
+	memset(buf, 0, len);
+	memcpy(buf, thunk, RZ_MIN(len, sizeof(thunk)));
+	return true;
+}
+
+bool test_rz_analysis_op_cache_stale() {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzAnalysisOp op;
+	SWITCH_TO_ARCH_BITS("x86", 32);
+	RzAnalysisOpCache *cache = analysis->op_cache;
+	// call 0x2000
+	const ut8 *call = (const ut8 *)"\xe8\xfb\x0f\x00\x00";
+	analysis->read_at = thunk_read_at;
+	rz_analysis_op(analysis, &op, 0x1000, call, 5, RZ_ANALYSIS_OP_MASK_ESIL);
+	mu_assert_true(op.reads_memory, "esil of the call depends on the target bytes");
+	mu_assert_streq(rz_strbuf_get(&op.esil), "0x1005,ebx,=", "get_pc_thunk call");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(rz_analysis_op_cache_size(analysis), 0, "op reading memory is not stored");
+	analysis->read_at = NULL;
+
+	// mov eax, 4
+	const ut8 *mov = (const ut8 *)"\xb8\x04\x00\x00\x00";
+	rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_VAL);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(rz_analysis_op_cache_size(analysis), 1, "op stored");
+	char *profile = rz_str_newf("%s\ngpr\tfoo\t.32\t0\t0\n", analysis->reg->reg_profile_str);
+	rz_reg_set_profile_string(analysis->reg, profile);
+	free(profile);
+	ut64 misses = cache->misses;
+	rz_analysis_op(analysis, &op, 0x1000, mov, 5, RZ_ANALYSIS_OP_MASK_VAL);
+	mu_assert_eq(cache->misses, misses + 1, "ops decoded with another register profile are a miss");
+	mu_assert_ptreq(op.dst->reg, rz_reg_get(analysis->reg, "eax", RZ_REG_TYPE_ANY), "register of the new profile");
+	rz_analysis_op_fini(&op);
+
+	// the conditions of a thumb IT block depend on the previously decoded IT instruction
+	SWITCH_TO_ARCH_BITS("arm", 16);
+	rz_analysis_op_cache_clear(analysis);
+	// ite pl; ldrpl r2, [r3, -0x18]
+	const ut8 *it = (const ut8 *)"\x54\xbf\x53\xf8\x18\x2c";
+	rz_analysis_op(analysis, &op, 0x100, it, 2, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	rz_analysis_op(analysis, &op, 0x102, it + 2, 4, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(rz_analysis_op_cache_size(analysis), 0, "ops of stateful plugins are not stored");
+
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+bool test_rz_analysis_il_vm_cache() {
+	RzCore *core = rz_core_new();
+	rz_io_open_at(core->io, "malloc://0x100", RZ_PERM_RWX, 0644, 0, NULL);
+	rz_core_set_asm_configs(core, "x86", 64, 0);
+	// loop: inc rax; jmp loop
+	rz_io_write_at(core->io, 0, (const ut8 *)"\x48\xff\xc0\xeb\xfb", 5);
+	RzAnalysis *analysis = core->analysis;
+	rz_reg_setv(analysis->reg, "rip", 0);
+	rz_reg_setv(analysis->reg, "rax", 0);
+	mu_assert_true(rz_analysis_il_vm_setup(analysis), "vm setup");
+	RzAnalysisILVM *vm = analysis->il_vm;
+	for (int i = 0; i < 10; i++) {
+		mu_assert_eq(rz_analysis_il_vm_step(analysis, vm, analysis->reg), RZ_ANALYSIS_IL_STEP_RESULT_SUCCESS, "step");
+	}
+	mu_assert_eq(rz_reg_getv(analysis->reg, "rax"), 5, "cached effects are executed again");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "rip"), 0, "back at the loop head");
+	mu_assert_eq(rz_analysis_il_vm_cache_size(vm), 2, "each op is lifted once");
+
+	// patch the loop to dec rax
+	rz_io_write_at(core->io, 0, (const ut8 *)"\x48\xff\xc8", 3);
+	for (int i = 0; i < 2; i++) {
+		mu_assert_eq(rz_analysis_il_vm_step(analysis, vm, analysis->reg), RZ_ANALYSIS_IL_STEP_RESULT_SUCCESS, "step");
+	}
+	mu_assert_eq(rz_reg_getv(analysis->reg, "rax"), 4, "changed bytes are lifted again");
+	mu_assert_eq(rz_analysis_il_vm_cache_size(vm), 2, "changed op replaced");
+
+	rz_analysis_il_vm_cache_clear(vm);
+	mu_assert_eq(rz_analysis_il_vm_cache_size(vm), 0, "cache cleared");
+	mu_assert_eq(rz_analysis_il_vm_step(analysis, vm, analysis->reg), RZ_ANALYSIS_IL_STEP_RESULT_SUCCESS, "step");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "rax"), 3, "step after clear");
+
+	rz_analysis_il_vm_cache_set_max_entries(vm, 0);
+	mu_assert_eq(rz_analysis_il_vm_cache_size(vm), 0, "shrinking drops the cache");
+	for (int i = 0; i < 2; i++) {
+		mu_assert_eq(rz_analysis_il_vm_step(analysis, vm, analysis->reg), RZ_ANALYSIS_IL_STEP_RESULT_SUCCESS, "step");
+	}
+	mu_assert_eq(rz_reg_getv(analysis->reg, "rax"), 2, "steps with the cache disabled");
+	mu_assert_eq(rz_analysis_il_vm_cache_size(vm), 0, "nothing cached");
+
+	rz_core_free(core);
+	mu_end;
+}
+
 bool test_rz_core_analysis_bytes() {
 	RzCore *core = rz_core_new();
 	rz_core_set_asm_configs(core, "x86", 64, 0);
@@ -173,6 +353,9 @@ bool test_rz_core_print_disasm() {
 
 int all_tests() {
 	mu_run_test(test_rz_analysis_op_val);
+	mu_run_test(test_rz_analysis_op_cache);
+	mu_run_test(test_rz_analysis_op_cache_stale);
+	mu_run_test(test_rz_analysis_il_vm_cache);
 	mu_run_test(test_rz_core_analysis_bytes);
 	mu_run_test(test_rz_core_print_disasm);
 	return tests_passed != tests_run;
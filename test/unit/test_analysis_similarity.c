@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_analysis.h>
+#include <rz_io.h>
+#include "minunit.h"
+
+#define N_FCNS     32
+#define FCN_SIZE   0x80
+#define FCN_STRIDE 0x100
+#define BASE_A     0x1000
+#define BASE_B     0x10000
+#define BASE_JUNK  0x20000
+
+static ut32 rnd_state;
+
+static ut8 rnd(void) {
+	rnd_state = rnd_state * 1103515245 + 12345;
+	return (rnd_state >> 16) & 0xff;
+}
+
+static bool add_function(RzAnalysis *analysis, RzList *list, ut64 addr) {
+	char name[32];
+	snprintf(name, sizeof(name), "fcn.%08" PFMT64x, addr);
+	RzAnalysisFunction *fcn = rz_analysis_create_function(analysis, name, addr, RZ_ANALYSIS_FCN_TYPE_FCN);
+	RzAnalysisBlock *block = rz_analysis_create_block(analysis, addr, FCN_SIZE);
+	if (!fcn || !block) {
+		return false;
+	}
+	rz_analysis_function_add_block(fcn, block);
+	rz_analysis_block_unref(block);
+	return rz_list_append(list, fcn) != NULL;
+}
+
+/**
+ * Functions of B are the functions of A in reverse order with 2 bytes
+ * changed, followed by unrelated functions.
+ */
+static bool setup(RzAnalysis *analysis, RzIO *io, RzList *list_a, RzList *list_b) {
+	ut8 buf[FCN_SIZE];
+	rnd_state = 0x1337;
+	for (ut32 i = 0; i < N_FCNS; i++) {
+		for (ut32 j = 0; j < FCN_SIZE; j++) {
+			buf[j] = rnd();
+		}
+		ut64 addr_a = BASE_A + i * FCN_STRIDE;
+		ut64 addr_b = BASE_B + (N_FCNS - 1 - i) * FCN_STRIDE;
+		rz_io_write_at(io, addr_a, buf, sizeof(buf));
+		buf[0x10] ^= 0xff;
+		buf[0x50] ^= 0xff;
+		rz_io_write_at(io, addr_b, buf, sizeof(buf));
+		if (!add_function(analysis, list_a, addr_a)) {
+			return false;
+		}
+	}
+	for (ut32 i = 0; i < N_FCNS; i++) {
+		if (!add_function(analysis, list_b, BASE_B + i * FCN_STRIDE)) {
+			return false;
+		}
+	}
+	for (ut32 i = 0; i < N_FCNS; i++) {
+		for (ut32 j = 0; j < FCN_SIZE; j++) {
+			buf[j] = rnd();
+		}
+		ut64 addr = BASE_JUNK + i * FCN_STRIDE;
+		rz_io_write_at(io, addr, buf, sizeof(buf));
+		if (!add_function(analysis, list_b, addr)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static int pair_cmp(const void *a, const void *b) {
+	const RzAnalysisMatchPair *pa = a, *pb = b;
+	ut64 x = ((const RzAnalysisFunction *)pa->pair_a)->addr;
+	ut64 y = ((const RzAnalysisFunction *)pb->pair_a)->addr;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+bool test_analysis_match_functions_threshold(void) {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzIO *io = rz_io_new();
+	mu_assert_notnull(analysis, "analysis");
+	mu_assert_notnull(io, "io");
+	rz_io_bind(io, &analysis->iob);
+	mu_assert_notnull(rz_io_open_at(io, "malloc://0x30000", RZ_PERM_RW, 0644, 0, NULL), "open");
+	RzList *list_a = rz_list_new();
+	RzList *list_b = rz_list_new();
+	mu_assert_true(setup(analysis, io, list_a, list_b), "setup");
+
+	RzAnalysisMatchOpt opt = { 0 };
+	opt.analysis_a = analysis;
+	opt.analysis_b = analysis;
+	RzAnalysisMatchResult *all = rz_analysis_match_functions(list_a, list_b, &opt);
+	mu_assert_notnull(all, "all the pairs");
+	opt.candidate_threshold = 0.5;
+	RzAnalysisMatchResult *lsh = rz_analysis_match_functions(list_a, list_b, &opt);
+	mu_assert_notnull(lsh, "candidate pairs");
+
+	mu_assert_eq(rz_list_length(all->matches), N_FCNS, "all matched");
+	mu_assert_eq(rz_list_length(lsh->matches), N_FCNS, "all matched with a threshold");
+	mu_assert_eq(rz_list_length(lsh->unmatch_a), 0, "unmatched A");
+	mu_assert_eq(rz_list_length(lsh->unmatch_b), N_FCNS, "unmatched B");
+	opt.candidate_recall = 0.5;
+	RzAnalysisMatchResult *low = rz_analysis_match_functions(list_a, list_b, &opt);
+	mu_assert_notnull(low, "candidate pairs with a low recall");
+	mu_assert_eq(rz_list_length(low->matches), N_FCNS, "near-identical pairs are still compared");
+	rz_analysis_match_result_free(low);
+	rz_list_sort(all->matches, (RzListComparator)pair_cmp);
+	rz_list_sort(lsh->matches, (RzListComparator)pair_cmp);
+	RzListIter *it_all = rz_list_iterator(all->matches);
+	RzListIter *it_lsh = rz_list_iterator(lsh->matches);
+	for (ut32 i = 0; i < N_FCNS; i++) {
+		RzAnalysisMatchPair *pa = rz_list_iter_get_data(it_all);
+		RzAnalysisMatchPair *pl = rz_list_iter_get_data(it_lsh);
+		ut64 expect = BASE_B + (N_FCNS - 1 - i) * FCN_STRIDE;
+		mu_assert_eq(((const RzAnalysisFunction *)pa->pair_a)->addr, BASE_A + i * FCN_STRIDE, "function A");
+		mu_assert_eq(((const RzAnalysisFunction *)pa->pair_b)->addr, expect, "function B");
+		mu_assert_ptreq(pl->pair_a, pa->pair_a, "same pairs");
+		mu_assert_ptreq(pl->pair_b, pa->pair_b, "same pairs");
+		mu_assert_true(pa->similarity > 0.95 && pa->similarity < 1.0, "near-identical");
+		mu_assert_true(pl->similarity == pa->similarity, "same similarity");
+		it_all = rz_list_iter_get_next(it_all);
+		it_lsh = rz_list_iter_get_next(it_lsh);
+	}
+
+	rz_analysis_match_result_free(all);
+	rz_analysis_match_result_free(lsh);
+	rz_list_free(list_a);
+	rz_list_free(list_b);
+	rz_io_free(io);
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_analysis_match_functions_threshold);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
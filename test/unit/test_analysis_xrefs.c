@@ -21,8 +21,100 @@ bool test_rz_analysis_xrefs_count() {
 	mu_end;
 }
 
+static bool check_xref(RzList *list, int n, ut64 from, ut64 to, RzAnalysisXRefType type) {
+	RzAnalysisXRef *xref = rz_list_get_n(list, n);
+	return xref && xref->from == from && xref->to == to && xref->type == type;
+}
+
+bool test_rz_analysis_xrefs_range() {
+	RzAnalysis *analysis = rz_analysis_new();
+
+	rz_analysis_xrefs_set(analysis, 0x100, 0x2000, RZ_ANALYSIS_XREF_TYPE_CALL);
+	rz_analysis_xrefs_set(analysis, 0x110, 0x1000, RZ_ANALYSIS_XREF_TYPE_CODE);
+	rz_analysis_xrefs_set(analysis, 0x120, 0x1000, RZ_ANALYSIS_XREF_TYPE_CALL);
+	rz_analysis_xrefs_set(analysis, 0x130, 0x3000, RZ_ANALYSIS_XREF_TYPE_DATA);
+	rz_analysis_xrefs_set(analysis, 0x110, 0x1000, RZ_ANALYSIS_XREF_TYPE_DATA);
+
+	mu_assert_eq(rz_analysis_xrefs_count(analysis), 4, "xrefs count");
+
+	RzList *list = rz_analysis_xrefs_get_to_range(analysis, 0x1000, 0x3000);
+	mu_assert_eq(rz_list_length(list), 3, "xrefs to range");
+	mu_assert("xref 0", check_xref(list, 0, 0x110, 0x1000, RZ_ANALYSIS_XREF_TYPE_DATA));
+	mu_assert("xref 1", check_xref(list, 1, 0x120, 0x1000, RZ_ANALYSIS_XREF_TYPE_CALL));
+	mu_assert("xref 2", check_xref(list, 2, 0x100, 0x2000, RZ_ANALYSIS_XREF_TYPE_CALL));
+	rz_list_free(list);
+
+	list = rz_analysis_xrefs_get_from_range(analysis, 0x110, 0x131);
+	mu_assert_eq(rz_list_length(list), 3, "xrefs from range");
+	mu_assert("xref 0", check_xref(list, 0, 0x110, 0x1000, RZ_ANALYSIS_XREF_TYPE_DATA));
+	mu_assert("xref 2", check_xref(list, 2, 0x130, 0x3000, RZ_ANALYSIS_XREF_TYPE_DATA));
+	rz_list_free(list);
+
+	list = rz_analysis_xrefs_get_from_range(analysis, 0x131, 0x131);
+	mu_assert_true(rz_list_empty(list), "empty range");
+	rz_list_free(list);
+
+	rz_analysis_xref_del(analysis, 0x120, 0x1000);
+	list = rz_analysis_xrefs_get_to(analysis, 0x1000);
+	mu_assert_eq(rz_list_length(list), 1, "xrefs to after delete");
+	mu_assert("xref 0", check_xref(list, 0, 0x110, 0x1000, RZ_ANALYSIS_XREF_TYPE_DATA));
+	rz_list_free(list);
+
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+static bool count_xrefs_cb(const RzAnalysisXRef *xref, void *user) {
+	ut64 *prev = user;
+	if (prev[1] && xref->from < prev[0]) {
+		return false;
+	}
+	prev[0] = xref->from;
+	prev[1]++;
+	return true;
+}
+
+bool test_rz_analysis_xrefs_many() {
+	RzAnalysis *analysis = rz_analysis_new();
+	const ut64 n = 0x4000;
+	ut64 i;
+
+	// enough xrefs to be merged a few times, added out of order
+	for (i = 0; i < n; i++) {
+		ut64 from = ((i * 0x9e37) % n) * 0x10;
+		rz_analysis_xrefs_set(analysis, from, 0x100000 + (from % 0x100), RZ_ANALYSIS_XREF_TYPE_CALL);
+	}
+	mu_assert_eq(rz_analysis_xrefs_count(analysis), n, "xrefs count");
+	for (i = 0; i < n; i += 2) {
+		rz_analysis_xrefs_deln(analysis, i * 0x10, 0x100000 + ((i * 0x10) % 0x100), RZ_ANALYSIS_XREF_TYPE_CALL);
+	}
+	mu_assert_eq(rz_analysis_xrefs_count(analysis), n / 2, "xrefs count after delete");
+
+	RzList *list = rz_analysis_xrefs_get_from(analysis, 0x10);
+	mu_assert_eq(rz_list_length(list), 1, "xrefs from");
+	mu_assert("xref", check_xref(list, 0, 0x10, 0x100010, RZ_ANALYSIS_XREF_TYPE_CALL));
+	rz_list_free(list);
+	list = rz_analysis_xrefs_get_from(analysis, 0x20);
+	mu_assert_null(list, "deleted xref");
+
+	list = rz_analysis_xrefs_get_to(analysis, 0x100010);
+	mu_assert_eq(rz_list_length(list), n / 16, "xrefs to");
+	rz_list_free(list);
+	list = rz_analysis_xrefs_get_to(analysis, 0x100020);
+	mu_assert_null(list, "deleted xrefs to");
+
+	ut64 prev[2] = { 0 };
+	mu_assert_true(rz_analysis_xrefs_foreach(analysis, count_xrefs_cb, prev), "sorted by from");
+	mu_assert_eq(prev[1], n / 2, "foreach count");
+
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test(test_rz_analysis_xrefs_count);
+	mu_run_test(test_rz_analysis_xrefs_range);
+	mu_run_test(test_rz_analysis_xrefs_many);
 	return tests_passed != tests_run;
 }
 
@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_bin.h>
+#include "minunit.h"
+
+#define N_SYMBOLS  3000
+#define N_SECTIONS 200
+
+#include "bin_object_mock.h"
+
+static bool check_lookups(RzBinObject *o, ut64 from, ut64 to, ut64 step) {
+	for (ut64 off = from; off < to; off += step) {
+		for (int va = 0; va < 2; va++) {
+			mu_assert_ptreq(rz_bin_get_section_at(o, off, va), linear_section_at(o, off, va), "section at");
+			mu_assert_ptreq(rz_bin_object_get_map_at(o, off, va), linear_map_at(o, off, va), "map at");
+			RzPVector *all = rz_bin_object_get_maps_at(o, off, va);
+			size_t n = 0;
+			void **it;
+			rz_pvector_foreach (o->maps, it) {
+				RzBinMap *m = *it;
+				ut64 mfrom = va ? rz_bin_object_addr_with_base(o, m->vaddr) : m->paddr;
+				ut64 mto = mfrom + (va ? m->vsize : m->psize);
+				if (off >= mfrom && off < mto) {
+					mu_assert_ptreq(rz_pvector_at(all, n), m, "maps at are in vector order");
+					n++;
+				}
+			}
+			mu_assert_eq(rz_pvector_len(all), n, "maps at count");
+			rz_pvector_free(all);
+		}
+	}
+	return true;
+}
+
+bool test_rz_bin_object_addr_lookup(void) {
+	RzBin *bin = rz_bin_new();
+	RzBuffer *buf = rz_buf_new_with_bytes((const ut8 *)"\x00", 1);
+	RzBinFile *bf = mock_open(bin, buf);
+	mu_assert_notnull(bf, "open mock bin");
+	RzBinObject *o = bf->o;
+	mu_assert_eq(rz_pvector_len(o->symbols), N_SYMBOLS, "symbols count");
+
+	mu_assert_true(check_lookups(o, 0, N_SECTIONS * SECTION_GAP + 0x200, 0x11), "physical lookups");
+	mu_assert_true(check_lookups(o, 0x10000, 0x10000 + N_SECTIONS * SECTION_GAP + 0x200, 0x11), "virtual lookups");
+
+	RzBinSymbol *sym = rz_bin_object_get_symbol_at(o, 0x10004, true);
+	mu_assert_notnull(sym, "symbol at vaddr");
+	mu_assert_streq(sym->name, "sym3", "first symbol at the address");
+	sym = rz_bin_object_get_symbol_at(o, 8, false);
+	mu_assert_notnull(sym, "symbol at paddr");
+	mu_assert_streq(sym->name, "sym6", "first symbol at the address");
+	mu_assert_null(rz_bin_object_get_symbol_at(o, 9, false), "no symbol at paddr");
+	for (ut64 off = 0; off < N_SYMBOLS / 3 * 4; off += 0x1f) {
+		mu_assert_ptreq(rz_bin_object_get_symbol_at(o, off, false), linear_symbol_at(o, off, false), "symbol at paddr");
+		mu_assert_ptreq(rz_bin_object_get_symbol_at(o, off + 0x10000, true), linear_symbol_at(o, off + 0x10000, true), "symbol at vaddr");
+	}
+
+	// the indexes follow the base address and the changes of the vectors
+	rz_bin_set_baddr(bin, 0x40000);
+	mu_assert_eq(o->baddr_shift, 0x30000, "baddr shift");
+	mu_assert_true(check_lookups(o, 0x40000, 0x40000 + N_SECTIONS * SECTION_GAP + 0x200, 0x11), "rebased lookups");
+	RzBinSection *s = rz_bin_section_new("late");
+	s->paddr = 0x100000;
+	s->size = 0x10;
+	s->vaddr = 0x100000;
+	s->vsize = 0x10;
+	rz_pvector_push(o->sections, s);
+	mu_assert_ptreq(rz_bin_get_section_at(o, 0x100008, false), s, "section pushed after the first lookup");
+	mu_assert_ptreq(rz_bin_get_section_at(o, 0x130008, true), s, "section pushed after the first lookup");
+
+	// in place edits are seen once notified
+	s->vaddr = 0x200000;
+	rz_bin_object_addrs_changed(o);
+	mu_assert_null(rz_bin_get_section_at(o, 0x130008, true), "section moved away");
+	mu_assert_ptreq(rz_bin_get_section_at(o, 0x230008, true), s, "section moved in place");
+	RzBinMap *map = rz_pvector_at(o->maps, 0);
+	mu_assert_ptreq(rz_bin_object_get_map_at(o, 0x40000, true), map, "first map");
+	map->vaddr = 0x300000;
+	rz_bin_object_addrs_changed(o);
+	mu_assert_ptreq(rz_bin_object_get_map_at(o, 0x330000, true), map, "map moved in place");
+	mu_assert_null(rz_bin_object_get_map_at(o, 0x40000, true), "map moved away");
+	sym = rz_pvector_at(o->symbols, 0);
+	sym->vaddr = 0x400000;
+	rz_bin_object_addrs_changed(o);
+	mu_assert_ptreq(rz_bin_object_get_symbol_at(o, 0x400000, true), sym, "symbol moved in place");
+	mu_assert_streq(rz_bin_object_get_symbol_at(o, 0x10000, true)->name, "sym1", "next symbol at the old address");
+
+	rz_bin_free(bin);
+	rz_buf_free(buf);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_rz_bin_object_addr_lookup);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
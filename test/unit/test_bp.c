@@ -0,0 +1,190 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_bp.h>
+#include "minunit.h"
+
+static int writes;
+
+static int count_writes(RzBreakpoint *bp, RzBreakpointItem *b, bool set) {
+	writes += set ? 1 : -1;
+	return true;
+}
+
+static RzBreakpoint *bp_new(void) {
+	RzBreakpointContext ctx = { 0 };
+	RzBreakpoint *bp = rz_bp_new(&ctx);
+	if (!bp) {
+		return NULL;
+	}
+	rz_bp_use(bp, "x86");
+	bp->breakpoint = count_writes;
+	writes = 0;
+	return bp;
+}
+
+bool test_bp_lookup(void) {
+	RzBreakpoint *bp = bp_new();
+	mu_assert_notnull(bp, "bp");
+	for (ut64 addr = 0x1000; addr < 0x1000 + 0x1000 * 4; addr += 4) {
+		RzBreakpointItem *b = rz_bp_add_sw(bp, addr, 2, RZ_PERM_X);
+		mu_assert_notnull(b, "bp added");
+	}
+	mu_assert_eq(rz_list_length(bp->bps), 0x1000, "bps count");
+	mu_assert_null(rz_bp_add_sw(bp, 0x1001, 1, RZ_PERM_X), "overlapping bp");
+
+	RzBreakpointItem *b = rz_bp_get_at(bp, 0x1008);
+	mu_assert_notnull(b, "get_at");
+	mu_assert_eq(b->addr, 0x1008, "get_at addr");
+	mu_assert_null(rz_bp_get_at(bp, 0x1009), "get_at inside");
+	mu_assert_ptreq(rz_bp_get_in(bp, 0x1009, 0), b, "get_in");
+	mu_assert_null(rz_bp_get_in(bp, 0x100a, 0), "get_in gap");
+	mu_assert_ptreq(rz_bp_get_ending_at(bp, 0x100a), b, "get_ending_at");
+	mu_assert_null(rz_bp_get_ending_at(bp, 0x1009), "get_ending_at inside");
+	mu_assert_null(rz_bp_get_at(bp, 0x1000 + 0x1000 * 4), "get_at past end");
+
+	int moved_idx = rz_bp_get_index_at(bp, 0x1008);
+	rz_bp_item_set_addr(bp, b, 0x100000);
+	mu_assert_null(rz_bp_get_at(bp, 0x1008), "moved away");
+	mu_assert_ptreq(rz_bp_get_at(bp, 0x100000), b, "moved");
+	mu_assert_ptreq(rz_bp_get_in(bp, 0x100001, 0), b, "moved get_in");
+
+	int idx = rz_bp_get_index_at(bp, 0x1010);
+	mu_assert_true(idx >= 0, "index");
+	mu_assert_true(rz_bp_del_index(bp, idx), "del_index");
+	mu_assert_null(rz_bp_get_at(bp, 0x1010), "deleted by index");
+	mu_assert_true(rz_bp_del(bp, 0x100000), "del");
+	mu_assert_null(rz_bp_get_in(bp, 0x100001, 0), "deleted");
+	mu_assert_eq(rz_list_length(bp->bps), 0x1000 - 2, "bps count after del");
+
+	// the freed slots are reused
+	b = rz_bp_add_sw(bp, 0x10, 1, RZ_PERM_X);
+	mu_assert_notnull(b, "bp added");
+	mu_assert_eq(rz_bp_get_index_at(bp, 0x10), RZ_MIN(idx, moved_idx), "slot reused");
+
+	mu_assert_true(rz_bp_del_all(bp), "del_all");
+	mu_assert_null(rz_bp_get_at(bp, 0x1000), "deleted all");
+	mu_assert_null(rz_bp_get_in(bp, 0x10, 0), "deleted all");
+	rz_bp_free(bp);
+	mu_end;
+}
+
+bool test_bp_shared_addr(void) {
+	RzBreakpoint *bp = bp_new();
+	mu_assert_notnull(bp, "bp");
+	for (ut64 addr = 0x1000; addr < 0x1000 + 0x100 * 4; addr += 4) {
+		mu_assert_notnull(rz_bp_add_sw(bp, addr, 2, RZ_PERM_X), "bp added");
+	}
+	RzBreakpointItem *a = rz_bp_add_sw(bp, 0x5000, 1, RZ_PERM_X);
+	RzBreakpointItem *b = rz_bp_add_sw(bp, 0x6000, 2, RZ_PERM_X);
+	RzBreakpointItem *c = rz_bp_add_sw(bp, 0x7000, 2, RZ_PERM_X);
+	mu_assert_notnull(a, "bp added");
+	mu_assert_notnull(b, "bp added");
+	mu_assert_notnull(c, "bp added");
+	// move them onto each other in the reverse order of the list
+	rz_bp_item_set_addr(bp, c, 0x5000);
+	rz_bp_item_set_addr(bp, b, 0x5000);
+
+	// the first matching breakpoint of the list wins
+	mu_assert_ptreq(rz_bp_get_at(bp, 0x5000), a, "get_at");
+	mu_assert_ptreq(rz_bp_get_in(bp, 0x5000, 0), a, "get_in");
+	mu_assert_ptreq(rz_bp_get_in(bp, 0x5001, 0), b, "get_in");
+	mu_assert_ptreq(rz_bp_get_ending_at(bp, 0x5002), b, "get_ending_at");
+	mu_assert_ptreq(rz_bp_get_ending_at(bp, 0x5001), a, "get_ending_at");
+
+	mu_assert_true(rz_bp_del(bp, 0x5000), "del");
+	mu_assert_ptreq(rz_bp_get_at(bp, 0x5000), b, "get_at after del");
+	mu_assert_ptreq(rz_bp_get_in(bp, 0x5000, 0), b, "get_in after del");
+	rz_bp_free(bp);
+	mu_end;
+}
+
+bool test_bp_coverage(void) {
+	RzBreakpoint *bp = bp_new();
+	mu_assert_notnull(bp, "bp");
+	mu_assert_notnull(rz_bp_add_sw(bp, 0x2000, 1, RZ_PERM_X), "regular bp");
+
+	RzVector addrs;
+	rz_vector_init(&addrs, sizeof(ut64), NULL, NULL);
+	for (ut64 i = 0; i < 0x1000; i++) {
+		ut64 addr = 0x1000 + ((i * 7) % 0x1000) * 0x10;
+		rz_vector_push(&addrs, &addr);
+	}
+	ut64 addr = 0x2000; // already has a breakpoint
+	rz_vector_push(&addrs, &addr);
+	addr = 0x1000; // duplicate
+	rz_vector_push(&addrs, &addr);
+	mu_assert_true(rz_bp_coverage_start(bp, &addrs), "coverage start");
+	mu_assert_false(rz_bp_coverage_start(bp, &addrs), "coverage already running");
+	rz_vector_fini(&addrs);
+
+	RzBreakpointCoverage *cov = bp->coverage;
+	mu_assert_notnull(cov, "coverage");
+	mu_assert_eq(cov->addrs.len, 0x1000 - 1, "traced addresses");
+	mu_assert_eq(writes, 0x1000 - 1, "coverage breakpoints written at start");
+	rz_bp_restore(bp, true);
+	mu_assert_eq(writes, 0x1000, "regular breakpoint written before continuing");
+	mu_assert_eq(*(ut64 *)rz_vector_index_ptr(&cov->addrs, 0), 0x1000, "sorted");
+
+	// hit every other block, more than needed to trigger a flush
+	for (ut64 i = 0; i < 0x800; i += 2) {
+		if (0x1000 + i * 0x10 == 0x2000) {
+			continue;
+		}
+		RzBreakpointItem *b = rz_bp_get_at(bp, 0x1000 + i * 0x10);
+		mu_assert_notnull(b, "coverage bp");
+		mu_assert_true(b->coverage, "coverage bp");
+		mu_assert_true(rz_bp_coverage_hit(bp, b), "hit");
+		mu_assert_false(b->enabled, "disabled after hit");
+		mu_assert_null(rz_bp_get_at(bp, 0x1000 + i * 0x10), "unindexed after hit");
+	}
+	mu_assert_true(rz_list_length(bp->bps) < 0x1000, "hit breakpoints flushed in batches");
+	rz_bp_coverage_flush(bp);
+	mu_assert_eq(rz_list_length(bp->bps), 1 + 0xfff - 0x3ff, "hit breakpoints deleted");
+	mu_assert_eq(writes, 1 + 0xfff - 0x3ff, "original bytes of hit blocks restored");
+	for (ut32 i = 0; i < cov->addrs.len; i++) {
+		ut64 a = *(ut64 *)rz_vector_index_ptr(&cov->addrs, i);
+		bool expect = a < 0x1000 + 0x800 * 0x10 && !((a - 0x1000) & 0x10);
+		mu_assert_eq(rz_bv_get(&cov->hits, i), expect, "hit bitmap");
+	}
+
+	// stopping and continuing only touches the regular breakpoint
+	rz_bp_restore(bp, false);
+	mu_assert_eq(writes, 0xfff - 0x3ff, "coverage breakpoints left in memory while stopped");
+	rz_bp_restore(bp, true);
+	mu_assert_eq(writes, 1 + 0xfff - 0x3ff, "coverage breakpoints not written again");
+
+	// reads see the original bytes (zeroes here) of the ones not hit yet
+	ut8 buf[0x40];
+	memset(buf, 0xcc, sizeof(buf));
+	rz_bp_coverage_hide(bp, 0x1000 - 0x8, buf, sizeof(buf));
+	for (int i = 0; i < sizeof(buf); i++) {
+		ut64 a = 0x1000 - 0x8 + i;
+		// 0x1000 and 0x1020 were hit, 0x1010 and 0x1030 were not
+		bool hidden = a == 0x1010 || a == 0x1030;
+		mu_assert_eq(buf[i], hidden ? 0 : 0xcc, "coverage breakpoints hidden from reads");
+	}
+
+	RzVector *hits = rz_bp_coverage_stop(bp);
+	mu_assert_notnull(hits, "hits returned on stop");
+	mu_assert_eq(hits->len, 0x3ff, "hits returned on stop");
+	mu_assert_eq(*(ut64 *)rz_vector_index_ptr(hits, 0), 0x1000, "first hit");
+	mu_assert_eq(*(ut64 *)rz_vector_index_ptr(hits, 1), 0x1020, "second hit");
+	rz_vector_free(hits);
+	mu_assert_null(bp->coverage, "coverage stopped");
+	mu_assert_eq(writes, 1, "original bytes restored");
+	mu_assert_eq(rz_list_length(bp->bps), 1, "coverage breakpoints deleted");
+	mu_assert_null(rz_bp_coverage_stop(bp), "no coverage running");
+	mu_assert_notnull(rz_bp_get_at(bp, 0x2000), "regular bp kept");
+	rz_bp_free(bp);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_bp_lookup);
+	mu_run_test(test_bp_shared_addr);
+	mu_run_test(test_bp_coverage);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
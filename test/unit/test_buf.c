@@ -1377,6 +1377,38 @@ bool test_rz_buf_fwd_scan(void) {
 	mu_end;
 }
 
+bool test_rz_buf_direct_data(void) {
+	const char *content = "AAAAAAAAAASomething To\nSay Here..BBBBBBBBBB";
+	const ut64 length = strlen(content);
+	RzBuffer *buf = rz_buf_new_with_bytes((ut8 *)content, length);
+	ut64 size = 0;
+	const ut8 *data = rz_buf_direct_data(buf, &size);
+	mu_assert_notnull(data, "bytes are directly addressable");
+	mu_assert_eq(size, length, "bytes size");
+	mu_assert_memeq(data, (ut8 *)content, length, "bytes data");
+
+	RzBuffer *slice = rz_buf_new_slice(buf, 10, 23);
+	data = rz_buf_direct_data(slice, &size);
+	mu_assert_notnull(data, "slice of bytes is directly addressable");
+	mu_assert_eq(size, 23, "slice size");
+	mu_assert_memeq(data, (ut8 *)"Something To\nSay Here..", 23, "slice data");
+	RzBuffer *big = rz_buf_new_slice(buf, 30, 100);
+	data = rz_buf_direct_data(big, &size);
+	mu_assert_notnull(data, "big slice of bytes is directly addressable");
+	mu_assert_eq(size, length - 30, "big slice is limited by the parent");
+	rz_buf_free(big);
+	rz_buf_free(slice);
+
+	RzBuffer *sparse = rz_buf_new_sparse_overlay(buf, RZ_BUF_SPARSE_WRITE_MODE_SPARSE);
+	mu_assert_null(rz_buf_direct_data(sparse, &size), "sparse is not directly addressable");
+	RzBuffer *sparse_slice = rz_buf_new_slice(sparse, 0, 10);
+	mu_assert_null(rz_buf_direct_data(sparse_slice, &size), "slice of sparse is not directly addressable");
+	rz_buf_free(sparse_slice);
+	rz_buf_free(sparse);
+	rz_buf_free(buf);
+	mu_end;
+}
+
 bool test_rz_buf_negative(bool use_slice) {
 	// Tests for reading around the high boundary of a 64bit address space
 	// This is unfortunately currently not fully supported due to st64 being used
@@ -1445,6 +1477,7 @@ int all_tests() {
 	mu_run_test(test_rz_buf_whole_buf);
 	mu_run_test(test_rz_buf_whole_buf_alloc);
 	mu_run_test(test_rz_buf_fwd_scan);
+	mu_run_test(test_rz_buf_direct_data);
 	mu_run_test(test_rz_buf_negative, false);
 	mu_run_test(test_rz_buf_negative, true);
 	return tests_passed != tests_run;
@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_core.h>
+#include "minunit.h"
+
+bool test_core_block_entropy_mapped_write(void) {
+	RzCore *core = rz_core_new();
+	rz_config_set_b(core->config, "io.va", true);
+	// physical offset 0 of the file is mapped at 0x1000
+	mu_assert_notnull(rz_io_open_at(core->io, "malloc://0x200", RZ_PERM_RW, 0644, 0x1000, NULL), "open");
+
+	double *entropy = rz_core_block_entropy(core, 0x1000, 0x100, 2);
+	mu_assert_notnull(entropy, "entropy");
+	mu_assert_eq(entropy[0], 0.0, "zeroes");
+	mu_assert_eq(entropy[1], 0.0, "zeroes");
+	free(entropy);
+
+	const ut8 bytes[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	mu_assert_true(rz_io_write_at(core->io, 0x1100, bytes, sizeof(bytes)), "write");
+	entropy = rz_core_block_entropy(core, 0x1000, 0x100, 2);
+	mu_assert_notnull(entropy, "entropy");
+	mu_assert_eq(entropy[0], 0.0, "untouched block");
+	mu_assert_true(entropy[1] > 0.0, "written block is hashed again");
+	free(entropy);
+
+	rz_core_free(core);
+	mu_end;
+}
+
+bool test_core_block_hash_many_layouts(void) {
+	RzCore *core = rz_core_new();
+	mu_assert_notnull(rz_io_open_at(core->io, "malloc://0x400", RZ_PERM_RW, 0644, 0, NULL), "open");
+	const ut8 bytes[] = { 1, 2, 3, 4 };
+	rz_io_write_at(core->io, 0, bytes, sizeof(bytes));
+	// more block sizes than the tables kept, the result must not depend on the cache
+	for (int round = 0; round < 2; round++) {
+		for (ut64 blocksize = 1; blocksize <= 64; blocksize++) {
+			double *entropy = rz_core_block_entropy(core, 0, blocksize, 1);
+			mu_assert_notnull(entropy, "entropy");
+			mu_assert_eq(entropy[0] > 0.0, blocksize > 1, "first block entropy");
+			free(entropy);
+		}
+	}
+	rz_core_free(core);
+	mu_end;
+}
+
+bool test_core_block_entropy_map_change(void) {
+	RzCore *core = rz_core_new();
+	rz_config_set_b(core->config, "io.va", true);
+	rz_config_set_b(core->config, "io.cache", true);
+	mu_assert_notnull(rz_io_open_at(core->io, "malloc://0x100", RZ_PERM_RW, 0644, 0x1000, NULL), "open");
+	RzIODesc *desc = rz_io_open_at(core->io, "malloc://0x100", RZ_PERM_RW, 0644, 0x2000, NULL);
+	mu_assert_notnull(desc, "open");
+	const ut8 bytes[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	mu_assert_true(rz_io_fd_write_at(core->io, desc->fd, 0, bytes, sizeof(bytes)) > 0, "write");
+
+	double *entropy = rz_core_block_entropy(core, 0x1000, 0x100, 0x11);
+	mu_assert_notnull(entropy, "entropy");
+	mu_assert_eq(entropy[0], 0.0, "zeroes");
+	mu_assert_true(entropy[0x10] > 0.0, "written bytes");
+	free(entropy);
+
+	RzIOMap *map = rz_io_map_get(core->io, 0x2000);
+	mu_assert_notnull(map, "map");
+	mu_assert_true(rz_io_map_remap(core->io, map->id, 0x3000), "remap");
+	entropy = rz_core_block_entropy(core, 0x2000, 0x100, 0x11);
+	mu_assert_notnull(entropy, "entropy");
+	mu_assert_eq(entropy[0], 0.0, "unmapped");
+	mu_assert_true(entropy[0x10] > 0.0, "moved map");
+	free(entropy);
+
+	mu_assert_true(rz_io_cache_write(core->io, 0x1000, bytes, sizeof(bytes)), "cache write");
+	entropy = rz_core_block_entropy(core, 0x1000, 0x100, 1);
+	mu_assert_notnull(entropy, "entropy");
+	mu_assert_true(entropy[0] > 0.0, "cached bytes");
+	free(entropy);
+	rz_io_cache_reset(core->io, core->io->cached);
+	entropy = rz_core_block_entropy(core, 0x1000, 0x100, 1);
+	mu_assert_notnull(entropy, "entropy");
+	mu_assert_eq(entropy[0], 0.0, "cache reset");
+	free(entropy);
+
+	rz_core_free(core);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_core_block_entropy_mapped_write);
+	mu_run_test(test_core_block_hash_many_layouts);
+	mu_run_test(test_core_block_entropy_map_change);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
@@ -15,8 +15,8 @@ Sdb *ref_db() {
 	sdb_set(registers_db, "0x100", "[{\"cnum\":0,\"data\":1094861636},{\"cnum\":1,\"data\":3735928559}]", 0);
 
 	Sdb *memory_sdb = sdb_ns(db, "memory", true);
-	sdb_set(memory_sdb, "0x7ffffffff000", "[{\"cnum\":0,\"data\":170},{\"cnum\":1,\"data\":187}]", 0);
-	sdb_set(memory_sdb, "0x7ffffffff001", "[{\"cnum\":0,\"data\":0},{\"cnum\":1,\"data\":1}]", 0);
+	sdb_set(memory_sdb, "0x0", "[{\"addr\":140737488351232,\"data\":\"qgA=\"}]", 0);
+	sdb_set(memory_sdb, "0x1", "[{\"addr\":140737488351232,\"data\":\"uwE=\"}]", 0);
 
 	Sdb *checkpoints_sdb = sdb_ns(db, "checkpoints", true);
 	sdb_set(checkpoints_sdb, "0x0", "{"
@@ -36,11 +36,14 @@ Sdb *ref_db() {
 					"{\"arena\":12,\"bytes\":\"DAwMDAwMDAwMDAwMDAwMDA==\",\"size\":16}"
 					"],"
 					"\"snaps\":["
-					"{\"name\":\"[stack]\",\"addr\":8796092882944,\"addr_end\":8796092883200,\"size\":256,\"data\":\"8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8A==\",\"perm\":7,\"user\":0,\"shared\":true}"
+					"{\"name\":\"[stack]\",\"addr\":8796092882944,\"addr_end\":8796092883200,\"size\":256,\"pages\":[\"bc710ad22c2d39f3c428dc94a0a7889d947ad0d602eaeca433e3fa84e3fd5beb\"],\"perm\":7,\"user\":0,\"shared\":true}"
 					"]"
 					"}",
 		0);
 
+	Sdb *pages_sdb = sdb_ns(db, "pages", true);
+	sdb_set(pages_sdb, "bc710ad22c2d39f3c428dc94a0a7889d947ad0d602eaeca433e3fa84e3fd5beb", "8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8A==", 0);
+
 	return db;
 }
 
@@ -50,14 +53,13 @@ RzDebugSession *ref_session() {
 
 	// Registers & Memory
 	rz_debug_session_add_reg_change(s, 0, 0x100, 0x41424344);
-	rz_debug_session_add_mem_change(s, 0x7ffffffff000, 0xaa);
-	rz_debug_session_add_mem_change(s, 0x7ffffffff001, 0x00);
+	rz_debug_session_add_mem_change(s, 0x7ffffffff000, (const ut8 *)"\xaa", 1);
+	rz_debug_session_add_mem_change(s, 0x7ffffffff001, (const ut8 *)"\x00", 1);
 	s->maxcnum++;
 	s->cnum++;
 
 	rz_debug_session_add_reg_change(s, 0, 0x100, 0xdeadbeef);
-	rz_debug_session_add_mem_change(s, 0x7ffffffff000, 0xbb);
-	rz_debug_session_add_mem_change(s, 0x7ffffffff001, 0x01);
+	rz_debug_session_add_mem_change(s, 0x7ffffffff000, (const ut8 *)"\xbb\x01", 2);
 
 	// Checkpoints
 	RzDebugCheckpoint checkpoint = { 0 };
@@ -75,8 +77,9 @@ RzDebugSession *ref_session() {
 	snap->perm = 7;
 	snap->user = 0;
 	snap->shared = true;
-	snap->data = malloc(snap->size);
-	memset(snap->data, 0xf0, snap->size);
+	ut8 data[0x100];
+	memset(data, 0xf0, sizeof(data));
+	rz_debug_snap_set_data(snap, data);
 	rz_list_append(checkpoint.snaps, snap);
 	rz_vector_push(s->checkpoints, &checkpoint);
 
@@ -123,20 +126,18 @@ static bool compare_registers_cb(void *user, const ut64 key, const void *value)
 	return true;
 }
 
-static bool compare_memory_cb(void *user, const ut64 key, const void *value) {
+static bool memory_eq(RzDebugSession *actual, RzDebugSession *expected) {
 	RzDebugChangeMem *actual_mem, *expected_mem;
-	HtUP *ref = user;
-	RzVector *actual_vmem = (RzVector *)value;
-
-	RzVector *expected_vmem = ht_up_find(ref, key, NULL);
-	mu_assert("vmem not found", expected_vmem);
-	mu_assert_eq(actual_vmem->len, expected_vmem->len, "vmem length");
+	mu_assert_eq(actual->memory->len, expected->memory->len, "memory length");
 
 	size_t i;
-	rz_vector_enumerate(actual_vmem, actual_mem, i) {
-		expected_mem = rz_vector_index_ptr(expected_vmem, i);
+	rz_vector_enumerate(actual->memory, actual_mem, i) {
+		expected_mem = rz_vector_index_ptr(expected->memory, i);
 		mu_assert_eq(actual_mem->cnum, expected_mem->cnum, "cnum");
-		mu_assert_eq(actual_mem->data, expected_mem->data, "data");
+		mu_assert_eq(actual_mem->addr, expected_mem->addr, "addr");
+		mu_assert_eq(actual_mem->size, expected_mem->size, "size");
+		mu_assert_memeq((ut8 *)rz_vector_index_ptr(actual->memory_data, actual_mem->data),
+			(ut8 *)rz_vector_index_ptr(expected->memory_data, expected_mem->data), expected_mem->size, "data");
 	}
 	return true;
 }
@@ -157,7 +158,11 @@ static bool snap_eq(RzDebugSnap *actual, RzDebugSnap *expected) {
 	mu_assert_eq(actual->perm, expected->perm, "snap perm");
 	mu_assert_eq(actual->user, expected->user, "snap user");
 	mu_assert_eq(actual->shared, expected->shared, "snap shared");
-	mu_assert_memeq(actual->data, expected->data, expected->size, "snap data");
+	ut8 *actual_data = rz_debug_snap_get_data(actual);
+	ut8 *expected_data = rz_debug_snap_get_data(expected);
+	mu_assert_memeq(actual_data, expected_data, expected->size, "snap data");
+	free(actual_data);
+	free(expected_data);
 	return true;
 }
 
@@ -171,7 +176,7 @@ static bool test_session_load(void) {
 	// Registers
 	ht_up_foreach(s->registers, compare_registers_cb, ref->registers);
 	// Memory
-	ht_up_foreach(s->memory, compare_memory_cb, ref->memory);
+	mu_assert_true(memory_eq(s, ref), "memory");
 	// Checkpoints
 	size_t i, chkpt_idx;
 	RzDebugCheckpoint *chkpt, *ref_chkpt;
@@ -198,9 +203,236 @@ static bool test_session_load(void) {
 	mu_end;
 }
 
+static bool test_session_load_shared_pages(void) {
+	Sdb *db = ref_db();
+	Sdb *checkpoints_sdb = sdb_ns(db, "checkpoints", false);
+	sdb_set(checkpoints_sdb, "0x1", "{\"registers\":[],\"snaps\":["
+					"{\"name\":\"[stack]\",\"addr\":8796092882944,\"addr_end\":8796092883200,\"size\":256,"
+					"\"pages\":[\"bc710ad22c2d39f3c428dc94a0a7889d947ad0d602eaeca433e3fa84e3fd5beb\"],\"perm\":7,\"user\":0,\"shared\":true}"
+					"]}",
+		0);
+	RzDebugSession *s = rz_debug_session_new();
+	rz_debug_session_deserialize(s, db);
+
+	mu_assert_eq(s->checkpoints->len, 2, "checkpoints length");
+	RzDebugCheckpoint *a = rz_vector_index_ptr(s->checkpoints, 0);
+	RzDebugCheckpoint *b = rz_vector_index_ptr(s->checkpoints, 1);
+	RzDebugSnap *snap_a = rz_list_first(a->snaps);
+	RzDebugSnap *snap_b = rz_list_first(b->snaps);
+	mu_assert_notnull(snap_a, "snap");
+	mu_assert_notnull(snap_b, "snap");
+	mu_assert_ptreq(snap_a->pages[0], snap_b->pages[0], "page shared");
+	mu_assert_eq(snap_a->pages[0]->refs, 2, "shared page refs");
+
+	sdb_free(db);
+	rz_debug_session_free(s);
+	mu_end;
+}
+
+static bool test_session_load_snap_data(void) {
+	RzDebugSession *ref = ref_session();
+	Sdb *db = ref_db();
+	sdb_ns_unset(db, "pages", NULL);
+	// contents of the snap saved by older versions
+	Sdb *checkpoints_sdb = sdb_ns(db, "checkpoints", false);
+	sdb_set(checkpoints_sdb, "0x0", "{\"registers\":[],\"snaps\":["
+					"{\"name\":\"[stack]\",\"addr\":8796092882944,\"addr_end\":8796092883200,\"size\":256,"
+					"\"data\":\"8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8PDw8A==\",\"perm\":7,\"user\":0,\"shared\":true}"
+					"]}",
+		0);
+	RzDebugSession *s = rz_debug_session_new();
+	rz_debug_session_deserialize(s, db);
+
+	mu_assert_eq(s->checkpoints->len, 1, "checkpoints length");
+	RzDebugCheckpoint *actual = rz_vector_index_ptr(s->checkpoints, 0);
+	RzDebugCheckpoint *expected = rz_vector_index_ptr(ref->checkpoints, 0);
+	mu_assert_eq(rz_list_length(actual->snaps), 1, "snaps length");
+	mu_assert_true(snap_eq(rz_list_first(actual->snaps), rz_list_first(expected->snaps)), "snap");
+
+	sdb_free(db);
+	rz_debug_session_free(s);
+	rz_debug_session_free(ref);
+	mu_end;
+}
+
+static bool test_session_load_byte_memory(void) {
+	Sdb *db = ref_db();
+	Sdb *memory_sdb = sdb_ns(db, "memory", false);
+	sdb_reset(memory_sdb);
+	sdb_set(memory_sdb, "0x7ffffffff000", "[{\"cnum\":0,\"data\":170},{\"cnum\":1,\"data\":187}]", 0);
+	RzDebugSession *s = rz_debug_session_new();
+	rz_debug_session_deserialize(s, db);
+
+	mu_assert_eq(s->memory->len, 2, "memory length");
+	RzDebugChangeMem *mem = rz_vector_index_ptr(s->memory, 0);
+	mu_assert_eq(mem->cnum, 0, "cnum");
+	mu_assert_eq(mem->addr, 0x7ffffffff000, "addr");
+	mu_assert_eq(mem->size, 1, "size");
+	mu_assert_eq(*(ut8 *)rz_vector_index_ptr(s->memory_data, mem->data), 0xaa, "data");
+	mem = rz_vector_index_ptr(s->memory, 1);
+	mu_assert_eq(mem->cnum, 1, "cnum");
+	mu_assert_eq(*(ut8 *)rz_vector_index_ptr(s->memory_data, mem->data), 0xbb, "data");
+
+	sdb_free(db);
+	rz_debug_session_free(s);
+	mu_end;
+}
+
+static bool test_session_load_memory_order(void) {
+	Sdb *db = ref_db();
+	Sdb *memory_sdb = sdb_ns(db, "memory", false);
+	sdb_reset(memory_sdb);
+	// many overlapping writes in the same step, surrounded by other steps
+	RzStrBuf sb;
+	rz_strbuf_init(&sb);
+	rz_strbuf_append(&sb, "[");
+	for (int i = 0; i < 64; i++) {
+		rz_strbuf_appendf(&sb, "%s{\"addr\":4096,\"data\":%d}", i ? "," : "", i);
+	}
+	rz_strbuf_append(&sb, "]");
+	sdb_set(memory_sdb, "0x0", "[{\"addr\":4096,\"data\":200},{\"addr\":4096,\"data\":201}]", 0);
+	sdb_set(memory_sdb, "0x1", rz_strbuf_get(&sb), 0);
+	sdb_set(memory_sdb, "0x2", "[{\"addr\":4096,\"data\":202}]", 0);
+	rz_strbuf_fini(&sb);
+	RzDebugSession *s = rz_debug_session_new();
+	rz_debug_session_deserialize(s, db);
+
+	mu_assert_eq(s->memory->len, 67, "memory length");
+	RzDebugChangeMem *mem;
+	size_t i;
+	rz_vector_enumerate(s->memory, mem, i) {
+		int cnum = i < 2 ? 0 : (i < 66 ? 1 : 2);
+		int data = i < 2 ? 200 + i : (i < 66 ? i - 2 : 202);
+		mu_assert_eq(mem->cnum, cnum, "cnum");
+		mu_assert_eq(*(ut8 *)rz_vector_index_ptr(s->memory_data, mem->data), data, "writes of a step in order");
+	}
+
+	sdb_free(db);
+	rz_debug_session_free(s);
+	mu_end;
+}
+
+static bool test_snap_pages(void) {
+	RzBreakpointContext bp_ctx = { 0 };
+	RzDebug *dbg = rz_debug_new(&bp_ctx);
+	RzIO *io = rz_io_new();
+	rz_io_bind(io, &dbg->iob);
+	rz_io_open_at(io, "malloc://0x2800", RZ_PERM_RW, 0644, 0x10000, NULL);
+	RzDebugMap *map = rz_debug_map_new("map", 0x10000, 0x12800, RZ_PERM_RW, 0);
+	rz_io_write_at(io, 0x10000, (const ut8 *)"first page", 10);
+
+	RzDebugSnap *a = rz_debug_snap_map(dbg, map);
+	mu_assert_notnull(a, "snap");
+	mu_assert_eq(a->size, 0x2800, "snap size");
+	rz_io_write_at(io, 0x11000, (const ut8 *)"second page", 11);
+	RzDebugSnap *b = rz_debug_snap_map_from(dbg, map, a);
+	mu_assert_notnull(b, "snap");
+
+	// only the changed page is copied
+	mu_assert_ptreq(b->pages[0], a->pages[0], "unchanged page shared");
+	mu_assert_ptrneq(b->pages[1], a->pages[1], "changed page copied");
+	mu_assert_ptreq(b->pages[2], a->pages[2], "unchanged last page shared");
+	mu_assert_eq(a->pages[0]->refs, 2, "shared page refs");
+	mu_assert_memeq(b->pages[1]->data, (const ut8 *)"second page", 11, "changed page data");
+	mu_assert_false(rz_debug_snap_is_equal(dbg, a, b), "snaps differ");
+
+	// restoring the first snap brings the changed page back
+	rz_debug_snap_restore(dbg, a);
+	ut8 buf[11];
+	rz_io_read_at(io, 0x11000, buf, sizeof(buf));
+	mu_assert_memeq(buf, (const ut8 *)"\0\0\0\0\0\0\0\0\0\0\0", sizeof(buf), "restored page");
+	RzDebugSnap *c = rz_debug_snap_map_from(dbg, map, b);
+	mu_assert_true(rz_debug_snap_is_equal(dbg, a, c), "restored snap");
+	ut8 *data = rz_debug_snap_get_data(c);
+	mu_assert_memeq(data, (const ut8 *)"first page", 10, "snap data");
+	free(data);
+
+	rz_debug_snap_free(a);
+	mu_assert_eq(b->pages[0]->refs, 2, "shared page refs after free");
+	rz_debug_snap_free(b);
+	rz_debug_snap_free(c);
+	rz_debug_map_free(map);
+	rz_io_free(io);
+	rz_debug_free(dbg);
+	mu_end;
+}
+
+static void record_write(RzDebug *dbg, ut32 cnum, ut64 addr, const char *data) {
+	dbg->session->cnum = dbg->session->maxcnum = cnum;
+	rz_io_write_at(dbg->iob.io, addr, (const ut8 *)data, strlen(data));
+	rz_debug_session_add_mem_change(dbg->session, addr, (const ut8 *)data, strlen(data));
+}
+
+static void record_checkpoint(RzDebug *dbg, RzDebugMap *map) {
+	RzVector *checkpoints = dbg->session->checkpoints;
+	RzDebugCheckpoint *last = rz_vector_empty(checkpoints) ? NULL : rz_vector_tail(checkpoints);
+	RzDebugCheckpoint checkpoint = { 0 };
+	checkpoint.cnum = dbg->session->cnum;
+	checkpoint.snaps = rz_list_newf((RzListFree)rz_debug_snap_free);
+	rz_list_append(checkpoint.snaps, rz_debug_snap_map_from(dbg, map, last ? rz_list_first(last->snaps) : NULL));
+	rz_vector_push(checkpoints, &checkpoint);
+}
+
+static bool test_session_restore_memory(void) {
+	RzBreakpointContext bp_ctx = { 0 };
+	RzDebug *dbg = rz_debug_new(&bp_ctx);
+	RzIO *io = rz_io_new();
+	rz_io_bind(io, &dbg->iob);
+	rz_io_open_at(io, "malloc://0x2800", RZ_PERM_RW, 0644, 0x10000, NULL);
+	RzDebugMap *map = rz_debug_map_new("map", 0x10000, 0x12800, RZ_PERM_RW, 0);
+	dbg->session = rz_debug_session_new();
+
+	record_checkpoint(dbg, map);
+	record_write(dbg, 1, 0x10010, "AAAA");
+	record_write(dbg, 2, 0x10012, "BBBB");
+	// only seen by the next checkpoint
+	rz_io_write_at(io, 0x12000, (const ut8 *)"ZZ", 2);
+	record_checkpoint(dbg, map);
+	record_write(dbg, 3, 0x11000, "CC");
+	record_write(dbg, 4, 0x10010, "DD");
+	// memory untouched between the steps is not written
+	rz_io_write_at(io, 0x10100, (const ut8 *)"QQ", 2);
+
+	ut8 buf[6];
+	mu_assert_true(rz_debug_goto_cnum(dbg, 3), "goto 3");
+	rz_io_read_at(io, 0x10010, buf, 6);
+	mu_assert_memeq(buf, (const ut8 *)"AABBBB", 6, "write undone");
+	rz_io_read_at(io, 0x11000, buf, 2);
+	mu_assert_memeq(buf, (const ut8 *)"CC", 2, "write kept");
+	rz_io_read_at(io, 0x10100, buf, 2);
+	mu_assert_memeq(buf, (const ut8 *)"QQ", 2, "untouched memory");
+
+	mu_assert_true(rz_debug_goto_cnum(dbg, 1), "goto 1");
+	rz_io_read_at(io, 0x10010, buf, 6);
+	mu_assert_memeq(buf, (const ut8 *)"AAAA\0\0", 6, "writes undone across checkpoints");
+	rz_io_read_at(io, 0x11000, buf, 2);
+	mu_assert_memeq(buf, (const ut8 *)"\0\0", 2, "writes undone across checkpoints");
+	rz_io_read_at(io, 0x12000, buf, 2);
+	mu_assert_memeq(buf, (const ut8 *)"\0\0", 2, "changed page restored");
+
+	mu_assert_true(rz_debug_goto_cnum(dbg, 4), "goto 4");
+	rz_io_read_at(io, 0x10010, buf, 6);
+	mu_assert_memeq(buf, (const ut8 *)"DDBBBB", 6, "writes redone");
+	rz_io_read_at(io, 0x11000, buf, 2);
+	mu_assert_memeq(buf, (const ut8 *)"CC", 2, "writes redone across checkpoints");
+	rz_io_read_at(io, 0x12000, buf, 2);
+	mu_assert_memeq(buf, (const ut8 *)"ZZ", 2, "changed page restored");
+
+	rz_debug_map_free(map);
+	rz_io_free(io);
+	rz_debug_free(dbg);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test(test_session_save);
 	mu_run_test(test_session_load);
+	mu_run_test(test_session_load_shared_pages);
+	mu_run_test(test_session_load_snap_data);
+	mu_run_test(test_session_load_byte_memory);
+	mu_run_test(test_session_load_memory_order);
+	mu_run_test(test_snap_pages);
+	mu_run_test(test_session_restore_memory);
 	return tests_passed != tests_run;
 }
 
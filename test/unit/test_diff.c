@@ -46,6 +46,90 @@ bool test_rz_diff_distances(void) {
 	mu_end;
 }
 
+static ut32 naive_levenshtein(const ut8 *a, ut32 la, const ut8 *b, ut32 lb) {
+	ut32 *row = malloc((lb + 1) * sizeof(ut32));
+	for (ut32 j = 0; j <= lb; j++) {
+		row[j] = j;
+	}
+	for (ut32 i = 1; i <= la; i++) {
+		ut32 diag = row[0];
+		row[0] = i;
+		for (ut32 j = 1; j <= lb; j++) {
+			ut32 up = row[j];
+			ut32 cost = diag + (a[i - 1] != b[j - 1]);
+			row[j] = RZ_MIN(cost, RZ_MIN(up, row[j - 1]) + 1);
+			diag = up;
+		}
+	}
+	ut32 distance = row[lb];
+	free(row);
+	return distance;
+}
+
+static ut32 naive_myers(const ut8 *a, ut32 la, const ut8 *b, ut32 lb) {
+	ut32 *row = calloc(lb + 1, sizeof(ut32));
+	for (ut32 i = 1; i <= la; i++) {
+		ut32 diag = 0;
+		for (ut32 j = 1; j <= lb; j++) {
+			ut32 up = row[j];
+			row[j] = a[i - 1] == b[j - 1] ? diag + 1 : RZ_MAX(up, row[j - 1]);
+			diag = up;
+		}
+	}
+	ut32 distance = la + lb - 2 * row[lb];
+	free(row);
+	return distance;
+}
+
+bool test_rz_diff_distances_random(void) {
+	// sizes around the 64 bits blocks used by the bit-parallel algorithms
+	static const ut32 sizes[] = { 1, 7, 63, 64, 65, 127, 128, 129, 200, 300 };
+	ut8 a[300], b[310];
+	ut32 distance, expected;
+	ut32 seed = 1337;
+
+	for (ut32 i = 0; i < RZ_ARRAY_SIZE(sizes); i++) {
+		for (ut32 round = 0; round < 16; round++) {
+			ut32 la = sizes[i], lb = sizes[(i + round) % RZ_ARRAY_SIZE(sizes)];
+			ut32 alphabet = 2 + round % 4;
+			for (ut32 k = 0; k < la; k++) {
+				seed = seed * 1103515245 + 12345;
+				a[k] = (seed >> 16) % alphabet;
+			}
+			if (round & 1) {
+				// similar buffers, with a few edits
+				lb = la;
+				memcpy(b, a, la);
+				for (ut32 k = 0; k < 1 + round; k++) {
+					seed = seed * 1103515245 + 12345;
+					b[(seed >> 16) % lb] = (seed >> 8) % alphabet;
+				}
+			} else {
+				for (ut32 k = 0; k < lb; k++) {
+					seed = seed * 1103515245 + 12345;
+					b[k] = (seed >> 16) % alphabet;
+				}
+			}
+
+			expected = naive_levenshtein(a, la, b, lb);
+			mu_assert_true(rz_diff_levenshtein_distance(a, la, b, lb, &distance, NULL), "rz_diff_levenshtein_distance");
+			mu_assert_eq(distance, expected, "levenshtein distance");
+			mu_assert_true(rz_diff_levenshtein_distance_within(a, la, b, lb, expected, &distance), "distance within the exact bound");
+			mu_assert_eq(distance, expected, "levenshtein distance within the bound");
+			if (expected) {
+				mu_assert_false(rz_diff_levenshtein_distance_within(a, la, b, lb, expected - 1, &distance), "distance above the bound");
+				mu_assert_true(rz_diff_levenshtein_distance_within(b, lb, a, la, expected + 3, &distance), "distance within a larger bound");
+				mu_assert_eq(distance, expected, "levenshtein distance within a larger bound");
+			}
+
+			expected = naive_myers(a, la, b, lb);
+			mu_assert_true(rz_diff_myers_distance(a, la, b, lb, &distance, NULL), "rz_diff_myers_distance");
+			mu_assert_eq(distance, expected, "myers distance");
+		}
+	}
+	mu_end;
+}
+
 bool test_rz_diff_unified_lines(void) {
 	RzDiff *diff = NULL;
 	char *result = NULL;
@@ -259,6 +343,7 @@ bool test_rz_diff_unified_bytes(void) {
 
 int all_tests() {
 	mu_run_test(test_rz_diff_distances);
+	mu_run_test(test_rz_diff_distances_random);
 	mu_run_test(test_rz_diff_unified_lines);
 	mu_run_test(test_rz_diff_unified_bytes);
 	return tests_passed != tests_run;
@@ -111,6 +111,18 @@ bool test_rz_file_mmap(void) {
 	mu_end;
 }
 
+bool test_rz_file_mtime(void) {
+	char *filename = rz_file_temp(NULL);
+	mu_assert_true(rz_file_dump(filename, (const ut8 *)"rizin", 5, false), "file written");
+	ut64 now = rz_time_now() / RZ_USEC_PER_SEC;
+	ut64 mtime = rz_file_mtime(filename);
+	mu_assert_true(mtime && mtime <= now + 1 && mtime + 60 >= now, "modified just now");
+	rz_file_rm(filename);
+	mu_assert_eq(rz_file_mtime(filename), 0, "no mtime once removed");
+	free(filename);
+	mu_end;
+}
+
 int all_tests() {
 	size_t i;
 	for (i = 0; i < RELPATH_CASES_COUNT; i++) {
@@ -120,6 +132,7 @@ int all_tests() {
 	mu_run_test(test_rz_file_basename);
 	mu_run_test(test_rz_file_dos_basename);
 	mu_run_test(test_rz_file_mmap);
+	mu_run_test(test_rz_file_mtime);
 	return tests_passed != tests_run;
 }
 
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 
 #include <math.h>
+#include <rz_core.h>
 #include <rz_flirt.h>
 #include <rz_util.h>
 #include "minunit.h"
@@ -48,6 +49,94 @@ test_flirt_pat_def(parse_multiline, 5,
 	"31C04885D2741F488D4417FF4839C77610EB1D0F1F4400004883E8014839C777 13 9867 0033 :0000 Curl_memrchr \n"
 	"---\n");
 
+static RzFlirtNode *parse_pat(const char *string) {
+	RzBuffer *buffer = rz_buf_new_with_string(string);
+	if (!buffer) {
+		return NULL;
+	}
+	RzFlirtNode *node = rz_sign_flirt_parse_string_pattern_from_buffer(buffer, RZ_FLIRT_NODE_OPTIMIZE_NONE, NULL);
+	rz_buf_free(buffer);
+	return node;
+}
+
+bool test_flirt_node_merge(void) {
+	RzFlirtNode *a = parse_pat(
+		"31C04885D2741F488D4417FF4839C77610EB1D0F1F4400004883E8014839C777 13 9867 0033 :0000 Curl_memrchr \n"
+		"---\n");
+	RzFlirtNode *b = parse_pat(
+		"0FB707C366662E0F1F840000000000908B07C366662E0F1F8400000000006690 08 DB34 0028 :0000 Curl_read16_le :0010 Curl_read32_le :0020 Curl_read16_be \n"
+		"4154554889FD534889F3C60700E8........C6441DFF004189C485C07515BE2E 07 FAEE 003B :0000 Curl_gethostname ^000E gethostname ^0027 strchr ........4885C07403C600004489E05B5D415CC3\n"
+		"---\n");
+	mu_assert_notnull(a, "first node");
+	mu_assert_notnull(b, "second node");
+	ut32 count = rz_sign_flirt_node_count_nodes(a) + rz_sign_flirt_node_count_nodes(b);
+
+	RzFlirtNode *root = RZ_NEW0(RzFlirtNode);
+	mu_assert_notnull(root, "root");
+	mu_assert_true(rz_sign_flirt_node_merge(root, a), "merge first node");
+	mu_assert_true(rz_sign_flirt_node_merge(root, b), "merge second node");
+	mu_assert_eq(rz_list_length(root->child_list), 2, "merged roots");
+	mu_assert_ptreq(rz_list_first(root->child_list), a, "merged in order");
+	mu_assert_eq(rz_sign_flirt_node_count_nodes(root), count, "all the signatures are kept");
+	rz_sign_flirt_node_free(root);
+	mu_end;
+}
+
+#define FLIRT_TEST_FCNS 120
+
+static bool flirt_apply_files(size_t max_threads) {
+	// the same pattern is in both files, the first one wins
+	RzFlirtNode *a = parse_pat(
+		"1111111111111111111111111111111111111111111111111111111111111111 00 0000 0040 :0000 alpha\n"
+		"---\n");
+	RzFlirtNode *b = parse_pat(
+		"1111111111111111111111111111111111111111111111111111111111111111 00 0000 0040 :0000 beta\n"
+		"2222222222222222222222222222222222222222222222222222222222222222 00 0000 0040 :0000 gamma\n"
+		"---\n");
+	RzFlirtNode *root = RZ_NEW0(RzFlirtNode);
+	mu_assert_notnull(root, "root");
+	mu_assert_true(a && rz_sign_flirt_node_merge(root, a), "merge first file");
+	mu_assert_true(b && rz_sign_flirt_node_merge(root, b), "merge second file");
+
+	RzCore *core = rz_core_new();
+	mu_assert_notnull(core, "core");
+	mu_assert_notnull(rz_io_open_at(core->io, "malloc://0x2000", RZ_PERM_RW, 0644, 0x1000, NULL), "open");
+	for (ut32 i = 0; i < FLIRT_TEST_FCNS; i++) {
+		ut64 addr = 0x1000 + i * 0x40;
+		ut8 bytes[0x20];
+		memset(bytes, 0x11 * (i % 3 + 1), sizeof(bytes));
+		rz_io_write_at(core->io, addr, bytes, sizeof(bytes));
+		char *name = rz_str_newf("fcn.%08" PFMT64x, addr);
+		RzAnalysisFunction *fcn = rz_analysis_create_function(core->analysis, name, addr, RZ_ANALYSIS_FCN_TYPE_FCN);
+		free(name);
+		mu_assert_notnull(fcn, "function");
+		RzAnalysisBlock *block = rz_analysis_create_block(core->analysis, addr, 0x40);
+		mu_assert_notnull(block, "block");
+		rz_analysis_function_add_block(fcn, block);
+		rz_analysis_block_unref(block);
+	}
+
+	mu_assert_true(rz_sign_flirt_apply_node(core->analysis, root, max_threads), "apply");
+	for (ut32 i = 0; i < FLIRT_TEST_FCNS; i++) {
+		RzAnalysisFunction *fcn = rz_analysis_get_function_at(core->analysis, 0x1000 + i * 0x40);
+		mu_assert_notnull(fcn, "function");
+		const char *expect = i % 3 == 0 ? "flirt.alpha" : (i % 3 == 1 ? "flirt.gamma" : "fcn.");
+		mu_assert_true(rz_str_startswith(fcn->name, expect), "function name");
+	}
+	mu_assert_notnull(rz_analysis_get_function_byname(core->analysis, "flirt.alpha"), "first match");
+	mu_assert_null(rz_analysis_get_function_byname(core->analysis, "flirt.beta"), "shadowed by the first file");
+
+	rz_core_free(core);
+	rz_sign_flirt_node_free(root);
+	return true;
+}
+
+bool test_flirt_apply_node(void) {
+	mu_assert_true(flirt_apply_files(1), "single thread");
+	mu_assert_true(flirt_apply_files(4), "4 threads");
+	mu_end;
+}
+
 int all_tests() {
 	test_flirt_pat_run(parse_signature);
 	test_flirt_pat_run(parse_comment);
@@ -55,6 +144,8 @@ int all_tests() {
 	test_flirt_pat_run(parse_large_function);
 	test_flirt_pat_run(parse_large_offset);
 	test_flirt_pat_run(parse_multiline);
+	mu_run_test(test_flirt_node_merge);
+	mu_run_test(test_flirt_apply_node);
 	return tests_passed != tests_run;
 }
 
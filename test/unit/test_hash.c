@@ -3,6 +3,7 @@
 
 #include <rz_util.h>
 #include <rz_hash.h>
+#include <rz_th.h>
 #include "minunit.h"
 
 typedef struct {
@@ -240,11 +241,45 @@ bool test_message_digest_small_block_stringified() {
 	mu_end;
 }
 
+bool test_message_digest_update_mt() {
+	char message[256];
+	char *result = NULL;
+	RzHash *rh = rz_hash_new();
+	RzHashCfg *md = rz_hash_cfg_new(rh);
+	mu_assert_notnull(md, "rz_hash_cfg_new");
+
+	const char *algos[] = { "md5", "sha1", "sha256", "crc32" };
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(algos); ++i) {
+		mu_assert_true(rz_hash_cfg_configure(md, algos[i]), "rz_hash_cfg_configure");
+	}
+	mu_assert_true(rz_hash_cfg_init(md), "rz_hash_cfg_init");
+	mu_assert_true(rz_hash_cfg_update_mt(md, (const ut8 *)"pass", 4, RZ_THREAD_POOL_ALL_CORES), "rz_hash_cfg_update_mt");
+	mu_assert_true(rz_hash_cfg_update_mt(md, (const ut8 *)"word", 4, 2), "rz_hash_cfg_update_mt with 2 threads");
+	mu_assert_true(rz_hash_cfg_final(md), "rz_hash_cfg_final");
+
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(hashes_to_test); ++i) {
+		hash_data_t *hd = &hashes_to_test[i];
+		for (size_t j = 0; j < RZ_ARRAY_SIZE(algos); ++j) {
+			if (strcmp(hd->algo, algos[j])) {
+				continue;
+			}
+			result = rz_hash_cfg_get_result_string(md, hd->algo, NULL, false);
+			snprintf(message, sizeof(message), "rz_hash_cfg_update_mt %s digest", hd->algo);
+			mu_assert_streq(result, hd->expected, message);
+			free(result);
+		}
+	}
+	rz_hash_cfg_free(md);
+	rz_hash_free(rh);
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_message_digest_configure);
 	mu_run_test(test_message_digest_api_stringified);
 	mu_run_test(test_message_digest_hmac_stringified);
 	mu_run_test(test_message_digest_small_block_stringified);
+	mu_run_test(test_message_digest_update_mt);
 	return tests_passed != tests_run;
 }
 
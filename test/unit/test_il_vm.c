@@ -510,6 +510,49 @@ static bool test_rzil_vm_op_repeat() {
 	mu_end;
 }
 
+static bool test_rzil_vm_resolve_vars() {
+	RzILVM *vm = rz_il_vm_new(0, 8, false);
+	RzILVar *r0 = rz_il_vm_create_global_var(vm, "r0", rz_il_sort_pure_bv(8));
+	rz_il_vm_set_global_var(vm, "r0", rz_il_value_new_bitv(rz_bv_new_from_ut64(8, 5)));
+
+	// t = r0 + 1; r0 = t
+	RzILOpEffect *op = rz_il_op_new_seq(
+		rz_il_op_new_set("t", true, rz_il_op_new_add(rz_il_op_new_var("r0", RZ_IL_VAR_KIND_GLOBAL), rz_il_op_new_bitv_from_ut64(8, 1))),
+		rz_il_op_new_set("r0", false, rz_il_op_new_var("t", RZ_IL_VAR_KIND_LOCAL)));
+	rz_il_vm_resolve_vars(vm, op);
+	RzILOpEffect *set_t = op->op.seq.x;
+	RzILOpEffect *set_r0 = op->op.seq.y;
+	mu_assert_null(set_t->op.set.slot, "local set not resolved");
+	mu_assert_ptreq(set_t->op.set.x->op.add.x->op.var.slot, r0, "global read resolved");
+	mu_assert_ptreq(set_r0->op.set.slot, r0, "global set resolved");
+	mu_assert_null(set_r0->op.set.x->op.var.slot, "local read not resolved");
+
+	for (ut64 i = 0; i < 2; i++) {
+		mu_assert_true(rz_il_vm_step(vm, op, 0x10), "step");
+		RzILVal *val = rz_il_vm_get_var_value(vm, RZ_IL_VAR_KIND_GLOBAL, "r0");
+		mu_assert_eq(rz_bv_to_ut64(val->data.bv), 6 + i, "r0 incremented");
+		bool read = false, written = false;
+		void **it;
+		rz_pvector_foreach (vm->events, it) {
+			RzILEvent *evt = *it;
+			if (evt->type == RZ_IL_EVENT_VAR_READ && !strcmp(evt->data.var_read.variable, "r0")) {
+				mu_assert_eq(rz_bv_to_ut64(evt->data.var_read.value->data.bv), 5 + i, "read event value");
+				read = true;
+			} else if (evt->type == RZ_IL_EVENT_VAR_WRITE) {
+				mu_assert_streq(evt->data.var_write.variable, "r0", "write event variable");
+				mu_assert_eq(rz_bv_to_ut64(evt->data.var_write.old_value->data.bv), 5 + i, "write event old value");
+				mu_assert_eq(rz_bv_to_ut64(evt->data.var_write.new_value->data.bv), 6 + i, "write event new value");
+				written = true;
+			}
+		}
+		mu_assert_true(read && written, "same events as by name");
+	}
+
+	rz_il_op_effect_free(op);
+	rz_il_vm_free(vm);
+	mu_end;
+}
+
 static void hook_test(RzILVM *vm, RzILOpEffect *op) {
 	rz_il_vm_set_global_var(vm, "myvar", rz_il_value_new_bitv(rz_bv_new_from_ut64(32, 0xc0ffee)));
 }
@@ -1019,6 +1062,80 @@ static bool test_rzil_vm_op_fcast() {
 	mu_end;
 }
 
+static bool test_rzil_vm_op_small_bitv() {
+	// bitvectors of up to 64 bits are computed in place, check them against the generic rz_bv_* functions
+	static const ut32 lengths[] = { 1, 5, 8, 31, 32, 33, 63, 64 };
+	RzILVM *vm = rz_il_vm_new(0, 8, true);
+	ut64 seed = 0x1234;
+
+#define EVAL_CHECK(op_expr, ref_expr, msg) \
+	do { \
+		RzILOpPure *op = op_expr; \
+		RzBitVector *r = rz_il_evaluate_bitv(vm, op); \
+		RzBitVector *ref = ref_expr; \
+		rz_il_op_pure_free(op); \
+		mu_assert_notnull(r, "eval"); \
+		mu_assert_true(rz_bv_eq(r, ref), msg); \
+		rz_bv_free(r); \
+		rz_bv_free(ref); \
+	} while (0)
+#define BITV(bv) rz_il_op_new_bitv(rz_bv_dup(bv))
+
+	for (ut32 i = 0; i < RZ_ARRAY_SIZE(lengths); i++) {
+		ut32 len = lengths[i];
+		for (ut32 round = 0; round < 8; round++) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			ut64 vx = round == 0 ? 0 : round == 1 ? UT64_MAX : seed;
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			ut64 vy = round == 2 ? 0 : round == 3 ? UT64_MAX : seed >> (round * 7);
+			RzBitVector *x = rz_bv_new_from_ut64(len, vx);
+			RzBitVector *y = rz_bv_new_from_ut64(len, vy);
+
+			EVAL_CHECK(rz_il_op_new_add(BITV(x), BITV(y)), rz_bv_add(x, y, NULL), "add");
+			EVAL_CHECK(rz_il_op_new_sub(BITV(x), BITV(y)), rz_bv_sub(x, y, NULL), "sub");
+			EVAL_CHECK(rz_il_op_new_mul(BITV(x), BITV(y)), rz_bv_mul(x, y), "mul");
+			EVAL_CHECK(rz_il_op_new_div(BITV(x), BITV(y)), rz_bv_div(x, y), "div");
+			EVAL_CHECK(rz_il_op_new_mod(BITV(x), BITV(y)), rz_bv_mod(x, y), "mod");
+			EVAL_CHECK(rz_il_op_new_log_and(BITV(x), BITV(y)), rz_bv_and(x, y), "and");
+			EVAL_CHECK(rz_il_op_new_log_or(BITV(x), BITV(y)), rz_bv_or(x, y), "or");
+			EVAL_CHECK(rz_il_op_new_log_xor(BITV(x), BITV(y)), rz_bv_xor(x, y), "xor");
+			EVAL_CHECK(rz_il_op_new_neg(BITV(x)), rz_bv_neg(x), "neg");
+			EVAL_CHECK(rz_il_op_new_log_not(BITV(x)), rz_bv_not(x), "not");
+			EVAL_CHECK(rz_il_op_new_append(BITV(x), BITV(y)), rz_bv_append(x, y), "append");
+
+			ut32 shifts[] = { 0, 1, len - 1, len, len + 3 };
+			for (ut32 s = 0; s < RZ_ARRAY_SIZE(shifts); s++) {
+				for (int fill = 0; fill < 2; fill++) {
+					RzBitVector *expect = rz_bv_dup(x);
+					rz_bv_lshift_fill(expect, shifts[s], fill);
+					EVAL_CHECK(rz_il_op_new_shiftl(fill ? rz_il_op_new_b1() : rz_il_op_new_b0(), BITV(x), rz_il_op_new_bitv_from_ut64(32, shifts[s])), expect, "shiftl");
+					expect = rz_bv_dup(x);
+					rz_bv_rshift_fill(expect, shifts[s], fill);
+					EVAL_CHECK(rz_il_op_new_shiftr(fill ? rz_il_op_new_b1() : rz_il_op_new_b0(), BITV(x), rz_il_op_new_bitv_from_ut64(32, shifts[s])), expect, "shiftr");
+				}
+			}
+
+			ut32 casts[] = { 1, len, len + 1, 64, 100 };
+			for (ut32 c = 0; c < RZ_ARRAY_SIZE(casts); c++) {
+				for (int fill = 0; fill < 2; fill++) {
+					RzBitVector *expect = rz_bv_new(casts[c]);
+					rz_bv_set_all(expect, fill);
+					rz_bv_copy_nbits(x, 0, expect, 0, RZ_MIN(len, casts[c]));
+					EVAL_CHECK(rz_il_op_new_cast(casts[c], fill ? rz_il_op_new_b1() : rz_il_op_new_b0(), BITV(x)), expect, "cast");
+				}
+			}
+
+			rz_bv_free(x);
+			rz_bv_free(y);
+		}
+	}
+
+#undef BITV
+#undef EVAL_CHECK
+	rz_il_vm_free(vm);
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_rzil_vm_init);
 	mu_run_test(test_rzil_vm_global_vars);
@@ -1035,6 +1152,7 @@ bool all_tests() {
 	mu_run_test(test_rzil_vm_op_goto_hook);
 	mu_run_test(test_rzil_vm_op_blk);
 	mu_run_test(test_rzil_vm_op_repeat);
+	mu_run_test(test_rzil_vm_resolve_vars);
 	mu_run_test(test_rzil_vm_op_load);
 	mu_run_test(test_rzil_vm_op_store);
 	mu_run_test(test_rzil_vm_op_loadw_le);
@@ -1045,6 +1163,7 @@ bool all_tests() {
 	mu_run_test(test_rzil_vm_op_shiftr);
 	mu_run_test(test_rzil_vm_op_shiftl);
 	mu_run_test(test_rzil_vm_op_compare);
+	mu_run_test(test_rzil_vm_op_small_bitv);
 	mu_run_test(test_rzil_vm_op_float);
 	mu_run_test(test_rzil_vm_op_fcast);
 	return tests_passed != tests_run;
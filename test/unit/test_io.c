@@ -3,6 +3,11 @@
 
 #include <rz_io.h>
 #include "minunit.h"
+#if __linux__
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <signal.h>
+#endif
 
 bool test_rz_io_cache(void) {
 	RzIO *io = rz_io_new();
@@ -58,6 +63,142 @@ bool test_rz_io_cache(void) {
 	mu_end;
 }
 
+bool test_rz_io_cache_push_pop(void) {
+	RzIO *io = rz_io_new();
+	rz_io_open(io, "malloc://15", RZ_PERM_RW, 0);
+	rz_io_write(io, (ut8 *)"ZZZZZZZZZZZZZZZ", 15);
+	io->cached = RZ_PERM_R;
+	mu_assert_true(rz_io_cache_push(io), "Cache push of an empty cache failed");
+	mu_assert_true(rz_io_cache_write(io, 0, (ut8 *)"AAAAA", 5), "Cache write at 0 failed");
+	mu_assert_true(rz_io_cache_pop(io), "Cache pop failed");
+	mu_assert_false(rz_io_cache_at(io, 0), "Cache shouldn't exist at 0 after pop");
+	mu_assert_true(rz_io_cache_write(io, 0, (ut8 *)"AAAAA", 5), "Cache write at 0 failed");
+	mu_assert_true(rz_io_cache_write(io, 10, (ut8 *)"BBBBB", 5), "Cache write at 10 failed");
+	mu_assert_true(rz_io_cache_push(io), "Cache push failed");
+	mu_assert_true(rz_io_cache_write(io, 3, (ut8 *)"CCCCCCCCC", 9), "Cache write at 3 failed");
+	mu_assert_eq(rz_io_cache_invalidate(io, 0, 1), 1, "Cache invalidate at 0 failed");
+	ut8 buf[15];
+	rz_io_read_at(io, 0, buf, sizeof(buf));
+	mu_assert_memeq(buf, (ut8 *)"ZZZCCCCCCCCCBBB", sizeof(buf), "IO read before pop doesn't match expected output");
+	mu_assert_true(rz_io_cache_pop(io), "Cache pop failed");
+	rz_io_read_at(io, 0, buf, sizeof(buf));
+	mu_assert_memeq(buf, (ut8 *)"AAAAAZZZZZBBBBB", sizeof(buf), "IO read after pop doesn't match expected output");
+	mu_assert_eq(rz_list_length(&io->cache_writes), 2, "Pop should restore the individual writes");
+	mu_assert_false(rz_io_cache_pop(io), "Cache pop without push should fail");
+	rz_io_free(io);
+	mu_end;
+}
+
+bool test_rz_io_cache_undo(void) {
+	RzIO *io = rz_io_new();
+	rz_io_open(io, "malloc://8", RZ_PERM_RW, 0);
+	rz_io_write(io, (ut8 *)"ZZZZZZZZ", 8);
+	mu_assert_true(rz_io_cache_write(io, 0, (ut8 *)"AAAA", 4), "Cache write at 0 failed");
+	mu_assert_true(rz_io_cache_write(io, 2, (ut8 *)"BBBBBB", 6), "Cache write at 2 failed");
+	mu_assert_true(rz_io_cache_write(io, 3, (ut8 *)"CC", 2), "Cache write at 3 failed");
+	RzList *writes = rz_io_cache_list(io);
+	mu_assert_eq(rz_list_length(writes), 3, "Cache list should contain every write");
+	RzIOCache *c = rz_list_get_n(writes, 0);
+	mu_assert_memeq(c->data, (ut8 *)"AAAA", 4, "First write doesn't match expected output");
+	c = rz_list_get_n(writes, 1);
+	mu_assert_memeq(c->data, (ut8 *)"BBBBBB", 6, "Second write doesn't match expected output");
+	mu_assert_memeq(c->odata, (ut8 *)"ZZZZZZ", 6, "Bytes before the second write don't match expected output");
+	c = rz_list_get_n(writes, 2);
+	mu_assert_memeq(c->data, (ut8 *)"CC", 2, "Third write doesn't match expected output");
+	rz_list_free(writes);
+	ut8 buf[8];
+	io->cached = RZ_PERM_R;
+	mu_assert_eq(rz_io_cache_invalidate(io, 6, 7), 1, "Invalidating the second write failed");
+	rz_io_read_at(io, 0, buf, sizeof(buf));
+	mu_assert_memeq(buf, (ut8 *)"AAACCZZZ", sizeof(buf), "IO read after removing a write below another doesn't match expected output");
+	mu_assert_false(rz_io_cache_at(io, 5), "Cache shouldn't exist at 5 after invalidate");
+	mu_assert_eq(rz_io_cache_invalidate(io, 4, 5), 1, "Invalidating the third write failed");
+	rz_io_read_at(io, 0, buf, sizeof(buf));
+	mu_assert_memeq(buf, (ut8 *)"AAAAZZZZ", sizeof(buf), "IO read after removing the last write doesn't match expected output");
+	mu_assert_false(rz_io_cache_at(io, 4), "Cache shouldn't exist at 4 after invalidate");
+	mu_assert_true(rz_io_cache_push(io), "Cache push failed");
+	mu_assert_true(rz_io_cache_write(io, 6, (ut8 *)"DD", 2), "Cache write at 6 failed");
+	mu_assert_true(rz_io_cache_write(io, 3, (ut8 *)"EEE", 3), "Cache write at 3 failed");
+	rz_io_read_at(io, 0, buf, sizeof(buf));
+	mu_assert_memeq(buf, (ut8 *)"AAAEEEDD", sizeof(buf), "IO read after merging writes doesn't match expected output");
+	mu_assert_true(rz_io_cache_pop(io), "Cache pop failed");
+	rz_io_read_at(io, 0, buf, sizeof(buf));
+	mu_assert_memeq(buf, (ut8 *)"AAAAZZZZ", sizeof(buf), "IO read after pop doesn't match expected output");
+	mu_assert_false(rz_io_cache_at(io, 4), "Cache shouldn't exist at 4 after pop");
+	mu_assert_eq(rz_list_length(&io->cache_writes), 1, "Pop should only keep the first write");
+	rz_io_free(io);
+	mu_end;
+}
+
+bool test_rz_io_ptrace_prot_none(void) {
+#if __linux__
+	// the child inherits these pages, which can only be read with ptrace
+	const size_t page = 0x1000;
+	ut8 *mem = mmap(NULL, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	mu_assert_true(mem != MAP_FAILED, "mmap failed");
+	memset(mem, 'A', page);
+	memset(mem + page, 'B', page);
+	const ut64 across = (ut64)(size_t)mem + page - 4;
+	const ut64 inside = (ut64)(size_t)mem + page;
+	ut8 across_buf[8] = { 0 }, inside_buf[8] = { 0 }, batch_buf[2][8] = { { 0 } };
+	RzIOReadReq reqs[] = {
+		{ across, batch_buf[0], sizeof(batch_buf[0]), false },
+		{ inside, batch_buf[1], sizeof(batch_buf[1]), false },
+	};
+	int across_read = -1, inside_read = -1;
+	bool batch_read = false, attached = false;
+	RzIO *io = NULL;
+	pid_t pid = -1;
+	const bool protected = !mprotect(mem + page, page, PROT_NONE);
+	if (!protected) {
+		goto beach;
+	}
+	pid = fork();
+	if (!pid) {
+		for (;;) {
+			pause();
+		}
+	}
+	if (pid < 0) {
+		goto beach;
+	}
+	io = rz_io_new();
+	char *uri = rz_str_newf("ptrace://%d", (int)pid);
+	RzIODesc *desc = rz_io_open_nomap(io, uri, RZ_PERM_R, 0);
+	free(uri);
+	if (!desc) {
+		// ptrace may not be permitted in this environment
+		eprintf("Skipping the ptrace read test, cannot attach to %d\n", (int)pid);
+		goto beach;
+	}
+	attached = true;
+	across_read = rz_io_pread_at(io, across, across_buf, sizeof(across_buf));
+	inside_read = rz_io_pread_at(io, inside, inside_buf, sizeof(inside_buf));
+	io->va = false;
+	batch_read = rz_io_read_at_batch(io, reqs, RZ_ARRAY_SIZE(reqs));
+beach:
+	rz_io_free(io);
+	if (pid > 0) {
+		kill(pid, SIGKILL);
+		waitpid(pid, NULL, 0);
+	}
+	munmap(mem, 2 * page);
+	mu_assert_true(protected, "mprotect failed");
+	mu_assert_true(pid > 0, "fork failed");
+	if (attached) {
+		mu_assert_true(across_read > 0, "ptrace read failed");
+		mu_assert_memeq(across_buf, (ut8 *)"AAAABBBB", sizeof(across_buf), "Read across a PROT_NONE page doesn't match expected output");
+		mu_assert_true(inside_read > 0, "ptrace read failed");
+		mu_assert_memeq(inside_buf, (ut8 *)"BBBBBBBB", sizeof(inside_buf), "Read of a PROT_NONE page doesn't match expected output");
+		mu_assert_true(batch_read, "ptrace batch read failed");
+		mu_assert_true(reqs[0].ok && reqs[1].ok, "ptrace batch read failed");
+		mu_assert_memeq(batch_buf[0], (ut8 *)"AAAABBBB", sizeof(batch_buf[0]), "Batch read across a PROT_NONE page doesn't match expected output");
+		mu_assert_memeq(batch_buf[1], (ut8 *)"BBBBBBBB", sizeof(batch_buf[1]), "Batch read of a PROT_NONE page doesn't match expected output");
+	}
+#endif
+	mu_end;
+}
+
 bool test_rz_io_mapsplit(void) {
 	RzIO *io = rz_io_new();
 	io->va = true;
@@ -632,6 +773,8 @@ bool test_rz_io_map_del_on_close_all(void) {
 
 bool all_tests(void) {
 	mu_run_test(test_rz_io_cache);
+	mu_run_test(test_rz_io_cache_push_pop);
+	mu_run_test(test_rz_io_cache_undo);
 	mu_run_test(test_rz_io_mapsplit);
 	mu_run_test(test_rz_io_mapsplit2);
 	mu_run_test(test_rz_io_mapsplit3);
@@ -647,6 +790,7 @@ bool all_tests(void) {
 	mu_run_test(test_rz_io_map_del_for_fd);
 	mu_run_test(test_rz_io_map_del_on_close);
 	mu_run_test(test_rz_io_map_del_on_close_all);
+	mu_run_test(test_rz_io_ptrace_prot_none);
 	return tests_passed != tests_run;
 }
 
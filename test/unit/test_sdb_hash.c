@@ -505,6 +505,67 @@ bool test_update_key(void) {
 	mu_end;
 }
 
+typedef struct {
+	ut32 visits;
+	ut64 sum;
+} CountUU;
+
+static bool count_uu_cb(void *user, const ut64 key, const ut64 value) {
+	CountUU *c = user;
+	c->visits++;
+	c->sum += value;
+	return true;
+}
+
+static bool delete_odd_uu_cb(void *user, const ut64 key, const ut64 value) {
+	if (key & 0x1000) {
+		ht_uu_delete(user, key);
+	}
+	return true;
+}
+
+bool test_ht_uu_many(void) {
+	HtUU *ht = ht_uu_new0();
+	const ut64 n = 0x10000;
+	ut64 i;
+	bool found;
+
+	// keys sharing their low bits
+	for (i = 0; i < n; i++) {
+		mu_assert("insert", ht_uu_insert(ht, i << 12, i));
+	}
+	mu_assert_eq(ht->count, n, "all the keys should be inserted");
+	mu_assert("already inserted", !ht_uu_insert(ht, 0x1000, 0));
+	for (i = 0; i < n; i++) {
+		mu_assert_eq(ht_uu_find(ht, i << 12, &found), i, "value");
+		mu_assert("found", found);
+	}
+	ht_uu_find(ht, 0x800, &found);
+	mu_assert("0x800 should not be there", !found);
+
+	for (i = 0; i < n; i += 2) {
+		mu_assert("delete", ht_uu_delete(ht, i << 12));
+	}
+	mu_assert_eq(ht->count, n / 2, "half of the keys should be deleted");
+	for (i = 0; i < n; i++) {
+		ht_uu_find(ht, i << 12, &found);
+		mu_assert_eq(found, i & 1, "only the odd keys should remain");
+	}
+
+	CountUU c = { 0 };
+	ht_uu_foreach(ht, count_uu_cb, &c);
+	mu_assert_eq(c.visits, n / 2, "every element should be visited once");
+	mu_assert_eq(c.sum, (n / 2) * (n / 2), "sum of the odd values");
+
+	mu_assert("update", ht_uu_update(ht, 0, 1));
+	ht_uu_foreach(ht, delete_odd_uu_cb, ht);
+	mu_assert_eq(ht->count, 1, "only the updated key should remain");
+	mu_assert_eq(ht_uu_find(ht, 0, NULL), 1, "updated value");
+
+	ht_uu_free(ht);
+	mu_end;
+}
+
 bool test_ht_pu_ops(void) {
 	bool res;
 	ut64 val;
@@ -555,6 +616,7 @@ int all_tests() {
 	mu_run_test(test_grow_4);
 	mu_run_test(test_foreach_delete);
 	mu_run_test(test_update_key);
+	mu_run_test(test_ht_uu_many);
 	mu_run_test(test_ht_pu_ops);
 	return tests_passed != tests_run;
 }
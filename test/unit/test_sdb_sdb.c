@@ -549,6 +549,82 @@ bool test_sdb_text_load_file() {
 	mu_end;
 }
 
+bool test_sdb_bin_save_load() {
+	Sdb *ref_db = text_ref_db();
+	mu_assert_true(sdb_bin_save(ref_db, ".bin_save_load"), "save success");
+	mu_assert_true(sdb_bin_check(".bin_save_load"), "binary file");
+
+	Sdb *db = sdb_new0();
+	bool succ = sdb_bin_load(db, ".bin_save_load");
+	mu_assert_true(succ, "load success");
+	bool eq = sdb_diff(ref_db, db, diff_cb, NULL);
+	sdb_free(db);
+	mu_assert_true(eq, "load correct");
+
+	// a single namespace
+	SdbBin *bin = sdb_bin_open(".bin_save_load");
+	mu_assert_notnull(bin, "open success");
+	db = sdb_new0();
+	succ = sdb_bin_load_ns(bin, db, "");
+	mu_assert_true(succ, "root load success");
+	eq = sdb_diff(ref_db, db, diff_cb, NULL);
+	sdb_free(db);
+	mu_assert_true(eq, "root load correct");
+	db = sdb_new0();
+	mu_assert_false(sdb_bin_load_ns(bin, db, "sub/nonexistent"), "missing namespace");
+	sdb_free(db);
+	sdb_bin_close(bin);
+	unlink(".bin_save_load");
+	sdb_free(ref_db);
+
+	// a nested namespace
+	ref_db = text_ref_broken_db();
+	mu_assert_true(sdb_bin_save(ref_db, ".bin_save_load"), "save success");
+	bin = sdb_bin_open(".bin_save_load");
+	mu_assert_notnull(bin, "open success");
+	db = sdb_new0();
+	succ = sdb_bin_load_ns(bin, db, "some/subns");
+	mu_assert_true(succ, "nested namespace load success");
+	eq = sdb_diff(sdb_ns_path(ref_db, "some/subns", false), db, diff_cb, NULL);
+	sdb_free(db);
+	mu_assert_true(eq, "nested namespace load correct");
+
+	// only the keys of a namespace
+	db = sdb_new0();
+	succ = sdb_bin_load_kvs(bin, db, "some/subns");
+	mu_assert_true(succ, "keys load success");
+	mu_assert_streq(sdb_const_get(db, "more", NULL), "equal=signs=than=one=", "keys load correct");
+	mu_assert_null(sdb_ns(db, "more", false), "no sub-namespaces");
+	sdb_free(db);
+	sdb_bin_close(bin);
+	unlink(".bin_save_load");
+	sdb_free(ref_db);
+
+	// repeated strings are stored once
+	ref_db = sdb_new0();
+	char key[32];
+	for (int i = 0; i < 100; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		sdb_set(sdb_ns(ref_db, key, true), "some rather long shared key", "and its rather long shared value", 0);
+	}
+	mu_assert_true(sdb_bin_save(ref_db, ".bin_save_load"), "save success");
+	mu_assert_true(rz_file_size(".bin_save_load") < 100 * 64, "shared strings");
+	db = sdb_new0();
+	succ = sdb_bin_load(db, ".bin_save_load");
+	mu_assert_true(succ, "load success");
+	eq = sdb_diff(ref_db, db, diff_cb, NULL);
+	sdb_free(db);
+	mu_assert_true(eq, "load correct");
+	unlink(".bin_save_load");
+	sdb_free(ref_db);
+
+	close(tmpfile_new(".bin_load_text", text_ref_simple, strlen(text_ref_simple)));
+	mu_assert_false(sdb_bin_check(".bin_load_text"), "text file");
+	mu_assert_null(sdb_bin_open(".bin_load_text"), "text file");
+	unlink(".bin_load_text");
+	mu_end;
+}
+
 int all_tests() {
 	// XXX two bugs found with crash
 	mu_run_test(test_sdb_namespace);
@@ -571,6 +647,7 @@ int all_tests() {
 	mu_run_test(test_sdb_text_load_broken);
 	mu_run_test(test_sdb_text_load_path_last_line);
 	mu_run_test(test_sdb_text_load_file);
+	mu_run_test(test_sdb_bin_save_load);
 	return tests_passed != tests_run;
 }
 
@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2023 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_search.h>
+#include "minunit.h"
+
+#define BUF_SIZE   0x4000
+#define BLOCK_SIZE 0x1000
+#define N_KWS      64
+
+static RzSearchKeyword *keyword_new(ut32 i, const ut8 *buf) {
+	char hex[64], mask[64];
+	const ut8 *src = buf + (i * 0x1f3) % (BUF_SIZE - 16);
+	int len = 1 + i % 8;
+	switch (i % 4) {
+	case 0:
+		// taken from the buffer, so it is found at least once
+		rz_hex_bin2str(src, len, hex);
+		return rz_search_keyword_new_hex(hex, NULL, NULL);
+	case 1:
+		// masked bytes in the middle
+		rz_hex_bin2str(src, len + 2, hex);
+		memset(mask, 'f', (len + 2) * 2);
+		mask[2] = mask[3] = '0';
+		mask[(len + 2) * 2] = 0;
+		return rz_search_keyword_new_hex(hex, mask, NULL);
+	case 2:
+		// fully masked keyword, matching everywhere
+		return i % 16 == 2 ? rz_search_keyword_new_hex("0000", "0000", NULL) : rz_search_keyword_new_str("AbC", NULL, NULL, true);
+	default:
+		return rz_search_keyword_new_str("abc", NULL, NULL, false);
+	}
+}
+
+static RzList *search(const ut8 *buf, ut32 first_kw, ut32 n_kws, bool overlap) {
+	RzSearch *s = rz_search_new(RZ_SEARCH_KEYWORD);
+	s->overlap = overlap;
+	for (ut32 i = first_kw; i < first_kw + n_kws; i++) {
+		rz_search_kw_add(s, keyword_new(i, buf));
+	}
+	rz_search_begin(s);
+	for (ut32 off = 0; off < BUF_SIZE; off += BLOCK_SIZE) {
+		rz_search_update(s, 0x1000 + off, buf + off, BLOCK_SIZE);
+	}
+	RzList *ret = rz_list_newf(free);
+	RzListIter *iter;
+	RzSearchHit *hit;
+	rz_list_foreach (s->hits, iter, hit) {
+		RzSearchHit *h = RZ_NEW0(RzSearchHit);
+		h->addr = hit->addr;
+		// the keyword is freed with the search, keep only its index
+		h->kw = (RzSearchKeyword *)(size_t)(hit->kw->kwidx + first_kw);
+		rz_list_append(ret, h);
+	}
+	rz_search_free(s);
+	return ret;
+}
+
+static int hit_idx_cmp(const void *a, const void *b) {
+	const RzSearchHit *ha = a, *hb = b;
+	if (ha->addr != hb->addr) {
+		return ha->addr < hb->addr ? -1 : 1;
+	}
+	return (int)(size_t)ha->kw - (int)(size_t)hb->kw;
+}
+
+static bool check_multi_search(const ut8 *buf, bool overlap) {
+	// all keywords at once, matched by the automaton
+	RzList *multi = search(buf, 0, N_KWS, overlap);
+	// every keyword alone, matched by the keyword loop
+	RzList *single = rz_list_newf(free);
+	for (ut32 i = 0; i < N_KWS; i++) {
+		RzList *hits = search(buf, i, 1, overlap);
+		rz_list_join(single, hits);
+		rz_list_free(hits);
+	}
+	rz_list_sort(single, hit_idx_cmp);
+	mu_assert_eq(rz_list_length(multi), rz_list_length(single), "number of hits");
+	RzListIter *it_multi, *it_single = rz_list_iterator(single);
+	RzSearchHit *hit;
+	rz_list_foreach (multi, it_multi, hit) {
+		RzSearchHit *expected = rz_list_iter_get(it_single);
+		mu_assert_eq(hit->addr, expected->addr, "hit address, in address order");
+		mu_assert_eq((size_t)hit->kw, (size_t)expected->kw, "hit keyword");
+	}
+	rz_list_free(multi);
+	rz_list_free(single);
+	return true;
+}
+
+bool test_rz_search_multi_keyword(void) {
+	ut8 *buf = malloc(BUF_SIZE);
+	ut32 seed = 0x1234;
+	for (ut32 i = 0; i < BUF_SIZE; i++) {
+		seed = seed * 1103515245 + 12345;
+		// a small alphabet, so that keywords are found many times
+		buf[i] = "abcABC\x00\x01"[(seed >> 16) % 8];
+	}
+	mu_assert_true(check_multi_search(buf, false), "multi keyword search");
+	mu_assert_true(check_multi_search(buf, true), "multi keyword search with overlap");
+	free(buf);
+	mu_end;
+}
+
+bool test_rz_search_multi_keyword_blocks(void) {
+	RzSearch *s = rz_search_new(RZ_SEARCH_KEYWORD);
+	rz_search_kw_add(s, rz_search_keyword_new_str("needle", NULL, NULL, false));
+	rz_search_kw_add(s, rz_search_keyword_new_str("dle", NULL, NULL, false));
+	rz_search_kw_add(s, rz_search_keyword_new_hex("aa00cc", "ff00ff", NULL));
+	rz_search_begin(s);
+	// the keywords are split between two blocks
+	const char *first = "xxxxneedlexxxxxxxxxxxxnee";
+	rz_search_update(s, 0x100, (const ut8 *)first, strlen(first));
+	const ut8 second[] = { 'd', 'l', 'e', 0xaa, 0x55, 0xcc, 'x' };
+	rz_search_update(s, 0x100 + strlen(first), second, sizeof(second));
+	mu_assert_eq(rz_list_length(s->hits), 5, "hits across blocks");
+	RzSearchHit *hit = rz_list_get_n(s->hits, 0);
+	mu_assert_eq(hit->addr, 0x104, "needle in the first block");
+	hit = rz_list_get_n(s->hits, 1);
+	mu_assert_eq(hit->addr, 0x107, "dle in the first block");
+	hit = rz_list_get_n(s->hits, 2);
+	mu_assert_eq(hit->addr, 0x116, "needle across the blocks");
+	mu_assert_eq(hit->kw->kwidx, 0, "needle across the blocks");
+	hit = rz_list_get_n(s->hits, 3);
+	mu_assert_eq(hit->addr, 0x119, "dle in the second block");
+	hit = rz_list_get_n(s->hits, 4);
+	mu_assert_eq(hit->addr, 0x11c, "masked keyword in the second block");
+	rz_search_free(s);
+	mu_end;
+}
+
+#define PARALLEL_BUF_SIZE 0x80000
+
+static RzList *search_parallel(int mode, const ut8 *buf, bool overlap, int maxhits, size_t threads) {
+	RzSearch *s = rz_search_new(mode);
+	s->overlap = overlap;
+	s->maxhits = maxhits;
+	if (mode == RZ_SEARCH_REGEXP) {
+		rz_search_kw_add(s, rz_search_keyword_new_regexp("/[aA][bB]+c/", NULL));
+	} else {
+		for (ut32 i = 0; i < N_KWS; i++) {
+			rz_search_kw_add(s, keyword_new(i, buf));
+		}
+	}
+	rz_search_begin(s);
+	// two calls, to find the keywords crossing them
+	const ut32 half = PARALLEL_BUF_SIZE / 2;
+	rz_search_update_parallel(s, 0x1000, buf, half, threads);
+	rz_search_update_parallel(s, 0x1000 + half, buf + half, half, threads);
+	RzList *ret = rz_list_newf(free);
+	RzListIter *iter;
+	RzSearchHit *hit;
+	rz_list_foreach (s->hits, iter, hit) {
+		RzSearchHit *h = RZ_NEW0(RzSearchHit);
+		h->addr = hit->addr;
+		h->kw = (RzSearchKeyword *)(size_t)hit->kw->kwidx;
+		rz_list_append(ret, h);
+	}
+	rz_search_free(s);
+	return ret;
+}
+
+static bool check_parallel_search(const ut8 *buf, int mode, bool overlap, int maxhits) {
+	RzList *serial = search_parallel(mode, buf, overlap, maxhits, 1);
+	RzList *parallel = search_parallel(mode, buf, overlap, maxhits, 4);
+	mu_assert_eq(rz_list_length(parallel), rz_list_length(serial), "number of hits");
+	mu_assert_true(rz_list_length(serial) > 0, "some hits");
+	RzListIter *it_parallel, *it_serial = rz_list_iterator(serial);
+	RzSearchHit *hit;
+	rz_list_foreach (parallel, it_parallel, hit) {
+		RzSearchHit *expected = rz_list_iter_get(it_serial);
+		mu_assert_eq(hit->addr, expected->addr, "hit address, in address order");
+		mu_assert_eq((size_t)hit->kw, (size_t)expected->kw, "hit keyword");
+	}
+	rz_list_free(serial);
+	rz_list_free(parallel);
+	return true;
+}
+
+bool test_rz_search_parallel(void) {
+	ut8 *buf = malloc(PARALLEL_BUF_SIZE);
+	ut32 seed = 0x4321;
+	for (ut32 i = 0; i < PARALLEL_BUF_SIZE; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = "abcABC\x00\x01"[(seed >> 16) % 8];
+	}
+	mu_assert_true(check_parallel_search(buf, RZ_SEARCH_KEYWORD, false, 0), "keywords");
+	mu_assert_true(check_parallel_search(buf, RZ_SEARCH_KEYWORD, true, 0), "keywords with overlap");
+	mu_assert_true(check_parallel_search(buf, RZ_SEARCH_KEYWORD, false, 1000), "keywords with maxhits");
+	mu_assert_true(check_parallel_search(buf, RZ_SEARCH_REGEXP, false, 0), "regexp");
+	free(buf);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_rz_search_multi_keyword);
+	mu_run_test(test_rz_search_multi_keyword_blocks);
+	mu_run_test(test_rz_search_parallel);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
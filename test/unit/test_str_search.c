@@ -309,6 +309,43 @@ bool test_rz_scan_strings_utf16_be(void) {
 	mu_end;
 }
 
+bool test_rz_scan_strings_padding(void) {
+	// strings surrounded by long runs of bytes which cannot start any
+	ut8 str[0x200];
+	for (size_t i = 0; i < sizeof(str); i++) {
+		str[i] = i % 0x60 < 0x40 ? 0 : 0x01 + i % 5;
+	}
+	memcpy(str + 0x43, "first string", 12);
+	memcpy(str + 0xa1, "a\0b\0c\0", 6); // too short
+	memcpy(str + 0x111, "w\0i\0d\0e\0 \0s\0t\0r\0", 16);
+	memcpy(str + 0x1e5, "\x1flast", 5);
+
+	RzList *str_list = rz_list_newf((RzListFree)rz_detected_string_free);
+	int n = rz_scan_strings_raw(str, str_list, &g_opt, 0, sizeof(str), RZ_STRING_ENC_GUESS);
+	mu_assert_eq(n, 3, "rz_scan_strings padding, number of strings");
+
+	RzDetectedString *s = rz_list_get_n(str_list, 0);
+	mu_assert_streq(s->string, "first string", "rz_scan_strings padding, first string");
+	mu_assert_eq(s->addr, 0x43, "rz_scan_strings padding, first address");
+	mu_assert_eq(s->type, RZ_STRING_ENC_8BIT, "rz_scan_strings padding, first type");
+	s = rz_list_get_n(str_list, 1);
+	mu_assert_streq(s->string, "wide str", "rz_scan_strings padding, wide string");
+	mu_assert_eq(s->addr, 0x111, "rz_scan_strings padding, wide address");
+	mu_assert_eq(s->type, RZ_STRING_ENC_UTF16LE, "rz_scan_strings padding, wide type");
+	s = rz_list_get_n(str_list, 2);
+	mu_assert_streq(s->string, "last", "rz_scan_strings padding, last string");
+	mu_assert_eq(s->addr, 0x1e6, "rz_scan_strings padding, last address");
+
+	rz_list_purge(str_list);
+	n = rz_scan_strings_raw(str, str_list, &g_opt, 0, sizeof(str), RZ_STRING_ENC_UTF8);
+	mu_assert_eq(n, 2, "rz_scan_strings padding utf8, number of strings");
+	s = rz_list_get_n(str_list, 1);
+	mu_assert_eq(s->addr, 0x1e6, "rz_scan_strings padding utf8, last address");
+
+	rz_list_free(str_list);
+	mu_end;
+}
+
 bool test_rz_scan_strings_extended_ascii(void) {
 	static const unsigned char str[] =
 		"Immensità s'annega il pensier mio: E il naufragar m'è dolce in questo mare.\x00"
@@ -354,6 +391,7 @@ bool all_tests() {
 	mu_run_test(test_rz_scan_strings_detect_utf32_be);
 	mu_run_test(test_rz_scan_strings_utf16_be);
 	mu_run_test(test_rz_scan_strings_extended_ascii);
+	mu_run_test(test_rz_scan_strings_padding);
 
 	return tests_passed != tests_run;
 }
@@ -121,6 +121,86 @@ bool test_thread_ht(void) {
 	mu_end;
 }
 
+#define HT_THREADS     8
+#define HT_THREAD_KEYS 0x1000
+
+typedef struct {
+	RzThreadHtUU *ht;
+	ut64 first;
+} HtInsertWorker;
+
+void *thread_ht_insert(HtInsertWorker *worker) {
+	for (ut64 key = worker->first; key < worker->first + HT_THREAD_KEYS; key++) {
+		if (!rz_th_ht_uu_insert(worker->ht, key, key * 2)) {
+			return NULL;
+		}
+	}
+	return worker;
+}
+
+bool test_thread_ht_concurrent(void) {
+	RzThreadHtUU *ht = rz_th_ht_uu_new0();
+	mu_assert_notnull(ht, "rz_th_ht_uu_new0() null check");
+
+	HtInsertWorker workers[HT_THREADS];
+	RzThread *threads[HT_THREADS];
+	for (ut32 i = 0; i < HT_THREADS; i++) {
+		workers[i].ht = ht;
+		workers[i].first = i * HT_THREAD_KEYS;
+		threads[i] = rz_th_new((RzThreadFunction)thread_ht_insert, &workers[i]);
+		mu_assert_notnull(threads[i], "rz_th_new() null check");
+	}
+	for (ut32 i = 0; i < HT_THREADS; i++) {
+		rz_th_wait(threads[i]);
+		mu_assert_ptreq(rz_th_get_retv(threads[i]), &workers[i], "every insert must succeed");
+		rz_th_free(threads[i]);
+	}
+
+	bool found = false;
+	for (ut64 key = 0; key < HT_THREADS * HT_THREAD_KEYS; key++) {
+		mu_assert_eq(rz_th_ht_uu_find(ht, key, &found), key * 2, "the value of every key is found");
+		mu_assert_true(found, "every key is found");
+	}
+	mu_assert_false(rz_th_ht_uu_insert(ht, 0x10, 0), "a key cannot be inserted twice");
+
+	HtUU *merged = rz_th_ht_uu_move(ht);
+	mu_assert_notnull(merged, "rz_th_ht_uu_move() null check");
+	mu_assert_eq(merged->count, HT_THREADS * HT_THREAD_KEYS, "all the keys are moved");
+	for (ut64 key = 0; key < HT_THREADS * HT_THREAD_KEYS; key++) {
+		mu_assert_eq(ht_uu_find(merged, key, &found), key * 2, "the value of every key is moved");
+		mu_assert_true(found, "every key is moved");
+	}
+	ht_uu_free(merged);
+	rz_th_ht_uu_free(ht);
+	mu_end;
+}
+
+static ut32 ht_freed;
+
+static void thread_ht_count_free(HtUPKv *kv) {
+	free(kv->value);
+	ht_freed++;
+}
+
+bool test_thread_ht_move_owner(void) {
+	HtUPOptions opt = { .freefn = thread_ht_count_free };
+	RzThreadHtUP *ht = rz_th_ht_up_new_opt(&opt);
+	mu_assert_notnull(ht, "rz_th_ht_up_new_opt() null check");
+	for (ut64 key = 0; key < HT_THREAD_KEYS; key++) {
+		mu_assert_true(rz_th_ht_up_insert(ht, key, RZ_NEW0(ut64)), "every insert must succeed");
+	}
+
+	ht_freed = 0;
+	HtUP *merged = rz_th_ht_up_move(ht);
+	mu_assert_notnull(merged, "rz_th_ht_up_move() null check");
+	mu_assert_eq(merged->count, HT_THREAD_KEYS, "all the keys are moved");
+	rz_th_ht_up_free(ht);
+	mu_assert_eq(ht_freed, 0, "the moved elements are not freed with the shards");
+	ht_up_free(merged);
+	mu_assert_eq(ht_freed, HT_THREAD_KEYS, "the moved elements are freed with the new table");
+	mu_end;
+}
+
 void thread_set_bool_arg(bool *value, bool *user) {
 	*value = true;
 	*user = true;
@@ -226,6 +306,8 @@ int all_tests() {
 	mu_run_test(test_thread_pool_cores);
 	mu_run_test(test_thread_queue);
 	mu_run_test(test_thread_ht);
+	mu_run_test(test_thread_ht_concurrent);
+	mu_run_test(test_thread_ht_move_owner);
 	mu_run_test(test_thread_iterator_list);
 	mu_run_test(test_thread_iterator_pvec);
 	return tests_passed != tests_run;